@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "batch.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "../shared.hpp"
+#include "core/arch/pep/isa/pep10.hpp"
+#include "core/math/bitmanip/strings.hpp"
+#include "sim3/cores/pep/traced_helpers.hpp"
+#include "sim3/systems/traced_pep_isa3_system.hpp"
+#include "spdlog/sinks/stdout_sinks.h"
+#include "toolchain/helpers/asmb.hpp"
+#include "toolchain/helpers/assemblerregistry.hpp"
+#include "toolchain/macro/declaration.hpp"
+#include "toolchain/pas/ast/generic/attr_symbol.hpp"
+#include "toolchain/pas/driver/pep10.hpp"
+#include "toolchain/pas/obj/pep10.hpp"
+#include "toolchain/pas/operations/generic/errors.hpp"
+#include "toolchain/pas/operations/pepp/bytes.hpp"
+#include "toolchain/symbol/entry.hpp"
+#include "toolchain/symbol/fork.hpp"
+#include "toolchain/symbol/table.hpp"
+#include "toolchain/symbol/visit.hpp"
+
+namespace {
+std::optional<QString> readFile(const QString &fname) {
+  QFile f(fname); // auto-closes
+  if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return std::nullopt;
+  return QString(f.readAll());
+}
+
+// Formatted like helpers::AsmHelper::errors() for a user program.
+QStringList userErrors(const QString &src, const pas::ast::Node *root, const QMap<size_t, QString> &lexErrors) {
+  QStringList ret;
+  auto lines = src.split("\n");
+  if (!lexErrors.empty() && root == nullptr) {
+    ret << "User Lexical Errors:\n";
+    for (const auto &err : lexErrors.asKeyValueRange()) {
+      ret << QStringLiteral(";Line %1").arg(QString::number(err.first + 1));
+      ret << QStringLiteral("%1 ;ERROR: %2").arg(lines[err.first]).arg(err.second);
+    }
+  }
+  if (auto errors = root ? pas::ops::generic::collectErrors(*root) : decltype(pas::ops::generic::collectErrors(*root)){};
+      !errors.empty()) {
+    ret << "User Errors:\n";
+    for (const auto &err : errors) {
+      ret << QStringLiteral(";Line %1").arg(QString::number(err.first.value.line + 1));
+      ret << QStringLiteral("%1 ;ERROR: %2").arg(lines[err.first.value.line]).arg(err.second.message);
+    }
+  }
+  return ret;
+}
+} // namespace
+
+BatchTask::BatchTask(int ed, std::string manifest, QObject *parent) : Task(parent), _ed(ed), _manifest(manifest) {
+  auto console_sink = std::make_shared<spdlog::sinks::stderr_sink_mt>();
+  console_sink->set_level(spdlog::level::warn);
+  console_sink->set_pattern("%v%");
+  _log.sinks() = {console_sink};
+  _log.flush_on(spdlog::level::warn);
+}
+
+void BatchTask::setThreads(int threads) { _threads = threads; }
+
+void BatchTask::setMaxSteps(quint64 maxSteps) { _maxSteps = maxSteps; }
+
+void BatchTask::setBm(bool forceBm) { _forceBm = forceBm; }
+
+void BatchTask::setOsIn(std::string fname) { _osIn = fname; }
+
+void BatchTask::setMacroDirs(std::list<std::string> dirs) { _macroDirs = dirs; }
+
+bool BatchTask::warmUp() {
+  if (_ed != 6) {
+    _log.error("Batch mode only supports Pep/10");
+    return false;
+  }
+  _books = helpers::builtins_registry(false);
+  auto book = helpers::book(_ed, &*_books);
+  if (book == nullptr) return false;
+  if (_forceBm) {
+    _osContents = QString::fromStdString(book->find_figure("os", "pep10baremetal")->default_fragment_text());
+  } else if (!_osIn.has_value()) {
+    _osContents = QString::fromStdString(book->find_figure("os", "pep10os")->default_fragment_text());
+  } else if (auto os = readFile(QString::fromStdString(*_osIn)); os) {
+    _osContents = *os;
+  } else {
+    _log.error("Failed to open OS file for reading:  {}", *_osIn);
+    return false;
+  }
+  _macros = helpers::registry(book, {});
+  helpers::addMacros(*_macros, _macroDirs, "Pep/10");
+
+  // Assembling the OS adds its system calls to the registry, which user programs need in order to use them.
+  auto osMacros = jobMacros();
+  helpers::AsmHelper helper(osMacros, _osContents);
+  if (!helper.assemble()) {
+    _log.error("OS assembly failed: ");
+    for (auto &error : helper.errors()) _log.error("  {}", error.toStdString());
+    return false;
+  }
+  _macros = osMacros;
+  _osSymbols = helper.osRoot()->get<pas::ast::generic::SymbolTable>().value;
+  std::stringstream s;
+  helper.elf()->save(s);
+  _osElf = s.str();
+  return true;
+}
+
+QSharedPointer<macro::Registry> BatchTask::jobMacros() const {
+  // Declarations are immutable, so the copies can share them.
+  auto ret = QSharedPointer<macro::Registry>::create();
+  for (auto type : {macro::types::Core, macro::types::System, macro::types::User})
+    for (auto registration : _macros->findMacrosByType(type))
+      ret->registerMacro(type, qSharedPointerConstCast<macro::Declaration>(registration->contents()));
+  return ret;
+}
+
+QJsonObject BatchTask::runJob(const QJsonObject &job) const {
+  QElapsedTimer timer;
+  timer.start();
+  QJsonObject ret{{"id", job["id"]}};
+  auto fail = [&](const char *status, QString error) {
+    ret["status"] = status;
+    ret["error"] = error;
+    return ret;
+  };
+
+  quint64 maxSteps = _maxSteps;
+  if (job.contains("max_steps")) {
+    // toInteger() yields 0 for non-integral values, so check the double as well.
+    const auto value = job["max_steps"];
+    if (!value.isDouble() || value.toDouble() < 0 || value.toDouble() != double(value.toInteger()))
+      return fail("bad_job", "max_steps must be a non-negative integer");
+    maxSteps = value.toInteger();
+  }
+
+  // Both kinds of job are placed next to the already-assembled OS. Source jobs are linked against a private fork of the
+  // OS's exported symbols, rather than assembling a fresh copy of the OS.
+  auto elf = QSharedPointer<ELFIO::elfio>::create();
+  {
+    std::stringstream s(_osElf);
+    elf->load(s);
+  }
+  if (job.contains("src")) {
+    auto src = readFile(job["src"].toString());
+    if (!src) return fail("load_error", "Failed to open source file");
+    using namespace pas::driver;
+    auto osSymbols = symbol::fork(_osSymbols);
+    Pipeline<pep10::Stage> pipeline;
+    pipeline.globals = QSharedPointer<Globals>::create();
+    pipeline.globals->macroRegistry = jobMacros();
+    for (auto &entry : symbol::enumerate(osSymbols->map(&*_osSymbols)))
+      if (entry->binding == symbol::Binding::kGlobal) pipeline.globals->table[entry->name] = entry;
+    pipeline.pipelines.push_back(pep10::stages<ANTLRParserTag>(*src, {.isOS = false}));
+    const bool assembled = pipeline.assemble(pep10::Stage::End);
+    auto root = pipeline.pipelines[0].first->bodies[repr::Nodes::name].value<repr::Nodes>().value;
+    if (!assembled || !root) {
+      ret["status"] = "asm_error";
+      ret["errors"] = QJsonArray::fromStringList(userErrors(*src, root.data(), pipeline.lexErrors));
+      return ret;
+    }
+    pas::obj::pep10::combineSections(*root);
+    pas::obj::pep10::writeUser(*elf, *root);
+    if (job["emit_object"].toBool())
+      ret["object"] = pas::ops::pepp::bytesToObject(pas::ops::pepp::toBytes<isa::Pep10>(*root));
+  } else if (job.contains("obj")) {
+    auto obj = readFile(job["obj"].toString());
+    if (!obj) return fail("load_error", "Failed to open object code");
+    auto objText = obj->toStdString();
+    auto bytes = bits::asciiHexToByte({objText.data(), objText.size()});
+    if (!bytes) return fail("load_error", "Object code is malformed");
+    pas::obj::pep10::writeUser(*elf, *bytes);
+  } else return fail("bad_job", "Job must contain src or obj");
+  // Save and load so that offsets will be correct.
+  {
+    std::stringstream relocated;
+    elf->save(relocated);
+    relocated.seekg(0, std::ios::beg);
+    elf->load(relocated);
+  }
+
+  auto system = targets::isa::systemFromElf(*elf, true);
+  system->init();
+  auto endpoint = system->output("pwrOff")->endpoint();
+  if (auto charIn = system->input("charIn"); charIn) {
+    std::optional<QString> input = std::nullopt;
+    if (job.contains("input")) input = job["input"].toString();
+    else if (job.contains("charIn") && !(input = readFile(job["charIn"].toString())))
+      return fail("load_error", "Failed to open charIn");
+    auto charInEndpoint = charIn->endpoint();
+    if (input)
+      for (auto c : input->toUtf8()) charInEndpoint->append_value(c);
+  }
+
+  const char *status = "ok";
+  try {
+    while (system->currentTick() < maxSteps && !endpoint->next_value().has_value())
+      system->tick(sim::api2::Scheduler::Mode::Jump);
+    if (system->currentTick() >= maxSteps) status = "fuel_exhausted";
+  } catch (const sim::api2::memory::Error &e) {
+    if (e.type() == sim::api2::memory::Error::Type::NeedsMMI) status = "needs_input";
+    else {
+      status = "memory_error";
+      ret["error"] = e.what();
+    }
+  } catch (const targets::isa::IllegalOpcode &) {
+    status = "illegal_opcode";
+  }
+
+  if (auto charOut = system->output("charOut"); charOut) {
+    auto charOutEndpoint = charOut->endpoint();
+    charOutEndpoint->set_to_head();
+    QByteArray out;
+    for (auto next = charOutEndpoint->next_value(); next.has_value(); next = charOutEndpoint->next_value())
+      out.append(char(*next));
+    ret["output"] = QString::fromUtf8(out);
+  }
+  ret["status"] = status;
+  ret["steps"] = qint64(system->currentTick());
+  ret["micros"] = qint64(timer.nsecsElapsed() / 1000);
+  return ret;
+}
+
+void BatchTask::emitResult(const QJsonObject &result) {
+  auto line = QJsonDocument(result).toJson(QJsonDocument::Compact).toStdString();
+  QMutexLocker lock(&_outLock);
+  std::cout << line << std::endl;
+}
+
+void BatchTask::run() {
+  if (!warmUp()) return emit finished(1);
+
+  std::ifstream file;
+  std::istream *in = &std::cin;
+  if (_manifest != "-") {
+    file.open(_manifest);
+    if (!file.is_open()) {
+      _log.error("Failed to open manifest for reading:  {}", _manifest);
+      return emit finished(2);
+    }
+    in = &file;
+  }
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(_threads > 0 ? _threads : QThread::idealThreadCount());
+  std::atomic<qint64> jobs = 0, passed = 0;
+  QElapsedTimer timer;
+  timer.start();
+  // Jobs are started as they are read, so that a producer on stdin does not need to finish before results appear.
+  std::string line;
+  for (qint64 lineNo = 1; std::getline(*in, line); lineNo++) {
+    if (QByteArray::fromStdString(line).trimmed().isEmpty()) continue;
+    jobs++;
+    QJsonParseError error;
+    auto doc = QJsonDocument::fromJson(QByteArray::fromStdString(line), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+      auto message = error.error != QJsonParseError::NoError ? error.errorString() : QStringLiteral("Job must be an object");
+      emitResult({{"id", lineNo}, {"status", "bad_job"}, {"error", message}});
+      continue;
+    }
+    auto job = doc.object();
+    if (!job.contains("id")) job["id"] = lineNo;
+    pool.start([this, job, &passed]() {
+      QJsonObject result;
+      try {
+        result = runJob(job);
+      } catch (const std::exception &e) {
+        result = {{"id", job["id"]}, {"status", "internal_error"}, {"error", e.what()}};
+      }
+      if (result["status"] == "ok") passed++;
+      emitResult(result);
+    });
+  }
+  pool.waitForDone();
+
+  const double seconds = timer.nsecsElapsed() / 1e9;
+  QJsonObject summary{{"jobs", jobs.load()},
+                      {"ok", passed.load()},
+                      {"seconds", seconds},
+                      {"jobs_per_sec", seconds > 0 ? jobs.load() / seconds : 0.0}};
+  emitResult({{"summary", summary}});
+  emit finished(0);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <CLI11.hpp>
+#include "../shared.hpp"
+#include "../task.hpp"
+#include "spdlog/logger.h"
+
+namespace macro {
+class Registry;
+}
+namespace pepp {
+class BuiltinRegistry;
+}
+namespace symbol {
+class Table;
+}
+
+// Assembles and runs many programs in one process, so that the book registry, macro registry, and assembled OS are
+// only loaded once. Source jobs are assembled by themselves and linked against the OS's exported symbols.
+//
+// Jobs are read one per line, as JSON objects, from a manifest file or stdin. Each job names either a source file
+// ("src") or an object code file ("obj"), and may provide charIn ("input" as text, or "charIn" as a path) and its own
+// fuel limit ("max_steps"). Results are written to stdout as one JSON object per line, in completion order, followed by
+// a summary line.
+class BatchTask : public Task {
+public:
+  BatchTask(int ed, std::string manifest, QObject *parent = nullptr);
+  void setThreads(int threads);
+  void setMaxSteps(quint64 maxSteps);
+  void setBm(bool forceBm);
+  void setOsIn(std::string fname);
+  void setMacroDirs(std::list<std::string> dirs);
+  void run() override;
+
+private:
+  // Load everything shared between jobs. Returns false if the OS does not assemble.
+  bool warmUp();
+  // A fresh copy of _macros.
+  // Assembling a program may register system calls in the registry it is given, so registries cannot be shared.
+  QSharedPointer<macro::Registry> jobMacros() const;
+  QJsonObject runJob(const QJsonObject &job) const;
+  void emitResult(const QJsonObject &result);
+
+  int _ed, _threads = 0;
+  std::string _manifest;
+  quint64 _maxSteps = 125'000;
+  bool _forceBm = false;
+  std::optional<std::string> _osIn;
+  std::list<std::string> _macroDirs;
+  spdlog::logger _log{"Pepp"};
+
+  // Shared, read-only state once warmUp() succeeds.
+  std::shared_ptr<pepp::BuiltinRegistry> _books;
+  // Book, user, and the OS's system call macros. Only ever read, and never passed to an assembler. See jobMacros().
+  QSharedPointer<macro::Registry> _macros;
+  QString _osContents;
+  // The OS's symbols. Each source job links against its own fork, since linking may mark symbols as multiply defined.
+  QSharedPointer<const symbol::Table> _osSymbols;
+  // The OS by itself, saved as an ELF. Jobs append their program to a copy rather than re-assembling the OS.
+  std::string _osElf;
+  QMutex _outLock;
+};
+
+void registerBatch(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
+  static bool bm = false;
+  static std::string manifest, osIn;
+  static int threads = 0;
+  static uint64_t maxSteps = 125'000;
+  static std::list<std::string> macroDirs;
+  static CLI::Option *bmOpt = nullptr;
+
+  static auto batchSC =
+      app.add_subcommand("batch", "Assemble and run a stream of jobs, reading one JSON object per line");
+  batchSC
+      ->add_option("-s,manifest", manifest,
+                   "File containing one job per line. The value `-` causes jobs to be read from stdin.")
+      ->default_val("-");
+  batchSC->add_option("-j,--jobs", threads, "Number of jobs to run at once. Defaults to the number of cores.")
+      ->check(CLI::NonNegativeNumber);
+  batchSC
+      ->add_option("--max,-m", maxSteps,
+                   "Maximum number of instructions a job may execute, unless the job sets max_steps.")
+      ->default_val(125'000);
+  static auto osOpt = batchSC->add_option("--os", osIn, "File from which os will be read.");
+  if (flags.edValue == 6) bmOpt = batchSC->add_flag("--bm", bm, "Use bare metal OS.")->excludes(osOpt);
+  static auto macroDirOpts = batchSC->add_option("--md,--macro-dir", macroDirs);
+  batchSC->callback([&]() {
+    flags.kind = detail::SharedFlags::Kind::TERM;
+    task = [&](QObject *parent) {
+      auto ret = new BatchTask(flags.edValue, manifest, parent);
+      ret->setThreads(threads);
+      ret->setMaxSteps(maxSteps);
+      if (bmOpt && *bmOpt) ret->setBm(bm);
+      else if (*osOpt) ret->setOsIn(osIn);
+      if (*macroDirOpts) ret->setMacroDirs(macroDirs);
+      return ret;
+    };
+  });
+}
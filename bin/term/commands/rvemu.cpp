@@ -11,6 +11,7 @@
 #include <sim3/systems/notraced_riscv_isa3_system/debug.hpp>
 #include <stdexcept>
 #include <string>
+#include "sim3/cores/riscv/decode/superinstructions.hpp"
 #include "sim3/systems/notraced_riscv_isa3_system.hpp"
 #include "sim3/systems/notraced_riscv_isa3_system/debug.hpp"
 #include "sim3/systems/notraced_riscv_isa3_system/rsp_server.hpp"
@@ -40,6 +41,10 @@ static int run_program(const RVEmuTask::Arguments &cli_args, const std::string_v
       .verbose_loader = cli_args.verbose,
       .use_shared_execute_segments =
           false, // We are only creating one machine, disabling this can enable some optimizations
+      .fuse_superinstructions = !cli_args.no_fusion,
+      .persistent_decoder_cache = cli_args.decoder_cache,
+      .translate_enabled = cli_args.translate || cli_args.translate_wait,
+      .translation_wait = cli_args.translate_wait,
 #ifdef NODEJS_WORKAROUND
       .ebreak_locations =
           {
@@ -251,10 +256,19 @@ static int run_program(const RVEmuTask::Arguments &cli_args, const std::string_v
   if (!cli_args.silent) {
     const auto retval = machine.return_value();
     spdlog::info(">>> Program exited, exit code = {} ({:0x})", int64_t(retval), uint64_t(retval));
-    if (cli_args.accurate)
+    if (cli_args.accurate || cli_args.translate || cli_args.translate_wait)
       spdlog::info("Instructions executed: {}  Runtime: {:.3}ms  Insn/s: {:.0}mi/s\n", machine.instruction_counter(),
                    runtime.count() * 1000.0, machine.instruction_counter() / (runtime.count() * 1e6));
     else spdlog::info("Runtime: {:.3}ms   (Use --accurate for instruction counting)\n", runtime.count() * 1000.0);
+    if (cli_args.verbose) {
+      const auto &counters = riscv::fusion_counters();
+      for (size_t it = 0; it < riscv::FUSED_IDIOM_NAMES.size(); it++) {
+        if (riscv::fusion_counters_enabled)
+          spdlog::info("Fused {}: {} sites, {} executed", riscv::FUSED_IDIOM_NAMES[it], counters.sites[it].load(),
+                       counters.hits[it].load());
+        else spdlog::info("Fused {}: {} sites", riscv::FUSED_IDIOM_NAMES[it], counters.sites[it].load());
+      }
+    }
     spdlog::info("Pages in use: {} ({} kB virtual memory, total {} kB)\n", machine.memory.pages_active(),
                  machine.memory.pages_active() * riscv::Page::size() / uint64_t(1024),
                  machine.memory.memory_usage_total() / uint64_t(1024));
@@ -402,6 +416,15 @@ void register_rvemu(CLI::App &app, task_factory_t &task, detail::SharedFlags &fl
   static auto config = rvemu->add_option_group("Simulation", "Control simulator resource usage and simulation");
   static auto accurate_flag =
       rvemu->add_flag("-a,--accurate", args.accurate, "Accurate instruction counting with precise exceptions.");
+  static auto decoder_cache_flag = rvemu->add_flag("--decoder-cache", args.decoder_cache,
+                                                   "Keep decoded programs on disk, speeding up later runs");
+  static auto no_fusion_flag =
+      rvemu->add_flag("--no-fusion", args.no_fusion, "Execute common instruction pairs separately, for comparison");
+  static auto translate_flag =
+      rvemu->add_flag("--translate", args.translate,
+                      "Compile hot blocks to native code with the host C compiler, used from the next run on");
+  static auto translate_wait_flag = rvemu->add_flag(
+      "--translate-wait", args.translate_wait, "Like --translate, but wait for the compiler before starting the program");
   static auto fuel_opt = rvemu->add_option("-f,--fuel", args.fuel, "Set max instructions until program halts");
   static auto memory_opt =
       rvemu->add_option("-m,--memory", args.max_memory, "Set max memory size in MiB (default: 4096 MiB)");
@@ -28,6 +28,10 @@ public:
     bool verbose = false;
     bool quit = false;
     bool accurate = false;
+    bool translate = false;
+    bool translate_wait = false;
+    bool decoder_cache = false;
+    bool no_fusion = false;
     bool instr_trace = false;
     bool debug = false;
     bool silent = false;
@@ -18,8 +18,10 @@
 #include "throughput.hpp"
 #include <chrono>
 #include <iostream>
+#include <optional>
 #include "core/integers.h"
 #include "core/sim/cores/cpu/pep_isa.hpp"
+#include "core/sim/debugger/watchpoints.hpp"
 #include "core/sim/memory/bus/simplebus.hpp"
 #include "core/sim/memory/ram/dense.hpp"
 #include "core/sim/system.hpp"
@@ -77,24 +79,39 @@ ThroughputTask::ThroughputTask(WhichVersion ver, QObject *parent) : Task(parent)
 
 void ThroughputTask::run() {
   using namespace Qt::StringLiterals;
+  using Duration = std::chrono::high_resolution_clock::duration;
+  const auto locale = std::locale("en_US.UTF-8");
+  std::optional<double> baseline;
+  auto report = [&](Duration d) {
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(d);
+    const auto per_second = maxInstr / std::chrono::duration<double>(d).count();
+    fmt::println("Duration: {} ms", ms.count());
+    std::cout << fmt::format(locale, "Instructions: {:L}\n", maxInstr);
+    std::cout << fmt::format(locale, "Throughput: {:L} instructions/second\n", (u64)per_second);
+    // Everything after sim3 is also reported relative to it, since that is the number the others are chasing.
+    if (baseline) fmt::println("Relative to sim3: {:.2f}x", per_second / *baseline);
+    return per_second;
+  };
 
-  std::chrono::high_resolution_clock::time_point start;
   switch (_version) {
-  case WhichVersion::Sim3: start = do_sim3(); break;
-  case WhichVersion::Core: start = do_core(); break;
+  case WhichVersion::Sim3: report(do_sim3()); break;
+  case WhichVersion::Core:
+    for (const auto count : watchpoints) report(do_core(count));
+    break;
+  case WhichVersion::CoreTick:
+    for (const auto count : watchpoints) report(do_core_tick(count));
+    break;
+  case WhichVersion::All:
+    baseline = report(do_sim3());
+    for (const auto count : watchpoints) report(do_core_tick(count));
+    for (const auto count : watchpoints) report(do_core(count));
+    break;
   }
-  const auto end = std::chrono::high_resolution_clock::now();
-  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-  const auto dt = 1.0 / (ms.count() / 1000.0);
-  const auto locale = std::locale("en_US.UTF-8");
-  fmt::println("Duration: {} ms", ms.count());
-  std::cout << fmt::format(locale, "Instructions: {:L}\n", maxInstr);
-  std::cout << fmt::format(locale, "Throughput: {:L} instructions/second\n", (i32)(dt * maxInstr));
 
   emit finished(0);
 }
 
-std::chrono::high_resolution_clock::time_point ThroughputTask::do_sim3() {
+std::chrono::high_resolution_clock::duration ThroughputTask::do_sim3() {
   static constexpr sim::api2::memory::Operation rw = {
       .type = sim::api2::memory::Operation::Type::Standard,
       .kind = sim::api2::memory::Operation::Kind::data,
@@ -121,15 +138,16 @@ std::chrono::high_resolution_clock::time_point ThroughputTask::do_sim3() {
   mem->write(0, {program.data(), program.size()}, rw);
   const auto start = std::chrono::high_resolution_clock::now();
   for (int it = 0; it < maxInstr; it++) cpu->clock(it);
-  return start;
+  return std::chrono::high_resolution_clock::now() - start;
 }
 
-std::chrono::high_resolution_clock::time_point ThroughputTask::do_core() {
+namespace {
+// Infinite looping branch to 0, with every hint the CPU needs to know it is untraced.
+auto make_core_loop() {
   static constexpr auto rw = Operation{Operation::Type::Standard, Operation::Kind::data};
-  fmt::println("Selected: core");
-  auto [system, mem, cpu] = make_core();
+  auto ret = make_core();
+  auto &[system, mem, cpu] = ret;
   cpu->write_register(isa::Pep10::Register::PC, 0x0000);
-  // Infinite looping branch to 0.
   const auto program = std::array<u8, 3>{static_cast<u8>(isa::Pep10::Mnemonic::BR), 0x00, 0x00};
   mem->write(0x0000, {program.data(), program.size()}, rw);
   // We are untraced, provide explicit hints to avoid recording.
@@ -137,7 +155,37 @@ std::chrono::high_resolution_clock::time_point ThroughputTask::do_core() {
   cpu->on_traced_changed(false);
   cpu->csrs()->on_traced_changed(false);
   cpu->registers()->on_traced_changed(false);
+  return ret;
+}
+
+// The first watchpoint shares a page with the loop, so every fetch takes the slow path through the page filter and
+// walks the list. The remainder sit in pages the loop never touches, and only cost memory.
+void add_watchpoints(WatchpointSet &wps, std::size_t count) {
+  for (std::size_t it = 0; it < count; it++) {
+    const auto lower = it == 0 ? Address{0x0010} : static_cast<Address>(0x0100 * it);
+    wps.add(AddressSpan(lower, lower + 1), WatchpointSet::Write);
+  }
+}
+} // namespace
+
+std::chrono::high_resolution_clock::duration ThroughputTask::do_core(std::size_t watchpoints) {
+  fmt::println("Selected: core, {} watchpoint(s)", watchpoints);
+  auto [system, mem, cpu] = make_core_loop();
+  WatchpointSet wps;
+  add_watchpoints(wps, watchpoints);
+  if (watchpoints > 0) mem->set_watchpoints(&wps);
+  const auto start = std::chrono::high_resolution_clock::now();
+  cpu->run(maxInstr);
+  return std::chrono::high_resolution_clock::now() - start;
+}
+
+std::chrono::high_resolution_clock::duration ThroughputTask::do_core_tick(std::size_t watchpoints) {
+  fmt::println("Selected: core-tick, {} watchpoint(s)", watchpoints);
+  auto [system, mem, cpu] = make_core_loop();
+  WatchpointSet wps;
+  add_watchpoints(wps, watchpoints);
+  if (watchpoints > 0) mem->set_watchpoints(&wps);
   const auto start = std::chrono::high_resolution_clock::now();
   for (int it = 0; it < maxInstr; it++) cpu->clock_tick(PulseSchedule::PulseIndex{(u64)it}, it);
-  return start;
+  return std::chrono::high_resolution_clock::now() - start;
 }
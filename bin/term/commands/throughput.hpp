@@ -16,6 +16,7 @@
 
 #include <QtCore>
 #include <chrono>
+#include <vector>
 #include "../shared.hpp"
 #include "../task.hpp"
 #include "CLI11.hpp"
@@ -24,14 +25,19 @@
 class ThroughputTask : public Task {
   Q_OBJECT
 public:
-  enum class WhichVersion { Sim3, Core };
+  // Core runs PepISA3CPU::run(), CoreTick the same CPU one clock_tick at a time, and All each of the others in turn.
+  enum class WhichVersion { Sim3, Core, CoreTick, All };
   ThroughputTask(WhichVersion ver, QObject *parent = nullptr);
   ~ThroughputTask() = default;
   void run();
-  // Both should return their "start" time
-  std::chrono::high_resolution_clock::time_point do_sim3();
-  std::chrono::high_resolution_clock::time_point do_core();
+  // Each returns how long it took to run maxInstr instructions, excluding setup.
+  // The core versions attach that many never-hit data watchpoints to memory first.
+  std::chrono::high_resolution_clock::duration do_sim3();
+  std::chrono::high_resolution_clock::duration do_core(std::size_t watchpoints = 0);
+  std::chrono::high_resolution_clock::duration do_core_tick(std::size_t watchpoints = 0);
   u64 maxInstr = 100'000'000;
+  // The core versions are run once per entry.
+  std::vector<std::size_t> watchpoints = {0};
 
 private:
   WhichVersion _version;
@@ -39,21 +45,28 @@ private:
 
 void registerThroughput(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
   static auto instrThruSC = app.add_subcommand("mit", "Measure instruction throughput");
-  static ThroughputTask::WhichVersion version = ThroughputTask::WhichVersion::Sim3;
+  static ThroughputTask::WhichVersion version = ThroughputTask::WhichVersion::All;
   static u64 maxInstr = 100'000'000;
+  static std::vector<std::size_t> watchpoints = {0};
   auto versionOpt =
       instrThruSC->add_option("-v,--version", version, "Which version to run")
           ->transform(CLI::CheckedTransformer(std::map<std::string, ThroughputTask::WhichVersion>{
-              {"sim3", ThroughputTask::WhichVersion::Sim3}, {"core", ThroughputTask::WhichVersion::Core}}));
+              {"sim3", ThroughputTask::WhichVersion::Sim3},
+              {"core", ThroughputTask::WhichVersion::Core},
+              {"core-tick", ThroughputTask::WhichVersion::CoreTick},
+              {"all", ThroughputTask::WhichVersion::All}}));
 
   static auto maxInstrOpt =
       instrThruSC->add_option("-n,--max-instr", maxInstr, "Maximum number of instructions to run");
+  static auto watchpointsOpt = instrThruSC->add_option(
+      "-w,--watchpoints", watchpoints, "Number of data watchpoints to attach to memory, e.g. 0 1 128");
   instrThruSC->group("");
   instrThruSC->callback([&]() {
     flags.kind = detail::SharedFlags::Kind::TERM;
     task = [](QObject *parent) {
       auto ret = new ThroughputTask(version, parent);
       ret->maxInstr = maxInstr;
+      ret->watchpoints = watchpoints;
       return ret;
     };
   });
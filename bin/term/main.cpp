@@ -23,6 +23,7 @@
 #include "./task.hpp"
 #include "commands/about.hpp"
 #include "commands/asm.hpp"
+#include "commands/batch.hpp"
 #include "commands/binutils/addr2line.hpp"
 #include "commands/binutils/readelf.hpp"
 #include "commands/dumpbooks.hpp"
@@ -89,6 +90,7 @@ int main(int argc, char **argv) {
   registerMicroAsm(app, task, shared_flags);
   registerRun(app, task, shared_flags);
   registerMicroRun(app, task, shared_flags);
+  registerBatch(app, task, shared_flags);
   // binutils-like programs
   registerReadelf(app, task, shared_flags);
   registerAddr2Line(app, task, shared_flags);
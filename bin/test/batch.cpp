@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "config.hpp"
+
+TEST_CASE("Terminal, batch", "[term][cli]") {
+  auto path = term_path();
+  QTemporaryDir dir;
+  {
+    auto in = QFile(dir.filePath("in.pep"));
+    REQUIRE(in.open(QIODevice::WriteOnly));
+    in.write("SCALL 0,i\n");
+    in.close();
+    auto loop = QFile(dir.filePath("loop.pep"));
+    REQUIRE(loop.open(QIODevice::WriteOnly));
+    loop.write("top: BR top\n");
+    loop.close();
+  }
+
+  QProcess term;
+  term.setWorkingDirectory(dir.path());
+  term.start(path, {"batch", "--bm", "-j", "2"});
+  REQUIRE(term.waitForStarted());
+  term.write(R"({"id": "scall", "src": "in.pep"})"
+             "\n"
+             R"({"id": "loop", "src": "loop.pep", "max_steps": 1000})"
+             "\n"
+             "not json\n"
+             R"({"id": "negative", "src": "loop.pep", "max_steps": -1})"
+             "\n");
+  term.closeWriteChannel();
+  wait_return(term, 0);
+
+  // Results arrive in completion order, so index them by id.
+  QMap<QString, QJsonObject> results;
+  QJsonObject summary;
+  for (const auto &line : out(term).split("\n", Qt::SkipEmptyParts)) {
+    auto obj = QJsonDocument::fromJson(line.toUtf8()).object();
+    if (obj.contains("summary")) summary = obj["summary"].toObject();
+    else results[obj["id"].toVariant().toString()] = obj;
+  }
+  REQUIRE(results.size() == 4);
+  CHECK(results["scall"]["status"].toString() == "ok");
+  CHECK(results["scall"]["output"].toString() == "Cannot use system calls in bare metal mode");
+  CHECK(results["loop"]["status"].toString() == "fuel_exhausted");
+  CHECK(results["loop"]["steps"].toInteger() >= 1000);
+  CHECK(results["3"]["status"].toString() == "bad_job");
+  CHECK(results["negative"]["status"].toString() == "bad_job");
+  CHECK(summary["jobs"].toInteger() == 4);
+  CHECK(summary["ok"].toInteger() == 1);
+}
+
+TEST_CASE("Terminal, batch with the full OS", "[term][cli]") {
+  auto path = term_path();
+  QTemporaryDir dir;
+  {
+    auto in = QFile(dir.filePath("in.pep"));
+    REQUIRE(in.open(QIODevice::WriteOnly));
+    in.write("@MAC\nLDWA charIn,i\n@DECO 42,i\nRET\n");
+    in.close();
+    auto macroDir = QDir(dir.path()).filePath("macros");
+    QDir(macroDir).mkpath(".");
+    auto mac = QFile(macroDir + "/mac.pepm");
+    REQUIRE(mac.open(QIODevice::WriteOnly));
+    mac.write("@MAC 0\nLDWA 0,i\n");
+    mac.close();
+  }
+
+  // Every job links against the OS's symbols and system calls, which were assembled once. Many concurrent jobs catch
+  // registries or symbols that are shared between jobs.
+  constexpr int count = 16;
+  QProcess term;
+  term.setWorkingDirectory(dir.path());
+  term.start(path, {"batch", "-j", "4", "--macro-dir", "macros"});
+  REQUIRE(term.waitForStarted());
+  for (int it = 0; it < count; it++) term.write(R"({"src": "in.pep"})" "\n");
+  term.closeWriteChannel();
+  wait_return(term, 0);
+
+  QJsonObject summary;
+  int results = 0;
+  for (const auto &line : out(term).split("\n", Qt::SkipEmptyParts)) {
+    auto obj = QJsonDocument::fromJson(line.toUtf8()).object();
+    if (obj.contains("summary")) {
+      summary = obj["summary"].toObject();
+      continue;
+    }
+    results++;
+    CHECK(obj["status"].toString() == "ok");
+    CHECK(obj["output"].toString() == "42");
+  }
+  CHECK(results == count);
+  CHECK(summary["ok"].toInteger() == count);
+}
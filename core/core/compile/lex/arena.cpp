@@ -0,0 +1,58 @@
+/*
+ * /Copyright (c) 2026. Stanley Warford, Matthew McRaven
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/compile/lex/arena.hpp"
+
+pepp::tc::lex::TokenArena::~TokenArena() { clear(); }
+
+pepp::tc::lex::TokenArena::TokenArena(TokenArena &&other) noexcept
+    : _blocks(std::move(other._blocks)), _offset(std::exchange(other._offset, BLOCK_SIZE)),
+      _tokens(std::move(other._tokens)) {
+  other._blocks.clear(), other._tokens.clear();
+}
+
+pepp::tc::lex::TokenArena &pepp::tc::lex::TokenArena::operator=(TokenArena &&other) noexcept {
+  if (this == &other) return *this;
+  clear();
+  _blocks = std::move(other._blocks);
+  _tokens = std::move(other._tokens);
+  _offset = std::exchange(other._offset, BLOCK_SIZE);
+  other._blocks.clear(), other._tokens.clear();
+  return *this;
+}
+
+void pepp::tc::lex::TokenArena::clear() noexcept {
+  // Destroy in reverse creation order, like any other scope would.
+  for (auto it = _tokens.rbegin(); it != _tokens.rend(); ++it) (*it)->~Token();
+  _tokens.clear();
+  if (_blocks.size() > 1) _blocks.resize(1);
+  _offset = _blocks.empty() ? BLOCK_SIZE : 0;
+}
+
+size_t pepp::tc::lex::TokenArena::size() const noexcept { return _tokens.size(); }
+
+size_t pepp::tc::lex::TokenArena::capacity() const noexcept { return _blocks.size() * BLOCK_SIZE; }
+
+void *pepp::tc::lex::TokenArena::allocate(size_t size, size_t align) {
+  size_t start = (_offset + align - 1) & ~(align - 1);
+  if (start + size > BLOCK_SIZE) {
+    // Array new aligns to max_align_t, which make() checks is sufficient for every token.
+    _blocks.emplace_back(new std::byte[BLOCK_SIZE]);
+    start = 0;
+  }
+  _offset = start + size;
+  return _blocks.back().get() + start;
+}
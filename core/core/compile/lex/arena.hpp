@@ -0,0 +1,66 @@
+/*
+ * /Copyright (c) 2026. Stanley Warford, Matthew McRaven
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+#include "core/compile/lex/tokens.hpp"
+
+namespace pepp::tc::lex {
+
+// Owns every token produced by a single lexer.
+// Tokens are bump-allocated out of fixed-size blocks and destroyed together when the arena is cleared or destroyed.
+// Handing a token to a Buffer or Listener is then a pointer copy rather than a heap allocation plus refcount traffic.
+// Token pointers are stable: blocks never move, including when the arena itself is moved.
+class TokenArena {
+public:
+  static constexpr size_t BLOCK_SIZE = 16 * 1024;
+  TokenArena() = default;
+  ~TokenArena();
+  TokenArena(const TokenArena &) = delete;
+  TokenArena &operator=(const TokenArena &) = delete;
+  TokenArena(TokenArena &&) noexcept;
+  TokenArena &operator=(TokenArena &&) noexcept;
+
+  template <typename T, typename... Args>
+    requires(std::derived_from<T, Token>)
+  T *make(Args &&...args) {
+    static_assert(sizeof(T) <= BLOCK_SIZE && alignof(T) <= alignof(std::max_align_t));
+    auto ret = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    _tokens.emplace_back(ret);
+    return ret;
+  }
+  // Destroy all tokens. Keeps the first block so that a reused lexer does not go back to the heap.
+  void clear() noexcept;
+  // Number of live tokens.
+  size_t size() const noexcept;
+  // Bytes of block storage currently held, whether or not it is in use.
+  size_t capacity() const noexcept;
+
+private:
+  void *allocate(size_t size, size_t align);
+  std::vector<std::unique_ptr<std::byte[]>> _blocks;
+  // Offset of the next free byte in _blocks.back(). Starts full so the first allocation opens a block.
+  size_t _offset = BLOCK_SIZE;
+  // Needed to run destructors, since tokens own strings and are destroyed through the virtual ~Token.
+  std::vector<Token *> _tokens;
+};
+
+} // namespace pepp::tc::lex
@@ -35,11 +35,11 @@ size_t pepp::tc::lex::Buffer::count_buffered_tokens() const { return _tokens.siz
 
 size_t pepp::tc::lex::Buffer::count_matched_tokens() const { return _head; }
 
-bits::span<const std::shared_ptr<pepp::tc::lex::Token>> pepp::tc::lex::Buffer::buffered_tokens() const {
-  return bits::span<std::shared_ptr<pepp::tc::lex::Token> const>(_tokens.cbegin() + _head, _tokens.cend());
+bits::span<pepp::tc::lex::Token *const> pepp::tc::lex::Buffer::buffered_tokens() const {
+  return bits::span<pepp::tc::lex::Token *const>(_tokens.cbegin() + _head, _tokens.cend());
 }
 
-void pepp::tc::lex::Buffer::push_token(std::shared_ptr<Token> t) { _tokens.push_back(t); }
+void pepp::tc::lex::Buffer::push_token(Token *t) { _tokens.push_back(t); }
 
 pepp::tc::support::LocationInterval pepp::tc::lex::Buffer::matched_interval() const {
   auto toks = matched_tokens();
@@ -49,13 +49,13 @@ pepp::tc::support::LocationInterval pepp::tc::lex::Buffer::matched_interval() co
   return support::LocationInterval(lb, ub);
 }
 
-bits::span<const std::shared_ptr<pepp::tc::lex::Token>>
+bits::span<pepp::tc::lex::Token *const>
 pepp::tc::lex::Buffer::matched_tokens_after(const Marker &m) const {
-  return bits::span<std::shared_ptr<pepp::tc::lex::Token> const>(_tokens.cbegin() + m._head, _tokens.cbegin() + _head);
+  return bits::span<pepp::tc::lex::Token *const>(_tokens.cbegin() + m._head, _tokens.cbegin() + _head);
 }
 
-bits::span<std::shared_ptr<pepp::tc::lex::Token> const> pepp::tc::lex::Buffer::matched_tokens() const {
-  return bits::span<std::shared_ptr<pepp::tc::lex::Token> const>(_tokens.cbegin(), _tokens.cbegin() + _head);
+bits::span<pepp::tc::lex::Token *const> pepp::tc::lex::Buffer::matched_tokens() const {
+  return bits::span<pepp::tc::lex::Token *const>(_tokens.cbegin(), _tokens.cbegin() + _head);
 }
 
 void pepp::tc::lex::Buffer::clear_tokens() {
@@ -66,19 +66,19 @@ void pepp::tc::lex::Buffer::clear_tokens() {
   // memory.
 }
 
-std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::Buffer::match(int mask) {
+pepp::tc::lex::Token *pepp::tc::lex::Buffer::match(int mask) {
   if (auto next = peek(); next && next->mask(mask)) return _head++, next;
   else return nullptr;
 }
 
-std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::Buffer::match_literal(const std::string &l) {
+pepp::tc::lex::Token *pepp::tc::lex::Buffer::match_literal(const std::string &l) {
   using T = pepp::tc::lex::CommonTokenType;
-  if (auto next = peek(); next && next->mask((int)T::Literal) && std::static_pointer_cast<Literal>(next)->literal == l)
+  if (auto next = peek(); next && next->mask((int)T::Literal) && static_cast<Literal *>(next)->literal == l)
     return _head++, next;
   else return nullptr;
 }
 
-std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::Buffer::peek(int mask) {
+pepp::tc::lex::Token *pepp::tc::lex::Buffer::peek(int mask) {
   if (_head == _tokens.size()) {
     // Do not append a nullptr, otherwise head will be < size even though we reached EoF;
     if (auto next = _lex->next_token(); !next) return nullptr;
@@ -89,10 +89,10 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::Buffer::peek(int mask) {
   return nullptr;
 }
 
-std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::Buffer::peek_literal(const std::string &l) {
+pepp::tc::lex::Token *pepp::tc::lex::Buffer::peek_literal(const std::string &l) {
   using T = pepp::tc::lex::CommonTokenType;
 
-  if (auto next = peek(); next && next->mask((int)T::Literal) && std::static_pointer_cast<Literal>(next)->literal == l)
+  if (auto next = peek(); next && next->mask((int)T::Literal) && static_cast<Literal *>(next)->literal == l)
     return next;
   else return nullptr;
 }
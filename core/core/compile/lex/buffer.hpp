@@ -27,30 +27,31 @@ struct ALexer;
 class Checkpoint;
 class Marker;
 
+// Tokens are borrowed from the lexer's arena, so they remain valid for as long as the lexer does.
 class Buffer {
 public:
   explicit Buffer(ALexer *lex);
-  std::shared_ptr<Token> match(int mask);
+  Token *match(int mask);
   template <typename Type>
     requires(std::derived_from<Type, Token> && requires { std::integral_constant<int, Type::TYPE>{}; })
-  std::shared_ptr<Type> match() {
+  Type *match() {
     static constexpr auto mask = Type::TYPE;
     auto next = peek();
     if (next && next->mask(mask)) {
       _head++;
-      return static_pointer_cast<Type>(next);
+      return static_cast<Type *>(next);
     }
     return nullptr;
   }
   template <typename... Types>
     requires((std::derived_from<Types, Token> && ...) &&
              (requires { std::integral_constant<int, Types::TYPE>{}; } && ...))
-  std::shared_ptr<Token> match_not() {
+  Token *match_not() {
     // Takes the bitwise NOT of the combined mask of all types.
     constexpr int combined = ~(Types::TYPE | ...);
     return match(combined);
   }
-  std::shared_ptr<Token> match_not(int mask) { return match(~mask); }
+  Token *match_not(int mask) { return match(~mask); }
 
   // match_until matches tokens in a loop until a token matches the mask. Returns the number of tokens matched.
   template <typename... Types>
@@ -60,33 +61,33 @@ public:
     return match_until((Types::TYPE | ...));
   }
   size_t match_until(int mask);
-  std::shared_ptr<Token> match_literal(const std::string &);
+  Token *match_literal(const std::string &);
   // Returns the next token if it matches the mask, otherwise returns nullptr.
-  std::shared_ptr<Token> peek(int mask = -1);
+  Token *peek(int mask = -1);
   template <typename Type>
     requires(std::derived_from<Type, Token> && requires { std::integral_constant<int, Type::TYPE>{}; })
-  std::shared_ptr<Type> peek() {
+  Type *peek() {
     auto next = peek(Type::TYPE);
-    if (next) return std::static_pointer_cast<Type>(next);
+    if (next) return static_cast<Type *>(next);
     else return nullptr;
   }
-  std::shared_ptr<Token> peek_literal(const std::string &);
+  Token *peek_literal(const std::string &);
   bool input_remains() const;
   size_t count_buffered_tokens() const;
   size_t count_matched_tokens() const;
   // Return all tokens in the buffer between checkpoints head and our head.
-  bits::span<std::shared_ptr<Token> const> matched_tokens_after(const Marker &) const;
-  bits::span<std::shared_ptr<Token> const> matched_tokens() const;
+  bits::span<Token *const> matched_tokens_after(const Marker &) const;
+  bits::span<Token *const> matched_tokens() const;
   // Return all tokens after _head, which are tokens not-yet matched.
-  bits::span<std::shared_ptr<Token> const> buffered_tokens() const;
+  bits::span<Token *const> buffered_tokens() const;
   support::LocationInterval matched_interval() const;
   // In some instances, the parser bypasses the token buffer to consume tokens directly from the lexer.
   // Sometimes we read one too many tokens in this mode and those tokens need to be re-buffered.
-  void push_token(std::shared_ptr<Token> t);
+  void push_token(Token *t);
 
 private:
   ALexer *_lex;
-  std::vector<std::shared_ptr<Token>> _tokens;
+  std::vector<Token *> _tokens;
   size_t _head = 0, _checkpoints = 0;
   friend class Marker;
   friend class Checkpoint;
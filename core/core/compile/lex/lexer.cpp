@@ -46,6 +46,6 @@ void pepp::tc::lex::ALexer::register_listener(Listener *listener) {
 
 pepp::tc::support::Location pepp::tc::lex::ALexer::current_location() const { return _cursor.location(); }
 
-void pepp::tc::lex::ALexer::notify_listeners(std::shared_ptr<Token> t) {
+void pepp::tc::lex::ALexer::notify_listeners(Token *t) {
   for (const auto &l : _listeners) l->consumed(t);
 }
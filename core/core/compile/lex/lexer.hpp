@@ -19,6 +19,7 @@
 #include <string>
 #include <unordered_set>
 #include <vector>
+#include "core/compile/lex/arena.hpp"
 #include "core/compile/source/location.hpp"
 #include "core/compile/source/seekable.hpp"
 
@@ -28,7 +29,7 @@ struct Token;
 struct ALexer {
   struct Listener {
     virtual ~Listener() = default;
-    virtual void consumed(std::shared_ptr<Token> t) = 0;
+    virtual void consumed(Token *t) = 0;
   };
   // references/pointers to *elements* are never invalidated unless removed from the container.
   // iterators may be invalidated in many cases. So, if derived lexer's return pointers to constant QStrings,
@@ -37,10 +38,10 @@ struct ALexer {
   virtual ~ALexer() = default;
   virtual bool input_remains() const = 0;
   // Whenever next_token is called, must notify all listeners via Listener::consumed.
-  // I originally wanted to return a unique_ptr here, but I don't know how long listeners will keep tokens alive.
-  // In the case of a source formatter, it may want to keep many lines worth of tokens alive.
-  // That being said, any Buffer/Listener should release the token as soon as they are done with it.
-  virtual std::shared_ptr<Token> next_token() = 0;
+  // Tokens are owned by this lexer's arena and remain valid until the lexer is destroyed, so a Buffer/Listener may
+  // hold on to them for the rest of the parse (e.g., a source formatter keeping many lines worth of tokens alive).
+  // Do not hold on to them after the lexer is gone.
+  virtual Token *next_token() = 0;
   // If you received an invalid/error token, call this method to advance to the next point where we can resume
   // tokenization. This will return the interval which was skipped over.
   // The default behavior is to read until the next newline.
@@ -54,7 +55,9 @@ struct ALexer {
 
 protected:
   std::vector<Listener *> _listeners;
-  void notify_listeners(std::shared_ptr<Token> t);
+  void notify_listeners(Token *t);
+  // Derived lexers must allocate tokens from here rather than the heap.
+  TokenArena _arena;
   support::SeekableData _cursor;
   std::shared_ptr<std::unordered_set<std::string>> _pool;
 };
@@ -1,4 +1,5 @@
 #include "core/compile/macro/macro_registry.hpp"
+#include "core/compile/macro/macro_replacement.hpp"
 
 pepp::tc::MacroRegistry::MacroRegistry(std::shared_ptr<const MacroRegistry> parent) : _parent(parent), _macros() {}
 
@@ -30,6 +31,8 @@ void pepp::tc::MacroRegistry::purge(const std::string &name) {
 bool pepp::tc::MacroRegistry::insert(std::shared_ptr<MacroDefinition> definition, SearchMode mode) {
   if (definition == nullptr) return false;
   else if (contains(definition->name, mode)) return false;
+  if (!definition->compiled)
+    definition->compiled = std::make_shared<MacroTemplate>(MacroTemplate::compile(*definition));
   MacroRecord record{.deleted = false, .definition = definition};
   // Erase macro if it already exists to avoid having multiple entries with the same name.
   // Must chek that f!=end, else we might erase an invalid iterator which will cause a crash.
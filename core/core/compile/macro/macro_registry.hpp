@@ -6,6 +6,7 @@
 #include <vector>
 
 namespace pepp::tc {
+class MacroTemplate;
 
 struct MacroDefinition {
   struct Argument {
@@ -15,6 +16,9 @@ struct MacroDefinition {
   std::string name;
   std::vector<Argument> arguments;
   std::string body;
+  // The body, pre-split at its argument slots. Filled in by MacroRegistry::insert so that definitions shared through a
+  // parent registry (e.g., builtin macros) are only scanned once, rather than on every instantiation.
+  std::shared_ptr<const MacroTemplate> compiled = nullptr;
 };
 
 // A collection of macro definitions searchable by name. A registry can have a parent which can be searched on misses in
@@ -42,6 +46,7 @@ public:
   // Otherwise, the maco is inserted into this registry and returns true.
   // To overwrite a macro definition from a parent, insert with SearchMode::Local.
   // To replace an existing definition in this registry, purge(name)+insert(...,SearchMode::Local).
+  // Compiles the definition's body if it has not been already; the definition must not be modified afterwards.
   bool insert(std::shared_ptr<MacroDefinition> definition, SearchMode mode = SearchMode::LocalThenParent);
 
 private:
@@ -1,49 +1,126 @@
 #include "core/compile/macro/macro_replacement.hpp"
-#include <regex>
+#include "core/compile/macro/macro_registry.hpp"
+
+namespace {
+bool is_ident_start(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+bool is_ident(char c) { return is_ident_start(c) || (c >= '0' && c <= '9'); }
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+// Length of the escape starting at input[pos], or 0 if there is not one.
+// Matches \() (with optional whitespace between the parens), \+, \@, and a backslash followed by an identifier.
+size_t escape_length(std::string_view input, size_t pos) {
+  if (input[pos] != '\\' || pos + 1 >= input.size()) return 0;
+  const char next = input[pos + 1];
+  if (next == '+' || next == '@') return 2;
+  else if (next == '(') {
+    auto end = pos + 2;
+    while (end < input.size() && is_space(input[end])) end++;
+    return end < input.size() && input[end] == ')' ? end + 1 - pos : 0;
+  } else if (is_ident_start(next)) {
+    auto end = pos + 2;
+    while (end < input.size() && is_ident(input[end])) end++;
+    return end - pos;
+  }
+  return 0;
+}
+
+// Call on_escape(offset, length) for each escape in input, and on_text(offset, length) for the text between them.
+template <typename Text, typename Escape> void scan(std::string_view input, Text on_text, Escape on_escape) {
+  size_t last_pos = 0;
+  for (size_t pos = input.find('\\'); pos != std::string_view::npos; pos = input.find('\\', pos)) {
+    if (auto len = escape_length(input, pos); len == 0) pos++;
+    else {
+      if (pos != last_pos) on_text(last_pos, pos - last_pos);
+      on_escape(pos, len);
+      last_pos = pos += len;
+    }
+  }
+  if (last_pos != input.size()) on_text(last_pos, input.size() - last_pos);
+}
+} // namespace
 
 std::string pepp::tc::replace_macro_arguments(std::string_view input, MacroReplacements rep) {
-  // Match \() or \+ or \@. Also match any backslash followed by something looking like an identifier
-  static const auto pattern = R"(\\\(\s*\)|\\\+|\\@|\\[a-zA-Z_]\w*)";
-  static const std::regex re(pattern);
+  return MacroTemplate(input).expand(rep);
+}
 
-  // The result will be built incrementally. Reserve
+pepp::tc::MacroTemplate::MacroTemplate(std::string_view body) : _body(body) {
+  scan(
+      _body, [this](size_t offset, size_t length) { append(Kind::Text, offset, length); },
+      [this](size_t offset, size_t length) { append(Kind::Key, offset, length); });
+}
+
+pepp::tc::MacroTemplate pepp::tc::MacroTemplate::compile(const MacroDefinition &definition) {
+  MacroTemplate ret;
+  ret._body = definition.body;
+  auto on_text = [&ret](size_t offset, size_t length) { ret.append(Kind::Text, offset, length); };
+  auto on_escape = [&](size_t offset, size_t length) {
+    const auto key = std::string_view(ret._body).substr(offset + 1, length - 1);
+    if (key == "()") return ret.append(Kind::Empty, offset, length);
+    else if (key == "@") return ret.append(Kind::Unique, offset, length);
+    else if (key == "+") return ret.append(Kind::Count, offset, length);
+    // If an argument name is repeated, the last one wins, as it would when inserted into MacroReplacements.
+    for (auto it = definition.arguments.size(); it-- > 0;)
+      if (definition.arguments[it].name == key) return ret.append(Kind::Argument, offset, length, it);
+    ret.append(Kind::Key, offset, length);
+  };
+  scan(ret._body, on_text, on_escape);
+  return ret;
+}
+
+std::string pepp::tc::MacroTemplate::expand(std::span<const std::string_view> arguments, u32 unique,
+                                            u16 count) const {
   std::string result;
-  result.reserve(input.size());
-
-  // Use const char* iterators to avoid unecessary std::string allocations.
-  const char *data = input.data();
-  //
-  const std::size_t len = input.size();
-  // Keep track of the last byte position which we copied to
-  std::size_t last_pos = 0;
-  // Construct a match itrator over our entire input string.
-  std::cregex_iterator it(data, data + len, re);
-
-  // End sentintel is default-constructed.
-  for (; it != std::cregex_iterator{}; ++it) {
-    // Extract the position and length of this match.
-    auto pos = static_cast<std::size_t>(it->position()), mlen = static_cast<std::size_t>(it->length());
-    // Copy all text between the last match and this match into the result.
-    result.append(data + last_pos, pos - last_pos);
-
-    // Check if the matched text is one of our replacements.
-    std::string_view key(data + pos, mlen);
-    auto found = rep.find(std::string(key));
-
-    // Insert the replacement text on a match, otherwise preserve the original value.
-    result.append(found != rep.end() ? std::string_view(found->second) : key);
-    last_pos = pos + mlen;
+  result.reserve(_body.size());
+  const std::string_view body = _body;
+  for (const auto &segment : _segments) {
+    switch (segment.kind) {
+    case Kind::Argument:
+      if (segment.argument < arguments.size()) result.append(arguments[segment.argument]);
+      break;
+    case Kind::Unique: result.append(std::to_string(unique)); break;
+    case Kind::Count: result.append(std::to_string(count)); break;
+    case Kind::Empty: break;
+    case Kind::Text: [[fallthrough]];
+    case Kind::Key: result.append(body.substr(segment.offset, segment.length)); break;
+    }
   }
+  return result;
+}
 
-  // Copy any remaining text after the last match.
-  result.append(data + last_pos, len - last_pos);
+std::string pepp::tc::MacroTemplate::expand(const MacroReplacements &rep) const {
+  std::string result;
+  result.reserve(_body.size());
+  const std::string_view body = _body;
+  for (const auto &segment : _segments) {
+    const auto text = body.substr(segment.offset, segment.length);
+    if (segment.kind != Kind::Text) {
+      if (auto found = rep.find(text); found != rep.end()) {
+        result.append(found->second);
+        continue;
+      }
+    }
+    result.append(text);
+  }
   return result;
 }
 
+void pepp::tc::MacroTemplate::append(Kind kind, u32 offset, u32 length, u16 argument) {
+  // Merge runs of text so that expand() copies as few pieces as possible.
+  if (kind == Kind::Text && !_segments.empty() && _segments.back().kind == Kind::Text &&
+      _segments.back().offset + _segments.back().length == offset)
+    _segments.back().length += length;
+  else _segments.emplace_back(Segment{.kind = kind, .argument = argument, .offset = offset, .length = length});
+}
+
+pepp::tc::MacroCounters::Values pepp::tc::MacroCounters::next(const std::string &name) {
+  return Values{.unique = _total++, .count = _counters[name]++};
+}
+
 pepp::tc::MacroReplacements pepp::tc::MacroCounters::counters_for(std::string name) {
   MacroReplacements ret;
+  const auto values = next(name);
   ret["\\()"] = "";
-  ret["\\@"] = std::to_string(_total++);
-  ret["\\+"] = std::to_string(_counters[name]++);
+  ret["\\@"] = std::to_string(values.unique);
+  ret["\\+"] = std::to_string(values.count);
   return ret;
 }
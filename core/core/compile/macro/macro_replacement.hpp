@@ -1,11 +1,14 @@
 #pragma once
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "core/ds/string_compare.hpp"
 #include "core/integers.h"
 #include "core/math/bitmanip/span.hpp"
 
 namespace pepp::tc {
+struct MacroDefinition;
 
 // Used to perform textual substituion of macro arguments into macro body, minimizing intermediate allocations.
 // Replace all occurences of the keys of replacements with their associated vlaues.
@@ -14,10 +17,45 @@ namespace pepp::tc {
 using MacroReplacements = std::unordered_map<std::string, std::string, bts::cs_hash, bts::cs_eq>;
 std::string replace_macro_arguments(std::string_view input, MacroReplacements replacements);
 
+// A macro body which has been split at its \-escapes once, so that each expansion only needs to concatenate text.
+// Escapes which name one of the macro's arguments, or which are \(), \+, or \@, are bound to those values when
+// compiled from a definition. expand(arguments...) keeps any other escape as literal text, as replace_macro_arguments
+// would.
+class MacroTemplate {
+public:
+  // Every escape in body becomes a slot to be looked up by expand(const MacroReplacements&).
+  explicit MacroTemplate(std::string_view body);
+  // Escapes naming an argument of definition are bound to that argument's index.
+  static MacroTemplate compile(const MacroDefinition &definition);
+
+  // Arguments are indexed in definition order; missing arguments expand to an empty string.
+  std::string expand(std::span<const std::string_view> arguments, u32 unique, u16 count) const;
+  std::string expand(const MacroReplacements &replacements) const;
+
+private:
+  enum class Kind : u8 { Text, Argument, Unique, Count, Empty, Key };
+  struct Segment {
+    Kind kind;
+    u16 argument = 0;
+    u32 offset = 0, length = 0;
+  };
+  MacroTemplate() = default;
+  void append(Kind kind, u32 offset, u32 length, u16 argument = 0);
+  std::string _body;
+  std::vector<Segment> _segments;
+};
+
 class MacroCounters {
 public:
+  struct Values {
+    u32 unique; // \@
+    u16 count;  // \+
+  };
+  // Return the values of \@ and \+ for the next instantiation of name, and then increment them.
+  Values next(const std::string &name);
   // Insert \(), \+, and \@ on the caller's behalf. Also increments \+ and \@.
   MacroReplacements counters_for(std::string name);
+  bool operator==(const MacroCounters &) const = default;
 
 private:
   std::unordered_map<std::string, u16> _counters = {};
@@ -0,0 +1,63 @@
+/*
+ * /Copyright (c) 2026. Stanley Warford, Matthew McRaven
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace pepp::tc {
+// Number of threads to use when a caller asks for 0, i.e. "as many as are useful".
+inline unsigned resolve_thread_count(unsigned threads) {
+  return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Calls work(0) ... work(count - 1) on up to threads threads, one of which is the calling thread, and returns once all
+// calls have finished. Indices are handed out in increasing order.
+// If calls throw, the exception from the lowest index is rethrown, which is the one a serial loop would have hit first.
+template <typename Work> void parallel_for(size_t count, unsigned threads, Work &&work) {
+  std::vector<std::exception_ptr> errors(count);
+  std::atomic<size_t> next = 0;
+  auto run = [&] {
+    for (size_t it; (it = next.fetch_add(1, std::memory_order_relaxed)) < count;) {
+      try {
+        work(it);
+      } catch (...) {
+        errors[it] = std::current_exception();
+      }
+    }
+  };
+  {
+    const size_t helpers = std::min<size_t>(resolve_thread_count(threads), count);
+    std::vector<std::jthread> pool;
+    pool.reserve(helpers);
+    for (size_t it = 1; it < helpers; it++) {
+      // Fewer threads only make this slower, not wrong.
+      try {
+        pool.emplace_back(run);
+      } catch (const std::system_error &) {
+        break;
+      }
+    }
+    run();
+  }
+  for (auto &error : errors)
+    if (error) std::rethrow_exception(error);
+}
+} // namespace pepp::tc
@@ -16,19 +16,84 @@
  */
 
 #include "core/compile/symbol/leaf_table.hpp"
+#include <mutex>
 #include <sstream>
 #include "core/compile/symbol/entry.hpp"
 #include "core/compile/symbol/types.hpp"
 #include "core/compile/symbol/value.hpp"
 #include "fmt/format.h"
 
+namespace pepp::core::symbol::detail {
+// Bump allocator for entries and their shared_ptr control blocks.
+// Every allocation has the same size, so freed allocations go on a free list and are handed out again before the
+// arena grows. Blocks are only returned when the arena is destroyed, which happens once the table and every entry
+// are gone. The last reference to an entry may be dropped on any thread, hence the lock.
+class EntryArena {
+public:
+  static constexpr size_t BLOCK_SIZE = 16 * 1024;
+  void *allocate(size_t size, size_t align) {
+    std::lock_guard lock(_lock);
+    if (_free != nullptr && size == _free_size) {
+      auto ret = _free;
+      _free = _free->next;
+      return ret;
+    }
+    size_t start = (_offset + align - 1) & ~(align - 1);
+    if (start + size > BLOCK_SIZE) {
+      _blocks.emplace_back(new std::byte[BLOCK_SIZE]);
+      start = 0;
+    }
+    _offset = start + size;
+    return _blocks.back().get() + start;
+  }
+  void deallocate(void *ptr, size_t size) noexcept {
+    static_assert(alignof(FreeSlot) <= alignof(std::max_align_t));
+    if (size < sizeof(FreeSlot)) return;
+    std::lock_guard lock(_lock);
+    // Only one size is ever allocated, so this only discards memory if that changes.
+    if (_free != nullptr && size != _free_size) return;
+    _free = new (ptr) FreeSlot{_free};
+    _free_size = size;
+  }
+
+private:
+  struct FreeSlot {
+    FreeSlot *next;
+  };
+  std::mutex _lock;
+  std::vector<std::unique_ptr<std::byte[]>> _blocks;
+  // Starts full so the first allocation opens a block.
+  size_t _offset = BLOCK_SIZE;
+  FreeSlot *_free = nullptr;
+  size_t _free_size = 0;
+};
+
+// Each control block keeps a copy of its allocator, so every live entry keeps the arena alive.
+template <typename T> struct EntryAllocator {
+  using value_type = T;
+  std::shared_ptr<EntryArena> arena;
+  explicit EntryAllocator(std::shared_ptr<EntryArena> arena) noexcept : arena(std::move(arena)) {}
+  template <typename U> EntryAllocator(const EntryAllocator<U> &other) noexcept : arena(other.arena) {}
+  T *allocate(size_t n) {
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+    return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *ptr, size_t n) noexcept { arena->deallocate(ptr, n * sizeof(T)); }
+  template <typename U> bool operator==(const EntryAllocator<U> &other) const noexcept { return arena == other.arena; }
+};
+} // namespace pepp::core::symbol::detail
+
+namespace {
+static constexpr size_t INITIAL_INDEX_SIZE = 64;
+}
+
 pepp::core::symbol::LeafTable::LeafTable(u16 pointer_size) noexcept
-    : _pointer_size(pointer_size), _pool(std::make_shared<bts::StringPool>()),
-      _entries(0, bts::PooledString::Hash(_pool.get()), bts::PooledString::Equals(_pool.get())) {}
+    : _pointer_size(pointer_size), _pool(std::make_shared<bts::StringPool>()), _index(INITIAL_INDEX_SIZE, 0),
+      _arena(std::make_shared<detail::EntryArena>()) {}
 
 pepp::core::symbol::LeafTable::LeafTable(u16 pointer_size, std::shared_ptr<bts::StringPool> pool) noexcept
-    : _pointer_size(pointer_size), _pool(std::make_shared<bts::StringPool>()),
-      _entries(0, bts::PooledString::Hash(_pool.get()), bts::PooledString::Equals(_pool.get())) {}
+    : _pointer_size(pointer_size), _pool(std::make_shared<bts::StringPool>()), _index(INITIAL_INDEX_SIZE, 0),
+      _arena(std::make_shared<detail::EntryArena>()) {}
 
 std::optional<pepp::core::symbol::LeafTable::entry_ptr_t> pepp::core::symbol::LeafTable::import(LeafTable &other,
                                                                                                 std::string_view name) {
@@ -42,13 +107,58 @@ std::optional<pepp::core::symbol::LeafTable::entry_ptr_t> pepp::core::symbol::Le
   return intSym;
 }
 
-pepp::core::symbol::LeafTable::entry_ptr_t pepp::core::symbol::LeafTable::reference(std::string_view name) noexcept {
-  // Create a new entry if one does not already exist
+size_t pepp::core::symbol::LeafTable::probe(std::string_view name, size_t hash) const noexcept {
+  const size_t mask = _index.size() - 1;
+  for (size_t it = hash & mask;; it = (it + 1) & mask) {
+    const auto handle = _index[it];
+    if (handle == 0) return it;
+    else if (_hashes[handle - 1] == hash && _entries[handle - 1].second->name == name) return it;
+  }
+}
+
+void pepp::core::symbol::LeafTable::rebuild_index(size_t capacity) {
+  _index.assign(capacity, 0);
+  const size_t mask = capacity - 1;
+  for (handle_t handle = 0; handle < _entries.size(); handle++) {
+    if (!_entries[handle].second) continue;
+    size_t it = _hashes[handle] & mask;
+    while (_index[it] != 0) it = (it + 1) & mask;
+    _index[it] = handle + 1;
+  }
+}
+
+pepp::core::symbol::LeafTable::handle_t
+pepp::core::symbol::LeafTable::reference_handle(std::string_view name) noexcept {
+  const auto hash = std::hash<std::string_view>{}(name);
+  auto position = probe(name, hash);
+  if (_index[position] != 0) return _index[position] - 1;
+
+  // Create a new entry, growing the index first so that it stays at most half full.
+  if (2 * (_live + 1) > _index.size()) {
+    rebuild_index(2 * _index.size());
+    position = probe(name, hash);
+  }
   auto pooled = _pool->insert(name, bts::StringPool::AddNullTerminator::Never);
-  if (auto it = _entries.find(pooled); it == _entries.end()) {
-    auto sv = _pool->find(pooled).value();
-    return _entries[pooled] = std::make_shared<symbol::Entry>(*this, sv);
-  } else return it->second;
+  auto sv = _pool->find(pooled).value();
+  auto entry = std::allocate_shared<symbol::Entry>(detail::EntryAllocator<symbol::Entry>(_arena), *this, sv);
+  handle_t handle;
+  if (!_free_handles.empty()) {
+    handle = _free_handles.back();
+    _free_handles.pop_back();
+    _entries[handle] = value_type(pooled, std::move(entry));
+    _hashes[handle] = hash;
+  } else {
+    handle = _entries.size();
+    _entries.emplace_back(pooled, std::move(entry));
+    _hashes.emplace_back(hash);
+  }
+  _index[position] = handle + 1;
+  _live++;
+  return handle;
+}
+
+pepp::core::symbol::LeafTable::entry_ptr_t pepp::core::symbol::LeafTable::reference(std::string_view name) noexcept {
+  return _entries[reference_handle(name)].second;
 }
 
 pepp::core::symbol::LeafTable::entry_ptr_t pepp::core::symbol::LeafTable::define(std::string_view name) noexcept {
@@ -64,21 +174,27 @@ pepp::core::symbol::LeafTable::entry_ptr_t pepp::core::symbol::LeafTable::define
 
 std::optional<pepp::core::symbol::LeafTable::entry_ptr_t>
 pepp::core::symbol::LeafTable::get(std::string_view name) const noexcept {
-  if (auto pooled = _pool->find(name); !pooled) return std::nullopt;
-  else if (auto item = _entries.find(*pooled); item != _entries.end()) return item->second;
+  if (auto handle = find(name); handle) return _entries[*handle].second;
   else return std::nullopt;
 }
 
-bool pepp::core::symbol::LeafTable::exists(std::string_view name) const noexcept {
-  if (auto pooled = _pool->find(name); !pooled) return false;
-  else return _entries.find(*pooled) != _entries.cend();
+std::optional<pepp::core::symbol::LeafTable::handle_t>
+pepp::core::symbol::LeafTable::find(std::string_view name) const noexcept {
+  if (auto handle = _index[probe(name, std::hash<std::string_view>{}(name))]; handle != 0) return handle - 1;
+  else return std::nullopt;
 }
 
-auto pepp::core::symbol::LeafTable::entries() const noexcept -> const pepp::core::symbol::LeafTable::map_t & {
-  return _entries;
+const pepp::core::symbol::LeafTable::entry_ptr_t &
+pepp::core::symbol::LeafTable::operator[](handle_t handle) const noexcept {
+  return _entries[handle].second;
 }
 
-auto pepp::core::symbol::LeafTable::entries() noexcept -> pepp::core::symbol::LeafTable::map_t & { return _entries; }
+bool pepp::core::symbol::LeafTable::exists(std::string_view name) const noexcept { return find(name).has_value(); }
+
+auto pepp::core::symbol::LeafTable::entries() const noexcept -> EntryRange {
+  return EntryRange{const_iterator(_entries.cbegin(), _entries.cend()),
+                    const_iterator(_entries.cend(), _entries.cend()), _live};
+}
 
 u16 pepp::core::symbol::LeafTable::pointer_size() const noexcept { return _pointer_size; }
 
@@ -16,8 +16,10 @@
  */
 #pragma once
 
+#include <iterator>
 #include <memory>
-#include <unordered_map>
+#include <optional>
+#include <vector>
 #include "core/ds/string_pool.hpp"
 #include "core/integers.h"
 namespace pepp::bts {
@@ -25,6 +27,9 @@ class StringPool;
 }
 namespace pepp::core::symbol {
 class Entry;
+namespace detail {
+class EntryArena;
+}
 /*
  * Some implementation ideas drawn from:
  * Design and Implementation of the Symbol Table for Object-Oriented Programming
@@ -36,11 +41,65 @@ class Entry;
 // For languages with scope, an alternative type will be provided.
 // Symbols that have been marked as deleted will have their entries remain in the table, but with a DeletedValue
 // assigned.
-
+//
+// Entries are stored contiguously in creation order, and are addressed by a stable integer handle (their index).
+// Names are found through an open-addressing (linear probing) index of handles, so looking up an existing symbol
+// hashes the name once and never touches the StringPool. Entry objects are bump-allocated out of an arena owned by the
+// table; the arena lives until the last entry_ptr_t into it is released.
+// Erased entries leave a hole in the contiguous storage, which the next new entry fills. Together with the arena
+// re-using the memory of released entries, this keeps a table that repeatedly erases and re-creates symbols (as the
+// incremental assembler does on every edit) from growing.
 class LeafTable : public std::enable_shared_from_this<LeafTable> {
 public:
   using entry_ptr_t = std::shared_ptr<symbol::Entry>;
-  using map_t = std::unordered_map<bts::PooledString, entry_ptr_t, bts::PooledString::Hash, bts::PooledString::Equals>;
+  // Index of an entry within this table. A handle refers to the same entry for as long as that entry is in the table.
+  // Once it is erased, the handle may be given to a later entry.
+  using handle_t = u32;
+  using value_type = std::pair<bts::PooledString, entry_ptr_t>;
+
+  // Iterates over live entries in handle order, skipping erased ones.
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = LeafTable::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    const_iterator() = default;
+    reference operator*() const noexcept { return *_it; }
+    pointer operator->() const noexcept { return &*_it; }
+    const_iterator &operator++() noexcept {
+      ++_it;
+      skip();
+      return *this;
+    }
+    const_iterator operator++(int) noexcept {
+      auto ret = *this;
+      ++*this;
+      return ret;
+    }
+    bool operator==(const const_iterator &other) const noexcept { return _it == other._it; }
+
+  private:
+    friend class LeafTable;
+    using base_t = std::vector<value_type>::const_iterator;
+    const_iterator(base_t it, base_t end) noexcept : _it(it), _end(end) { skip(); }
+    void skip() noexcept {
+      while (_it != _end && !_it->second) ++_it;
+    }
+    base_t _it{}, _end{};
+  };
+  struct EntryRange {
+    const_iterator begin() const noexcept { return _begin; }
+    const_iterator end() const noexcept { return _end; }
+    const_iterator cbegin() const noexcept { return _begin; }
+    const_iterator cend() const noexcept { return _end; }
+    size_t size() const noexcept { return _size; }
+    bool empty() const noexcept { return _size == 0; }
+    const_iterator _begin, _end;
+    size_t _size;
+  };
 
   // Create a StringPool exclusively for this LeafTable.
   explicit LeafTable(u16 pointer_size) noexcept;
@@ -59,30 +118,57 @@ public:
 
   // Either returns an existing symbol entry or creates a new, undefined one.
   entry_ptr_t reference(std::string_view name) noexcept;
+  // Like reference, but returns the handle of the entry.
+  handle_t reference_handle(std::string_view name) noexcept;
   // If name not already defined, creates a new, singly-defined symbol entry.
   // Otherwise, modifies the existing symbol to be multiply-defined.
   entry_ptr_t define(std::string_view name) noexcept;
   // Unlike reference, will return nullopt if symbol not found.
   std::optional<entry_ptr_t> get(std::string_view name) const noexcept;
+  std::optional<handle_t> find(std::string_view name) const noexcept;
+  // Entry for a handle returned by this table, or nullptr if that entry has been erased.
+  const entry_ptr_t &operator[](handle_t handle) const noexcept;
   // Returns true if this table contains the matching symbol.
   bool exists(std::string_view name) const noexcept;
   // Number of bytes needed to store a pointer to another symbol
   u16 pointer_size() const noexcept;
 
   // Return all symbols contained by the table.
-  auto entries() const noexcept -> map_t const &;
-  // Return all symbols contained by the table. Mutable to allow transformations by visitors.
-  auto entries() noexcept -> map_t &;
+  // Entries are mutable through the returned pointers, which allows transformations by visitors.
+  EntryRange entries() const noexcept;
+  // Remove every entry for which pred(const value_type&) is true. Returns the number of entries removed.
+  // Handles of the remaining entries are unchanged.
+  template <typename Pred> size_t erase_if(Pred pred) {
+    size_t erased = 0;
+    for (handle_t handle = 0; handle < _entries.size(); handle++) {
+      auto &item = _entries[handle];
+      if (item.second && pred(std::as_const(item))) item.second.reset(), _free_handles.emplace_back(handle), erased++;
+    }
+    if (erased != 0) _live -= erased, rebuild_index(_index.size());
+    return erased;
+  }
 
   inline auto pool() const noexcept -> std::shared_ptr<const bts::StringPool> { return _pool; }
 
 private:
+  // Position in _index holding name, or the empty position where it would be inserted.
+  size_t probe(std::string_view name, size_t hash) const noexcept;
+  void rebuild_index(size_t capacity);
+
   u16 _pointer_size;
 
   // Symbols are often repeated between multiple tables, use a shared
   std::shared_ptr<bts::StringPool> _pool;
 
-  map_t _entries;
+  // Indexed by handle. Erased entries keep their slot, with a null entry_ptr_t, until a new entry takes it over.
+  std::vector<value_type> _entries;
+  std::vector<handle_t> _free_handles;
+  // Hash of each entry's name, so that growing _index does not re-hash strings.
+  std::vector<size_t> _hashes;
+  // Power-of-two sized. Holds handle+1 for live entries, and 0 for empty positions. Kept at most half full.
+  std::vector<handle_t> _index;
+  size_t _live = 0;
+  std::shared_ptr<detail::EntryArena> _arena;
 };
 
 // For each symbol in the table, whose "base" is >= threshold, increment its "offset".
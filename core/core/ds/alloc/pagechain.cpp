@@ -96,6 +96,7 @@ std::unique_ptr<pepp::bts::BufferChain> pepp::bts::BufferManager::alloc_chain()
 }
 
 pepp::bts::Buffer *pepp::bts::BufferManager::alloc_buffer() {
+  std::lock_guard lock(_lock);
   if (_free_head != NO_INDEX) {
     // Reuse a slot. Its generation was already bumped when it was freed, so the id handed out here cannot match one
     // that named the previous occupant.
@@ -137,6 +138,7 @@ const pepp::bts::Buffer *pepp::bts::BufferManager::find(Buffer::ID id) const {
 }
 
 void pepp::bts::BufferManager::free_buffer(Buffer::ID id) {
+  std::lock_guard lock(_lock);
   const u16 index = Buffer::index_of(id);
   if (index == 0 || index >= _slots.size()) return;
   auto &slot = _slots[index];
@@ -1,4 +1,5 @@
 #pragma once
+#include <mutex>
 #include "core/ds/alloc/paged.hpp"
 #include "core/ds/opaque_handle.hpp"
 
@@ -150,6 +151,10 @@ private:
   // leveling out generations too.
   u16 _free_head = NO_INDEX, _free_tail = NO_INDEX;
   u16 _live_count = 0, _free_count = 0;
+  // Serializes alloc_buffer() and free_buffer(), since initiators recording on different threads grow their own
+  // chains. Both happen once per 64KiB, so this is never contended for long. find() does not take it: a Buffer never
+  // moves, and nothing resolves an id while the chain that owns it is still growing.
+  std::mutex _lock;
 };
 
 } // namespace pepp::bts
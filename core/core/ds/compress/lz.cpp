@@ -0,0 +1,107 @@
+#include "lz.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+constexpr u32 HASH_BITS = 14;
+// After this many bytes without a match, the compressor starts striding over the input. Data that did not compress
+// recently probably will not compress soon, and probing every byte of it is most of the cost of compressing it.
+constexpr std::size_t SKIP_SHIFT = 6;
+
+u32 load32(const u8 *p) noexcept {
+  u32 ret;
+  std::memcpy(&ret, p, sizeof(ret));
+  return ret;
+}
+
+u32 hash(u32 sequence) noexcept { return (sequence * 2654435761u) >> (32 - HASH_BITS); }
+
+void put_length(std::vector<u8> &dst, std::size_t len) {
+  for (; len >= 255; len -= 255) dst.push_back(255);
+  dst.push_back(static_cast<u8>(len));
+}
+
+void put_sequence(std::vector<u8> &dst, bits::span<const u8> literals, std::size_t offset, std::size_t match) {
+  const std::size_t lit = literals.size(), extra = match ? match - pepp::lz::MIN_MATCH : 0;
+  dst.push_back(static_cast<u8>((std::min<std::size_t>(lit, 15) << 4) | std::min<std::size_t>(extra, 15)));
+  if (lit >= 15) put_length(dst, lit - 15);
+  dst.insert(dst.end(), literals.begin(), literals.end());
+  if (match == 0) return;
+  dst.push_back(static_cast<u8>(offset & 0xFF)), dst.push_back(static_cast<u8>(offset >> 8));
+  if (extra >= 15) put_length(dst, extra - 15);
+}
+
+// Returns false if the length runs off the end of the stream.
+bool get_length(const u8 *&in, const u8 *end, std::size_t &len) noexcept {
+  for (u8 byte = 255; byte == 255;) {
+    if (in == end) return false;
+    byte = *in++;
+    len += byte;
+  }
+  return true;
+}
+} // namespace
+
+void pepp::lz::compress(bits::span<const u8> src, std::vector<u8> &dst) {
+  dst.reserve(dst.size() + bound(src.size()));
+  const u8 *base = src.data();
+  const std::size_t size = src.size();
+  // Positions of the most recent sequence with each hash. A stale or colliding entry is caught by comparing bytes.
+  std::vector<u32> table(std::size_t{1} << HASH_BITS, 0);
+
+  std::size_t anchor = 0, at = 0;
+  while (at + MIN_MATCH <= size) {
+    const u32 sequence = load32(base + at);
+    auto &slot = table[hash(sequence)];
+    const std::size_t candidate = std::exchange(slot, static_cast<u32>(at));
+    if (candidate >= at || at - candidate > MAX_OFFSET || load32(base + candidate) != sequence) {
+      at += 1 + ((at - anchor) >> SKIP_SHIFT);
+      continue;
+    }
+    std::size_t len = MIN_MATCH;
+    while (at + len < size && base[candidate + len] == base[at + len]) ++len;
+    put_sequence(dst, src.subspan(anchor, at - anchor), at - candidate, len);
+    at += len, anchor = at;
+  }
+  put_sequence(dst, src.subspan(anchor), 0, 0);
+}
+
+std::vector<u8> pepp::lz::compress(bits::span<const u8> src) {
+  std::vector<u8> ret;
+  compress(src, ret);
+  return ret;
+}
+
+bool pepp::lz::decompress(bits::span<const u8> src, bits::span<u8> dst) noexcept {
+  const u8 *in = src.data(), *in_end = in + src.size();
+  u8 *out = dst.data(), *const out_begin = out, *const out_end = out + dst.size();
+  // Every stream ends with a literal-only sequence, even an empty one, so running out of input anywhere else means
+  // the stream was truncated.
+  while (true) {
+    if (in == in_end) return false;
+    const u8 token = *in++;
+    std::size_t lit = token >> 4;
+    if (lit == 15 && !get_length(in, in_end, lit)) return false;
+    if (lit > static_cast<std::size_t>(in_end - in) || lit > static_cast<std::size_t>(out_end - out)) return false;
+    std::copy_n(in, lit, out);
+    in += lit, out += lit;
+    // Only the last sequence ends without a match.
+    if (in == in_end) break;
+
+    if (in_end - in < 2) return false;
+    const std::size_t offset = in[0] | (in[1] << 8);
+    in += 2;
+    std::size_t len = (token & 0xF);
+    if (len == 15 && !get_length(in, in_end, len)) return false;
+    len += MIN_MATCH;
+    if (offset == 0 || offset > static_cast<std::size_t>(out - out_begin)) return false;
+    else if (len > static_cast<std::size_t>(out_end - out)) return false;
+    const u8 *from = out - offset;
+    // A match may overlap the bytes it produces, which is how runs are encoded, so memcpy is only safe without one.
+    if (offset >= len) std::memcpy(out, from, len), out += len;
+    else
+      for (std::size_t it = 0; it < len; ++it) *out++ = *from++;
+  }
+  return out == out_end;
+}
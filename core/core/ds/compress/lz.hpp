@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+#include "core/integers.h"
+#include "core/math/bitmanip/span.hpp"
+
+namespace pepp::lz {
+
+// A small LZ77 byte codec for data we compress and decompress ourselves, so it trades ratio for being fast in both
+// directions and for not needing a third-party library.
+//
+// The stream is LZ4's block format: a run of sequences, each a token byte whose high nibble is a literal count and
+// whose low nibble is a match length less MIN_MATCH, then the literals, then a 16-bit little-endian offset back into
+// the output. A nibble of 15 continues into extra bytes, each adding up to 255. The final sequence carries literals
+// only. The stream does not record its decompressed size, so callers must store it alongside.
+static constexpr std::size_t MIN_MATCH = 4;
+static constexpr std::size_t MAX_OFFSET = 0xFFFF;
+
+// Largest stream compress() can produce for `size` input bytes.
+constexpr std::size_t bound(std::size_t size) noexcept { return size + size / 255 + 16; }
+
+// Append the compressed form of `src` to `dst`.
+void compress(bits::span<const u8> src, std::vector<u8> &dst);
+std::vector<u8> compress(bits::span<const u8> src);
+
+// Decompress `src` into `dst`, which must be exactly the size of the original. Returns false if the stream is
+// malformed or does not fill `dst` exactly, in which case the contents of `dst` are unspecified.
+bool decompress(bits::span<const u8> src, bits::span<u8> dst) noexcept;
+
+} // namespace pepp::lz
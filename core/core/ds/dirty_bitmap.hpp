@@ -0,0 +1,70 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <vector>
+#include "core/integers.h"
+namespace pepp {
+// Tracks which indices (e.g., addresses or rows of a view) have been modified, one bit per index.
+// Marking a range costs O(length / 64) and never allocates once the bitmap has grown to cover the highest index,
+// so it is cheap enough to update once per memory access. Dirty indices are reported as maximal runs, which lets a
+// view repaint consecutive rows with a single notification.
+class DirtyBitmap {
+public:
+  // Both bounds are inclusive.
+  void mark(u64 lower, u64 upper);
+  void mark(u64 index) { mark(index, index); }
+  bool test(u64 index) const {
+    const auto word = index / 64;
+    return word < _words.size() && (_words[word] >> (index % 64)) & 1;
+  }
+  bool any() const { return _lo <= _hi; }
+  void clear();
+  // Calls fn(lower, upper) for each maximal run of dirty indices in ascending order. Both bounds are inclusive.
+  template <typename Fn> void for_each_run(Fn &&fn) const;
+
+private:
+  static constexpr u64 ones = std::numeric_limits<u64>::max();
+  std::vector<u64> _words;
+  // Words outside [_lo, _hi] are known to be clean, so clear() and for_each_run() may skip them.
+  std::size_t _lo = std::numeric_limits<std::size_t>::max(), _hi = 0;
+};
+
+inline void DirtyBitmap::mark(u64 lower, u64 upper) {
+  if (upper < lower) return;
+  const std::size_t first = lower / 64, last = upper / 64;
+  if (last >= _words.size()) _words.resize(last + 1, 0);
+  _lo = std::min(_lo, first), _hi = std::max(_hi, last);
+  const u64 head = ones << (lower % 64), tail = ones >> (63 - upper % 64);
+  if (first == last) _words[first] |= head & tail;
+  else {
+    _words[first] |= head;
+    std::fill(_words.begin() + first + 1, _words.begin() + last, ones);
+    _words[last] |= tail;
+  }
+}
+
+inline void DirtyBitmap::clear() {
+  if (any()) std::fill(_words.begin() + _lo, _words.begin() + _hi + 1, 0);
+  _lo = std::numeric_limits<std::size_t>::max(), _hi = 0;
+}
+
+template <typename Fn> void DirtyBitmap::for_each_run(Fn &&fn) const {
+  if (!any()) return;
+  bool inRun = false;
+  u64 start = 0;
+  for (std::size_t word = _lo; word <= _hi; word++) {
+    const u64 bits = _words[word], base = word * 64;
+    for (int bit = 0; bit < 64;) {
+      // Looking for the start of a run means skipping 0s; looking for its end means skipping 1s.
+      const u64 rest = (inRun ? ~bits : bits) >> bit;
+      if (rest == 0) break;
+      bit += std::countr_zero(rest);
+      if (inRun) fn(start, base + bit - 1);
+      else start = base + bit;
+      inRun = !inRun;
+    }
+  }
+  if (inRun) fn(start, (_hi + 1) * 64 - 1);
+}
+} // namespace pepp
@@ -0,0 +1,35 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include "core/integers.h"
+namespace pepp {
+// Hands the most recent value from one producer thread to one consumer thread without either side ever blocking.
+// The producer fills back() and calls publish(); the consumer calls update() and then reads front().
+// A third slot sits between them, so the producer can always start a new value while the consumer is still reading an
+// old one. Values published faster than they are consumed are dropped, which is what a display wants.
+template <typename T> class SnapshotBuffer {
+public:
+  SnapshotBuffer() = default;
+  SnapshotBuffer(const SnapshotBuffer &) = delete;
+  SnapshotBuffer &operator=(const SnapshotBuffer &) = delete;
+
+  // Producer side. back() is only valid until the next publish().
+  T &back() { return _slots[_back]; }
+  void publish() { _back = _middle.exchange(_back | Fresh, std::memory_order_acq_rel) & IndexMask; }
+
+  // Consumer side. Returns true if front() now holds a value that has not been seen before.
+  bool update() {
+    if ((_middle.load(std::memory_order_relaxed) & Fresh) == 0) return false;
+    _front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+    return true;
+  }
+  const T &front() const { return _slots[_front]; }
+
+private:
+  static constexpr u8 IndexMask = 0b011, Fresh = 0b100;
+  std::array<T, 3> _slots{};
+  // Each slot is owned by exactly one of these three at any time.
+  u8 _back = 0, _front = 1;
+  std::atomic<u8> _middle = 2;
+};
+} // namespace pepp
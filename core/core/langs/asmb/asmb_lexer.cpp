@@ -1,5 +1,6 @@
 #include "./asmb_lexer.hpp"
 #include <charconv>
+#include <mutex>
 #include <regex>
 #include <spdlog/spdlog.h>
 #include "core/compile/lex/tokens.hpp"
@@ -7,7 +8,7 @@
 #include "core/langs/asmb/asmb_tokens.hpp"
 #include "core/math/bitmanip/strings.hpp"
 
-static std::unordered_set<char> literals_for(pepp::tc::lex::AsmbOptions opts) {
+static const std::unordered_set<char> &literals_for(pepp::tc::lex::AsmbOptions opts) {
   static const std::unordered_set<char> parens{'(', ')'};
   static const std::unordered_set<char> operators{'+', '-', '*', '/', '%', '|', '&', '^', '=', '~', '!', '<', '>'};
   static const std::unordered_set<char> r_with_both = [&] {
@@ -37,11 +38,22 @@ static std::unordered_set<char> literals_for(pepp::tc::lex::AsmbOptions opts) {
   else return r_comma_only;
 }
 
+// A lexer is constructed for every macro instantiation, and compiling a std::regex is far more expensive than lexing
+// a typical macro body. Comment leaders rarely vary, so share one compiled regex per leader.
+static std::shared_ptr<const std::regex> line_comment_regex(const std::string &leader) {
+  static std::mutex lock;
+  static std::unordered_map<std::string, std::shared_ptr<const std::regex>> cache;
+  std::scoped_lock guard(lock);
+  auto &ret = cache[leader];
+  if (!ret) ret = std::make_shared<const std::regex>(leader + "[^\n]*");
+  return ret;
+}
+
 pepp::tc::lex::AsmbLexer::AsmbLexer(std::shared_ptr<std::unordered_set<std::string>> identifier_pool,
                                     support::SeekableData &&data, AsmbOptions options)
     : ALexer(identifier_pool, std::move(data)), _opts(options) {
-  _lineCommentRegex = std::make_unique<std::regex>(options.line_comment_leader + "[^\n]*");
-  _literals = literals_for(options);
+  _lineCommentRegex = line_comment_regex(options.line_comment_leader);
+  _literals = &literals_for(options);
 }
 
 bool pepp::tc::lex::AsmbLexer::input_remains() const { return _cursor.input_remains(); }
@@ -59,7 +71,7 @@ static const std::string identifier_nodot_at_str = R"([@a-zA-Z_][a-zA-Z0-9_]*)";
 static const std::string identifier_dot_noat_str = R"([a-zA-Z_][a-zA-Z0-9_.]*)";
 static const std::string identifier_nodot_noat_str = R"([a-zA-Z_][a-zA-Z0-9_]*)";
 
-std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
+pepp::tc::lex::Token *pepp::tc::lex::AsmbLexer::next_token() {
   using LocationInterval = support::LocationInterval;
   static const std::regex identifier_dot_at(identifier_dot_at_str);
   static const std::regex identifier_nodot_at(identifier_nodot_at_str);
@@ -76,7 +88,7 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
   static const std::regex badHex("0[xX]");
   static const std::regex charConstant(R"('([^'\\]|\\[bvnrt\\0']|\\[xX][0-9a-fA-F]{2})')");
   static const std::regex strConstant(R"("([^"\\]|\\[bvnrt\\0"]|\\[xX][0-9a-fA-F]{2})*\")");
-  std::shared_ptr<pepp::tc::lex::Token> current_token = nullptr;
+  pepp::tc::lex::Token *current_token = nullptr;
   auto loc_start = _cursor.location();
   // Ensure when a token starts a newline that we update row:location mapping.
   if (loc_start.column == 0 && !_row_to_streampos.contains(loc_start.row))
@@ -87,20 +99,20 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
     if (next == '\n') {
       _cursor.advance(1);
       _cursor.newline();
-      current_token = std::make_shared<Empty>(LocationInterval{loc_start, _cursor.location()});
+      current_token = _arena.make<Empty>(LocationInterval{loc_start, _cursor.location()});
       break;
     } else if (next == '\r') {
       _cursor.skip(1);
       loc_start = _cursor.location();
-      current_token = std::make_shared<Empty>(LocationInterval{loc_start, _cursor.location()});
+      current_token = _arena.make<Empty>(LocationInterval{loc_start, _cursor.location()});
       continue;
     } else if (std::isspace(next)) {
       _cursor.skip(1);
       loc_start = _cursor.location();
       continue;
-    } else if (_literals.contains(next)) {
+    } else if (_literals->contains(next)) {
       _cursor.advance(1);
-      current_token = std::make_shared<Literal>(LocationInterval{loc_start, _cursor.location()}, std::string{next});
+      current_token = _arena.make<Literal>(LocationInterval{loc_start, _cursor.location()}, std::string{next});
       break;
     } else if (!_opts.recognize_operators && (next == '+' || next == '-')) {
       auto sign = (next == '-') ? -1 : 1;
@@ -113,43 +125,43 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
         int val = 0;
         (void)std::from_chars(match.data(), match.data() + match.size(), val, 10);
         auto fmt = sign < 0 ? Format::SignedDec : Format::UnsignedDec;
-        current_token = std::make_shared<Integer>(LocationInterval{loc_start, _cursor.location()}, sign * val, fmt);
+        current_token = _arena.make<Integer>(LocationInterval{loc_start, _cursor.location()}, sign * val, fmt);
       } else
         current_token =
-            std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+            _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
       break;
     } else if (auto maybeMacroArg = _cursor.matchView(macroarg); !maybeMacroArg.empty()) {
       auto match = maybeMacroArg.str(0);
       _cursor.advance(match.size());
       auto const *id = &*_pool->emplace(match.substr(1)).first; // Drop leading backslash
       if (_opts.allow_macro_arguments)
-        current_token = std::make_shared<MacroPlaceholder>(LocationInterval{loc_start, _cursor.location()}, id);
+        current_token = _arena.make<MacroPlaceholder>(LocationInterval{loc_start, _cursor.location()}, id);
       else
         current_token =
-            std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+            _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
       break;
     } else if (auto maybeSymbol = _cursor.matchView(symbol); !maybeSymbol.empty()) {
       auto match = maybeSymbol.str(0);
       _cursor.advance(match.size());
       auto const *id = &*_pool->emplace(bits::chopped(match, 1)).first; // Drop trailing :
-      current_token = std::make_shared<SymbolDeclaration>(LocationInterval{loc_start, _cursor.location()}, id);
+      current_token = _arena.make<SymbolDeclaration>(LocationInterval{loc_start, _cursor.location()}, id);
       break;
     } else if (auto maybeIdent = _cursor.matchView(identifier); !maybeIdent.empty()) {
       auto match = maybeIdent.str(0);
       _cursor.advance(match.size());
       auto const *id = &*_pool->emplace(match).first;
-      current_token = std::make_shared<Identifier>(LocationInterval{loc_start, _cursor.location()}, id);
+      current_token = _arena.make<Identifier>(LocationInterval{loc_start, _cursor.location()}, id);
       break;
     } else if (auto maybeDot = _cursor.matchView(directive); !maybeDot.empty()) {
       auto match = maybeDot.str(0);
       _cursor.advance(match.size());
       auto const *id = &*_pool->emplace(match.substr(1)).first; // Drop leading .
-      current_token = std::make_shared<DotCommand>(LocationInterval{loc_start, _cursor.location()}, id);
+      current_token = _arena.make<DotCommand>(LocationInterval{loc_start, _cursor.location()}, id);
       break;
     } else if (next == '.') { // Bad dot command!
       _cursor.advance(1);
       current_token =
-          std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+          _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
       break;
     } else if (auto maybeHex = _cursor.matchView(hexadecimal); !maybeHex.empty()) {
       auto match = maybeHex.str(0);
@@ -158,13 +170,13 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
       match = match.substr(2); // drop leading 0x.
       int val = 0;
       (void)std::from_chars(match.data(), match.data() + match.size(), val, 16);
-      current_token = std::make_shared<Integer>(LocationInterval{loc_start, _cursor.location()}, val, Format::Hex);
+      current_token = _arena.make<Integer>(LocationInterval{loc_start, _cursor.location()}, val, Format::Hex);
       break;
     } else if (auto maybeBadHex = _cursor.matchView(badHex); !maybeBadHex.empty()) {
       auto match = maybeBadHex.str(0);
       _cursor.advance(match.size());
       current_token =
-          std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+          _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
       break;
     } else if (auto maybeDec = _cursor.matchView(decimal); !maybeDec.empty()) {
       using Format = Integer::Format;
@@ -172,14 +184,13 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
       _cursor.advance(match.size());
       int val = 0;
       (void)std::from_chars(match.data(), match.data() + match.size(), val, 10);
-      current_token =
-          std::make_shared<Integer>(LocationInterval{loc_start, _cursor.location()}, val, Format::UnsignedDec);
+      current_token = _arena.make<Integer>(LocationInterval{loc_start, _cursor.location()}, val, Format::UnsignedDec);
       break;
     } else if (auto maybeComment = _cursor.matchView(*_lineCommentRegex); !maybeComment.empty()) {
       auto match = maybeComment.str(0);
       _cursor.advance(match.size());
       auto const *id = &*_pool->emplace(match.substr(1)).first; // Drop leading ;
-      current_token = std::make_shared<InlineComment>(LocationInterval{loc_start, _cursor.location()}, id);
+      current_token = _arena.make<InlineComment>(LocationInterval{loc_start, _cursor.location()}, id);
       break;
     } else if (next == '\'') {
       if (auto maybeChar = _cursor.matchView(charConstant); !maybeChar.empty()) {
@@ -188,12 +199,12 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
         // Omit open and close quotes.
         match = bits::chopped(match.substr(1), 1);
         current_token =
-            std::make_shared<CharacterConstant>(LocationInterval{loc_start, _cursor.location()}, std::string{match});
+            _arena.make<CharacterConstant>(LocationInterval{loc_start, _cursor.location()}, std::string{match});
         break;
       } else {
         _cursor.advance(1);
         current_token =
-            std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+            _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
         break;
       }
     } else if (next == '"') {
@@ -203,24 +214,24 @@ std::shared_ptr<pepp::tc::lex::Token> pepp::tc::lex::AsmbLexer::next_token() {
         // Omit open and close quotes.
         match = bits::chopped(match.substr(1), 1);
         auto const *id = &*_pool->emplace(match).first;
-        current_token = std::make_shared<StringConstant>(LocationInterval{loc_start, _cursor.location()}, id);
+        current_token = _arena.make<StringConstant>(LocationInterval{loc_start, _cursor.location()}, id);
         break;
       } else {
         _cursor.advance(1);
         current_token =
-            std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+            _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
         break;
       }
     } else {
       _cursor.advance(1);
       current_token =
-          std::make_shared<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
+          _arena.make<Invalid>(LocationInterval{loc_start, _cursor.location()}, std::string{_cursor.select()});
       break;
     }
   }
   // End must have been all whitespace, treat as empty token.
   if (current_token == nullptr)
-    current_token = std::make_shared<Empty>(LocationInterval{loc_start, _cursor.location()});
+    current_token = _arena.make<Empty>(LocationInterval{loc_start, _cursor.location()});
   notify_listeners(current_token);
   if (print_tokens && current_token) SPDLOG_TRACE("Token: {}", current_token->repr());
   _cursor.skip(0);
@@ -25,17 +25,17 @@ struct AsmbLexer : public ALexer {
   AsmbLexer &operator=(AsmbLexer &&) = default;
 
   bool input_remains() const override;
-  std::shared_ptr<Token> next_token() override;
+  Token *next_token() override;
   // Provide a string view between two locations.
   // Only works for already-parsed locations. If interval outside of parsed text, will return empty stringview.
   std::string_view view(support::LocationInterval loc) const;
 
 private:
   AsmbOptions _opts;
-  std::unique_ptr<std::regex> _lineCommentRegex = nullptr;
+  std::shared_ptr<const std::regex> _lineCommentRegex = nullptr;
   // Not needed in base lexer since we only need it to support macros/conditionals.
   std::map<decltype(support::Location::row), size_t> _row_to_streampos;
-  std::unordered_set<char> _literals;
+  const std::unordered_set<char> *_literals = nullptr;
 };
 
 } // namespace pepp::tc::lex
@@ -7,6 +7,7 @@
 #include <vector>
 #include "core/compile/ir_linear/line_dot.hpp"
 #include "core/compile/ir_value/symbolic.hpp"
+#include "core/compile/parallel.hpp"
 #include "core/compile/symbol/value.hpp"
 #include "core/langs/asmb/ir_program.hpp"
 
@@ -51,10 +52,17 @@ struct SectionDescriptor {
 // starting in the .ORG section.
 //
 // When a .BURN <num> is present, grouping occurs as-if an extra section was append to prog which contains a .ORG <num>.
+//
+// When re-assembling after an edit, pass the previous result and the index of the first section whose IR changed.
+// Sections before first_section are not laid out again: their lines' addresses are copied from previous, and their
+// descriptors must already hold the low/high addresses and byte counts from that previous call. Sections before the
+// first .ORG are laid out right-to-left from it, so first_section is ignored if it is at or before that .ORG section.
 template <typename Address>
 IRMemoryAddressTable<Address> assign_addresses(std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
                                                LineToSymbolType line_to_Symbol,
-                                               typename Address::Type initial_base_address = 0) {
+                                               typename Address::Type initial_base_address = 0,
+                                               const IRMemoryAddressTable<Address> *previous = nullptr,
+                                               size_t first_section = 0) {
   enum class Direction { Forward, Backward } direction = Direction::Forward;
   using addr_t = typename Address::Type;
   static const auto max_address = std::numeric_limits<addr_t>::max();
@@ -102,6 +110,8 @@ IRMemoryAddressTable<Address> assign_addresses(std::vector<std::pair<SectionDesc
   }
 
   if (prog.size() != sorted_work.size()) throw std::logic_error("Layout of sections failed");
+  if (previous == nullptr || (first_org_section != -1 && static_cast<i64>(first_section) <= first_org_section))
+    first_section = 0;
 
   // Phase 2: assign addresses for each section to each line of IR.
   addr_t base_address = 0;
@@ -170,6 +180,11 @@ IRMemoryAddressTable<Address> assign_addresses(std::vector<std::pair<SectionDesc
 
   for (auto &sec_idx : sorted_work) {
     auto &sec = prog[sec_idx.index];
+    if (static_cast<size_t>(sec_idx.index) < first_section) {
+      for (const auto &line : sec.second)
+        if (auto it = previous->find(line.get()); it != previous->end()) ret.container.emplace_back(*it);
+      continue;
+    }
 
     // If this section contains the first org, there may be some lines BEFORE that org which need to be assigned
     // backwards.
@@ -253,9 +268,25 @@ struct ProgramObjectCodeResult {
   std::vector<SectionSpans> section_spans;
 };
 
+namespace detail {
+// Programs with fewer lines than this are encoded on the calling thread, as handing sections out costs more than it saves.
+static constexpr u64 PARALLEL_CODEGEN_MIN_LINES = 4096;
+
+// Relocations and object code spans produced by a single section when sections are encoded concurrently.
+struct SectionObjectCode {
+  std::multimap<std::shared_ptr<pepp::core::symbol::Entry>, StaticRelocation> relocations;
+  IR2ObjectCodeMap ir_to_object_code;
+};
+} // namespace detail
+
+// With more than one thread (0 meaning one per hardware thread), sections are encoded concurrently.
+// Visitors only read addresses and symbols, and each section writes a disjoint span of the object code, so the only
+// shared state is the relocation table and IR-to-object-code map. Those are built per-section and merged in section
+// order afterwards, which keeps the result identical to encoding on a single thread.
 template <typename Address, typename Visitor>
 ProgramObjectCodeResult to_object_code(const IRMemoryAddressTable<Address> &addresses,
-                                       std::vector<std::pair<SectionDescriptor, IRProgram>> &prog) {
+                                       std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
+                                       unsigned threads = 1) {
   ProgramObjectCodeResult ret;
   std::vector<detail::SectionOffsets> offsets(prog.size(), detail::SectionOffsets{});
   u64 object_size = 0, ir_count = 0;
@@ -271,17 +302,43 @@ ProgramObjectCodeResult to_object_code(const IRMemoryAddressTable<Address> &addr
   ret.ir_to_object_code.container.reserve(ir_count);
   ret.section_spans.reserve(prog.size());
 
-  for (u32 it = 0; it < prog.size(); it++) {
-    const auto &[sec, ir] = prog[it];
-    auto &offset = offsets[it];
-    auto code_begin = ret.object_code.begin() + offset.object_code_offset;
-    auto code_end = code_begin + offset.object_code_size;
-
-    auto oc_subspan = bits::span<u8>(code_begin, code_end);
-    Visitor visitor(addresses, sec.low_address, it, oc_subspan, ret.relocations, ret.ir_to_object_code);
-    offset.reloc_offset = ret.relocations.size();
-    for (const auto &line : ir) visitor.accept(line.get());
-    offset.reloc_size = offset.reloc_offset - ret.relocations.size();
+  if (threads == 1 || prog.size() < 2 || ir_count < detail::PARALLEL_CODEGEN_MIN_LINES) {
+    for (u32 it = 0; it < prog.size(); it++) {
+      const auto &[sec, ir] = prog[it];
+      auto &offset = offsets[it];
+      auto code_begin = ret.object_code.begin() + offset.object_code_offset;
+      auto code_end = code_begin + offset.object_code_size;
+
+      auto oc_subspan = bits::span<u8>(code_begin, code_end);
+      Visitor visitor(addresses, sec.low_address, it, oc_subspan, ret.relocations, ret.ir_to_object_code);
+      offset.reloc_offset = ret.relocations.size();
+      for (const auto &line : ir) visitor.accept(line.get());
+      offset.reloc_size = ret.relocations.size() - offset.reloc_offset;
+    }
+  } else {
+    std::vector<detail::SectionObjectCode> per_section(prog.size());
+    // Rethrows the error from the earliest section, which is the one the serial loop would have thrown.
+    parallel_for(prog.size(), threads, [&](size_t it) {
+      const auto &[sec, ir] = prog[it];
+      auto &local = per_section[it];
+      auto code_begin = ret.object_code.begin() + offsets[it].object_code_offset;
+      auto code_end = code_begin + offsets[it].object_code_size;
+      local.ir_to_object_code.container.reserve(ir.size());
+      Visitor visitor(addresses, sec.low_address, u32(it), bits::span<u8>(code_begin, code_end), local.relocations,
+                      local.ir_to_object_code);
+      for (const auto &line : ir) visitor.accept(line.get());
+    });
+
+    // Relocations for the same symbol must remain in the order the serial loop would have inserted them.
+    for (u32 it = 0; it < prog.size(); it++) {
+      auto &local = per_section[it];
+      offsets[it].reloc_offset = ret.relocations.size();
+      for (const auto &reloc : local.relocations) ret.relocations.insert(reloc);
+      offsets[it].reloc_size = ret.relocations.size() - offsets[it].reloc_offset;
+      auto &container = local.ir_to_object_code.container;
+      ret.ir_to_object_code.container.insert(ret.ir_to_object_code.container.end(), container.begin(),
+                                             container.end());
+    }
   }
 
   // SectionInfo cannot be created until core loop is complete, because relocation might re-allocate and invalidate
@@ -94,12 +94,13 @@ pepp::tc::PeppSectionAnalysisResults pepp::tc::pepp_split_to_sections(Diagnostic
 }
 
 pepp::tc::IRMemoryAddressTable<pepp::tc::PeppAddress>
-pepp::tc::pepp_assign_addresses(std::vector<std::pair<SectionDescriptor, IRProgram>> &prog, u16 initial_base_address) {
+pepp::tc::pepp_assign_addresses(std::vector<std::pair<SectionDescriptor, IRProgram>> &prog, u16 initial_base_address,
+                                const IRMemoryAddressTable<PeppAddress> *previous, size_t first_section) {
   static const auto f = [](const pepp::tc::LinearIR *line) -> pepp::core::symbol::Type {
     auto isCode = dynamic_cast<const DyadicInstruction *>(&*line) || dynamic_cast<const MonadicInstruction *>(&*line);
     return isCode ? pepp::core::symbol::Type::Code : pepp::core::symbol::Type::Object;
   };
-  return assign_addresses<PeppAddress>(prog, f, initial_base_address);
+  return assign_addresses<PeppAddress>(prog, f, initial_base_address, previous, first_section);
 }
 
 namespace pepp::tc {
@@ -237,6 +238,12 @@ ProgramObjectCodeResult pepp_to_object_code(const IRMemoryAddressTable<PeppAddre
   return to_object_code<PeppAddress, PeppObjectVistitor>(addresses, prog);
 }
 
+ProgramObjectCodeResult pepp_to_object_code(const IRMemoryAddressTable<PeppAddress> &addresses,
+                                            std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
+                                            unsigned threads) {
+  return to_object_code<PeppAddress, PeppObjectVistitor>(addresses, prog, threads);
+}
+
 } // namespace pepp::tc
 
 static std::shared_ptr<ELFIO::elfio> create_elf() {
@@ -47,11 +47,20 @@ PeppSectionAnalysisResults pepp_split_to_sections(DiagnosticTable &diag, IRProgr
 // starting in the .ORG section.
 //
 // When a .BURN <num> is present, grouping occurs as-if an extra section was append to prog which contains a .ORG <num>.
+//
+// previous and first_section allow re-using the layout of unchanged leading sections; see pepp::tc::assign_addresses.
 IRMemoryAddressTable<PeppAddress> pepp_assign_addresses(std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
-                                                        u16 initial_base_address = 0);
+                                                        u16 initial_base_address = 0,
+                                                        const IRMemoryAddressTable<PeppAddress> *previous = nullptr,
+                                                        size_t first_section = 0);
 
 ProgramObjectCodeResult pepp_to_object_code(const IRMemoryAddressTable<PeppAddress> &,
                                             std::vector<std::pair<SectionDescriptor, IRProgram>> &prog);
+// Encodes sections concurrently on up to threads threads, or one per hardware thread if threads is 0.
+// The result is identical to the single-threaded overload.
+ProgramObjectCodeResult pepp_to_object_code(const IRMemoryAddressTable<PeppAddress> &,
+                                            std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
+                                            unsigned threads);
 
 ElfResult pepp_to_elf(std::vector<std::pair<SectionDescriptor, IRProgram>> &prog,
                       const IRMemoryAddressTable<PeppAddress> &addrs, const ProgramObjectCodeResult &object_code,
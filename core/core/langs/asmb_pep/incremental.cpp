@@ -0,0 +1,288 @@
+#include "core/langs/asmb_pep/incremental.hpp"
+#include <cctype>
+#include "core/compile/ir_linear/attr_symbol.hpp"
+#include "core/compile/ir_linear/line_macro.hpp"
+#include "core/compile/ir_value/symbolic.hpp"
+#include "core/compile/symbol/entry.hpp"
+#include "core/compile/symbol/leaf_table.hpp"
+#include "core/compile/symbol/value.hpp"
+#include "core/langs/asmb_pep/ir_lines.hpp"
+#include "core/langs/asmb_pep/parser.hpp"
+#include "core/math/bitmanip/strings.hpp"
+
+namespace {
+using namespace pepp::tc;
+
+std::vector<std::string> split_lines(const std::string &text) {
+  std::vector<std::string> ret;
+  size_t start = 0;
+  for (size_t end = text.find('\n'); end != std::string::npos; start = end + 1, end = text.find('\n', start))
+    ret.emplace_back(text.substr(start, end - start));
+  ret.emplace_back(text.substr(start));
+  return ret;
+}
+
+// Conservatively detect directives which allow a statement to span lines.
+// A match inside a comment or string only costs a full parse.
+bool has_block_directive(std::string_view line) {
+  for (size_t it = line.find('.'); it != std::string_view::npos; it = line.find('.', it + 1)) {
+    size_t end = it + 1;
+    while (end < line.size() && (std::isalnum(static_cast<unsigned char>(line[end])) || line[end] == '_')) end++;
+    auto word = bits::to_upper(line.substr(it + 1, end - it - 1));
+    if (word == "IF" || word == "ELSEIF" || word == "ELSE" || word == "ENDIF" || word == "MACRO" || word == "ENDM")
+      return true;
+  }
+  return false;
+}
+
+// Advance counters exactly as PepParser did while producing ir.
+void replay_counters(MacroCounters &counters, const IRProgram &ir) {
+  for (const auto &line : ir) {
+    if (line->type() != MacroInstantiation::TYPE) continue;
+    auto as_macro = static_cast<const MacroInstantiation *>(line.get());
+    (void)counters.next(as_macro->macro->name);
+    replay_counters(counters, as_macro->lines);
+  }
+}
+
+bool contains_macro(const IRProgram &ir) {
+  return std::any_of(ir.cbegin(), ir.cend(), [](auto &line) { return line->type() == MacroInstantiation::TYPE; });
+}
+
+support::LocationInterval shift_rows(support::LocationInterval ival, i32 delta) {
+  if (!ival.valid()) return ival;
+  auto lower = ival.lower(), upper = ival.upper();
+  lower.row += delta, upper.row += delta;
+  return {lower, upper};
+}
+
+// Lines must be joined exactly as they appeared in the original text so that locations and statement boundaries match.
+std::string join_lines(const std::vector<std::string> &text, bool final_line) {
+  std::string ret;
+  for (size_t it = 0; it < text.size(); it++) {
+    ret += text[it];
+    if (it + 1 < text.size() || !final_line) ret += '\n';
+  }
+  return ret;
+}
+
+bool same_section(const std::pair<SectionDescriptor, IRProgram> &lhs,
+                  const std::pair<SectionDescriptor, IRProgram> &rhs) {
+  const auto &[ld, lir] = lhs;
+  const auto &[rd, rir] = rhs;
+  return ld.name == rd.name && ld.flags == rd.flags && ld.org_count == rd.org_count &&
+         ld.alignment == rd.alignment && lir == rir;
+}
+} // namespace
+
+pepp::tc::parser::IncrementalPepAssembler::IncrementalPepAssembler(std::shared_ptr<MacroRegistry> reg)
+    : _parent(reg), _macros(std::make_shared<MacroRegistry>(reg)),
+      _symtab(std::make_shared<pepp::core::symbol::LeafTable>(2)) {}
+
+pepp::tc::parser::IncrementalPepAssembler::UpdateStats
+pepp::tc::parser::IncrementalPepAssembler::update(std::string text) {
+  auto new_text = split_lines(text);
+  const size_t old_n = _lines.size(), new_n = new_text.size();
+
+  // Find the lines which differ between the cached program and the new text.
+  size_t prefix = 0, suffix = 0;
+  const auto common = std::min(old_n, new_n);
+  while (prefix < common && _lines[prefix].text == new_text[prefix]) prefix++;
+  if (prefix == old_n && old_n == new_n) {
+    _stats = UpdateStats{.full_parse = false, .first_section = (u32)_sections.size()};
+    return _stats;
+  }
+  while (suffix < common - prefix && _lines[old_n - 1 - suffix].text == new_text[new_n - 1 - suffix]) suffix++;
+  const size_t old_end = old_n - suffix, new_end = new_n - suffix;
+
+  bool incremental = !_lines.empty() && _block_lines == 0 && !_opaque_counters;
+  for (size_t it = prefix; incremental && it < new_end; it++) incremental = !has_block_directive(new_text[it]);
+  if (!incremental) {
+    parse_all(std::move(new_text));
+    return _stats;
+  }
+
+  // Counters at the start of the edit, and the counters the old lines after the edit were parsed with.
+  MacroCounters counters, old_counters;
+  for (size_t it = 0; it < prefix; it++) replay_counters(counters, _lines[it].ir);
+  old_counters = counters;
+  for (size_t it = prefix; it < old_end; it++) replay_counters(old_counters, _lines[it].ir);
+
+  _stats = UpdateStats{.full_parse = false, .first_line = (u32)prefix, .parsed_lines = (u32)(new_end - prefix)};
+  std::vector<std::string> changed(std::make_move_iterator(new_text.begin() + prefix),
+                                   std::make_move_iterator(new_text.begin() + new_end));
+  auto parsed = parse_range(std::move(changed), prefix, new_end == new_n, counters);
+  if (_opaque_counters) {
+    parse_all(split_lines(text));
+    return _stats;
+  }
+
+  // Lines after the edit keep their IR, but move up or down and may need to re-expand macros with new counters.
+  // Lines without macro invocations do not advance the counters, so only those with invocations need attention.
+  const i32 delta = (i32)new_end - (i32)old_end;
+  bool diverged = !(counters == old_counters);
+  for (size_t it = old_end; it < old_n; it++) {
+    auto &line = _lines[it];
+    const auto new_row = (u32)(it + delta);
+    if (diverged && contains_macro(line.ir)) {
+      replay_counters(old_counters, line.ir);
+      auto reparsed = parse_range({line.text}, new_row, new_row + 1 == new_n, counters);
+      if (_opaque_counters) {
+        parse_all(split_lines(text));
+        return _stats;
+      }
+      line = std::move(reparsed.front());
+      _stats.parsed_lines++;
+      diverged = !(counters == old_counters);
+    } else if (delta != 0) {
+      for (auto &ir : line.ir) ir->source_interval = shift_rows(ir->source_interval, delta);
+      for (auto &[loc, _] : line.diagnostics) loc = shift_rows(loc, delta);
+    }
+  }
+
+  _lines.erase(_lines.begin() + prefix, _lines.begin() + old_end);
+  _lines.insert(_lines.begin() + prefix, std::make_move_iterator(parsed.begin()), std::make_move_iterator(parsed.end()));
+  rebuild_symbols();
+  assign_addresses(true);
+  prune_symbols();
+  return _stats;
+}
+
+pepp::tc::IRProgram pepp::tc::parser::IncrementalPepAssembler::program() const {
+  IRProgram ret;
+  for (const auto &line : _lines) ret.insert(ret.end(), line.ir.cbegin(), line.ir.cend());
+  return ret;
+}
+
+pepp::tc::IRProgram pepp::tc::parser::IncrementalPepAssembler::flattened() const {
+  IRProgram ret;
+  for (const auto &line : _lines) ret.insert(ret.end(), line.flat.cbegin(), line.flat.cend());
+  return ret;
+}
+
+pepp::tc::DiagnosticTable pepp::tc::parser::IncrementalPepAssembler::diagnostics() const {
+  DiagnosticTable ret;
+  for (const auto &line : _lines)
+    for (const auto &[loc, msg] : line.diagnostics) ret.add_message(loc, msg);
+  return ret;
+}
+
+std::shared_ptr<pepp::core::symbol::LeafTable> pepp::tc::parser::IncrementalPepAssembler::symbol_table() const {
+  return _symtab;
+}
+
+std::vector<std::pair<pepp::tc::SectionDescriptor, pepp::tc::IRProgram>> &
+pepp::tc::parser::IncrementalPepAssembler::sections() {
+  return _sections;
+}
+
+const pepp::tc::IRMemoryAddressTable<pepp::tc::PeppAddress> &
+pepp::tc::parser::IncrementalPepAssembler::addresses() const {
+  return _addresses;
+}
+
+void pepp::tc::parser::IncrementalPepAssembler::parse_all(std::vector<std::string> &&text) {
+  // A fresh registry and symbol table, so that inline macros and symbols from the previous parse do not collide.
+  _macros = std::make_shared<MacroRegistry>(_parent);
+  _symtab = std::make_shared<pepp::core::symbol::LeafTable>(2);
+  _opaque_counters = false;
+  _stats = UpdateStats{.full_parse = true, .first_line = 0, .parsed_lines = (u32)text.size()};
+  MacroCounters counters;
+  _lines = parse_range(std::move(text), 0, true, counters);
+  _block_lines = std::count_if(_lines.cbegin(), _lines.cend(), [](const Line &l) { return l.block_directive; });
+  rebuild_symbols();
+  assign_addresses(false);
+  prune_symbols();
+}
+
+std::vector<pepp::tc::parser::IncrementalPepAssembler::Line>
+pepp::tc::parser::IncrementalPepAssembler::parse_range(std::vector<std::string> &&text, u32 first, bool final_line,
+                                                       MacroCounters &counters) {
+  std::vector<Line> ret(text.size());
+  if (text.empty()) return ret;
+  DiagnosticTable diag;
+  PepParser parser(support::SeekableData{join_lines(text, final_line), support::Location(first, 0)}, _macros,
+                   _symtab, counters);
+  auto ir = parser.parse(diag);
+
+  // Attribute IR and diagnostics to the line on which they start.
+  const auto line_of = [&](const support::LocationInterval &loc) -> Line & {
+    if (!loc.valid() || loc.lower().row < first) return ret.front();
+    return ret[std::min<size_t>(loc.lower().row - first, ret.size() - 1)];
+  };
+  for (auto &line : ir) line_of(line->source_interval).ir.emplace_back(line);
+  for (const auto &[loc, msg] : diag) line_of(loc).diagnostics.emplace_back(loc, msg);
+  for (size_t it = 0; it < ret.size(); it++) {
+    ret[it].text = std::move(text[it]);
+    ret[it].flat = flatten_macros(ret[it].ir);
+    ret[it].block_directive = has_block_directive(ret[it].text);
+  }
+
+  // Expansions which failed part-way consumed counters without leaving IR behind.
+  // Later lines cannot know which counters to start from, so give up on partial parses until the next full parse.
+  for (const auto &line : ret) replay_counters(counters, line.ir);
+  if (!(counters == parser.counters())) _opaque_counters = true;
+  counters = parser.counters();
+  return ret;
+}
+
+void pepp::tc::parser::IncrementalPepAssembler::rebuild_symbols() {
+  using namespace pepp::core::symbol;
+  // Lines which are no longer part of the program may have defined symbols or changed their binding.
+  // Re-play every definition and annotation in program order, as PepParser would have performed them.
+  for (auto &[_, entry] : _symtab->entries()) entry->state = DefinitionState::Undefined, entry->binding = Binding::Local;
+  for (const auto &line : _lines) {
+    for (const auto &ir : line.flat) {
+      if (auto decl = ir->typed_attribute<SymbolDeclaration>(); decl) (void)_symtab->define(decl->entry->name);
+      if (ir->type() != DotAnnotate::TYPE) continue;
+      auto as_annotate = static_cast<const DotAnnotate *>(ir.get());
+      auto symbolic = std::dynamic_pointer_cast<pepp::ast::Symbolic>(as_annotate->argument.value);
+      if (!symbolic) continue;
+      else if (as_annotate->which == DotAnnotate::Which::EXPORT) symbolic->symbol()->binding = Binding::Global;
+      else if (as_annotate->which == DotAnnotate::Which::IMPORT) symbolic->symbol()->binding = Binding::Weak;
+    }
+  }
+  for (auto &[_, entry] : _symtab->entries())
+    if (entry->is_undefined()) entry->value = std::make_shared<EmptyValue>(0);
+}
+
+void pepp::tc::parser::IncrementalPepAssembler::prune_symbols() {
+  // Drop symbols only referenced by the table itself, since a fresh parse would never have created them.
+  // Removing an alias may orphan its target, so repeat until nothing changes.
+  while (_symtab->erase_if([](const auto &kv) { return kv.second.use_count() == 1; }) > 0);
+}
+
+void pepp::tc::parser::IncrementalPepAssembler::assign_addresses(bool reuse) {
+  _stats.first_section = 0;
+  // Layout is meaningless for programs with errors, and would throw on multiply defined symbols.
+  bool valid = std::all_of(_lines.cbegin(), _lines.cend(), [](const Line &l) { return l.diagnostics.empty(); });
+  for (const auto &[_, entry] : _symtab->entries())
+    valid &= entry->is_undefined() || entry->is_singly_defined();
+  if (!valid) {
+    _sections.clear(), _addresses.container.clear();
+    return;
+  }
+
+  auto flat = flattened();
+  DiagnosticTable diag;
+  auto split = pepp_split_to_sections(diag, flat);
+  auto &sections = split.grouped_ir;
+  size_t first = 0;
+  // Sections up to the first .ORG are laid out right-to-left from it, so they depend on every section up to the .ORG.
+  const auto first_org = std::find_if(sections.cbegin(), sections.cend(), [](auto &s) { return s.first.org_count > 0; });
+  const size_t reusable = first_org == sections.cend() ? sections.size() : first_org - sections.cbegin() + 1;
+  if (reuse) {
+    const auto common = std::min(sections.size(), _sections.size());
+    while (first < common && same_section(sections[first], _sections[first])) first++;
+    if (first < reusable && first_org != sections.cend()) first = 0;
+    for (size_t it = 0; it < first; it++) {
+      // A new split does not know the previous layout, which assign_addresses requires for re-used sections.
+      auto &desc = sections[it].first;
+      const auto &old = _sections[it].first;
+      desc.low_address = old.low_address, desc.high_address = old.high_address, desc.byte_count = old.byte_count;
+    }
+  }
+  _stats.first_section = first;
+  _addresses = pepp_assign_addresses(sections, 0, reuse ? &_addresses : nullptr, first);
+  _sections = std::move(sections);
+}
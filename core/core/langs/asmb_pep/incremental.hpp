@@ -0,0 +1,80 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/compile/macro/macro_registry.hpp"
+#include "core/compile/macro/macro_replacement.hpp"
+#include "core/langs/asmb/diagnostic_table.hpp"
+#include "core/langs/asmb/ir_program.hpp"
+#include "core/langs/asmb_pep/codegen.hpp"
+
+namespace pepp::core::symbol {
+class LeafTable;
+}
+namespace pepp::tc::parser {
+
+// Re-assembles a program after each edit, re-using as much of the previous assembly as possible.
+// Intended for editors, which re-assemble on every keystroke.
+//
+// IR and diagnostics are cached per source line. An update diffs the new text against the cached lines and re-parses
+// only the lines that changed, plus any later macro invocations whose \@ / \+ counters shifted because of the edit.
+// Statements never span lines unless they use conditionals or inline macro definitions, so any edit in a program
+// containing .IF/.ELSEIF/.ELSE/.ENDIF/.MACRO/.ENDM falls back to parsing the whole program.
+//
+// When the program parsed without errors, it is also split into sections and assigned addresses.
+// Sections in front of the first section whose IR changed keep their previous addresses where possible; see
+// pepp::tc::assign_addresses.
+class IncrementalPepAssembler {
+public:
+  // Macros defined inline in the program are placed in a child of reg, so reg itself is never modified.
+  explicit IncrementalPepAssembler(std::shared_ptr<MacroRegistry> reg);
+
+  struct UpdateStats {
+    bool full_parse = false;
+    // Range of source lines that were re-parsed.
+    u32 first_line = 0, parsed_lines = 0;
+    // Index of the first section which was assigned new addresses, or the number of sections if none were.
+    u32 first_section = 0;
+  };
+  UpdateStats update(std::string text);
+
+  // Top-level IR in source order, as PepParser::parse would return it.
+  IRProgram program() const;
+  IRProgram flattened() const;
+  DiagnosticTable diagnostics() const;
+  std::shared_ptr<pepp::core::symbol::LeafTable> symbol_table() const;
+  // Empty if the program contains errors.
+  std::vector<std::pair<SectionDescriptor, IRProgram>> &sections();
+  const IRMemoryAddressTable<PeppAddress> &addresses() const;
+
+private:
+  struct Line {
+    std::string text;
+    // Top-level IR whose source_interval begins on this line, and the same IR after flatten_macros.
+    IRProgram ir, flat;
+    std::vector<std::pair<support::LocationInterval, std::string>> diagnostics;
+    // Line contains a directive which may change how subsequent lines are parsed.
+    bool block_directive = false;
+  };
+  void parse_all(std::vector<std::string> &&text);
+  // Parse lines [first, first+text.size()) of the program. counters are the macro counters at the start of the range,
+  // and are updated to their value at the end of the range.
+  std::vector<Line> parse_range(std::vector<std::string> &&text, u32 first, bool final_line, MacroCounters &counters);
+  // Replay symbol definitions from the cached IR, since removed lines may have defined symbols.
+  void rebuild_symbols();
+  // Remove symbols which are no longer referenced by any IR. Must run after the previous layout has been released.
+  void prune_symbols();
+  void assign_addresses(bool reuse);
+
+  std::shared_ptr<MacroRegistry> _parent, _macros;
+  std::shared_ptr<pepp::core::symbol::LeafTable> _symtab;
+  std::vector<Line> _lines;
+  u32 _block_lines = 0;
+  // Set when parsing consumed macro counters in a way which cannot be recovered from the IR (i.e., expansion errors).
+  bool _opaque_counters = false;
+  std::vector<std::pair<SectionDescriptor, IRProgram>> _sections;
+  IRMemoryAddressTable<PeppAddress> _addresses;
+  UpdateStats _stats;
+};
+
+} // namespace pepp::tc::parser
@@ -11,6 +11,7 @@
 #include "core/compile/ir_value/symbolic.hpp"
 #include "core/compile/ir_value/text.hpp"
 #include "core/compile/macro/macro_replacement.hpp"
+#include "core/compile/parallel.hpp"
 #include "core/compile/symbol/entry.hpp"
 #include "core/compile/symbol/leaf_table.hpp"
 #include "core/compile/symbol/types.hpp"
@@ -30,10 +31,21 @@ pepp::tc::parser::PepParser::PepParser(pepp::tc::support::SeekableData &&data, s
   _lexer_stack.emplace(_root_lexer, buffer);
 }
 
+pepp::tc::parser::PepParser::PepParser(pepp::tc::support::SeekableData &&data, std::shared_ptr<MacroRegistry> reg,
+                                       std::shared_ptr<pepp::core::symbol::LeafTable> symtab, MacroCounters counters)
+    : _pool(std::make_shared<std::unordered_set<std::string>>()),
+      _root_lexer(std::make_shared<lex::PepLexer>(_pool, std::move(data))), _symtab(symtab), _macros(reg),
+      _counters(std::move(counters)) {
+  auto buffer = std::make_shared<lex::Buffer>(&*_root_lexer);
+  _lexer_stack.emplace(_root_lexer, buffer);
+}
+
 pepp::tc::IRProgram pepp::tc::parser::PepParser::parse(DiagnosticTable &diag) { return do_parse(diag, std::nullopt); }
 
 std::shared_ptr<pepp::core::symbol::LeafTable> pepp::tc::parser::PepParser::symbol_table() const { return _symtab; }
 
+pepp::tc::MacroCounters const &pepp::tc::parser::PepParser::counters() const { return _counters; }
+
 void pepp::tc::parser::PepParser::debug_print_tokens(bool debug) { _root_lexer->print_tokens = debug; }
 
 std::shared_ptr<pepp::ast::IRValue> pepp::tc::parser::PepParser::argument() {
@@ -117,9 +129,9 @@ pepp::tc::IRProgram pepp::tc::parser::PepParser::do_parse(DiagnosticTable &diag,
   return lines;
 }
 
-static const auto split_args = [](std::shared_ptr<pepp::tc::lex::Token> const &t) {
+static const auto split_args = [](pepp::tc::lex::Token const *t) {
   if (t->type() != pepp::tc::lex::Literal::TYPE) return false;
-  auto lit = std::static_pointer_cast<pepp::tc::lex::Literal>(t);
+  auto lit = static_cast<pepp::tc::lex::Literal const *>(t);
   return lit->literal == ",";
 };
 
@@ -141,7 +153,7 @@ std::shared_ptr<pepp::tc::LinearIR> pepp::tc::parser::PepParser::macro(Diagnosti
   // Get tokens after the macro name, split on commas, re-assmble to strings.
   auto tokens = buf->matched_tokens_after(cp.marker());
   std::vector<std::string> args;
-  std::span<std::shared_ptr<pepp::tc::lex::Token> const> head, rest = tokens;
+  std::span<pepp::tc::lex::Token *const> head, rest = tokens;
   while (!rest.empty()) {
     std::tie(head, rest) = pepp::tc::split_exclusive(rest, split_args);
     const auto first_loc = head.front()->location().lower(), last_loc = head.back()->location().upper();
@@ -149,14 +161,26 @@ std::shared_ptr<pepp::tc::LinearIR> pepp::tc::parser::PepParser::macro(Diagnosti
     args.emplace_back(arg);
   }
   auto ret = std::make_shared<MacroInstantiation>(macro_def, args);
-  auto rep = _counters.counters_for(macro_def->name);
   // TODO: Validate # of matched arguments vs number of args in definition, accounting for default values.
-  for (int it = 0; it < macro_def->arguments.size(); it++) {
-    const auto arg_name = macro_def->arguments.at(it).name;
-    const auto arg_value = args.size() > it ? args.at(it) : macro_def->arguments.at(it).default_value.value_or("");
-    rep["\\" + arg_name] = arg_value;
+  std::string new_body;
+  if (macro_def->compiled) {
+    const auto counters = _counters.next(macro_def->name);
+    std::vector<std::string_view> values(macro_def->arguments.size());
+    for (int it = 0; it < macro_def->arguments.size(); it++) {
+      if (args.size() > it) values[it] = args.at(it);
+      else if (const auto &value = macro_def->arguments.at(it).default_value; value) values[it] = *value;
+    }
+    new_body = bits::rtrimmed(macro_def->compiled->expand(values, counters.unique, counters.count));
+  } else {
+    // Definitions which never passed through MacroRegistry::insert have not been compiled.
+    auto rep = _counters.counters_for(macro_def->name);
+    for (int it = 0; it < macro_def->arguments.size(); it++) {
+      const auto arg_name = macro_def->arguments.at(it).name;
+      const auto arg_value = args.size() > it ? args.at(it) : macro_def->arguments.at(it).default_value.value_or("");
+      rep["\\" + arg_name] = arg_value;
+    }
+    new_body = bits::rtrimmed(replace_macro_arguments(macro_def->body, rep));
   }
-  auto new_body = bits::rtrimmed(replace_macro_arguments(macro_def->body, rep));
   auto new_lexer = std::make_shared<lex::PepLexer>(_pool, support::SeekableData{std::move(new_body)});
   auto new_buffer = std::make_shared<lex::Buffer>(&*new_lexer);
   _lexer_stack.emplace(new_lexer, new_buffer);
@@ -407,7 +431,7 @@ std::shared_ptr<pepp::tc::LinearIR> pepp::tc::parser::PepParser::pseudo(Optional
     buf->match_until<lex::Empty, lex::EoF>();
     auto tokens = buf->matched_tokens_after(marker);
     std::vector<std::string> args;
-    std::span<std::shared_ptr<pepp::tc::lex::Token> const> head, rest = tokens;
+    std::span<pepp::tc::lex::Token *const> head, rest = tokens;
     while (!rest.empty()) {
       std::tie(head, rest) = pepp::tc::split_exclusive(rest, split_args);
       const auto first_loc = head.front()->location().lower(), last_loc = head.back()->location().upper();
@@ -636,3 +660,26 @@ pepp::tc::IRProgram pepp::tc::parser::flatten_macros(const IRProgram &program) {
   }
   return ret;
 }
+
+// Programs with fewer top-level lines than this are flattened on the calling thread.
+static constexpr size_t PARALLEL_FLATTEN_MIN_LINES = 1024;
+
+pepp::tc::IRProgram pepp::tc::parser::flatten_macros(const IRProgram &program, unsigned threads) {
+  threads = resolve_thread_count(threads);
+  if (threads == 1 || program.size() < PARALLEL_FLATTEN_MIN_LINES) return flatten_macros(program);
+
+  const size_t chunk = (program.size() + threads - 1) / threads;
+  std::vector<IRProgram> flattened((program.size() + chunk - 1) / chunk);
+  // Reports the same error the serial path would have, which is the first one in source order.
+  parallel_for(flattened.size(), threads, [&](size_t it) {
+    auto begin = program.begin() + it * chunk;
+    auto end = program.begin() + std::min(program.size(), (it + 1) * chunk);
+    flattened[it] = flatten_macros(IRProgram(begin, end));
+  });
+
+  IRProgram ret;
+  ret.reserve(std::accumulate(flattened.cbegin(), flattened.cend(), size_t{0},
+                              [](size_t acc, const IRProgram &part) { return acc + part.size(); }));
+  for (auto &part : flattened) ret.insert(ret.end(), part.begin(), part.end());
+  return ret;
+}
@@ -37,9 +37,15 @@ class DiagnosticTable;
 namespace parser {
 struct PepParser {
   PepParser(support::SeekableData &&data, std::shared_ptr<pepp::tc::MacroRegistry> reg);
+  // Parse a fragment of a larger program whose other fragments were parsed into symtab.
+  // counters must hold the \@ and \+ values at the start of the fragment for expansions to match a whole-program parse.
+  PepParser(support::SeekableData &&data, std::shared_ptr<pepp::tc::MacroRegistry> reg,
+            std::shared_ptr<pepp::core::symbol::LeafTable> symtab, MacroCounters counters);
 
   IRProgram parse(DiagnosticTable &);
   std::shared_ptr<pepp::core::symbol::LeafTable> symbol_table() const;
+  // Counter values after the last macro expanded by parse().
+  MacroCounters const &counters() const;
 
   void debug_print_tokens(bool debug);
 
@@ -85,6 +91,10 @@ private:
 };
 
 IRProgram flatten_macros(IRProgram const &program);
+// Flattens contiguous runs of top-level lines concurrently on up to threads threads (0 for one per hardware thread),
+// and concatenates them in order.
+// Each macro instantiation only touches its own body, so the result is identical to the single-threaded overload.
+IRProgram flatten_macros(IRProgram const &program, unsigned threads);
 } // namespace parser
 } // namespace tc
 } // namespace pepp
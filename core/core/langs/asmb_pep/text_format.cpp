@@ -64,11 +64,11 @@ namespace {
 struct TokenGroup {
   int stem_token_type = (int)pepp::tc::lex::CommonTokenType::Invalid;
   int stem_token_index = -1;
-  std::span<std::shared_ptr<pepp::tc::lex::Token> const> head = {}, rest = {};
+  std::span<pepp::tc::lex::Token *const> head = {}, rest = {};
   // Return the stem token
   pepp::tc::lex::Token const *stem() const {
     if (stem_token_index < 0 || stem_token_index >= head.size()) return nullptr;
-    return &*head[stem_token_index];
+    return head[stem_token_index];
   }
   // Format the "stem" token in head specially, and use default formatting for prefix and suffix.
   std::string formatted_head(std::string formatted_stem) const {
@@ -101,7 +101,7 @@ bool adjacent(pepp::tc::support::LocationInterval first, pepp::tc::support::Loca
 // Given a span of tokens, return a TokenGroup representing the longest prefix of tokens that meets the requirements
 // prefix+stem+suffix. The remaining tokens are in the "rest" field of the return value. Will return an empty/invalid
 // group if input is already exhausted.
-TokenGroup next_group(std::span<std::shared_ptr<pepp::tc::lex::Token> const> tokens) {
+TokenGroup next_group(std::span<pepp::tc::lex::Token *const> tokens) {
   using CTT = pepp::tc::lex::CommonTokenType;
   // comments/empty/eof/literals to "combine" with macro placeholders either to their left or their right.
   static const int left_uncombinable = (int)CTT::InlineComment | (int)CTT::Empty | (int)CTT::EoF | (int)CTT::Literal;
@@ -143,7 +143,7 @@ ret:
 
 } // namespace
 
-std::string pepp::tc::format_source(std::span<std::shared_ptr<lex::Token> const> tokens) {
+std::string pepp::tc::format_source(std::span<lex::Token *const> tokens) {
   using CTT = lex::CommonTokenType;
   using ATT = lex::AsmTokenType;
 
@@ -170,7 +170,7 @@ std::string pepp::tc::format_source(std::span<std::shared_ptr<lex::Token> const>
   auto finalize_args = [&]() { col2 = fmt::format("{}", fmt::join(arg_list, space_after_comma ? ", " : ",")); };
   // Process tokens on (prefix+stem+suffix) group at a time.
   // next_group guarantees a non-empty head as long as the input is non-empty.
-  std::span<std::shared_ptr<lex::Token> const> rest = tokens;
+  std::span<lex::Token *const> rest = tokens;
   while (!rest.empty()) {
     auto group = next_group(rest);
     rest = group.rest;
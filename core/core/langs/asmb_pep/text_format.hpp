@@ -30,7 +30,7 @@ std::string format_as_columns(const std::string &col0, const std::string &col1,
 // It does not make semantic checks that the code is correct, and can be used in more cases than assemble+format.
 // If the line is not valid, it will return an empty string. In this case, you will need to reach into the tokenizer and
 // grab the original source text for the source interval.
-std::string format_source(bits::span<std::shared_ptr<lex::Token> const> tokens);
+std::string format_source(bits::span<lex::Token *const> tokens);
 
 // Split a span of tokens into a head+rest pair, where head includes all items up-to and including the first item
 // matching the predicate.
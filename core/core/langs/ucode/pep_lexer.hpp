@@ -8,6 +8,6 @@ struct MicroLexer : public ALexer {
   MicroLexer(std::shared_ptr<std::unordered_set<std::string>> identifier_pool, support::SeekableData &&data);
   ~MicroLexer() override = default;
   bool input_remains() const override;
-  std::shared_ptr<Token> next_token() override;
+  Token *next_token() override;
 };
 } // namespace pepp::tc::lex
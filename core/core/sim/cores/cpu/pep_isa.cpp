@@ -91,6 +91,7 @@ void PepISA3CPU::initialize(System *sys) {
   if (!dev) throw std::runtime_error("PepISA3CPU: could not find target device " + _config.target);
   _target = dev->capability<Target>();
   if (!_target) throw std::runtime_error("PepISA3CPU: device " + _config.target + " is not a memory target");
+  _dense = dynamic_cast<Dense *>(_target);
   switch (_config.isa) {
   case ISA::Pep8: throw std::logic_error("PepISA3CPU: ISA " + isa_to_string(_config.isa) + " not implemented");
   case ISA::Pep9: _opcodes = isa::Pep9::opcode_plane; break;
@@ -153,35 +154,60 @@ std::unique_ptr<DeviceSerializer> PepISA3CPU::make_serializer() {
   return std::make_unique<DeviceSerializer>(std::move(s));
 }
 
-void PepISA3CPU::clock_tick(PulseSchedule::PulseIndex idx, u64 tick) {
-  // Create a single record for the entire instruction
-  trace::Recorder::Instruction record(_trace, _may_trace);
-  // TODO: when function signature changes, use that tick offset instead of this placeholder.
-  record.tick(1);
+void PepISA3CPU::clock_tick(PulseSchedule::PulseIndex idx, u64 tick) { step<true, Target>(_opcodes); }
 
+void PepISA3CPU::run(u64 n) {
+  // Pep8 was already rejected by initialize().
+  const bool pep10 = _config.isa == ISA::Pep10;
+  if (_dense && _may_trace) pep10 ? run<true, ISA::Pep10, Dense>(n) : run<true, ISA::Pep9, Dense>(n);
+  else if (_dense) pep10 ? run<false, ISA::Pep10, Dense>(n) : run<false, ISA::Pep9, Dense>(n);
+  else if (_may_trace) pep10 ? run<true, ISA::Pep10, Target>(n) : run<true, ISA::Pep9, Target>(n);
+  else pep10 ? run<false, ISA::Pep10, Target>(n) : run<false, ISA::Pep9, Target>(n);
+}
+
+template <bool Traced, PepISA3CPU::ISA Isa, typename Mem> void PepISA3CPU::run(u64 n) {
+  // The constexpr plane rather than the _opcodes copy, so the table's address is a constant in the loop.
+  const auto &opcodes = Isa == ISA::Pep10 ? isa::Pep10::opcode_plane : isa::Pep9::opcode_plane;
+  for (u64 it = 0; it < n; ++it) step<Traced, Mem>(opcodes);
+}
+
+template <bool Traced, typename Mem> void PepISA3CPU::step(const isa::OpcodePlane &opcodes) {
+  // Untraced, there is no record at all. An inert one would still cost a check of its own per instruction, since
+  // handle() is opaque to the compiler and so might have opened it.
+  if constexpr (Traced) {
+    // Create a single record for the entire instruction
+    trace::Recorder::Instruction record(_trace, _may_trace);
+    // TODO: when function signature changes, use that tick offset instead of this placeholder.
+    record.tick(1);
+    execute<true, Mem>(opcodes);
+    record.commit();
+  } else execute<false, Mem>(opcodes);
+}
+
+template <bool Traced, typename Mem> void PepISA3CPU::execute(const isa::OpcodePlane &opcodes) {
   // Take PC out of the register bank for the duration of this instruction. Everything below moves it through _pc,
   // and the single store after handle() is the only version the trace ever sees. See read_pc().
   _pc = read_register_uncached(isa::Pep10::Register::PC);
   const auto init_pc = _pc;
   // TODO: Should probably be an instruction access?
-  u8 is = _target->read<u8, false>(_pc, op_data()).second;
+  u8 is = read_memory<Mem, u8>(_pc);
   _pc += 1;
   write_register(isa::Pep10::Register::IS, is);
   // Defer PC writeback until end of instruction to avoid ~3 updates on a BR (1 for to fetch IS, 1 to fetch OS, 1 for
   // the branch).
-  handle(_opcodes[is]);
+  handle<Mem>(opcodes[is]);
   // Change in PC is range [1, 3] which is the normal increment amount and probably not from a branch.
   // Since all instructions other than branches have a fixed PC increment, we can use a specialized increment encoding
   // to save ~2B/instruction in the trace. We do not use the normal encoding for calls/branches, as those can have
   // data-dependence for the branch target.
   const auto pc_delta = _pc - init_pc;
   if ((pc_delta & 0b11) == pc_delta) {
-    auto r = _regbank->ref(isa::Pep10::Register::PC);
-    if (_may_trace) _trace.emit_incr_register(op_data(), r, static_cast<i16>(pc_delta));
+    // ref() is out of line, so only look the register up when there is a trace to put it in.
+    if (Traced && _may_trace)
+      _trace.emit_incr_register(op_data(), _regbank->ref(isa::Pep10::Register::PC), static_cast<i16>(pc_delta));
     _regbank->write_pc_untraced(_pc);
   } else write_register_uncached(isa::Pep10::Register::PC, _pc);
   // TODO: handle breakpoints, debug info, etc
-  record.commit();
   _count.instructions += 1;
 }
 
@@ -219,19 +245,19 @@ u8 PepISA3CPU::read_packed_csr() const { return _csrs->read_packed(); }
 
 void PepISA3CPU::write_packed_csr(u8 value) { _csrs->write_packed(value); }
 
-void PepISA3CPU::handle(Op opcode) {
+template <typename Mem> void PepISA3CPU::handle(Op opcode) {
   using R = isa::Pep10::Register;
   using BC = BranchCondition;
   using enum isa::SharedOpBehavior;
-  const auto operand = [&] { return decode_op_addr(this, opcode.addr); };
+  const auto operand = [&] { return decode_op_addr<Mem>(this, opcode.addr); };
   // One switch over the whole behavior enum rather than two, which is significantly faster than a monadic/dyadic split.
   // However, we can't preload operand anymore, so we need a small lambda to defer reading it until we've figured out if
   // the insruction is dyadic or not.
   switch (opcode.behavior) {
   case UNIMPL: return unimpl_handler(this);
   case STOP: throw std::logic_error("Unimplemented instruction: STOP");
-  case RET: return handle_ret(this);
-  case SRET: return handle_sret(this);
+  case RET: return handle_ret<Mem>(this);
+  case SRET: return handle_sret<Mem>(this);
   case MOVFLGA: return handle_movflga(this);
   case MOVAFLG: return handle_movaflg(this);
   case MOVSPA: return handle_movspa(this);
@@ -245,29 +271,29 @@ void PepISA3CPU::handle(Op opcode) {
   case ROR: return handle_rorr(this, (R)opcode.target);
   case SCALL: throw std::logic_error("Unimplemented instruction: SCALL");
   case TRAP_CALL: throw std::logic_error("Unimplemented instruction: TRAP_CALL");
-  case BR: return handle_unconditional_branch(this, opcode, operand());
-  case BRLE: return handle_branch(this, opcode, BC::LE, operand());
-  case BRLT: return handle_branch(this, opcode, BC::LT, operand());
-  case BREQ: return handle_branch(this, opcode, BC::EQ, operand());
-  case BRNE: return handle_branch(this, opcode, BC::NE, operand());
-  case BRGE: return handle_branch(this, opcode, BC::GE, operand());
-  case BRGT: return handle_branch(this, opcode, BC::GT, operand());
-  case BRV: return handle_branch(this, opcode, BC::V, operand());
-  case BRC: return handle_branch(this, opcode, BC::C, operand());
-  case CALL: return handle_call(this, opcode, operand());
-  case ADDSP: return handle_addsp(this, opcode, operand());
-  case SUBSP: return handle_subsp(this, opcode, operand());
-  case ADD: return handle_addr(this, opcode, operand());
-  case SUB: return handle_subr(this, opcode, operand());
-  case AND: return handle_bitopr(this, opcode, Bitop::AND, operand());
-  case OR: return handle_bitopr(this, opcode, Bitop::OR, operand());
-  case XOR: return handle_bitopr(this, opcode, Bitop::XOR, operand());
-  case CPW: return handle_cpwr(this, opcode, operand());
-  case CPB: return handle_cpbr(this, opcode, operand());
-  case LDW: return handle_ldwr(this, opcode, operand());
-  case LDB: return handle_ldbr(this, opcode, operand());
-  case STW: return handle_stwr(this, opcode, operand());
-  case STB: return handle_stbr(this, opcode, operand());
+  case BR: return handle_unconditional_branch<Mem>(this, opcode, operand());
+  case BRLE: return handle_branch<Mem>(this, opcode, BC::LE, operand());
+  case BRLT: return handle_branch<Mem>(this, opcode, BC::LT, operand());
+  case BREQ: return handle_branch<Mem>(this, opcode, BC::EQ, operand());
+  case BRNE: return handle_branch<Mem>(this, opcode, BC::NE, operand());
+  case BRGE: return handle_branch<Mem>(this, opcode, BC::GE, operand());
+  case BRGT: return handle_branch<Mem>(this, opcode, BC::GT, operand());
+  case BRV: return handle_branch<Mem>(this, opcode, BC::V, operand());
+  case BRC: return handle_branch<Mem>(this, opcode, BC::C, operand());
+  case CALL: return handle_call<Mem>(this, opcode, operand());
+  case ADDSP: return handle_addsp<Mem>(this, opcode, operand());
+  case SUBSP: return handle_subsp<Mem>(this, opcode, operand());
+  case ADD: return handle_addr<Mem>(this, opcode, operand());
+  case SUB: return handle_subr<Mem>(this, opcode, operand());
+  case AND: return handle_bitopr<Mem>(this, opcode, Bitop::AND, operand());
+  case OR: return handle_bitopr<Mem>(this, opcode, Bitop::OR, operand());
+  case XOR: return handle_bitopr<Mem>(this, opcode, Bitop::XOR, operand());
+  case CPW: return handle_cpwr<Mem>(this, opcode, operand());
+  case CPB: return handle_cpbr<Mem>(this, opcode, operand());
+  case LDW: return handle_ldwr<Mem>(this, opcode, operand());
+  case LDB: return handle_ldbr<Mem>(this, opcode, operand());
+  case STW: return handle_stwr<Mem>(this, opcode, operand());
+  case STB: return handle_stbr<Mem>(this, opcode, operand());
   default: throw std::logic_error("Unknown opcode behavior");
   }
 }
\ No newline at end of file
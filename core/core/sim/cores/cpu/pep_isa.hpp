@@ -11,6 +11,7 @@
 #include "core/sim/cores/cpu/pep_csrbank.hpp"
 #include "core/sim/cores/cpu/pep_regbank.hpp"
 
+class Dense;
 
 /*
  * The following classes of instructions are still not tested. Those tests require a more complete system model to
@@ -58,6 +59,10 @@ public:
 
   // ClockSink interface
   void clock_tick(PulseSchedule::PulseIndex idx, u64 tick) override;
+  // Execute n instructions back to back, with the same effect as n calls to clock_tick. The loop is specialized once up
+  // front rather than deciding per instruction: on the ISA's opcode plane, on whether this CPU is traced, and on whether
+  // the target is a Dense, in which case memory access skips the bus's virtual dispatch.
+  void run(u64 n);
   void set_clock_source(const ClockSource *src) override;
   const ClockSource *clock_source() const override;
 
@@ -93,6 +98,12 @@ public:
   PepRegisterBank *registers() const { return _regbank; }
   PepCSRBank *csrs() const { return _csrs; }
 
+  // Memory access on behalf of the instruction handlers. Mem is Target to go through the bus, or Dense when run() has
+  // found that the target is a Dense, which must be the only other instantiation.
+  template <typename Mem> Mem *memory();
+  template <typename Mem, std::integral I, bool byteswap = false> I read_memory(Address address);
+  template <typename Mem, std::integral I, bool byteswap = false> void write_memory(Address address, I value);
+
   // No longer static const because it embeds this instance's id.
   Operation op_data() const { return _op_data; }
 
@@ -115,6 +126,8 @@ private:
   PepRegisterBank *_regbank = nullptr;
   PepCSRBank *_csrs = nullptr;
   Target *_target = nullptr;
+  // _target again when it is a Dense, else null.
+  Dense *_dense = nullptr;
   // Mirror of the buffer's traced bit, pushed by TraceBuffer::trace. Read several times per instruction, and the
   // reason the trace hooks below cost a branch rather than a call when tracing is off.
   bool _may_trace = true;
@@ -122,10 +135,28 @@ private:
   // Override this value once our id is known.
   Operation _op_data = Operation(Operation::Type::Standard, Operation::Kind::data, Device::ID{0});
 
-  void handle(isa::SharedOp opcode);
+  // One instruction. With Traced false the trace hooks are compiled out, which is only correct when _may_trace is false.
+  // step() wraps the instruction in its trace record, and execute() is the instruction itself.
+  template <bool Traced, typename Mem> void step(const isa::OpcodePlane &opcodes);
+  template <bool Traced, typename Mem> void execute(const isa::OpcodePlane &opcodes);
+  template <bool Traced, ISA Isa, typename Mem> void run(u64 n);
+  template <typename Mem> void handle(isa::SharedOp opcode);
   const ClockSource *_clk = nullptr;
 };
 
+template <typename Mem> inline Mem *PepISA3CPU::memory() {
+  if constexpr (std::is_same_v<Mem, Dense>) return _dense;
+  else return _target;
+}
+
+template <typename Mem, std::integral I, bool byteswap> inline I PepISA3CPU::read_memory(Address address) {
+  return memory<Mem>()->template read<I, byteswap>(address, _op_data).second;
+}
+
+template <typename Mem, std::integral I, bool byteswap> inline void PepISA3CPU::write_memory(Address address, I value) {
+  memory<Mem>()->template write<I, byteswap>(address, value, _op_data);
+}
+
 template <typename RegisterType> inline void PepISA3CPU::write_register(RegisterType reg, u16 value) {
   if (reg == RegisterType::PC) _pc = value;
   else write_register_uncached(reg, value);
@@ -1,28 +1,28 @@
 #include "pep_isa_instructions.hpp"
 #include "core/sim/cores/cpu/pep_csrbank.hpp"
 #include "core/sim/cores/cpu/pep_isa.hpp"
+#include "core/sim/memory/ram/dense.hpp"
 
 // The two ISAs declare identical Register enums, so one alias serves both.
 using R = isa::Pep10::Register;
 
-u16 decode_op_addr(PepISA3CPU *self, isa::SharedAddrMode addr) {
+template <typename Mem> u16 decode_op_addr(PepISA3CPU *self, isa::SharedAddrMode addr) {
   // Fetch current PC
   u16 pc = self->read_pc();
   // Increment PC by 2 to point to next instruction.
   self->write_pc(pc + 2);
-  auto target = self->target();
   // Read value at mem[PC] into OS register.
-  u16 opr = target->read<u16, bits::host_is_le>(pc, self->op_data()).second;
+  u16 opr = self->read_memory<Mem, u16, bits::host_is_le>(pc);
   self->write_register<R::OS>(opr);
 
   switch (addr) {
   case isa::SharedAddrMode::I: return pc;
-  case isa::SharedAddrMode::N: opr = target->read<u16, bits::host_is_le>(opr, self->op_data()).second; [[fallthrough]];
+  case isa::SharedAddrMode::N: opr = self->read_memory<Mem, u16, bits::host_is_le>(opr); [[fallthrough]];
   case isa::SharedAddrMode::D: return opr;
 
   case isa::SharedAddrMode::SF:
     opr = self->read_register<R::SP>() + opr;
-    return self->target()->read<u16, bits::host_is_le>(opr, self->op_data()).second;
+    return self->read_memory<Mem, u16, bits::host_is_le>(opr);
 
   case isa::SharedAddrMode::S: return self->read_register<R::SP>() + opr;
   case isa::SharedAddrMode::X: return self->read_register<R::X>() + opr;
@@ -30,29 +30,29 @@ u16 decode_op_addr(PepISA3CPU *self, isa::SharedAddrMode addr) {
     return self->read_register<R::X>() + self->read_register<R::SP>() + opr;
   case isa::SharedAddrMode::SFX:
     opr = self->read_register<R::SP>() + opr;
-    return self->read_register<R::X>() + self->target()->read<u16, bits::host_is_le>(opr, self->op_data()).second;
+    return self->read_register<R::X>() + self->read_memory<Mem, u16, bits::host_is_le>(opr);
   }
   throw std::logic_error("Invalid addressing mode for decode_op_addr");
 }
 
 void unimpl_handler(PepISA3CPU *) { throw std::logic_error("Unimplemented instruction encountered"); }
 
-void handle_ret(PepISA3CPU *self) {
+template <typename Mem> void handle_ret(PepISA3CPU *self) {
   self->decrement_call_depth();
   u16 sp = self->read_register<R::SP>();
-  auto addr = self->target()->read<u16, bits::host_is_le>(sp, self->op_data()).second;
+  auto addr = self->read_memory<Mem, u16, bits::host_is_le>(sp);
   self->write_pc(addr);
   self->write_register<R::SP>(sp + 2);
   // TODO: notify debugger of ret @ PC
 }
 
-void handle_sret(PepISA3CPU *self) {
+template <typename Mem> void handle_sret(PepISA3CPU *self) {
   // Long enough to either hold all regs or one ctx switch block.
   static constexpr u8 registersBytes = 2 * ::isa::Pep10::RegisterCount;
   u8 ctx[std::max<std::size_t>(registersBytes, 12)];
   auto ctxSpan = bits::span<u8>{ctx, sizeof(ctx)};
 
-  auto memory = self->target();
+  auto memory = self->memory<Mem>();
   // Fill ctx with all register's current values.
   // Then we can do a single write back to _regs and only generate 1 trace
   // packet.
@@ -62,7 +62,7 @@ void handle_sret(PepISA3CPU *self) {
   regs->read(0, {ctx, tmp}, self->op_data());
 
   // Reload NZVC
-  auto csrs = memory->read<u8>(sp, self->op_data()).second;
+  auto csrs = self->read_memory<Mem, u8>(sp);
   self->write_packed_csr(csrs);
 
   // Load A into ctx. No need for byteswap, _memory is little endian as are
@@ -202,9 +202,9 @@ void handle_rorr(PepISA3CPU *self, isa::Pep10::Register reg) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_branch(PepISA3CPU *self, Op op, BranchCondition cond, u16 op_addr) {
+template <typename Mem> void handle_branch(PepISA3CPU *self, Op op, BranchCondition cond, u16 op_addr) {
   const auto [n, z, v, c] = PepCSRBank::unpack(self->read_packed_csr());
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   bool taken;
   switch (cond) {
   case BranchCondition::UNCONDITIONAL: taken = true; break;
@@ -220,39 +220,39 @@ void handle_branch(PepISA3CPU *self, Op op, BranchCondition cond, u16 op_addr) {
   if (taken) self->write_pc(op_spec);
 }
 
-void handle_unconditional_branch(PepISA3CPU *self, Op op, u16 op_addr) {
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+template <typename Mem> void handle_unconditional_branch(PepISA3CPU *self, Op op, u16 op_addr) {
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   self->write_pc(op_spec);
 }
 
-void handle_call(PepISA3CPU *self, Op op, u16 op_addr) {
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+template <typename Mem> void handle_call(PepISA3CPU *self, Op op, u16 op_addr) {
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const u16 pc = self->read_pc();
   u16 sp = self->read_register<R::SP>();
-  self->target()->write<u16, bits::host_is_le>(sp -= 2, pc, self->op_data());
+  self->write_memory<Mem, u16, bits::host_is_le>(sp -= 2, pc);
   self->write_register<R::SP>(sp);
   self->write_pc(op_spec);
   self->increment_call_depth();
   // TODO: if (_dbg) _dbg->notifyCall(pc - 3, sp);
 }
 
-void handle_addsp(PepISA3CPU *self, Op op, u16 op_addr) {
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+template <typename Mem> void handle_addsp(PepISA3CPU *self, Op op, u16 op_addr) {
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const auto sp = self->read_register<R::SP>() + op_spec;
   self->write_register<R::SP>(sp);
   // TODO: if (_dbg) _dbg->notifyAddSP(pc - 3, sp);
 }
 
-void handle_subsp(PepISA3CPU *self, Op op, u16 op_addr) {
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+template <typename Mem> void handle_subsp(PepISA3CPU *self, Op op, u16 op_addr) {
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const auto sp = self->read_register<R::SP>() - op_spec;
   self->write_register<R::SP>(sp);
   // TODO: if (_dbg) _dbg->notifySubSP(pc - 3, sp);
 }
 
-void handle_addr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_addr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const u16 src = self->read_register(reg);
   const u16 tmp = src + op_spec;
   // Is negative if high order bit is 1.
@@ -270,9 +270,9 @@ void handle_addr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_subr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_subr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
-  const u16 operand = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 operand = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const u16 src = self->read_register(reg);
   const u16 tmp = src + ~operand + 1;
   // Is negative if high order bit is 1.
@@ -290,9 +290,9 @@ void handle_subr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_bitopr(PepISA3CPU *self, Op op, Bitop bitop, u16 op_addr) {
+template <typename Mem> void handle_bitopr(PepISA3CPU *self, Op op, Bitop bitop, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const u16 src = self->read_register(reg);
   auto [n, z, v, c] = PepCSRBank::unpack(self->read_packed_csr());
   u16 tmp;
@@ -309,9 +309,9 @@ void handle_bitopr(PepISA3CPU *self, Op op, Bitop bitop, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_cpwr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_cpwr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
-  const u16 operand = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 operand = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   const u16 src = self->read_register(reg);
   const u16 neg = ~operand + 1;
   const u16 tmp = src + neg;
@@ -331,10 +331,10 @@ void handle_cpwr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_cpbr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_cpbr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
   // op_addr is address for 2-byte operands, so we need an offset of 1.
-  const u8 op_spec = self->target()->read<u8>(op_addr + 1, self->op_data()).second;
+  const u8 op_spec = self->read_memory<Mem, u8>(op_addr + 1);
   const auto src = self->read_register(reg);
   // The result is the decoded operand specifier plus A/X. mask down to a byte.
   u16 tmp = (src + ~op_spec + 1) & 0xff;
@@ -346,9 +346,9 @@ void handle_cpbr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, 0, 0));
 }
 
-void handle_ldwr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_ldwr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
-  const u16 op_spec = self->target()->read<u16, bits::host_is_le>(op_addr, self->op_data()).second;
+  const u16 op_spec = self->read_memory<Mem, u16, bits::host_is_le>(op_addr);
   auto [n, z, v, c] = PepCSRBank::unpack(self->read_packed_csr());
   // Is negative if high order bit is 1.
   n = op_spec & 0x8000;
@@ -358,10 +358,10 @@ void handle_ldwr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_ldbr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_ldbr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
   // op_addr is address for 2-byte operands, so we need an offset of 1.
-  const u8 op_spec = self->target()->read<u8>(op_addr + 1, self->op_data()).second;
+  const u8 op_spec = self->read_memory<Mem, u8>(op_addr + 1);
   auto [n, z, v, c] = PepCSRBank::unpack(self->read_packed_csr());
   // LDBr always clears n.
   n = 0;
@@ -371,14 +371,36 @@ void handle_ldbr(PepISA3CPU *self, Op op, u16 op_addr) {
   self->write_packed_csr(PepCSRBank::pack(n, z, v, c));
 }
 
-void handle_stwr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_stwr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
   u16 src = self->read_register(reg);
-  self->target()->write<u16, bits::host_is_le>(op_addr, src, self->op_data());
+  self->write_memory<Mem, u16, bits::host_is_le>(op_addr, src);
 }
 
-void handle_stbr(PepISA3CPU *self, Op op, u16 op_addr) {
+template <typename Mem> void handle_stbr(PepISA3CPU *self, Op op, u16 op_addr) {
   const isa::Pep10::Register reg = static_cast<isa::Pep10::Register>(op.target);
   const u8 src = self->read_register(reg);
-  self->target()->write<u8>(op_addr, src, self->op_data());
+  self->write_memory<Mem, u8>(op_addr, src);
 }
+
+#define INSTANTIATE_HANDLERS(Mem)                                                                                      \
+  template u16 decode_op_addr<Mem>(PepISA3CPU *, isa::SharedAddrMode);                                                 \
+  template void handle_ret<Mem>(PepISA3CPU *);                                                                         \
+  template void handle_sret<Mem>(PepISA3CPU *);                                                                        \
+  template void handle_branch<Mem>(PepISA3CPU *, Op, BranchCondition, u16);                                            \
+  template void handle_unconditional_branch<Mem>(PepISA3CPU *, Op, u16);                                               \
+  template void handle_call<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_addsp<Mem>(PepISA3CPU *, Op, u16);                                                              \
+  template void handle_subsp<Mem>(PepISA3CPU *, Op, u16);                                                              \
+  template void handle_addr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_subr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_bitopr<Mem>(PepISA3CPU *, Op, Bitop, u16);                                                      \
+  template void handle_cpwr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_cpbr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_ldwr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_ldbr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_stwr<Mem>(PepISA3CPU *, Op, u16);                                                               \
+  template void handle_stbr<Mem>(PepISA3CPU *, Op, u16);
+INSTANTIATE_HANDLERS(Target)
+INSTANTIATE_HANDLERS(Dense)
+#undef INSTANTIATE_HANDLERS
@@ -7,17 +7,19 @@ class PepISA3CPU;
 
 using Op = isa::SharedOp;
 
+// Handlers which touch memory are templated on how they reach it; see PepISA3CPU::memory(). Both instantiations, Target
+// and Dense, are provided by the .cpp.
 
 // Read word at Mem[PC] and store to OS, incrementing PC by 2.
 // Return the /address/ of the operand value, which is usable for both load and store instructions.
 // For store-type operands, this is the address you write to. For load-type operands, you will need to read from this
 // address to get the actual operand specifier.
-u16 decode_op_addr(PepISA3CPU *self, isa::SharedAddrMode addr);
+template <typename Mem> u16 decode_op_addr(PepISA3CPU *self, isa::SharedAddrMode addr);
 
 void unimpl_handler(PepISA3CPU *);
 
-void handle_ret(PepISA3CPU *self);
-void handle_sret(PepISA3CPU *self);
+template <typename Mem> void handle_ret(PepISA3CPU *self);
+template <typename Mem> void handle_sret(PepISA3CPU *self);
 void handle_movflga(PepISA3CPU *self);
 void handle_movaflg(PepISA3CPU *self);
 void handle_movspa(PepISA3CPU *self);
@@ -33,15 +35,15 @@ void handle_rorr(PepISA3CPU *self, isa::Pep10::Register reg);
 
 enum class BranchCondition { UNCONDITIONAL, LE, LT, EQ, NE, GE, GT, V, C };
 
-void handle_branch(PepISA3CPU *self, Op op, BranchCondition cond, u16 op_addr);
+template <typename Mem> void handle_branch(PepISA3CPU *self, Op op, BranchCondition cond, u16 op_addr);
 // Specialization of handle_branch() which executes more efficiently.
-void handle_unconditional_branch(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_call(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_unconditional_branch(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_call(PepISA3CPU *self, Op op, u16 op_addr);
 
-void handle_addsp(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_subsp(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_addr(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_subr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_addsp(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_subsp(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_addr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_subr(PepISA3CPU *self, Op op, u16 op_addr);
 
 enum class Bitop {
   AND,
@@ -49,11 +51,11 @@ enum class Bitop {
   XOR,
 };
 
-void handle_bitopr(PepISA3CPU *self, Op op, Bitop bitop, u16 op_addr);
-void handle_cpwr(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_cpbr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_bitopr(PepISA3CPU *self, Op op, Bitop bitop, u16 op_addr);
+template <typename Mem> void handle_cpwr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_cpbr(PepISA3CPU *self, Op op, u16 op_addr);
 
-void handle_ldwr(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_ldbr(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_stwr(PepISA3CPU *self, Op op, u16 op_addr);
-void handle_stbr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_ldwr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_ldbr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_stwr(PepISA3CPU *self, Op op, u16 op_addr);
+template <typename Mem> void handle_stbr(PepISA3CPU *self, Op op, u16 op_addr);
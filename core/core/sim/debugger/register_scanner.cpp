@@ -100,6 +100,15 @@ std::size_t RegisterScan::reset(std::initializer_list<Register::Kind> kinds) {
   return count;
 }
 
+std::vector<RegisterScan::Register::ID> RegisterScan::registers(std::initializer_list<Register::Kind> kinds) const {
+  std::vector<Register::ID> ret;
+  for (const auto &[id, reg] : _regs)
+    if (std::find(kinds.begin(), kinds.end(), reg->kind) != kinds.end()) ret.push_back(id);
+  // _regs is unordered, but IDs are handed out in exposure order.
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
 // Initialize the hash with the correct initial value for our FNV-a1 hash algorithm.
 RegisterScan::Selection::Selection(RegisterScan *scan) : _scan(scan), _hash(pepp::fnv_1a_basis()) {}
 RegisterScan::Selection::Selection() : Selection(nullptr) {}
@@ -127,6 +127,8 @@ public:
   void clear(const RegisterRef &n);
   // Reset every exposed register of the given kind. Host-unwritable registers are skipped.
   std::size_t reset(std::initializer_list<Register::Kind> kinds);
+  // Every exposed register of the given kinds, in the order they were exposed.
+  std::vector<Register::ID> registers(std::initializer_list<Register::Kind> kinds) const;
 
   class Sample;
   // A class which holds a list of registers to sample where order matters. Useful for pre-selecting performance
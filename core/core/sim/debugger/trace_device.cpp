@@ -11,11 +11,16 @@ BufferDevice::BufferDevice(Configuration cfg) : _config(std::move(cfg)) {
 }
 
 void BufferDevice::initialize(System *sys) {
+  _system = sys;
   _tb = std::make_unique<tvm::TraceBuffer>(sys->buffer_manager(), _config.ring_size);
+  _tb->set_hot_slots(_config.hot_slots);
+  _checkpoints =
+      std::make_unique<tvm::Checkpoints>(sys, *_tb, _config.checkpoint_interval, _config.checkpoint_budget);
 }
 
 void BufferDevice::reset() {
   if (_tb) _tb->clear();
+  if (_checkpoints) _checkpoints->clear();
 }
 
 tvm::TraceBuffer &BufferDevice::buffer() {
@@ -30,6 +35,24 @@ const tvm::TraceBuffer &BufferDevice::buffer() const {
   return *_tb;
 }
 
+tvm::Checkpoints &BufferDevice::checkpoints() {
+  if (!_checkpoints) [[unlikely]]
+    throw std::logic_error("trace::BufferDevice: checkpoints requested before initialize()");
+  return *_checkpoints;
+}
+
+const tvm::Checkpoints &BufferDevice::checkpoints() const {
+  if (!_checkpoints) [[unlikely]]
+    throw std::logic_error("trace::BufferDevice: checkpoints requested before initialize()");
+  return *_checkpoints;
+}
+
+std::size_t BufferDevice::seek(tvm::Cursor current, tvm::Cursor target) {
+  auto &cps = checkpoints();
+  if (!_blaster) _blaster = _system->make_trace_interpreter();
+  return cps.seek(*_blaster, current, target);
+}
+
 std::unique_ptr<DeviceSerializer> BufferDevice::serializer() const {
   // Should never be called because we set skip_serialize = true in the constructor.
   // Throw an error to force me to fix the bug otherwise.
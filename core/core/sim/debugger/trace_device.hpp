@@ -1,6 +1,8 @@
 #pragma once
 #include <memory>
 #include "core/sim/api/device.hpp"
+#include "core/sim/debugger/tvm_checkpoints.hpp"
+#include "core/sim/debugger/tvm_interpreter.hpp"
 #include "core/sim/debugger/tvm_tracebuffer.hpp"
 
 namespace trace {
@@ -19,6 +21,12 @@ public:
   struct Configuration : public Device::Configuration {
     // Upper bound on retained history: the ring holds this many slots, each up to ~16k programs.
     size_t ring_size = 4;
+    // Snapshot the machine at the start of every Nth ring slot, so seek() replays at most N slots. 0 disables.
+    size_t checkpoint_interval = 1;
+    // Bytes of memory pages the checkpoints may hold before the oldest are dropped.
+    size_t checkpoint_budget = 16u << 20;
+    // Keep only this many of the newest slots uncompressed, so the same buffers hold a longer history. 0 disables.
+    size_t hot_slots = 0;
   };
 
   explicit BufferDevice(Configuration cfg);
@@ -33,6 +41,13 @@ public:
   // Release every slot before up_to.slot. Any Buffer::Location handed out for those slots dies here.
   void acknowledge(tvm::Cursor up_to) { buffer().acknowledge(up_to); }
 
+  // --- Seeking ---
+  tvm::Checkpoints &checkpoints();
+  const tvm::Checkpoints &checkpoints() const;
+  // Move the machine from `current` to `target` by restoring the nearest checkpoint and replaying from there. Returns
+  // the number of programs replayed.
+  std::size_t seek(tvm::Cursor current, tvm::Cursor target);
+
   // --- Which devices are recorded ---
   // Asked of the device whose bytes change, not of the initiator: if the memory being written is traced, the
   // transaction is worth keeping, and the initiator only decides which recording it lands in.
@@ -56,6 +71,10 @@ private:
   Configuration _config;
   // Null until initialize() runs.
   std::unique_ptr<tvm::TraceBuffer> _tb;
+  std::unique_ptr<tvm::Checkpoints> _checkpoints;
+  // Built on first seek() and reused, so its stencil table stays warm.
+  std::unique_ptr<tvm::Interpreter> _blaster;
+  System *_system = nullptr;
 };
 
 } // namespace trace
@@ -0,0 +1,190 @@
+#include "core/sim/debugger/tvm_checkpoints.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include "core/math/bitmanip/enums.hpp"
+#include "core/sim/debugger/tvm_interpreter.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+// Reads and writes that neither perturb device state nor re-enter the trace.
+const Operation rw_internal(Operation::Type::BufferInternal, Operation::Kind::data);
+
+std::size_t linear(tvm::Cursor c) { return c.slot * tvm::TraceBuffer::MAX_LOCATION_ENTRIES + c.entry; }
+bool before(const tvm::Checkpoints::Checkpoint &cp, tvm::Cursor at) { return cp.at < at; }
+} // namespace
+
+namespace tvm {
+
+Checkpoints::Checkpoints(System *system, TraceBuffer &tb, std::size_t interval, std::size_t budget)
+    : _system(system), _tb(tb), _interval(interval), _budget(budget), _generation(tb.stencil_generation()) {
+  _tb.on_slot_begin([this](Cursor at) { on_slot_begin(at); });
+}
+
+void Checkpoints::set_budget(std::size_t bytes) {
+  _budget = bytes;
+  while (_bytes > _budget && _checkpoints.size() > 1) evict_front();
+}
+
+const Checkpoints::Checkpoint *Checkpoints::capture(Cursor at) {
+  if (_generation != _tb.stencil_generation()) clear();
+  auto *scan = _system->register_scan();
+  if (!_selected) {
+    using namespace bits;
+    using Kind = RegisterScan::Register::Kind;
+    _registers = RegisterScan::Selection(scan);
+    for (auto id : scan->registers({Kind::State})) {
+      const auto [reg, _] = scan->resolve(RegisterScan::RegisterRef{id, RegisterScan::Register::Field::ID{0}});
+      // A register the trace does not restore would not be restored by replaying either, and one the host cannot
+      // write could not be restored at all.
+      if (!reg->restore_on_step_back) continue;
+      else if (!any(reg->host_access & RegisterScan::Access::Write)) continue;
+      _registers.add(id);
+    }
+    _selected = true;
+  }
+
+  Checkpoint cp{.at = at, .registers = _registers.sample(), .memory = {}};
+  // Pages that have not changed since the most recent checkpoint before this one are shared with it.
+  auto after = std::lower_bound(_checkpoints.begin(), _checkpoints.end(), at, before);
+  const Checkpoint *previous = after == _checkpoints.begin() ? nullptr : &*std::prev(after);
+
+  for (auto dev : *_system->root()) {
+    if (!_tb.traced(dev->id())) continue;
+    auto *target = dev->capability<Target>();
+    if (target == nullptr) continue;
+    const auto span = target->span();
+    const std::size_t size = size_inclusive(span);
+    // Not even one copy of this target would fit, so there is no point reading it.
+    if (size > _budget) continue;
+
+    Image image{.device = dev->id(), .base = span.lower(), .pages = {}};
+    const Image *old = nullptr;
+    if (previous != nullptr)
+      for (const auto &it : previous->memory)
+        if (it.device == image.device && it.base == image.base) old = &it;
+
+    Page page;
+    for (std::size_t offset = 0, index = 0; offset < size; offset += PAGE_SIZE, ++index) {
+      page.fill(0);
+      const auto len = std::min<std::size_t>(PAGE_SIZE, size - offset);
+      std::shared_ptr<const Page> shared;
+      try {
+        target->read(span.lower() + offset, bits::span<u8>{page.data(), len}, rw_internal);
+      } catch (const std::runtime_error &) {
+        // Unmapped, for instance. Leave it null and restore() will leave it alone.
+        image.pages.emplace_back(nullptr);
+        continue;
+      }
+      if (old != nullptr && index < old->pages.size() && old->pages[index] && *old->pages[index] == page)
+        shared = old->pages[index];
+      else shared = std::make_shared<const Page>(page), _bytes += PAGE_SIZE;
+      image.pages.emplace_back(std::move(shared));
+    }
+    cp.memory.emplace_back(std::move(image));
+  }
+
+  if (after != _checkpoints.end() && after->at == at) {
+    *after = std::move(cp);
+    // The pages only the replaced checkpoint held were just freed. Which ones those were is no longer knowable.
+    recount();
+  } else _checkpoints.insert(after, std::move(cp));
+  while (_bytes > _budget && _checkpoints.size() > 1) evict_front();
+  return find(at);
+}
+
+void Checkpoints::restore(const Checkpoint &cp) {
+  auto *scan = _system->register_scan();
+  const auto registers = _registers.registers();
+  const auto values = cp.registers.values();
+  for (std::size_t it = 0; it < registers.size() && it < values.size(); ++it)
+    scan->write<u64>(RegisterScan::RegisterRef{registers[it], RegisterScan::Register::Field::ID{0}}, values[it],
+                     RegisterScan::Level::Host);
+
+  Page current;
+  for (const auto &image : cp.memory) {
+    auto *dev = _system->find_by_id(image.device);
+    auto *target = dev ? dev->capability<Target>() : nullptr;
+    if (target == nullptr) continue;
+    const std::size_t size = size_inclusive(target->span());
+    for (std::size_t index = 0; index < image.pages.size(); ++index) {
+      const auto &page = image.pages[index];
+      const std::size_t offset = index * PAGE_SIZE;
+      if (!page || offset >= size) continue;
+      const auto len = std::min<std::size_t>(PAGE_SIZE, size - offset);
+      // Most pages are untouched between a checkpoint and wherever the machine is now.
+      target->read(image.base + offset, bits::span<u8>{current.data(), len}, rw_internal);
+      if (std::equal(current.begin(), current.begin() + len, page->begin())) continue;
+      target->write(image.base + offset, bits::span<const u8>{page->data(), len}, rw_internal);
+    }
+  }
+}
+
+const Checkpoints::Checkpoint *Checkpoints::find(Cursor at) const {
+  auto it = std::lower_bound(_checkpoints.begin(), _checkpoints.end(), at, before);
+  return it != _checkpoints.end() && it->at == at ? &*it : nullptr;
+}
+
+const Checkpoints::Checkpoint *Checkpoints::nearest(Cursor target) {
+  if (_generation != _tb.stencil_generation()) clear();
+  // The programs between these and the ring are gone, so there is no replaying from them to anywhere.
+  const auto oldest = _tb.oldest_cursor();
+  while (!_checkpoints.empty() && _checkpoints.front().at < oldest) evict_front();
+  if (_checkpoints.empty()) return nullptr;
+  auto after = std::lower_bound(_checkpoints.begin(), _checkpoints.end(), target, before);
+  if (after == _checkpoints.end()) return &_checkpoints.back();
+  else if (after == _checkpoints.begin()) return &*after;
+  auto prev = std::prev(after);
+  return distance(prev->at, target) <= distance(after->at, target) ? &*prev : &*after;
+}
+
+std::size_t Checkpoints::seek(Interpreter &blaster, Cursor current, Cursor target) {
+  Cursor from = current;
+  if (auto cp = nearest(target); cp && distance(cp->at, target) < distance(current, target)) {
+    restore(*cp);
+    from = cp->at;
+  }
+  if (from == target) return 0;
+  // Replaying must not record into the trace it is replaying.
+  auto &backend = blaster.backend();
+  const auto mode = backend.access_mode();
+  backend.set_access_mode(AccessMode::ReplaceWithInternal);
+  std::size_t count = 0;
+  if (from < target) count = blaster.replay(_tb, from, target, Direction::Forward);
+  else count = blaster.replay(_tb, target, from, Direction::Backward);
+  backend.set_access_mode(mode);
+  return count;
+}
+
+void Checkpoints::clear() {
+  _checkpoints.clear();
+  _bytes = 0;
+  _generation = _tb.stencil_generation();
+}
+
+std::size_t Checkpoints::distance(Cursor lhs, Cursor rhs) {
+  const auto l = linear(lhs), r = linear(rhs);
+  return l < r ? r - l : l - r;
+}
+
+void Checkpoints::on_slot_begin(Cursor at) {
+  if (_interval != 0 && at.slot % _interval == 0) capture(at);
+}
+
+void Checkpoints::evict_front() {
+  for (const auto &image : _checkpoints.front().memory)
+    for (const auto &page : image.pages)
+      if (page && page.use_count() == 1) _bytes -= PAGE_SIZE;
+  _checkpoints.pop_front();
+}
+
+void Checkpoints::recount() {
+  std::unordered_set<const Page *> pages;
+  for (const auto &cp : _checkpoints)
+    for (const auto &image : cp.memory)
+      for (const auto &page : image.pages)
+        if (page) pages.insert(page.get());
+  _bytes = pages.size() * PAGE_SIZE;
+}
+
+} // namespace tvm
@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "core/sim/api/device.hpp"
+#include "core/sim/api/memory.hpp"
+#include "core/sim/debugger/register_scanner.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+
+// The system class from core/sim/system.hpp
+class System;
+
+namespace tvm {
+class Interpreter;
+
+// Periodic full-state snapshots of a traced machine, so that seeking in a long trace does not have to walk every
+// recording between here and there.
+//
+// A trace only stores deltas, so reaching an arbitrary cursor means replaying every program between the machine's
+// current position and that cursor. A checkpoint pins the machine's state at a ring slot boundary -- every register
+// RegisterScan can restore plus the contents of every traced Target -- so seek() can restore whichever checkpoint is
+// closest to the target and replay at most an interval's worth of slots from there. Finding that checkpoint is
+// a binary search, so the cost of a seek no longer grows with the length of the trace.
+//
+// Memory is held in fixed-size pages that are shared with the previous checkpoint whenever their contents did not
+// change, so only dirty pages cost anything. When the pages held exceed the budget, the oldest checkpoints are
+// dropped first; the newest is always kept.
+//
+// Only state the trace can restore is captured. A device that keeps state outside of its Target and its registers
+// (e.g., the contents of an input FIFO) is not rewound by a checkpoint any more than it would be by replaying.
+class Checkpoints {
+public:
+  static constexpr Address PAGE_SIZE = 1024;
+  using Page = std::array<u8, PAGE_SIZE>;
+  // The contents of one traced Target.
+  struct Image {
+    Device::ID device{};
+    Address base = 0;
+    // The last page may extend past the end of the Target. Null for a page that could not be read.
+    std::vector<std::shared_ptr<const Page>> pages;
+  };
+  struct Checkpoint {
+    // The machine is in this state immediately before the program at `at` executes.
+    Cursor at{};
+    RegisterScan::Sample registers;
+    std::vector<Image> memory;
+  };
+
+  // A checkpoint is taken at the start of every `interval`th ring slot. 0 disables automatic checkpoints.
+  Checkpoints(System *system, TraceBuffer &tb, std::size_t interval = 1, std::size_t budget = 16u << 20);
+  Checkpoints(const Checkpoints &) = delete;
+  Checkpoints &operator=(const Checkpoints &) = delete;
+
+  void set_interval(std::size_t slots) { _interval = slots; }
+  std::size_t interval() const { return _interval; }
+  // Upper bound, in bytes, on page storage. Lowering it evicts immediately.
+  void set_budget(std::size_t bytes);
+  std::size_t budget() const { return _budget; }
+
+  // Snapshot the machine, which the caller promises is at `at`. Replaces any checkpoint already at `at`. Returns
+  // nullptr if the budget could not hold it alongside the newer checkpoints.
+  const Checkpoint *capture(Cursor at);
+  // Write a checkpoint's registers and pages back into the machine. Pages that already match are not written.
+  void restore(const Checkpoint &cp);
+
+  // The checkpoint at exactly `at`, if one is retained.
+  const Checkpoint *find(Cursor at) const;
+  // The retained checkpoint closest to `target`, in programs, or nullptr if there are none. Checkpoints older than
+  // the trace buffer's oldest entry are discarded first, since the programs between them and the ring are gone.
+  const Checkpoint *nearest(Cursor target);
+  // Move the machine from `current` to `target` with `blaster`, which must be driving this trace buffer's system.
+  // Starts from the nearest checkpoint when that is closer to `target` than `current` is. Returns the number of
+  // programs replayed.
+  std::size_t seek(Interpreter &blaster, Cursor current, Cursor target);
+
+  void clear();
+  std::size_t size() const { return _checkpoints.size(); }
+  // Bytes of page storage held across all checkpoints. Pages shared between checkpoints count once.
+  std::size_t bytes() const { return _bytes; }
+  const Checkpoint &operator[](std::size_t index) const { return _checkpoints[index]; }
+
+  // The number of programs between two cursors. Every slot but the newest holds exactly MAX_LOCATION_ENTRIES.
+  static std::size_t distance(Cursor lhs, Cursor rhs);
+
+private:
+  // Called at the start of every slot; captures on multiples of the interval.
+  void on_slot_begin(Cursor at);
+  // Drop the oldest checkpoint, returning its unshared pages to the budget.
+  void evict_front();
+  // Recompute bytes() from scratch.
+  void recount();
+
+  System *_system = nullptr;
+  TraceBuffer &_tb;
+  std::size_t _interval = 1, _budget = 0, _bytes = 0;
+  // TraceBuffer::clear() invalidates every cursor, and with it every checkpoint.
+  std::size_t _generation = 0;
+  // Built on first capture, because devices expose their registers during initialize().
+  RegisterScan::Selection _registers;
+  bool _selected = false;
+  // Sorted by cursor.
+  std::deque<Checkpoint> _checkpoints;
+};
+
+} // namespace tvm
@@ -6,7 +6,33 @@ namespace tvm {
 Decoder::Decoder(std::shared_ptr<pepp::bts::BufferManager> mgr, MachineState &state)
     : _mgr(std::move(mgr)), _state(state) {}
 
-void Decoder::decode() {
+void Decoder::fetch(pepp::bts::Buffer::ID ibp, u16 ip, Packet &p) const {
+  p.ibp = ibp, p.ip = ip;
+  p.IS = {};
+  p.valid = 0;
+  // Whenever a packet needs an a refernece relative to the IP's offset into the current buffer,
+  // refer to this variable that than IP. This lets us pre-increment IP and avoid difficulties with branching / early
+  // returns.
+  p.iop = 2 + ip;
+  // An unreadable opcode cracks as a zero word, and begin() hard-stops on it. Fetching must not touch the machine
+  // state, since packets are also fetched ahead of time for the stencil table.
+  auto buf = _mgr->find(ibp);
+  const auto whole = buf ? buf->span() : bits::span<const u8>{};
+  p.readable = (size_t)ip + 2 <= whole.size();
+  if (p.readable) p.IS = tvm::OpWord((u16)(((u16)whole[ip]) | (u16)whole[ip + 1] << 8));
+  // Mask out low-order bit, because opcodes are naturally aligned.
+  p.next_ip = (ip + 2 + p.IS.word_len * 2) & 0xFFFE;
+  // Fetch every operand word any decode_* could ask for. A word past the end of the buffer is only an error if it is
+  // actually read, which word() reports.
+  for (u8 it = 0; it < std::min<u8>(p.IS.word_len, Packet::MAX_WORDS); ++it) {
+    const u16 offset = p.iop + 2 * it;
+    if ((size_t)offset + 2 > whole.size()) continue;
+    p.words[it] = ((u16)whole[offset]) | (u16)whole[offset + 1] << 8;
+    p.valid |= 1 << it;
+  }
+}
+
+void Decoder::begin(const Packet &p) {
   auto &regs = _state.regs;
   // Honour the previous instruction's MODCLR bit. This is a decode-stage concern -- CLRMOD means "clear MOD1/MOD2 at
   // the start of the next instruction", and this is that start -- and keeping it here means Decoder+Backend is a
@@ -17,28 +43,29 @@ void Decoder::decode() {
     regs.MOD2 = {};
     _state.csrs.M1 = 0, _state.csrs.M2 = 0;
   }
-  const auto ibp = (pepp::bts::Buffer::ID)regs.IP.hi;
-  // read 16 bits at ip.lo from data and increment.
-  u16 opcode = read(ibp, regs.IP.lo);
-  // Perform bit-cracking to expose fields
-  regs.IS = tvm::OpWord(opcode);
+  if (!p.readable) _state.hard_stop(StopCause::InvalidIBuffer);
+  regs.IS = p.IS;
   _state.csrs.CLRMOD = regs.IS.clrmod;
-  // Whenever a packet needs an a refernece relative to the IP's offset into the current buffer,
-  // refer to this variable that than IP. This lets us pre-increment IP and avoid difficulties with branching / early
-  // returns.
-  const auto iop = 2 + regs.IP.lo;
+  regs.IP.lo = p.next_ip;
+}
 
-  // Mask out low-order bit, because opcodes are naturally aligned.
-  regs.IP.lo = (regs.IP.lo + 2 + regs.IS.word_len * 2) & 0xFFFE;
-  switch (static_cast<Opcode>(regs.IS.ocpode)) {
-  case Opcode::HALT: _decoded = decode_halt(ibp, iop); break;
-  case Opcode::RET: _decoded = decode_ret(ibp, iop); break;
-  case Opcode::CALL: _decoded = decode_call(ibp, iop); break;
-  case Opcode::INVCALL: _decoded = decode_invcall(ibp, iop); break;
-  case Opcode::INVRET: _decoded = decode_invret(ibp, iop); break;
-  case Opcode::ASYN: _decoded = decode_asyn(ibp, iop); break;
-  case Opcode::ISYN: _decoded = decode_isyn(ibp, iop); break;
-  case Opcode::LMR: _decoded = decode_lmr(ibp, iop); break;
+void Decoder::decode() {
+  Packet p;
+  fetch((pepp::bts::Buffer::ID)_state.regs.IP.hi, _state.regs.IP.lo, p);
+  decode(p);
+}
+
+void Decoder::decode(const Packet &p) {
+  begin(p);
+  switch (static_cast<Opcode>(p.IS.ocpode)) {
+  case Opcode::HALT: _decoded = decode_halt(p); break;
+  case Opcode::RET: _decoded = decode_ret(p); break;
+  case Opcode::CALL: _decoded = decode_call(p); break;
+  case Opcode::INVCALL: _decoded = decode_invcall(p); break;
+  case Opcode::INVRET: _decoded = decode_invret(p); break;
+  case Opcode::ASYN: _decoded = decode_asyn(p); break;
+  case Opcode::ISYN: _decoded = decode_isyn(p); break;
+  case Opcode::LMR: _decoded = decode_lmr(p); break;
   case Opcode::BRF: [[fallthrough]];
   case Opcode::NOP: [[fallthrough]];
   case Opcode::BREQ: [[fallthrough]];
@@ -47,55 +74,55 @@ void Decoder::decode() {
   case Opcode::BRLT: [[fallthrough]];
   case Opcode::BRLE: [[fallthrough]];
   case Opcode::BRNE: [[fallthrough]];
-  case Opcode::BR: _decoded = decode_br(ibp, iop); break;
+  case Opcode::BR: _decoded = decode_br(p); break;
   case Opcode::SETMEM: [[fallthrough]]; // Difference between SETMEM/X is in execution, not decoding
-  case Opcode::SETMEMX: _decoded = decode_setmem(ibp, iop); break;
-  case Opcode::SETMEMDX: _decoded = decode_setmemdx(ibp, iop); break;
-  case Opcode::STEPMEM: _decoded = decode_stepmem(ibp, iop); break;
-  case Opcode::CMPMEM: _decoded = decode_cmpmem(ibp, iop); break;
-  case Opcode::CLRMEM: _decoded = decode_clrmem(ibp, iop); break;
+  case Opcode::SETMEMX: _decoded = decode_setmem(p); break;
+  case Opcode::SETMEMDX: _decoded = decode_setmemdx(p); break;
+  case Opcode::STEPMEM: _decoded = decode_stepmem(p); break;
+  case Opcode::CMPMEM: _decoded = decode_cmpmem(p); break;
+  case Opcode::CLRMEM: _decoded = decode_clrmem(p); break;
   case Opcode::SETREG: [[fallthrough]]; // All three register ops share a packet layout; only the Delta differs.
   case Opcode::SETREGX: [[fallthrough]];
-  case Opcode::STEPREG: _decoded = decode_deltareg(ibp, iop); break;
-  case Opcode::CMPREG: _decoded = decode_cmpreg(ibp, iop); break;
-  case Opcode::CLRREG: _decoded = decode_clrreg(ibp, iop); break;
-  case Opcode::TRADDR: _decoded = decode_traddr(ibp, iop); break;
-  case Opcode::LDP: _decoded = decode_ldp(ibp, iop); break;
-  case Opcode::ACCDP: _decoded = decode_accdp(ibp, iop); break;
-  case Opcode::INCDP: _decoded = decode_incdp(ibp, iop); break;
-  case Opcode::MMIO: _decoded = decode_mmio(ibp, iop); break;
+  case Opcode::STEPREG: _decoded = decode_deltareg(p); break;
+  case Opcode::CMPREG: _decoded = decode_cmpreg(p); break;
+  case Opcode::CLRREG: _decoded = decode_clrreg(p); break;
+  case Opcode::TRADDR: _decoded = decode_traddr(p); break;
+  case Opcode::LDP: _decoded = decode_ldp(p); break;
+  case Opcode::ACCDP: _decoded = decode_accdp(p); break;
+  case Opcode::INCDP: _decoded = decode_incdp(p); break;
+  case Opcode::MMIO: _decoded = decode_mmio(p); break;
   default: _state.hard_stop(StopCause::IllegalOpcode); break; // Treat unrecognized upcodes as hard failures.
   }
 }
 
-tvm::DecodedOp::Halt Decoder::decode_halt(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::Halt Decoder::decode_halt(const Packet &p) {
   tvm::DecodedOp::Halt ret;
   switch (_state.regs.IS.word_len) {
   default: [[fallthrough]];
-  case 1: ret.cause = (tvm::StopCause)read(ibp, iop + 0); break;
+  case 1: ret.cause = (tvm::StopCause)word(p, 0); break;
   case 0: ret.cause = tvm::StopCause::None; break;
   }
   return ret;
 }
 
-tvm::DecodedOp::Ret Decoder::decode_ret(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::Ret Decoder::decode_ret(const Packet &p) {
   // No-op for decoding, since all data is passed on stack.
   return {};
 }
 
-tvm::DecodedOp::Call Decoder::decode_call(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::Call Decoder::decode_call(const Packet &p) {
   tvm::DecodedOp::Call ret;
-  ret.next_ip.hi = _state.regs.IP.hi, ret.next_ip.lo = iop + 0;
+  ret.next_ip.hi = _state.regs.IP.hi, ret.next_ip.lo = p.iop + 0;
   switch (_state.regs.IS.word_len) {
   default: [[fallthrough]];
-  case 2: ret.next_ip.hi = read(ibp, iop + 2); [[fallthrough]];
-  case 1: ret.next_ip.lo = read(ibp, iop + 0);
+  case 2: ret.next_ip.hi = word(p, 1); [[fallthrough]];
+  case 1: ret.next_ip.lo = word(p, 0);
   case 0: break;
   }
   return ret;
 }
 
-tvm::DecodedOp::InvCall Decoder::decode_invcall(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::InvCall Decoder::decode_invcall(const Packet &p) {
   tvm::DecodedOp::InvCall ret;
   // IP.lo has already been advanced past this packet, so IP is the fall-through address. Any target word the packet
   // omits defaults to it: a missing hi word keeps IP.hi, and a wholly missing target calls the next instruction.
@@ -103,10 +130,10 @@ tvm::DecodedOp::InvCall Decoder::decode_invcall(pepp::bts::Buffer::ID ibp, u16 i
   // Targets interleave lo-first, so a near call (both targets in this buffer) costs 2 words instead of 4.
   switch (_state.regs.IS.word_len) {
   default: [[fallthrough]];
-  case 4: ret.on_backward.hi = read(ibp, iop + 6); [[fallthrough]];
-  case 3: ret.on_forward.hi = read(ibp, iop + 4); [[fallthrough]];
-  case 2: ret.on_backward.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: ret.on_forward.lo = read(ibp, iop + 0); [[fallthrough]];
+  case 4: ret.on_backward.hi = word(p, 3); [[fallthrough]];
+  case 3: ret.on_forward.hi = word(p, 2); [[fallthrough]];
+  case 2: ret.on_backward.lo = word(p, 1); [[fallthrough]];
+  case 1: ret.on_forward.lo = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   // Mirror resolved targets into modifier registers if appropriate.
@@ -115,12 +142,12 @@ tvm::DecodedOp::InvCall Decoder::decode_invcall(pepp::bts::Buffer::ID ibp, u16 i
   return ret;
 }
 
-tvm::DecodedOp::InvRet Decoder::decode_invret(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::InvRet Decoder::decode_invret(const Packet &p) {
   // No-op for decoding; the direction bookkeeping is entirely an execute-stage concern.
   return {};
 }
 
-u64 Decoder::decode_syn_data(pepp::bts::Buffer::ID ibp, u16 iop, u8 &size) {
+u64 Decoder::decode_syn_data(const Packet &p, u8 &size) {
   auto &regs = _state.regs;
   // Unless a size word is provided, data is DP relative rather than immediate.
   tvm::SegmentPair data = regs.DP;
@@ -131,9 +158,9 @@ u64 Decoder::decode_syn_data(pepp::bts::Buffer::ID ibp, u16 iop, u8 &size) {
     // If MOD1/MOD2 are set, then read from them rather than the data registers.
     // This allows "immediate" versions to avoid clobbering DP regs.
     // Silently truncate to 8 bytes, since our timestamps are at most u64s.
-    regs.MOD1.lo = std::min<u16>(read(ibp, iop + 0), sizeof(u64));
+    regs.MOD1.lo = std::min<u16>(word(p, 0), sizeof(u64));
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 2;
+    regs.MOD2.lo = p.iop + 2;
     _state.csrs.M1 = _state.csrs.M2 = 1;
     data = regs.MOD2;
     size = regs.MOD1.lo;
@@ -152,18 +179,18 @@ u64 Decoder::decode_syn_data(pepp::bts::Buffer::ID ibp, u16 iop, u8 &size) {
   return value;
 }
 
-tvm::DecodedOp::ASyn Decoder::decode_asyn(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::ASyn Decoder::decode_asyn(const Packet &p) {
   tvm::DecodedOp::ASyn ret;
   u8 width = 0;
   // Absolute timestamps are unsigned, so a narrow encoding is just the low-order bytes of a bigger number.
-  ret.timestamp = decode_syn_data(ibp, iop, width);
+  ret.timestamp = decode_syn_data(p, width);
   return ret;
 }
 
-tvm::DecodedOp::ISyn Decoder::decode_isyn(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::ISyn Decoder::decode_isyn(const Packet &p) {
   tvm::DecodedOp::ISyn ret;
   u8 width = 0;
-  u64 raw = decode_syn_data(ibp, iop, width);
+  u64 raw = decode_syn_data(p, width);
   // Need to sign-extend the value if it is narrows than 8 bytes.
   if (width > 0 && width < sizeof(u64)) {
     const u64 bits = 8 * (u64)width;
@@ -177,23 +204,23 @@ tvm::DecodedOp::ISyn Decoder::decode_isyn(pepp::bts::Buffer::ID ibp, u16 iop) {
   return ret;
 }
 
-tvm::DecodedOp::LMR Decoder::decode_lmr(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::LMR Decoder::decode_lmr(const Packet &p) {
   tvm::DecodedOp::LMR ret;
   if (_state.regs.IS.word_len == 0) return ret;
-  ret.mask = (tvm::RegMask)read(ibp, iop + 0);
+  ret.mask = (tvm::RegMask)word(p, 0);
   auto count = _state.regs.IS.word_len - 1;
-  auto buf = _mgr->find(ibp);
+  auto buf = _mgr->find(p.ibp);
   if (buf == nullptr) return _state.hard_stop(StopCause::InvalidIBuffer), ret;
   // Rather than read incrementally, form a span.
   // Bounds check before forming the span to avoid a buffer overflow/UB.
   const auto whole = buf->span();
-  const std::size_t first = (std::size_t)iop + 2, bytes = (std::size_t)count * 2;
+  const std::size_t first = (std::size_t)p.iop + 2, bytes = (std::size_t)count * 2;
   if (first + bytes > whole.size()) return _state.hard_stop(StopCause::InvalidIBuffer), ret;
   ret.data = whole.subspan(first, bytes);
   return ret;
 }
 
-tvm::DecodedOp::BR Decoder::decode_br(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::BR Decoder::decode_br(const Packet &p) {
   tvm::DecodedOp::BR ret;
   auto &regs = _state.regs;
   // Select condition code base on the original opcode.
@@ -204,13 +231,13 @@ tvm::DecodedOp::BR Decoder::decode_br(pepp::bts::Buffer::ID ibp, u16 iop) {
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
   case 2:
-    ret.displacement.hi = read(ibp, iop + 2);
-    ret.displacement.lo = read(ibp, iop + 0);
+    ret.displacement.hi = word(p, 1);
+    ret.displacement.lo = word(p, 0);
     regs.MOD2 = ret.displacement, _state.csrs.M2 = 1;
     break;
   case 1:
     ret.displacement.hi = regs.IP.hi;
-    ret.displacement.lo = read(ibp, iop + 0);
+    ret.displacement.lo = word(p, 0);
     regs.MOD2 = ret.displacement, _state.csrs.M2 = 1;
     break;
   case 0:
@@ -224,7 +251,7 @@ tvm::DecodedOp::BR Decoder::decode_br(pepp::bts::Buffer::ID ibp, u16 iop) {
   return ret;
 }
 
-tvm::DecodedOp::DeltaMem Decoder::decode_setmem(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DeltaMem Decoder::decode_setmem(const Packet &p) {
   tvm::DecodedOp::DeltaMem ret;
   auto &regs = _state.regs;
   ret.kind = (regs.IS.ocpode == (u8)tvm::Opcode::SETMEMX) ? tvm::Delta::Xor : tvm::Delta::Assign;
@@ -238,17 +265,17 @@ tvm::DecodedOp::DeltaMem Decoder::decode_setmem(pepp::bts::Buffer::ID ibp, u16 i
   case 5:
     // If MOD1/MOD2 are set, then read from them rather than the data registers.
     // This allows "immediate" versions to avoid clobbering DP regs.
-    regs.MOD1.lo = read(ibp, iop + 8);
+    regs.MOD1.lo = word(p, 4);
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 10;
+    regs.MOD2.lo = p.iop + 10;
     _state.csrs.M1 = _state.csrs.M2 = 1;
     ret.data = regs.MOD2;
     ret.size = regs.MOD1.lo;
     [[fallthrough]];
-  case 4: regs.OFF.lo = read(ibp, iop + 6); [[fallthrough]];
-  case 3: regs.OFF.hi = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ACCESS = read(ibp, iop + 0); [[fallthrough]];
+  case 4: regs.OFF.lo = word(p, 3); [[fallthrough]];
+  case 3: regs.OFF.hi = word(p, 2); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ACCESS = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.access = Operation(regs.ACCESS);
@@ -257,7 +284,7 @@ tvm::DecodedOp::DeltaMem Decoder::decode_setmem(pepp::bts::Buffer::ID ibp, u16 i
   return ret;
 }
 
-tvm::DecodedOp::DeltaMem Decoder::decode_setmemdx(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DeltaMem Decoder::decode_setmemdx(const Packet &p) {
   tvm::DecodedOp::DeltaMem ret;
   auto &regs = _state.regs;
   // No non-XOR form of this opcode exists; see Opcode::SETMEMDX.
@@ -267,8 +294,8 @@ tvm::DecodedOp::DeltaMem Decoder::decode_setmemdx(pepp::bts::Buffer::ID ibp, u16
 
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ACCESS = read(ibp, iop + 0); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ACCESS = word(p, 0); [[fallthrough]];
   case 0: break;
   }
 
@@ -291,7 +318,7 @@ tvm::DecodedOp::DeltaMem Decoder::decode_setmemdx(pepp::bts::Buffer::ID ibp, u16
   return ret;
 }
 
-tvm::DecodedOp::DeltaMem Decoder::decode_stepmem(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DeltaMem Decoder::decode_stepmem(const Packet &p) {
   tvm::DecodedOp::DeltaMem ret;
   auto &regs = _state.regs;
   ret.kind = tvm::Delta::Add;
@@ -305,21 +332,21 @@ tvm::DecodedOp::DeltaMem Decoder::decode_stepmem(pepp::bts::Buffer::ID ibp, u16
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
   case 6:
-    regs.MOD1.lo = read(ibp, iop + 10);
+    regs.MOD1.lo = word(p, 5);
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 12;
+    regs.MOD2.lo = p.iop + 12;
     _state.csrs.M2 = 1;
     ret.data = regs.MOD2;
     ret.size = regs.MOD1.lo;
     [[fallthrough]];
   case 5:
-    regs.MOD1.hi = read(ibp, iop + 8), _state.csrs.M1 = 1;
+    regs.MOD1.hi = word(p, 4), _state.csrs.M1 = 1;
     ret.order = decode_order(regs.MOD1.hi);
     [[fallthrough]];
-  case 4: regs.OFF.lo = read(ibp, iop + 6); [[fallthrough]];
-  case 3: regs.OFF.hi = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ACCESS = read(ibp, iop + 0); [[fallthrough]];
+  case 4: regs.OFF.lo = word(p, 3); [[fallthrough]];
+  case 3: regs.OFF.hi = word(p, 2); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ACCESS = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.access = Operation(regs.ACCESS);
@@ -329,7 +356,7 @@ tvm::DecodedOp::DeltaMem Decoder::decode_stepmem(pepp::bts::Buffer::ID ibp, u16
   return ret;
 }
 
-tvm::DecodedOp::CmpMem Decoder::decode_cmpmem(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::CmpMem Decoder::decode_cmpmem(const Packet &p) {
   tvm::DecodedOp::CmpMem ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 0; // Enter target mode.
@@ -342,16 +369,16 @@ tvm::DecodedOp::CmpMem Decoder::decode_cmpmem(pepp::bts::Buffer::ID ibp, u16 iop
   case 4:
     // If MOD1/MOD2 are set, then read from them rather than the data registers.
     // This allows "immediate" versions to avoid clobbering DP regs.
-    regs.MOD1.lo = read(ibp, iop + 6);
+    regs.MOD1.lo = word(p, 3);
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 8;
+    regs.MOD2.lo = p.iop + 8;
     _state.csrs.M1 = _state.csrs.M2 = 1;
     ret.data = regs.MOD2;
     ret.size = regs.MOD1.lo;
     [[fallthrough]];
-  case 3: regs.OFF.lo = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.OFF.hi = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ID.lo = read(ibp, iop + 0); [[fallthrough]];
+  case 3: regs.OFF.lo = word(p, 2); [[fallthrough]];
+  case 2: regs.OFF.hi = word(p, 1); [[fallthrough]];
+  case 1: regs.ID.lo = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.target = (Device::ID)regs.ID.lo;
@@ -359,7 +386,7 @@ tvm::DecodedOp::CmpMem Decoder::decode_cmpmem(pepp::bts::Buffer::ID ibp, u16 iop
   return ret;
 }
 
-tvm::DecodedOp::ClrMem Decoder::decode_clrmem(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::ClrMem Decoder::decode_clrmem(const Packet &p) {
   tvm::DecodedOp::ClrMem ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 0; // Enter target mode.
@@ -367,15 +394,15 @@ tvm::DecodedOp::ClrMem Decoder::decode_clrmem(pepp::bts::Buffer::ID ibp, u16 iop
 
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
-  case 2: ret.data = regs.MOD1.lo = read(ibp, iop + 2), _state.csrs.M1 = 1; [[fallthrough]];
-  case 1: regs.ID.lo = read(ibp, iop + 0); [[fallthrough]];
+  case 2: ret.data = regs.MOD1.lo = word(p, 1), _state.csrs.M1 = 1; [[fallthrough]];
+  case 1: regs.ID.lo = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.target = (Device::ID)regs.ID.lo;
   return ret;
 }
 
-tvm::DecodedOp::DeltaReg Decoder::decode_deltareg(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DeltaReg Decoder::decode_deltareg(const Packet &p) {
   tvm::DecodedOp::DeltaReg ret;
   auto &regs = _state.regs;
   switch ((tvm::Opcode)regs.IS.ocpode) {
@@ -393,16 +420,16 @@ tvm::DecodedOp::DeltaReg Decoder::decode_deltareg(pepp::bts::Buffer::ID ibp, u16
   case 4:
     // If MOD1/MOD2 are set, then read from them rather than the data registers.
     // This allows "immediate" versions to avoid clobbering DP regs.
-    regs.MOD1.lo = read(ibp, iop + 6);
+    regs.MOD1.lo = word(p, 3);
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 8;
+    regs.MOD2.lo = p.iop + 8;
     _state.csrs.M1 = _state.csrs.M2 = 1;
     ret.data = regs.MOD2;
     ret.size = regs.MOD1.lo;
     [[fallthrough]];
-  case 3: regs.ID.lo = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.ID.hi = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ACCESS = read(ibp, iop + 0); [[fallthrough]];
+  case 3: regs.ID.lo = word(p, 2); [[fallthrough]];
+  case 2: regs.ID.hi = word(p, 1); [[fallthrough]];
+  case 1: regs.ACCESS = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   // regs.ACCESS is still programmed above for whatever later instruction retains it; it just has no bearing on a
@@ -412,7 +439,7 @@ tvm::DecodedOp::DeltaReg Decoder::decode_deltareg(pepp::bts::Buffer::ID ibp, u16
   return ret;
 }
 
-tvm::DecodedOp::CmpReg Decoder::decode_cmpreg(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::CmpReg Decoder::decode_cmpreg(const Packet &p) {
   tvm::DecodedOp::CmpReg ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 1; // Enter register mode.
@@ -425,15 +452,15 @@ tvm::DecodedOp::CmpReg Decoder::decode_cmpreg(pepp::bts::Buffer::ID ibp, u16 iop
   case 3:
     // If MOD1/MOD2 are set, then read from them rather than the data registers.
     // This allows "immediate" versions to avoid clobbering DP regs.
-    regs.MOD1.lo = read(ibp, iop + 4);
+    regs.MOD1.lo = word(p, 2);
     regs.MOD2.hi = regs.IP.hi;
-    regs.MOD2.lo = iop + 6;
+    regs.MOD2.lo = p.iop + 6;
     _state.csrs.M1 = _state.csrs.M2 = 1;
     ret.data = regs.MOD2;
     ret.size = regs.MOD1.lo;
     [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ID.hi = read(ibp, iop + 0); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ID.hi = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.reg =
@@ -441,14 +468,14 @@ tvm::DecodedOp::CmpReg Decoder::decode_cmpreg(pepp::bts::Buffer::ID ibp, u16 iop
   return ret;
 }
 
-tvm::DecodedOp::ClrReg Decoder::decode_clrreg(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::ClrReg Decoder::decode_clrreg(const Packet &p) {
   tvm::DecodedOp::ClrReg ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 1; // Enter register mode.
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ID.hi = read(ibp, iop + 0); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ID.hi = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   ret.reg =
@@ -456,21 +483,21 @@ tvm::DecodedOp::ClrReg Decoder::decode_clrreg(pepp::bts::Buffer::ID ibp, u16 iop
   return ret;
 }
 
-tvm::DecodedOp::TRADDR Decoder::decode_traddr(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::TRADDR Decoder::decode_traddr(const Packet &p) {
   tvm::DecodedOp::TRADDR ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 0; // Enter target mode
 
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
-  case 8: regs.MOD1.hi = read(ibp, iop + 14); [[fallthrough]];
-  case 7: regs.MOD1.lo = read(ibp, iop + 12), _state.csrs.M1 = 1; [[fallthrough]];
-  case 6: regs.MOD2.lo = read(ibp, iop + 10); [[fallthrough]];
-  case 5: regs.MOD2.hi = read(ibp, iop + 8), _state.csrs.M2 = 1; [[fallthrough]];
-  case 4: regs.ID.hi = read(ibp, iop + 6); [[fallthrough]];
-  case 3: regs.OFF.lo = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.OFF.hi = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ID.lo = read(ibp, iop + 0); [[fallthrough]];
+  case 8: regs.MOD1.hi = word(p, 7); [[fallthrough]];
+  case 7: regs.MOD1.lo = word(p, 6), _state.csrs.M1 = 1; [[fallthrough]];
+  case 6: regs.MOD2.lo = word(p, 5); [[fallthrough]];
+  case 5: regs.MOD2.hi = word(p, 4), _state.csrs.M2 = 1; [[fallthrough]];
+  case 4: regs.ID.hi = word(p, 3); [[fallthrough]];
+  case 3: regs.OFF.lo = word(p, 2); [[fallthrough]];
+  case 2: regs.OFF.hi = word(p, 1); [[fallthrough]];
+  case 1: regs.ID.lo = word(p, 0); [[fallthrough]];
   case 0: break;
   }
 
@@ -482,44 +509,44 @@ tvm::DecodedOp::TRADDR Decoder::decode_traddr(pepp::bts::Buffer::ID ibp, u16 iop
   return ret;
 }
 
-tvm::DecodedOp::LDP Decoder::decode_ldp(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::LDP Decoder::decode_ldp(const Packet &p) {
   tvm::DecodedOp::LDP ret;
   auto &regs = _state.regs;
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
-  case 3: regs.DP.hi = read(ibp, iop + 4); [[fallthrough]];
-  case 2: regs.DS = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.DP.lo = read(ibp, iop + 0); [[fallthrough]];
+  case 3: regs.DP.hi = word(p, 2); [[fallthrough]];
+  case 2: regs.DS = word(p, 1); [[fallthrough]];
+  case 1: regs.DP.lo = word(p, 0); [[fallthrough]];
   case 0: break;
   }
   return ret;
 }
 
-tvm::DecodedOp::DPIncr Decoder::decode_accdp(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DPIncr Decoder::decode_accdp(const Packet &p) {
   tvm::DecodedOp::DPIncr ret;
   ret.DS = ret.dp_incr = _state.regs.DS;
   switch (_state.regs.IS.word_len) {
   default: [[fallthrough]];
-  case 1: ret.DS = read(ibp, iop + 0);
+  case 1: ret.DS = word(p, 0);
   case 0: break;
   }
   return ret;
 }
 
-tvm::DecodedOp::DPIncr Decoder::decode_incdp(pepp::bts::Buffer::ID ibp, u16 iop) {
+tvm::DecodedOp::DPIncr Decoder::decode_incdp(const Packet &p) {
   tvm::DecodedOp::DPIncr ret;
   ret.DS = _state.regs.DS;
   ret.dp_incr = 0;
   switch (_state.regs.IS.word_len) {
   default: [[fallthrough]];
-  case 2: ret.DS = read(ibp, iop + 2);
-  case 1: ret.dp_incr = read(ibp, iop + 0);
+  case 2: ret.DS = word(p, 1);
+  case 1: ret.dp_incr = word(p, 0);
   case 0: break;
   }
   return ret;
 }
 
-DecodedOp::MMIO Decoder::decode_mmio(pepp::bts::Buffer::ID ibp, u16 iop) {
+DecodedOp::MMIO Decoder::decode_mmio(const Packet &p) {
   tvm::DecodedOp::MMIO ret;
   auto &regs = _state.regs;
   _state.csrs.TR = 0; // Enter target mode.
@@ -529,11 +556,11 @@ DecodedOp::MMIO Decoder::decode_mmio(pepp::bts::Buffer::ID ibp, u16 iop) {
   switch (regs.IS.word_len) {
   default: [[fallthrough]];
   case 3:
-    regs.MOD1.lo = read(ibp, iop + 4), _state.csrs.M1 = 1;
+    regs.MOD1.lo = word(p, 2), _state.csrs.M1 = 1;
     ret.write = regs.MOD1.lo;
     [[fallthrough]];
-  case 2: regs.ID.lo = read(ibp, iop + 2); [[fallthrough]];
-  case 1: regs.ACCESS = read(ibp, iop + 0); [[fallthrough]];
+  case 2: regs.ID.lo = word(p, 1); [[fallthrough]];
+  case 1: regs.ACCESS = word(p, 0); [[fallthrough]];
   case 0: break;
   }
 
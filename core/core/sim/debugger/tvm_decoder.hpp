@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include <memory>
 #include "core/ds/alloc/pagechain.hpp"
 #include "core/integers.h"
@@ -18,57 +19,87 @@ namespace tvm {
 // hard-stop the machine, so the caller must re-check L before executing what was decoded.
 class Decoder {
 public:
+  // One instruction packet lifted out of its buffer: the OpWord plus every operand word a decode_* could read.
+  // Fetching is the only part of decoding that does not depend on register state, so it is the part that can be done
+  // ahead of time. See StencilTable.
+  struct Packet {
+    // TRADDR has the widest packet any decode_* reads.
+    static constexpr u8 MAX_WORDS = 8;
+    pepp::bts::Buffer::ID ibp{};
+    // Offset of the OpWord, of its first operand word, and of the next packet.
+    u16 ip = 0, iop = 0, next_ip = 0;
+    tvm::OpWord IS{};
+    // False when the OpWord itself was outside of the buffer.
+    bool readable = false;
+    // Bit i is set when words[i] was inside the buffer.
+    u8 valid = 0;
+    std::array<u16, MAX_WORDS> words{};
+  };
+
   Decoder(std::shared_ptr<pepp::bts::BufferManager> mgr, MachineState &state);
 
   // Fetch the word under IP, advance IP past the packet, program the registers this packet supplied, and resolve the
   // operands into decoded(). Check state.csrs.L afterwards: a decode failure leaves decoded() holding the *previous*
   // instruction's alternative.
   void decode();
+  // As decode(), for a packet that was already fetched from under IP.
+  void decode(const Packet &p);
+  // Copy the packet at ibp:ip out of its buffer. Never modifies the machine state; an unreadable buffer is reported
+  // when the packet is decoded.
+  void fetch(pepp::bts::Buffer::ID ibp, u16 ip, Packet &p) const;
 
   // The most recently decoded instruction, with all of its operands already resolved. Callers that want to observe a
   // program without running it (timestamps, touched locations) can read this between decode and execute.
   const tvm::DecodedOp::OpChoice &decoded() const { return _decoded; }
 
 private:
-  tvm::DecodedOp::Halt decode_halt(pepp::bts::Buffer::ID ibp, u16 iop);
+  friend class StencilTable;
+  // The decode-stage work common to every opcode: honour CLRMOD, latch IS, and advance IP past the packet.
+  void begin(const Packet &p);
+
+  tvm::DecodedOp::Halt decode_halt(const Packet &p);
   // Register write is result of stackop, which is not allowed in decode stage
-  tvm::DecodedOp::Ret decode_ret(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::Ret decode_ret(const Packet &p);
   // Register write depends on a preceding stack op, which is not allowed in decode stage.
-  tvm::DecodedOp::Call decode_call(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::InvCall decode_invcall(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::Call decode_call(const Packet &p);
+  tvm::DecodedOp::InvCall decode_invcall(const Packet &p);
   // Operand-free, like RET. Kept separate so dispatch routes it to on_invret rather than on_ret.
-  tvm::DecodedOp::InvRet decode_invret(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::ASyn decode_asyn(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::ISyn decode_isyn(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::InvRet decode_invret(const Packet &p);
+  tvm::DecodedOp::ASyn decode_asyn(const Packet &p);
+  tvm::DecodedOp::ISyn decode_isyn(const Packet &p);
   // Shared operand decoding for ASYN/ISYN. Programs the MOD registers for the immediate form, then reads the
   // little-endian timestamp bytes. `width` receives the number of bytes actually consumed so that the caller can
   // sign-extend a delta; the returned value itself is only zero-extended.
-  u64 decode_syn_data(pepp::bts::Buffer::ID ibp, u16 iop, u8 &width);
+  u64 decode_syn_data(const Packet &p, u8 &width);
   // Unlike other decode functions, this one does not update registers!
   // This is because the shift/extract logic is somewhat complex -- and really belongs in the execute stage.
-  tvm::DecodedOp::LMR decode_lmr(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::BR decode_br(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::LMR decode_lmr(const Packet &p);
+  tvm::DecodedOp::BR decode_br(const Packet &p);
   // SETMEM and SETMEMX, which differ only in the Delta they resolve to.
-  tvm::DecodedOp::DeltaMem decode_setmem(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::DeltaMem decode_setmem(const Packet &p);
   // Resolves to the same DecodedOp::DeltaMem as decode_setmem. The only difference is where the offset came from,
   // and by the time a backend sees it that distinction has already been resolved away.
-  tvm::DecodedOp::DeltaMem decode_setmemdx(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::DeltaMem decode_setmemdx(const Packet &p);
   // STEPMEM has to carry a endianness bit.
-  tvm::DecodedOp::DeltaMem decode_stepmem(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::CmpMem decode_cmpmem(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::ClrMem decode_clrmem(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::DeltaMem decode_stepmem(const Packet &p);
+  tvm::DecodedOp::CmpMem decode_cmpmem(const Packet &p);
+  tvm::DecodedOp::ClrMem decode_clrmem(const Packet &p);
   // SETREG, SETREGX and STEPREG all at once: unlike their memory counterparts the three share a packet layout
   // exactly.
-  tvm::DecodedOp::DeltaReg decode_deltareg(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::CmpReg decode_cmpreg(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::ClrReg decode_clrreg(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::TRADDR decode_traddr(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::LDP decode_ldp(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::DPIncr decode_accdp(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::DPIncr decode_incdp(pepp::bts::Buffer::ID ibp, u16 iop);
-  tvm::DecodedOp::MMIO decode_mmio(pepp::bts::Buffer::ID ibp, u16 iop);
+  tvm::DecodedOp::DeltaReg decode_deltareg(const Packet &p);
+  tvm::DecodedOp::CmpReg decode_cmpreg(const Packet &p);
+  tvm::DecodedOp::ClrReg decode_clrreg(const Packet &p);
+  tvm::DecodedOp::TRADDR decode_traddr(const Packet &p);
+  tvm::DecodedOp::LDP decode_ldp(const Packet &p);
+  tvm::DecodedOp::DPIncr decode_accdp(const Packet &p);
+  tvm::DecodedOp::DPIncr decode_incdp(const Packet &p);
+  tvm::DecodedOp::MMIO decode_mmio(const Packet &p);
 
-  u16 read(pepp::bts::Buffer::ID id, u16 offset) { return tvm::read16(*_mgr, _state, id, offset); }
+  // Operand word `index` of p. Hard-stops with InvalidIBuffer and returns 0 when that word was outside of the buffer.
+  u16 word(const Packet &p, u8 index) {
+    if ((p.valid >> index) & 1) return p.words[index];
+    return _state.hard_stop(StopCause::InvalidIBuffer), 0;
+  }
 
   std::shared_ptr<pepp::bts::BufferManager> _mgr;
   MachineState &_state;
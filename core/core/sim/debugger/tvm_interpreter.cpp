@@ -1,4 +1,6 @@
 #include "core/sim/debugger/tvm_interpreter.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+#include <utility>
 
 namespace tvm {
 
@@ -11,6 +13,13 @@ void Interpreter::step() {
   // Decode can fail (bad instruction buffer, out-of-range DP for a sync op, unknown opcode), in which case decoded()
   // still holds the previous instruction. Re-check L before handing anything to the backend.
   if (_state.csrs.L) _backend->dispatch(_state, _decoder.decoded());
+  // Nearly every recorded program is a prefix, a CALL into a promoted stencil, and a postfix. Run the stencil's body
+  // here, while IP is known to be at its entry, so the loop in run() only decodes the packets around it.
+  if (_stencil_source && _state.csrs.L && std::holds_alternative<tvm::DecodedOp::Call>(_decoder.decoded())) {
+    const SegmentPair entry = _state.regs.IP;
+    if (auto stencil = _stencils.find(*_stencil_source, _decoder, entry))
+      StencilTable::run(*stencil, _decoder, *_backend, _state);
+  }
 }
 
 void Interpreter::run(pepp::bts::Buffer::Location loc, RegisterRetention retain) {
@@ -40,4 +49,23 @@ std::size_t Interpreter::run_each(std::span<const ProgramLocation> locs, Registe
   return count;
 }
 
+std::size_t Interpreter::replay(const TraceBuffer &tb, Cursor from, Cursor to, Direction direction,
+                                RegisterRetention retain) {
+  const auto previous = std::exchange(_stencil_source, &tb);
+  _backend->set_direction(direction);
+  std::size_t count = 0;
+  auto each = [&](auto begin, auto end) {
+    for (auto it = begin; it != end; ++it) {
+      run(*it, retain);
+      ++count;
+      if (_state.csrs.F == 1) break;
+    }
+  };
+  const auto entries = tb.range(from, to);
+  if (direction == Direction::Forward) each(entries.begin(), entries.end());
+  else each(entries.rbegin(), entries.rend());
+  _stencil_source = previous;
+  return count;
+}
+
 } // namespace tvm
@@ -6,11 +6,13 @@
 #include "core/sim/debugger/tvm_backend.hpp"
 #include "core/sim/debugger/tvm_decoder.hpp"
 #include "core/sim/debugger/tvm_machine.hpp"
+#include "core/sim/debugger/tvm_stencil_table.hpp"
 
 // The system class from core/sim/system.hpp
 class System;
 namespace tvm {
 class TraceBuffer;
+struct Cursor;
 
 // This is basically an ASIC with a custom instruction set used to copy  values into a simulator's
 // registers+memory.
@@ -91,6 +93,18 @@ public:
     }
     return end;
   }
+
+  // --- Bulk replay ---
+  // Replay the entries of tb in [from, to): oldest first when replaying Forward, newest first when Backward. Sets the
+  // backend's direction, and stops after the first program that hard-stops (F==1). Returns the number of programs run.
+  // CALLs into tb's stencil chain run from precompiled stencils, as if set_stencil_source(&tb) had been called.
+  std::size_t replay(const TraceBuffer &tb, Cursor from, Cursor to, Direction direction,
+                     RegisterRetention retain = RegisterRetention::None);
+  // While non-null, step() executes the body of any CALL into tb's stencil chain from the stencil table instead of
+  // decoding it one packet at a time. decoded() is not updated for the packets inside such a body.
+  void set_stencil_source(const TraceBuffer *tb) { _stencil_source = tb; }
+  const TraceBuffer *stencil_source() const { return _stencil_source; }
+  const StencilTable &stencils() const { return _stencils; }
   auto &csrs() { return _state.csrs; }
   const auto &csrs() const { return _state.csrs; }
   auto &regs() { return _state.regs; }
@@ -117,5 +131,7 @@ private:
   MachineState _state{};
   Decoder _decoder;
   std::unique_ptr<Backend> _backend;
+  const TraceBuffer *_stencil_source = nullptr;
+  StencilTable _stencils;
 };
 } // namespace tvm
@@ -0,0 +1,91 @@
+#include "core/sim/debugger/tvm_stencil_table.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+
+namespace tvm {
+
+const StencilTable::Stencil *StencilTable::find(const TraceBuffer &tb, const Decoder &decoder, SegmentPair entry) {
+  // clear() frees the stencil chain and may hand the same buffers out again with new contents.
+  if (_tb != &tb || _generation != tb.stencil_generation()) {
+    clear();
+    _tb = &tb, _generation = tb.stencil_generation();
+  }
+  if (auto it = _stencils.find(entry.as_u32()); it != _stencils.end()) return ++_hits, &it->second;
+  // Code anywhere else (the ring's own code chains) is overwritten as slots are reused.
+  if (!tb.is_stencil_code(pepp::bts::Buffer::ID{entry.hi})) return nullptr;
+  auto [it, _] = _stencils.emplace(entry.as_u32(), compile(decoder, entry));
+  return &it->second;
+}
+
+void StencilTable::run(const Stencil &stencil, Decoder &decoder, Backend &backend, MachineState &state) {
+  auto &regs = state.regs;
+  for (const auto &op : stencil.ops) {
+    if (!state.csrs.L || regs.IP.hi != op.packet.ibp.value || regs.IP.lo != op.packet.ip) return;
+    op.handler(decoder, backend, state, op.packet);
+  }
+}
+
+void StencilTable::clear() {
+  _stencils.clear();
+  _tb = nullptr, _generation = 0, _hits = 0;
+}
+
+StencilTable::Handler StencilTable::handler_for(Opcode opcode) {
+  using D = Decoder;
+  using B = Backend;
+  namespace op = tvm::DecodedOp;
+  switch (opcode) {
+  case Opcode::HALT: return &run_packet<op::Halt, &D::decode_halt, &B::on_halt>;
+  case Opcode::RET: return &run_packet<op::Ret, &D::decode_ret, &B::on_ret>;
+  case Opcode::CALL: return &run_packet<op::Call, &D::decode_call, &B::on_call>;
+  case Opcode::INVCALL: return &run_packet<op::InvCall, &D::decode_invcall, &B::on_invcall>;
+  case Opcode::INVRET: return &run_packet<op::InvRet, &D::decode_invret, &B::on_invret>;
+  case Opcode::ASYN: return &run_packet<op::ASyn, &D::decode_asyn, &B::on_asyn>;
+  case Opcode::ISYN: return &run_packet<op::ISyn, &D::decode_isyn, &B::on_isyn>;
+  case Opcode::LMR: return &run_packet<op::LMR, &D::decode_lmr, &B::on_lmr>;
+  case Opcode::BRF: [[fallthrough]];
+  case Opcode::NOP: [[fallthrough]];
+  case Opcode::BREQ: [[fallthrough]];
+  case Opcode::BRGT: [[fallthrough]];
+  case Opcode::BRGE: [[fallthrough]];
+  case Opcode::BRLT: [[fallthrough]];
+  case Opcode::BRLE: [[fallthrough]];
+  case Opcode::BRNE: [[fallthrough]];
+  case Opcode::BR: return &run_packet<op::BR, &D::decode_br, &B::on_br>;
+  case Opcode::SETMEM: [[fallthrough]];
+  case Opcode::SETMEMX: return &run_packet<op::DeltaMem, &D::decode_setmem, &B::on_deltamem>;
+  case Opcode::SETMEMDX: return &run_packet<op::DeltaMem, &D::decode_setmemdx, &B::on_deltamem>;
+  case Opcode::STEPMEM: return &run_packet<op::DeltaMem, &D::decode_stepmem, &B::on_deltamem>;
+  case Opcode::CMPMEM: return &run_packet<op::CmpMem, &D::decode_cmpmem, &B::on_cmpmem>;
+  case Opcode::CLRMEM: return &run_packet<op::ClrMem, &D::decode_clrmem, &B::on_clrmem>;
+  case Opcode::SETREG: [[fallthrough]];
+  case Opcode::SETREGX: [[fallthrough]];
+  case Opcode::STEPREG: return &run_packet<op::DeltaReg, &D::decode_deltareg, &B::on_deltareg>;
+  case Opcode::CMPREG: return &run_packet<op::CmpReg, &D::decode_cmpreg, &B::on_cmpreg>;
+  case Opcode::CLRREG: return &run_packet<op::ClrReg, &D::decode_clrreg, &B::on_clrreg>;
+  case Opcode::TRADDR: return &run_packet<op::TRADDR, &D::decode_traddr, &B::on_traddr>;
+  case Opcode::LDP: return &run_packet<op::LDP, &D::decode_ldp, &B::on_ldp>;
+  case Opcode::ACCDP: return &run_packet<op::DPIncr, &D::decode_accdp, &B::on_dpincr>;
+  case Opcode::INCDP: return &run_packet<op::DPIncr, &D::decode_incdp, &B::on_dpincr>;
+  case Opcode::MMIO: return &run_packet<op::MMIO, &D::decode_mmio, &B::on_mmio>;
+  default: return nullptr;
+  }
+}
+
+StencilTable::Stencil StencilTable::compile(const Decoder &decoder, SegmentPair entry) const {
+  Stencil ret;
+  const auto ibp = pepp::bts::Buffer::ID{entry.hi};
+  u16 ip = entry.lo;
+  while (ret.ops.size() < MAX_OPS) {
+    MicroOp op;
+    decoder.fetch(ibp, ip, op.packet);
+    // Leave anything that would hard-stop to the slow path, which reports it with the right cause.
+    if (!op.packet.readable || !(op.handler = handler_for((Opcode)op.packet.IS.ocpode))) break;
+    ret.ops.emplace_back(op);
+    const auto opcode = (Opcode)op.packet.IS.ocpode;
+    if (opcode == Opcode::RET || opcode == Opcode::HALT) break;
+    ip = op.packet.next_ip;
+  }
+  return ret;
+}
+
+} // namespace tvm
@@ -0,0 +1,74 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "core/sim/debugger/tvm_backend.hpp"
+#include "core/sim/debugger/tvm_decoder.hpp"
+#include "core/sim/debugger/tvm_machine.hpp"
+
+namespace tvm {
+class TraceBuffer;
+
+// Precompiled stencils for bulk replay.
+//
+// Most of a recorded trace is CALLs into a handful of stencils the TraceBuffer promoted, so replaying a ring decodes
+// the same few bodies word by word over and over. Promoted stencils are never modified or freed until
+// TraceBuffer::clear(), which makes them safe to compile once: each packet is fetched out of its buffer a single time
+// and bound to a handler specialized for its opcode. Replaying a stencil then walks a flat micro-op list, calling the
+// decode_* and the Backend handler for each packet directly -- no fetch, no opcode switch, no trip through the
+// OpChoice variant.
+//
+// Decoding itself still happens at replay time, because what a packet resolves to depends on the registers it
+// inherits (DP, DS, and anything retained from an earlier packet). Only the work that is a pure function of the
+// stencil's bytes is hoisted. That keeps a compiled stencil exactly equivalent to stepping it.
+class StencilTable {
+public:
+  using Handler = void (*)(Decoder &, Backend &, MachineState &, const Decoder::Packet &);
+  struct MicroOp {
+    Decoder::Packet packet;
+    Handler handler = nullptr;
+  };
+  // The packets of one stencil in address order, from its entry point through its RET.
+  struct Stencil {
+    std::vector<MicroOp> ops;
+  };
+  // Bodies are straight-line SET*/CMP* sequences, so this only bounds a malformed stencil that never returns.
+  static constexpr std::size_t MAX_OPS = 256;
+
+  // The compiled stencil that starts at `entry`, compiling it on first use. Returns nullptr when `entry` is not in tb's
+  // stencil chain, in which case the caller should decode normally.
+  const Stencil *find(const TraceBuffer &tb, const Decoder &decoder, tvm::SegmentPair entry);
+
+  // Run `stencil` from the current IP for as long as execution stays on its straight-line path. Returns as soon as a
+  // packet sends IP anywhere other than the next micro-op (a taken branch, a nested call, the final RET) or stops the
+  // machine, and the caller resumes stepping from wherever IP now is. decoder.decoded() is not updated.
+  static void run(const Stencil &stencil, Decoder &decoder, Backend &backend, MachineState &state);
+
+  // Drop every compiled stencil.
+  void clear();
+  std::size_t size() const { return _stencils.size(); }
+  // Number of find() calls answered by an already compiled stencil.
+  std::size_t hits() const { return _hits; }
+
+private:
+  // Specialized per opcode, so each micro-op is one indirect call that decodes and executes its packet.
+  template <typename Op, Op (Decoder::*decode)(const Decoder::Packet &),
+            void (Backend::*execute)(MachineState &, const Op &)>
+  static void run_packet(Decoder &decoder, Backend &backend, MachineState &state, const Decoder::Packet &p) {
+    decoder.begin(p);
+    const Op op = (decoder.*decode)(p);
+    // Decode can fail, exactly as in Interpreter::step().
+    if (state.csrs.L) (backend.*execute)(state, op);
+  }
+  // Mirrors the opcode switch in Decoder::decode(). nullptr for an opcode the decoder does not recognize.
+  static Handler handler_for(tvm::Opcode opcode);
+  Stencil compile(const Decoder &decoder, tvm::SegmentPair entry) const;
+
+  // Keyed on the entry point's SegmentPair::as_u32().
+  std::unordered_map<u32, Stencil> _stencils;
+  // The trace buffer and stencil generation the compiled stencils were fetched from.
+  const TraceBuffer *_tb = nullptr;
+  std::size_t _generation = 0;
+  std::size_t _hits = 0;
+};
+
+} // namespace tvm
@@ -1,12 +1,65 @@
 #include "tvm_tracebuffer.hpp"
 #include <algorithm>
 #include <cassert>
+#include <concepts>
 #include <cstring>
 #include <iterator>
+#include <utility>
+#include "core/ds/compress/lz.hpp"
 #include "core/ds/hash/fnv.hpp"
 #include "core/sim/api/trace.hpp"
 #include "core/sim/debugger/tvm_encoding.hpp"
 
+namespace {
+// Sequential little-endian reads of an image written by TraceBuffer::freeze().
+struct ImageReader {
+  const u8 *at;
+  template <std::unsigned_integral T> T get() {
+    T ret = 0;
+    for (std::size_t it = 0; it < sizeof(T); ++it) ret |= static_cast<T>(at[it]) << (8 * it);
+    at += sizeof(T);
+    return ret;
+  }
+  bits::span<const u8> bytes(std::size_t len) { return {std::exchange(at, at + len), len}; }
+};
+
+// Rewrite every buffer id in a run of packets. Only the operands that hold a buffer id are touched: IP.hi through
+// CALL/INVCALL/LMR and DP.hi through LDP/LMR. CALLs aim at the stencil chain, which is never compressed, so those are
+// left alone by `remap` rather than here.
+template <typename Remap> void remap_code(bits::span<u8> code, Remap &&remap) {
+  for (std::size_t at = 0; at + 2 <= code.size();) {
+    const tvm::OpWord op(static_cast<u16>(code[at] | (code[at + 1] << 8)));
+    const std::size_t len = 2 + 2 * op.word_len;
+    if (at + len > code.size()) break;
+    auto patch = [&](std::size_t word) {
+      if (word > op.word_len) return;
+      u8 *p = code.data() + at + 2 * word;
+      const u16 id = remap(static_cast<u16>(p[0] | (p[1] << 8)));
+      p[0] = static_cast<u8>(id & 0xFF), p[1] = static_cast<u8>(id >> 8);
+    };
+    switch (static_cast<tvm::Opcode>(op.ocpode)) {
+    case tvm::Opcode::CALL: patch(2); break;
+    case tvm::Opcode::INVCALL: patch(3), patch(4); break;
+    case tvm::Opcode::LDP: patch(3); break;
+    case tvm::Opcode::LMR: {
+      if (op.word_len == 0) break;
+      const u16 mask = static_cast<u16>(code[at + 2] | (code[at + 3] << 8));
+      constexpr u16 ids = static_cast<u16>(tvm::RegMask::IP_HI) | static_cast<u16>(tvm::RegMask::DP_HI);
+      // One word per set bit, lowest bit first.
+      for (std::size_t bit = 0, word = 2; bit < 15; ++bit) {
+        if (!(mask & (1u << bit))) continue;
+        if (ids & (1u << bit)) patch(word);
+        ++word;
+      }
+      break;
+    }
+    default: break;
+    }
+    at += len;
+  }
+}
+} // namespace
+
 namespace tvm {
 
 // Ensure that the concept is modeled as expected.
@@ -15,14 +68,12 @@ static_assert(std::bidirectional_iterator<TraceBuffer::Iterator>);
 
 // --- Node ---
 
-void TraceBuffer::Node::reset(pepp::bts::BufferManager &mgr) {
-  // acknowledge() is the only caller, and it already ensures that all recordings are closed. This is just being
-  // defensive.
-  assert(open == 0 && "reset() of a slot with open recordings");
-  if (code) code->clear();
-  // Return pages to pool while keeping the map entries
-  for (auto &[initiator, chain] : data)
-    if (chain) chain->clear();
+void TraceBuffer::Node::release(pepp::bts::BufferManager &mgr) {
+  // Return pages to pool while keeping the chains
+  for (auto &[code, data] : chains) {
+    if (code) code->clear();
+    if (data) data->clear();
+  }
   // Return location buffer to pool rather than retaining it. After being reset, it's UB to access this node anyway,
   // and allowing the buffer to re-use this data should lower total occupancy of the ring.
   // Re-acquired on write_location().
@@ -30,9 +81,18 @@ void TraceBuffer::Node::reset(pepp::bts::BufferManager &mgr) {
     mgr.free_buffer(locations->id());
     locations = nullptr;
   }
-  count = 0;
+}
+
+void TraceBuffer::Node::reset(pepp::bts::BufferManager &mgr) {
+  // acknowledge() is the only caller, and it already ensures that all recordings are closed. This is just being
+  // defensive.
+  assert(open() == 0 && "reset() of a slot with open recordings");
+  release(mgr);
+  // Assign rather than clear(), which would keep the capacity.
+  cold = {};
+  cold_size = 0;
   // Cursors can no longer point to this node, and this node can be used by begin().
-  slot = NO_SLOT;
+  state.store(EMPTY, std::memory_order_release);
 }
 
 // --- Construction / Destruction ---
@@ -41,13 +101,10 @@ TraceBuffer::TraceBuffer(std::shared_ptr<pepp::bts::BufferManager> mgr, size_t r
   // Every slot lookup is `absolute_slot % _ring.size()`, so an empty ring is a division by zero on first use rather
   // than a buffer that simply holds nothing. Refuse it here, where the cause is still visible.
   if (ring_size == 0) throw std::invalid_argument("TraceBuffer: ring_size must be at least 1");
-  _ring.resize(ring_size);
-  // Eagerly allocate chains, and defer to clear() to populate initial data
-  for (auto &node : _ring) {
-    node.code = _mgr->alloc_chain();
-    // Lazily allocate node.data to avoid paying for all devices up front.
-    // Also lazily allocate node.locations, which is a full 64KiB buffer that is only needed if we enable tracing.
-  }
+  // Nodes hold atomics, so the ring is built at its final size rather than resized.
+  // Chains are allocated lazily per initiator, and node.locations when a slot is first claimed, since it is a full
+  // 64KiB buffer that is only needed if we enable tracing.
+  _ring = std::vector<Node>(ring_size);
   _stencils = _mgr->alloc_chain();
   clear();
 }
@@ -72,41 +129,46 @@ Traceable *TraceBuffer::find_traceable(Device::ID initiator) const { return _fin
 // --- Recording lifecycle ---
 
 Recording *TraceBuffer::find_recording(Device::ID initiator) {
-  auto it = _recordings.find(initiator);
+  auto &state = _initiators[initiator.value];
   // Closed recordings are not findable. Entries outlive their commit() so the scratch vectors keep their capacity,
-  // which means a bare map hit says "this initiator has recorded before", not "this initiator is recording now" --
+  // which means a bare table hit says "this initiator has recorded before", not "this initiator is recording now" --
   // and every caller wants the second. Returning the stale one let a write that arrived outside any instruction
   // append its payload to a finished record: the bytes were charged to the footprint and reserved in the ring, but no
   // commit ever referenced them.
-  if (it == _recordings.end() || !it->second.active) return nullptr;
-  return &it->second;
+  if (!state || !state->rec.active) return nullptr;
+  return &state->rec;
 }
 
 pepp::bts::BufferChain &TraceBuffer::data_chain(Recording &rec) {
   // Resolved on first use and then retained. The recording pinned its slot at begin(), so we do not need to re-resolve.
   if (rec.chain == nullptr) {
-    auto &slot = node_at(rec.slot).data[rec.id];
-    if (!slot) slot = _mgr->alloc_chain();
-    // The chain is owned by a unique_ptr, so rehashing the map moves the unique_pointer, not the chain.
-    rec.chain = slot.get();
+    auto &chain = node_at(rec.slot).chains[rec.id.value].data;
+    if (!chain) chain = _mgr->alloc_chain();
+    rec.chain = chain.get();
   }
   return *rec.chain;
 }
 
 void TraceBuffer::begin(Device::ID initiator) {
-  // Advance if the current slot's location buffer is full. Guarded on residency because a one-slot ring
-  // current_node() is the same node before and after an advance; without it a full slot would advance twice.
-  if (auto &head = current_node(); head.slot == _head && head.count >= MAX_LOCATION_ENTRIES) advance_slot();
-
-  // Re-read the node: a watermark callback fired by advance_slot() may have acknowledged this very slot.
-  auto &node = current_node();
-  if (node.slot != NO_SLOT && node.slot != _head) throw RingOverflow(_head);
-
-  // Allocate the location buffer now, so that neither commit() nor abort() will allocate it.
-  if (node.locations == nullptr) node.locations = _mgr->alloc_buffer();
+  // Only this initiator's thread touches its entry, so creating it needs no lock.
+  auto &self = _initiators[initiator.value];
+  if (!self) self = std::make_unique<Initiator>(), self->rec.id = initiator;
+
+  // Reserve the next entry of the head slot. This is the only state recordings share, and taking an entry is one CAS
+  // on the head node; the stamp in the same word means a node the ring has since moved off cannot be reserved into.
+  // Falls back to open_head() when the head is full or unclaimed, which happens once per slot.
+  std::size_t slot;
+  u64 prior;
+  while (true) {
+    slot = _head.load(std::memory_order_acquire);
+    auto &head = node_at(slot);
+    prior = head.state.load(std::memory_order_acquire);
+    if (!Node::holds(prior, slot) || Node::count_of(prior) >= MAX_LOCATION_ENTRIES) open_head(slot);
+    else if (head.state.compare_exchange_weak(prior, prior + Node::RESERVE, std::memory_order_acq_rel)) break;
+  }
 
   // clear() keeps the capacity earned by previous programs.
-  auto &rec = _recordings[initiator];
+  auto &rec = self->rec;
   assert(!rec.active && "begin() called while this initiator is already recording");
   rec.id = initiator;
   rec.prefix.clear();
@@ -114,17 +176,47 @@ void TraceBuffer::begin(Device::ID initiator) {
   rec.postfix.clear();
   rec.active = true;
   rec.data_start = {};
-  // Claim the slot and index after everything that could throw. The data chain is resolved lazily on first write.
-  node.slot = _head;
-  rec.slot = _head;
-  rec.entry = node.count++;
+  // The data chain is resolved lazily on first write.
+  rec.slot = slot;
+  rec.entry = Node::count_of(prior);
   rec.chain = nullptr;
-  node.open++;
   rec.dp = {};
 
   // Write a tombstone so that a reserved-but-uncommitted entry dereferences to a program that immediately halts,
   // rather than stale data from a previous occupant. commit() overwrites this; abort() leaves it.
-  write_location(node, rec.entry, _tombstone);
+  write_location(node_at(slot), rec.entry, _tombstone);
+}
+
+void TraceBuffer::open_head(std::size_t seen) {
+  std::lock_guard lock(_ring_lock);
+  // Another initiator advanced the head while we waited for the lock.
+  if (_head.load(std::memory_order_relaxed) != seen) return;
+  // Advance if the current slot's location buffer is full. Guarded on residency because in a one-slot ring
+  // current_node() is the same node before and after an advance; without it a full slot would advance twice.
+  if (auto &head = current_node(); head.holds(seen)) {
+    // Another initiator claimed it while we waited for the lock.
+    if (head.count() < MAX_LOCATION_ENTRIES) return;
+    advance_slot();
+  }
+
+  // Re-read the node: a watermark callback fired by advance_slot() may have acknowledged this very slot.
+  const std::size_t slot = _head.load(std::memory_order_relaxed);
+  auto &node = current_node();
+  if (!node.is_empty()) throw RingOverflow(slot);
+
+  // Nothing has been written for this program yet, so if nothing else is in flight either, the machine's state is the
+  // state at {slot, 0}. Every open recording holds a count in the node it began in.
+  if (!_slot_callbacks.empty()) {
+    const auto open = [](const Node &node) { return node.open() > 0; };
+    if (std::none_of(_ring.begin(), _ring.end(), open))
+      for (auto &cb : _slot_callbacks) cb(Cursor{slot, 0});
+  }
+
+  // Allocate the location buffer now, so that neither commit() nor abort() will allocate it.
+  if (node.locations == nullptr) node.locations = _mgr->alloc_buffer();
+  node.locations->allocate_uninitialized(pepp::bts::Buffer::SIZE - node.locations->used_capacity());
+  // Claim the node after everything that could throw, which is also what lets the waiting initiators in.
+  node.state.store(Node::claimed(slot), std::memory_order_release);
 }
 
 tvm::ProgramLocation TraceBuffer::commit(Device::ID initiator) {
@@ -136,20 +228,30 @@ tvm::ProgramLocation TraceBuffer::commit(Device::ID initiator) {
   auto halt = EncodedOp::Halt<0>{}.encode();
   rec->postfix.insert(rec->postfix.end(), halt.begin(), halt.end());
 
-  // Release the reservation before anything that can throw. If resolve_body or flush_to_ring fails, the entry keeps
-  // its tombstone and replays as a halt.
   auto &node = node_at(rec->slot);
-  assert(node.open > 0 && "commit() without a matching begin() reservation");
-  node.open--;
+  assert(node.open() > 0 && "commit() without a matching begin() reservation");
   rec->active = false;
 
-  auto resolution = resolve_body({rec->body.data(), rec->body.size()});
-  auto ret = flush_to_ring(*rec, resolution);
-  _footprint.programs++;
-
-  // Advance once the slot is full and no recordings are open. Must be after flush_to_ring: advance_slot() runs
-  // watermark callbacks, and a callback that acknowledges would reset this node while we're still writing to it.
-  if (rec->slot == _head && node.count >= MAX_LOCATION_ENTRIES && node.open == 0) advance_slot();
+  // Keep the reservation until the chains are written, since a slot with nothing open may be compressed from another
+  // initiator's thread. If resolve_body or flush_to_ring fails, the entry keeps its tombstone and replays as a halt.
+  auto &self = owner(*rec);
+  tvm::ProgramLocation ret;
+  try {
+    ret = flush_to_ring(self, resolve_body(self, {rec->body.data(), rec->body.size()}));
+  } catch (...) {
+    node.state.fetch_sub(1, std::memory_order_acq_rel);
+    throw;
+  }
+  self.footprint.programs++;
+  const u64 after = node.state.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+  // Advance once the slot is full and no recordings are open, which exactly one commit observes. Must be after
+  // flush_to_ring: advance_slot() runs watermark callbacks, and a callback that acknowledges would reset this node
+  // while we're still writing to it. begin() may have advanced past it already.
+  if (Node::count_of(after) >= MAX_LOCATION_ENTRIES && Node::open_of(after) == 0) {
+    std::lock_guard lock(_ring_lock);
+    if (rec->slot == _head.load(std::memory_order_relaxed)) advance_slot();
+  }
   return ret;
 }
 
@@ -165,8 +267,8 @@ void TraceBuffer::abort(Device::ID initiator) {
   // want to avoid throwing. This executes inside Recorder::Instruction's destructor, where a throw would
   // std::terminate. We still throw because of asserts, but if you hit this assert, fix your buggy program.
   auto &node = node_at(rec->slot);
-  assert(node.open > 0 && "abort() without a matching begin() reservation");
-  node.open--;
+  assert(node.open() > 0 && "abort() without a matching begin() reservation");
+  node.state.fetch_sub(1, std::memory_order_acq_rel);
   // Whatever payload this record wrote stays in the data chain, unreferenced, until the slot is reclaimed. Reclaiming
   // it would need a chain rewind, which does not exist. Keep the same clear-but-keep-capacity treatment as begin(), so
   // that aborting costs does not incur additional memory allocations.
@@ -216,14 +318,14 @@ pepp::bts::Buffer::Location TraceBuffer::append_data(Device::ID initiator, bits:
   assert(rec && rec->active && "append_data() outside a begin()/commit() pair");
   if (rec == nullptr || !rec->active) return {};
   auto loc = data_chain(*rec).append(data);
-  _footprint.data += data.size();
+  owner(*rec).footprint.data += data.size();
   if (rec->data_start.id == pepp::bts::Buffer::ID{0}) rec->data_start = loc;
   return loc;
 }
 
 DataSlot TraceBuffer::append_data_uninitialized(Recording &rec, std::size_t len) {
   const auto res = data_chain(rec).reserve(len);
-  _footprint.data += len;
+  owner(rec).footprint.data += len;
   // The first payload of a record is where the driver points DP before entering the program, so it is remembered
   // separately from the anchor, which keeps moving as further payloads are appended.
   if (rec.data_start.id == pepp::bts::Buffer::ID{0}) rec.data_start = res.loc;
@@ -237,8 +339,8 @@ DataSlot TraceBuffer::append_data_uninitialized(Device::ID initiator, std::size_
 }
 
 bool TraceBuffer::is_recording(Device::ID initiator) const {
-  auto it = _recordings.find(initiator);
-  return it != _recordings.end() && it->second.active;
+  const auto &state = _initiators[initiator.value];
+  return state && state->rec.active;
 }
 
 // --- Backpressure ---
@@ -247,19 +349,42 @@ void TraceBuffer::on_watermark(float threshold, WatermarkCallback cb) {
   _watermarks.push_back({threshold, std::move(cb), false});
 }
 
+void TraceBuffer::on_slot_begin(SlotCallback cb) { _slot_callbacks.push_back(std::move(cb)); }
+
+void TraceBuffer::set_hot_slots(std::size_t slots) {
+  _hot_slots = slots;
+  freeze_cold();
+}
+
+TraceBuffer::ColdFootprint TraceBuffer::cold_footprint() const {
+  ColdFootprint ret;
+  for (const auto &node : _ring) {
+    if (node.is_empty() || !node.is_cold()) continue;
+    ret.slots++, ret.raw += node.cold_size, ret.compressed += node.cold.size();
+  }
+  return ret;
+}
+
 void TraceBuffer::clear() {
   // Node::reset asserts open == 0, so we must close all open recordings.
-  for (auto &[id, rec] : _recordings) abort(id);
+  for (auto &state : _initiators)
+    if (state) abort(state->rec.id);
   // Then we can return the underlying buffers (if any) to the buffer manager safely.
   for (auto &node : _ring) node.reset(*_mgr);
   _head = _tail = 0;
-
-  // Reset all performance / footprint counters.
-  _footprint = {};
-  // All tables for stencil promotion must be cleared.
-  _stencil_map.clear(), _pending_hashes.clear(), _stencils->clear();
+  _cold_from = 0;
+  _thawed.clear();
+
+  // Reset all performance / footprint counters, and all tables for stencil promotion.
+  for (auto &state : _initiators) {
+    if (!state) continue;
+    state->footprint = {};
+    state->stencils.clear(), state->pending.clear();
+  }
+  _stencils->clear();
+  ++_stencil_generation;
   // Create a tombstone entry in the stencil chain so reserved-but-unwritten location entries can point to a valid
-  // program. Not counted in _footprint.stencils. It's only two bytes, and they are a functional requirement of the
+  // program. Not counted in Footprint::stencils. It's only two bytes, and they are a functional requirement of the
   // reservation system.
   const auto halt = EncodedOp::Halt<0>{}.encode();
   _tombstone = {};
@@ -268,7 +393,7 @@ void TraceBuffer::clear() {
   // The thresholds and callbacks are the UI's registrations and outlive any one run; only whether they have fired is
   // a property of the trace just discarded.
   for (auto &wm : _watermarks) wm.fired = false;
-  // Deliberately untouched: _traced, _address_in_payload, _ring.size(), _mgr.
+  // Deliberately untouched: _traced, _address_in_payload, _ring.size(), _mgr, _slot_callbacks, _hot_slots.
 }
 
 void TraceBuffer::acknowledge(Cursor up_to) {
@@ -277,13 +402,13 @@ void TraceBuffer::acknowledge(Cursor up_to) {
   // fire arbitrarily and never reset. Worse, the loop below would reset() the node _head is still recording into,
   // returning its chains to the pool while an open Recording holds a pointer into them. A cursor held from before the
   // ring moved, or one taken from a different buffer, is an easy way to arrive here.
-  const size_t limit = std::min(up_to.slot, _head);
+  const size_t limit = std::min(up_to.slot, _head.load());
   while (_tail < limit) {
     auto &node = _ring[_tail % _ring.size()];
     // A recording that reserved an entry here has not closed yet, and is still appending to this node's chains.
     // reset() would hand those buffers back underneath it. Stop rather than skip: _tail has to stay contiguous, and
     // the caller can acknowledge the rest once the recording closes.
-    if (node.open > 0) break;
+    if (node.open() > 0) break;
     node.reset(*_mgr);
     _tail++;
   }
@@ -302,9 +427,25 @@ float TraceBuffer::ring_occupancy() const {
 
 // --- Footprint accounting ---
 
-TraceBuffer::Footprint TraceBuffer::footprint() const { return _footprint; }
+std::size_t TraceBuffer::recording_count() const {
+  return std::ranges::count_if(_initiators, [](const auto &state) { return state != nullptr; });
+}
 
-void TraceBuffer::reset_footprint() { _footprint = {}; }
+TraceBuffer::Footprint TraceBuffer::footprint() const {
+  Footprint ret;
+  for (const auto &state : _initiators) {
+    if (!state) continue;
+    const auto &part = state->footprint;
+    ret.code += part.code, ret.code_if_inlined += part.code_if_inlined, ret.stencils += part.stencils;
+    ret.data += part.data, ret.programs += part.programs;
+  }
+  return ret;
+}
+
+void TraceBuffer::reset_footprint() {
+  for (auto &state : _initiators)
+    if (state) state->footprint = {};
+}
 
 std::size_t TraceBuffer::buffer_footprint() const {
   // Whole buffers, not bytes written -- this is the number that answers "how much memory is this actually holding",
@@ -312,9 +453,10 @@ std::size_t TraceBuffer::buffer_footprint() const {
   std::size_t buffers = 0;
   for (auto &node : _ring) {
     if (node.locations) ++buffers;
-    if (node.code) buffers += node.code->buffer_count();
-    for (auto &[initiator, chain] : node.data)
-      if (chain) buffers += chain->buffer_count();
+    for (auto &[code, data] : node.chains) {
+      if (code) buffers += code->buffer_count();
+      if (data) buffers += data->buffer_count();
+    }
   }
   if (_stencils) buffers += _stencils->buffer_count();
   return buffers * pepp::bts::Buffer::SIZE;
@@ -329,7 +471,7 @@ std::size_t TraceBuffer::buffer_footprint() const {
 // than the one being replayed.
 pepp::bts::Buffer::ID TraceBuffer::data_successor(pepp::bts::Buffer::ID id) const {
   for (auto &node : _ring) {
-    for (auto &[initiator, chain] : node.data) {
+    for (auto &[code, chain] : node.chains) {
       if (!chain) continue;
       auto succ = chain->successor(id);
       if (succ != pepp::bts::Buffer::ID{0}) return succ;
@@ -340,7 +482,7 @@ pepp::bts::Buffer::ID TraceBuffer::data_successor(pepp::bts::Buffer::ID id) cons
 
 pepp::bts::Buffer::ID TraceBuffer::data_predecessor(pepp::bts::Buffer::ID id) const {
   for (auto &node : _ring) {
-    for (auto &[initiator, chain] : node.data) {
+    for (auto &[code, chain] : node.chains) {
       if (!chain) continue;
       auto pred = chain->predecessor(id);
       if (pred != pepp::bts::Buffer::ID{0}) return pred;
@@ -353,14 +495,41 @@ pepp::bts::Buffer::ID TraceBuffer::data_predecessor(pepp::bts::Buffer::ID id) co
 
 u32 TraceBuffer::hash(bits::span<const u8> data) { return static_cast<u32>(pepp::fnv_1a(data)); }
 
+std::size_t TraceBuffer::stencil_count() const {
+  std::size_t ret = 0;
+  for (const auto &state : _initiators) ret += state ? state->stencils.size() : 0;
+  return ret;
+}
+
+std::size_t TraceBuffer::pending_count() const {
+  std::size_t ret = 0;
+  for (const auto &state : _initiators) ret += state ? state->pending.size() : 0;
+  return ret;
+}
+
+bool TraceBuffer::is_stencil(u32 h) const {
+  return std::ranges::any_of(_initiators, [h](const auto &state) { return state && state->stencils.contains(h); });
+}
+
+bool TraceBuffer::is_pending(u32 h) const {
+  return std::ranges::any_of(_initiators, [h](const auto &state) { return state && state->pending.contains(h); });
+}
+
 u32 TraceBuffer::stencil_hits(u32 h) const {
-  auto it = _stencil_map.find(h);
-  return it != _stencil_map.end() ? it->second.hit_count : 0;
+  u32 ret = 0;
+  for (const auto &state : _initiators) {
+    if (!state) continue;
+    else if (auto it = state->stencils.find(h); it != state->stencils.end()) ret += it->second.hit_count;
+  }
+  return ret;
 }
 
 u16 TraceBuffer::stencil_size(u32 h) const {
-  auto it = _stencil_map.find(h);
-  return it != _stencil_map.end() ? static_cast<u16>(it->second.body.size()) : 0;
+  for (const auto &state : _initiators) {
+    if (!state) continue;
+    else if (auto it = state->stencils.find(h); it != state->stencils.end()) return static_cast<u16>(it->second.body.size());
+  }
+  return 0;
 }
 
 // --- Stencil dedup ---
@@ -369,7 +538,7 @@ bool TraceBuffer::stencil_matches(const StencilEntry &entry, bits::span<const u8
   return std::ranges::equal(entry.body, body);
 }
 
-TraceBuffer::BodyResolution TraceBuffer::resolve_body(bits::span<const u8> body) {
+TraceBuffer::BodyResolution TraceBuffer::resolve_body(Initiator &self, bits::span<const u8> body) {
   if (body.empty())
     return {false, {}};
 
@@ -378,17 +547,18 @@ TraceBuffer::BodyResolution TraceBuffer::resolve_body(bits::span<const u8> body)
   // Already promoted? A hash match is not proof of a body match -- the hash is a truncated 32-bit FNV, so two distinct
   // bodies can collide. Substituting a CALL on a collision would replay someone else's memory writes in place of this
   // program's, which is silent and unrecoverable, so confirm the bytes before trusting the entry.
-  if (auto it = _stencil_map.find(hash); it != _stencil_map.end() && stencil_matches(it->second, body)) {
+  auto &stencils = self.stencils;
+  if (auto it = stencils.find(hash); it != stencils.end() && stencil_matches(it->second, body)) {
     it->second.hit_count++;
     return {true, it->second.location};
-  } else if (it != _stencil_map.end()) {
+  } else if (it != stencils.end()) {
     // Collision: this body is not the promoted one. Inline it rather than calling the wrong stencil. It can never be
     // promoted itself, since the hash slot is taken, but correctness beats footprint here.
     return {false, {}};
   }
 
   // Seen once before?
-  if (_pending_hashes.contains(hash)) {
+  if (self.pending.contains(hash)) {
     if (body.size() >= PROMOTION_THRESHOLD) {
       // Promote: copy body to stencil chain.
       // Must append RET to ensure that the caller has an opportunity to run its own postifx.
@@ -396,22 +566,27 @@ TraceBuffer::BodyResolution TraceBuffer::resolve_body(bits::span<const u8> body)
       // does not fit rolls over to a fresh buffer, which would strand the RET and leave the stencil running off the
       // end -- so reserve both up front, exactly as flush_to_ring does for a subroutine.
       auto ret = EncodedOp::Ret<0>{}.encode();
-      _stencils->ensure_capacity(body.size() + ret.size());
-      // reserve() rather than append() so the copy hands back a pointer to where the body landed. Resolving that
-      // afterwards would mean walking the chain, and doing it here -- once per promotion -- keeps it off the hit
-      // path entirely.
-      const auto res = _stencils->reserve(body.size());
-      bits::memcpy(res.bytes, body);
-      _stencils->append({ret.data(), ret.size()});
+      pepp::bts::BufferChain::Reservation res;
+      {
+        // The chain is shared, but a promotion happens once per distinct body, so the lock stays off the hit path.
+        std::lock_guard lock(_stencil_lock);
+        _stencils->ensure_capacity(body.size() + ret.size());
+        // reserve() rather than append() so the copy hands back a pointer to where the body landed. Resolving that
+        // afterwards would mean walking the chain, and doing it here -- once per promotion -- keeps it off the hit
+        // path entirely.
+        res = _stencils->reserve(body.size());
+        bits::memcpy(res.bytes, body);
+        _stencils->append({ret.data(), ret.size()});
+      }
       // The fixed cost of promotion is the unbounded lifetime of the stencil chain, which is amortized over re-uses.
-      _footprint.stencils += body.size() + ret.size();
+      self.footprint.stencils += body.size() + ret.size();
 
       StencilEntry entry{};
       entry.location = res.loc;
       entry.body = res.bytes;
       entry.hit_count = 2;
-      _stencil_map[hash] = entry;
-      _pending_hashes.erase(hash);
+      stencils[hash] = entry;
+      self.pending.erase(hash);
       return {true, res.loc};
     }
     // Below threshold — inline every time, don't re-add to pending.
@@ -419,13 +594,16 @@ TraceBuffer::BodyResolution TraceBuffer::resolve_body(bits::span<const u8> body)
   }
 
   // Maybe first occurrence? Cap the size of pending so that it doesn't grow unboundedly.
-  if (_pending_hashes.size() >= MAX_PENDING_HASHES) _pending_hashes.clear();
-  _pending_hashes.insert(hash);
+  if (self.pending.size() >= MAX_PENDING_HASHES) self.pending.clear();
+  self.pending.insert(hash);
   return {false, {}};
 }
 
-tvm::ProgramLocation TraceBuffer::flush_to_ring(Recording &rec, BodyResolution resolution) {
+tvm::ProgramLocation TraceBuffer::flush_to_ring(Initiator &self, BodyResolution resolution) {
+  auto &rec = self.rec;
   auto &node = node_at(rec.slot);
+  auto &code = node.chains[rec.id.value].code;
+  if (!code) code = _mgr->alloc_chain();
 
   // The subroutine is: [prefix][body or CALL][postfix]
   // There are no separators or terminators between these sections.
@@ -444,13 +622,13 @@ tvm::ProgramLocation TraceBuffer::flush_to_ring(Recording &rec, BodyResolution r
   if (resolution.is_stencil) total += call_enc.size();
   else total += rec.body.size();
 
-  node.code->ensure_capacity(total);
+  code->ensure_capacity(total);
 
   pepp::bts::Buffer::Location subroutine_start{};
   bool have_start = false;
 
   auto append = [&](bits::span<const u8> bytes) {
-    auto loc = node.code->append(bytes);
+    auto loc = code->append(bytes);
     if (!have_start) {
       subroutine_start = loc;
       have_start = true;
@@ -466,10 +644,10 @@ tvm::ProgramLocation TraceBuffer::flush_to_ring(Recording &rec, BodyResolution r
   append({rec.postfix.data(), rec.postfix.size()});
 
   // The number of bytes actually written to the code chain vs the bytes.
-  _footprint.code += total;
+  self.footprint.code += total;
   // What if this body was inlined instead of promoted? Provides a metric for how much stencil promotion is saving us
   // rather than making promotion an optional feature.
-  _footprint.code_if_inlined += rec.prefix.size() + rec.body.size() + rec.postfix.size();
+  self.footprint.code_if_inlined += rec.prefix.size() + rec.body.size() + rec.postfix.size();
 
   // Record where this program starts and where its data starts.
   const tvm::ProgramLocation program{subroutine_start, rec.data_start};
@@ -488,9 +666,138 @@ void TraceBuffer::advance_slot() {
   for (auto &wm : _watermarks)
     if (!wm.fired && occ >= wm.threshold) wm.fired = true, wm.callback();
 
+  // After the watermarks, which may acknowledge slots that would otherwise have been compressed for nothing.
+  freeze_cold();
   // Overflow checking is handled by begin(ID).
 }
 
+// --- Cold storage ---
+
+void TraceBuffer::freeze_cold() {
+  if (_hot_slots == 0) return;
+  for (_cold_from = std::max(_cold_from, _tail); _cold_from + _hot_slots <= _head; ++_cold_from) {
+    auto &node = node_at(_cold_from);
+    if (!node.holds(_cold_from) || node.is_cold()) continue;
+    // An instruction that began here is still appending to the chains. Try again on the next advance, rather than
+    // skipping it, so that _cold_from never passes a hot slot.
+    else if (node.open() > 0) break;
+    freeze(node);
+  }
+}
+
+void TraceBuffer::freeze(Node &node) {
+  // The image is the entries of the location buffer, then a code and a data chain for each initiator that wrote into
+  // the slot, where every buffer is written as (id, bytes used, bytes). The ids are what let thaw() find the words
+  // that name them.
+  std::vector<u8> image;
+  auto put = [&image](std::unsigned_integral auto value) {
+    for (std::size_t it = 0; it < sizeof(value); ++it) image.push_back(static_cast<u8>(value >> (8 * it)));
+  };
+  auto put_buffer = [&](const pepp::bts::Buffer &buf, std::size_t used) {
+    put(buf.id().value), put(static_cast<u32>(used));
+    image.insert(image.end(), buf.data(), buf.data() + used);
+  };
+  auto put_chain = [&](const std::unique_ptr<pepp::bts::BufferChain> &chain) {
+    const u16 count = chain ? chain->buffer_count() : 0;
+    put(count);
+    for (u16 it = 0; it < count; ++it) {
+      const auto &buf = *chain->buffer(std::size_t{it});
+      put_buffer(buf, buf.used_capacity());
+    }
+  };
+  const auto in_use = [](const Node::Chains &lane) {
+    return (lane.code && lane.code->buffer_count()) || (lane.data && lane.data->buffer_count());
+  };
+
+  // A slot that reserved entries but has no location buffer cannot exist, since begin() allocates one.
+  assert(node.locations != nullptr && "freeze() of a slot with no location buffer");
+  // The location buffer is claimed whole, so only the entries handed out are worth keeping.
+  put_buffer(*node.locations, node.count() * sizeof(ProgramLocation));
+  put(static_cast<u16>(std::ranges::count_if(node.chains, in_use)));
+  for (std::size_t it = 0; it < node.chains.size(); ++it) {
+    if (!in_use(node.chains[it])) continue;
+    put(static_cast<u16>(it));
+    put_chain(node.chains[it].code), put_chain(node.chains[it].data);
+  }
+
+  node.cold = pepp::lz::compress(image);
+  node.cold_size = image.size();
+  node.release(*_mgr);
+}
+
+void TraceBuffer::thaw(std::size_t absolute_slot) {
+  auto &node = node_at(absolute_slot);
+  std::vector<u8> image(node.cold_size);
+  if (!pepp::lz::decompress(node.cold, image))
+    throw std::runtime_error("TraceBuffer: compressed slot " + std::to_string(absolute_slot) + " is corrupt");
+
+  // Old id -> new id. A slot holds a handful of buffers, so a linear search beats hashing.
+  std::vector<std::pair<u16, u16>> ids;
+  auto remap = [&ids](u16 id) {
+    for (const auto &[from, to] : ids)
+      if (from == id) return to;
+    return id;
+  };
+  ImageReader in{image.data()};
+  auto get_chain = [&](pepp::bts::BufferChain &chain) {
+    const auto count = in.get<u16>();
+    for (u16 it = 0; it < count; ++it) {
+      const auto id = in.get<u16>();
+      const auto used = in.get<u32>();
+      // One record per buffer, so the chain keeps its shape and a DP that walks off the end of one buffer still lands
+      // where it did before.
+      if (it != 0) chain.ensure_capacity(pepp::bts::Buffer::SIZE);
+      const auto res = chain.reserve(used);
+      bits::memcpy(res.bytes, in.bytes(used));
+      ids.emplace_back(id, res.loc.id.value);
+    }
+  };
+
+  in.get<u16>();
+  const auto location_bytes = in.bytes(in.get<u32>());
+  for (auto lanes = in.get<u16>(); lanes > 0; --lanes) {
+    auto &lane = node.chains[in.get<u16>() & 0xFF];
+    for (auto *chain : {&lane.code, &lane.data}) {
+      if (!*chain) *chain = _mgr->alloc_chain();
+      get_chain(**chain);
+    }
+  }
+
+  for (auto &lane : node.chains) {
+    if (!lane.code) continue;
+    for (u16 it = 0; it < lane.code->buffer_count(); ++it) {
+      auto *buf = lane.code->buffer(std::size_t{it});
+      remap_code({buf->data(), buf->used_capacity()}, remap);
+    }
+  }
+  node.locations = _mgr->alloc_buffer();
+  bits::memcpy(node.locations->span().first(location_bytes.size()), location_bytes);
+  node.locations->allocate_uninitialized(location_bytes.size());
+  for (std::size_t offset = 0; offset + sizeof(ProgramLocation) <= location_bytes.size();
+       offset += sizeof(ProgramLocation)) {
+    ProgramLocation program;
+    std::memcpy(&program, node.locations->data() + offset, sizeof(program));
+    program.code.id = pepp::bts::Buffer::ID{remap(program.code.id.value)};
+    program.data.id = pepp::bts::Buffer::ID{remap(program.data.id.value)};
+    std::memcpy(node.locations->data() + offset, &program, sizeof(program));
+  }
+
+  _thawed.push_back(absolute_slot);
+  while (_thawed.size() > THAWED_SLOTS) {
+    const auto oldest = _thawed.front();
+    _thawed.pop_front();
+    // It may have been acknowledged, and its node taken by a newer slot, since it was thawed.
+    if (auto &old = node_at(oldest); old.holds(oldest) && old.is_cold()) old.release(*_mgr);
+  }
+}
+
+const TraceBuffer::Node *TraceBuffer::readable_node(size_t absolute_slot) const {
+  const Node *node = resident_node(absolute_slot);
+  if (node != nullptr && node->locations == nullptr && node->is_cold())
+    const_cast<TraceBuffer *>(this)->thaw(absolute_slot);
+  return node;
+}
+
 // --- Location buffer I/O ---
 
 void TraceBuffer::write_location(Node &node, u16 entry, tvm::ProgramLocation program) {
@@ -498,15 +805,12 @@ void TraceBuffer::write_location(Node &node, u16 entry, tvm::ProgramLocation pro
   // begin() advances the slot before handing out an index that would overflow, so every reserved entry fits.
   assert(entry < MAX_LOCATION_ENTRIES && "location buffer overflow: entry written without a matching begin() reservation");
   // begin() allocates the location buffer when it reserves an index, so the buffer is always present here.
+  // Interleaved recordings may commit out of order, so an entry at index 5 can be written before index 3. The buffer
+  // was claimed at full size, so that is just a store.
   assert(node.locations != nullptr && "write_location() into a slot with no location buffer");
   u16 offset = entry * sizeof(tvm::ProgramLocation);
   auto *dst = node.locations->data() + offset;
   std::memcpy(dst, &program, sizeof(program));
-  // Interleaved recordings may commit out of order, so an entry at index 5 can be written before index 3. Extend
-  // the buffer's used_capacity to cover this entry if it's the high-water mark so far.
-  size_t required = offset + sizeof(tvm::ProgramLocation);
-  if (node.locations->used_capacity() < required)
-    node.locations->allocate_uninitialized(required - node.locations->used_capacity());
 }
 
 tvm::ProgramLocation TraceBuffer::read_location(const Node &node, u16 entry) const {
@@ -522,16 +826,16 @@ tvm::ProgramLocation TraceBuffer::read_location(const Node &node, u16 entry) con
 
 // --- Cursor / Iteration ---
 
-Cursor TraceBuffer::cursor() const { return {_head, current_node().count}; }
+Cursor TraceBuffer::cursor() const { return {_head, current_node().count()}; }
 
 Cursor TraceBuffer::committed_cursor() const {
-  // Walk back to the earliest reservation still open. _recordings holds one entry per initiator that has ever
-  // recorded — one or two in practice — so a scan is cheaper than maintaining a running minimum that would have to
-  // be recomputed whenever the holder of the minimum closed.
-  Cursor stable{_head, current_node().count};
-  for (const auto &[id, rec] : _recordings) {
-    if (!rec.active) continue;
-    if (const Cursor at{rec.slot, rec.entry}; at < stable) stable = at;
+  // Walk back to the earliest reservation still open. Only one or two initiators record in practice, so a scan is
+  // cheaper than maintaining a running minimum that would have to be recomputed whenever the holder of the minimum
+  // closed.
+  Cursor stable{_head, current_node().count()};
+  for (const auto &state : _initiators) {
+    if (!state || !state->rec.active) continue;
+    if (const Cursor at{state->rec.slot, state->rec.entry}; at < stable) stable = at;
   }
   return stable;
 }
@@ -549,7 +853,7 @@ TraceBuffer::Iterator::Iterator(const TraceBuffer *tb, Cursor cursor) : _tb(tb),
 
 TraceBuffer::Iterator::reference TraceBuffer::Iterator::operator*() const {
   // If not resident, returns nullptr rather than returning a pointer to an overwritten location.
-  const Node *node = _tb->resident_node(_cursor.slot);
+  const Node *node = _tb->readable_node(_cursor.slot);
   if (node == nullptr) return {};
   return _tb->read_location(*node, _cursor.entry);
 }
@@ -1,8 +1,12 @@
 #pragma once
+#include <array>
+#include <atomic>
 #include <bitset>
+#include <deque>
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -78,7 +82,7 @@ struct Recording {
   // Reserving these values at begin() allows safe interleaving of initiators.
   std::size_t slot = 0;
   u16 entry = 0;
-  // Memoize the result of data_chain to avoid a map lookup on every traced write. Resolved once per recording now
+  // Memoize the result of data_chain to avoid a node lookup on every traced write. Resolved once per recording now
   // that the slot cannot move underneath it; begin() clears it.
   pepp::bts::BufferChain *chain = nullptr;
 };
@@ -112,11 +116,25 @@ struct Recording {
 // frequently. There are only a limited number of meaningful memory access patterns in Pep/10, so I expect a high
 // stencil hit rate over time.
 //
-// Each initiator gets its own data chain within a ring slot, and data is written immediately rather than being
-// buffered like code. Private chains prevent interleaved data from multiple initiators from causing spurious
+// A ring is bounded by the BufferManager's id space (4095 live buffers) long before it is bounded by memory. With
+// set_hot_slots(), only the newest slots keep their buffers; an older slot is compressed as it leaves that window and
+// its buffers go back to the manager. Reading a cold slot through an Iterator decompresses it into fresh buffers,
+// which are released again once a few other cold slots have been read. Only the Buffer::IDs change, and the location
+// entries and code are patched to match, so a replay cannot tell a decompressed slot from one that never left.
+//
+// Each initiator gets its own code and data chains within a ring slot, and data is written immediately rather than
+// being buffered like code. Private chains prevent interleaved data from multiple initiators from causing spurious
 // stencil dedup failures. Chains are created on first write from an initiator, so the cost is one chain per initiator
 // actually recording not one per Device::ID.
 //
+// Initiators may record from different threads, one thread per initiator. Everything a recording touches between
+// begin() and commit() is private to its initiator -- the scratch vectors, the slot's chains, the stencil tables and
+// the footprint counters -- except for the entry it reserves, which begin() claims with a CAS on the head node. The
+// ring lock is only taken once per slot, to advance the head and claim the next node, and the stencil lock only when a
+// body is promoted. Stencils are therefore deduplicated per initiator, which costs little since two devices rarely
+// emit the same body. Callbacks run on whichever recording thread crosses a slot boundary. Everything outside the
+// recording API (acknowledge, iteration, clear, the setters) must not overlap with a recording.
+//
 // For a typical Pep/N trace, I expect programs to be as follows.
 //   prefix:  Record current wall time with ASYN, or the wall-time delta with ISYN
 //   body:    setmem/setreg paired with DP updated (ACCDP/INCDP/LDP)
@@ -164,6 +182,8 @@ public:
   // Throws RingOverflow if this call would destroy data (i.e., this advances to a new slot, and that slot is in use).
   // This is the only place that refusal is raised, so an instruction that gets past begin() is guaranteed somewhere to
   // commit into. Nothing is opened when it throws.
+  //
+  // Lock-free unless this call is the one that finds the head slot full or unclaimed.
   void begin(Device::ID initiator);
 
   // Finalize the current recording. Appends HALT to the postfix, hashes the body, checks for stencil promotion,
@@ -246,6 +266,34 @@ public:
   using WatermarkCallback = std::function<void()>;
   void on_watermark(float threshold, WatermarkCallback cb);
 
+  // Register a callback for when the first program of a ring slot is about to begin while no other recording is open.
+  // At that moment the machine is exactly at the callback's cursor, {slot, 0}, which makes it the place to snapshot
+  // state (see tvm::Checkpoints). A slot whose first program overlaps another initiator's recording is skipped.
+  using SlotCallback = std::function<void(Cursor)>;
+  void on_slot_begin(SlotCallback cb);
+
+  // --- Cold storage ---
+
+  // Keep only the newest `slots` ring slots, the head included, in live buffers. Older slots are compressed once no
+  // recording is open in them, and decompressed on demand by an Iterator that reads them. 0, the default, never
+  // compresses. Lowering it compresses immediately; raising it (or disabling it) leaves already-cold slots cold.
+  //
+  // A ProgramLocation read from a cold slot names buffers that only live until THAWED_SLOTS other cold slots have
+  // been read, so use it before dereferencing the next slot rather than collecting locations up front.
+  void set_hot_slots(std::size_t slots);
+  std::size_t hot_slots() const { return _hot_slots; }
+  // Cold slots kept decompressed at once. Two let a replay cross from one cold slot into the next without thrashing.
+  static constexpr std::size_t THAWED_SLOTS = 2;
+
+  struct ColdFootprint {
+    // Resident slots held in compressed form.
+    std::size_t slots = 0;
+    // Bytes those slots' location buffers and chains held before compression, and after.
+    std::size_t raw = 0, compressed = 0;
+    double ratio() const { return compressed ? (double)raw / (double)compressed : 0.0; }
+  };
+  ColdFootprint cold_footprint() const;
+
   // Mark all slots with index < up_to.slot as consumed.
   // Frees their code and data chains back to the buffer manager.
   void acknowledge(Cursor up_to);
@@ -318,6 +366,8 @@ public:
   //
   // Equal to cursor() when nothing is recording, which is every instruction boundary in a single-initiator system.
   Cursor committed_cursor() const;
+  // Cursor of the oldest entry still held, i.e. the first one acknowledge() has not released.
+  Cursor oldest_cursor() const { return {_tail, 0}; }
 
   // --- Data chain navigation ---
   // Search all ring nodes' data chains for the successor of the given buffer ID.
@@ -331,8 +381,8 @@ public:
   std::size_t ring_size() const { return _ring.size(); }
   // Number of distinct initiators that have ever recorded. Entries persist after commit() so their scratch capacity
   // is reused, so this counts devices seen, not devices currently recording.
-  std::size_t recording_count() const { return _recordings.size(); }
-  std::size_t instruction_count() const { return _footprint.programs; }
+  std::size_t recording_count() const;
+  std::size_t instruction_count() const { return footprint().programs; }
   // Current ring occupancy: (_head - _tail) / ring_size.
   float ring_occupancy() const;
 
@@ -371,7 +421,8 @@ public:
     // >1 means promotion is winning. Counts bytes written, not buffers reserved -- see buffer_footprint() for that.
     double compression_ratio() const { return total() ? (double)total_if_inlined() / (double)total() : 0.0; }
   };
-  // A snapshot, by value: callers routinely take one before a run and another after, and compare them.
+  // A snapshot, by value: callers routinely take one before a run and another after, and compare them. Summed over
+  // initiators, which each count their own.
   Footprint footprint() const;
 
   // Reset all footprint /counters/ to 0 while retaining all other state inside the class.
@@ -385,53 +436,83 @@ public:
   std::size_t buffer_footprint() const;
 
   // --- Inspect stencil promotion, mostly used for tests
+  // Each initiator promotes its own bodies, so these sum (or search) over initiators.
   // Hash a byte span using the same function as resolve_body.
   static u32 hash(bits::span<const u8> data);
   // Number of promoted stencils.
-  size_t stencil_count() const { return _stencil_map.size(); }
+  size_t stencil_count() const;
   // Number of hashes seen once (awaiting second occurrence).
-  size_t pending_count() const { return _pending_hashes.size(); }
+  size_t pending_count() const;
   // True if this hash has been promoted to the stencil chain.
-  bool is_stencil(u32 h) const { return _stencil_map.contains(h); }
+  bool is_stencil(u32 h) const;
   // True if this hash has been seen once but not yet promoted.
-  bool is_pending(u32 h) const { return _pending_hashes.contains(h); }
+  bool is_pending(u32 h) const;
   // Hit count for a promoted stencil. Returns 0 if not promoted.
   u32 stencil_hits(u32 h) const;
   // Size of a promoted stencil body (bytes). Returns 0 if not promoted.
   u16 stencil_size(u32 h) const;
+  // True if `id` is a buffer in the stencil chain. Code there is never rewritten before clear(), so it is safe to
+  // compile ahead of time (see StencilTable).
+  bool is_stencil_code(pepp::bts::Buffer::ID id) const { return _stencils->buffer(id) != nullptr; }
+  // Incremented by every clear(), the only operation that invalidates stencil code.
+  std::size_t stencil_generation() const { return _stencil_generation; }
 
 private:
   // --- Ring node ---
-  // Absolute slot index meaning "this node holds nothing". _head never approaches it.
-  static constexpr std::size_t NO_SLOT = SIZE_MAX;
-
   struct Node {
-    // Which absolute ring slot currently occupies this node, or NO_SLOT when it holds nothing.
+    // One word, so that begin() can check the stamp, reserve an entry and open it with a single CAS:
+    //   [63:32] slot stamp   [31:16] count   [15:0] open
     //
-    // A Cursor names an *absolute* slot, but a node is found by absolute_slot % ring_size -- so slot 1 and slot 5 of a
+    // The stamp is which absolute ring slot currently occupies this node, or EMPTY when it holds nothing. A Cursor
+    // names an *absolute* slot, but a node is found by absolute_slot % ring_size -- so slot 1 and slot 5 of a
     // four-slot ring are the same node. Without this stamp an iterator into a slot the ring had since reused would
     // silently read the newer slot's entries and hand back a real-looking program from the wrong point in history.
-    // Comparing against it turns that into a null location, which fails loudly on replay instead.
+    // Comparing against it turns that into a null location, which fails loudly on replay instead. It doubles as the
+    // "this slot holds unacknowledged trace" flag begin() refuses to write over. Only the low 32 bits of a slot are
+    // kept, which aliases after 2^45 programs.
     //
-    // It doubles as the "this slot holds unacknowledged trace" flag begin() refuses to write over.
-    std::size_t slot = NO_SLOT;
-    // Location buffer: array of Buffer::Locations, one per traced instruction.
+    // count is the number of times begin() has been called on this slot, which is also the number of location-buffer
+    // entries in use. Never decremented. An entry that has not yet been committed holds a tombstone (a program that
+    // immediately halts).
+    //
+    // open is the number of recordings currently open in this slot (incremented by begin(), decremented by
+    // commit()/abort()). acknowledge() will not reclaim a slot while open > 0, because an open recording is still
+    // appending to its chains.
+    std::atomic<u64> state = EMPTY;
+    static constexpr u64 EMPTY = u64{0xFFFF'FFFF} << 32;
+    // Added by begin(): one more entry, and one more recording open.
+    static constexpr u64 RESERVE = (u64{1} << 16) | 1;
+    static constexpr u64 claimed(std::size_t slot) { return u64{static_cast<u32>(slot)} << 32; }
+    static constexpr bool holds(u64 state, std::size_t slot) { return (state >> 32) == static_cast<u32>(slot); }
+    static constexpr u16 count_of(u64 state) { return static_cast<u16>(state >> 16); }
+    static constexpr u16 open_of(u64 state) { return static_cast<u16>(state); }
+    bool holds(std::size_t slot) const { return holds(state.load(std::memory_order_acquire), slot); }
+    bool is_empty() const { return (state.load(std::memory_order_acquire) & ~u64{0xFFFF'FFFF}) == EMPTY; }
+    u16 count() const { return count_of(state.load(std::memory_order_acquire)); }
+    u16 open() const { return open_of(state.load(std::memory_order_acquire)); }
+
+    // Location buffer: array of Buffer::Locations, one per traced instruction. Allocated at full size when the slot is
+    // claimed, so that initiators writing their own entries never race to extend it.
     pepp::bts::Buffer *locations = nullptr;
-    // Code chain: subroutine bodies, which are prefix + body/CALL + postfix
-    std::unique_ptr<pepp::bts::BufferChain> code;
-    // One data chain per initiator writing into this slot, so that concurrent recorders cannot fragment each other's
-    // payloads. Created on first write and then kept across reset() -- a cleared chain owns no buffers, so a retained
-    // entry costs one map node and saves rebuilding the chain for an initiator that records here again.
-    std::unordered_map<Device::ID, std::unique_ptr<pepp::bts::BufferChain>, pepp::handle_hash<Device::ID>> data;
-    // Number of times begin() has been called on this slot, which is also the number of location-buffer entries in
-    // use. Never decremented. An entry that has not yet been committed holds a tombstone (a program that immediately
-    // halts).
-    u16 count = 0;
-    // Number of recordings currently open in this slot (incremented by begin(), decremented by commit()/abort()).
-    // acknowledge() will not reclaim a slot while open > 0, because an open recording is still appending to its
-    // chains.
-    u16 open = 0;
-
+    // One code chain (prefix + body/CALL + postfix) and one data chain per initiator writing into this slot, so that
+    // concurrent recorders can neither fragment each other's payloads nor contend on an append. Indexed by Device::ID,
+    // so that finding one touches nothing another initiator might be creating. Created on first write and then kept
+    // across reset() -- a cleared chain owns no buffers, and keeping it saves rebuilding the chain for an initiator
+    // that records here again.
+    struct Chains {
+      std::unique_ptr<pepp::bts::BufferChain> code, data;
+    };
+    std::array<Chains, 256> chains;
+    // Compressed image of the location buffer and chains, which a slot gains when it leaves the hot window. While
+    // present it is the slot's real contents, and the buffers above are a decompressed cache of it, absent
+    // (locations == nullptr) until an Iterator reads the slot.
+    std::vector<u8> cold;
+    // Size of that image before compression.
+    std::size_t cold_size = 0;
+
+    bool is_cold() const { return !cold.empty(); }
+    // Return the location buffer and chain buffers to the pool, but keep everything else.
+    void release(pepp::bts::BufferManager &mgr);
     void reset(pepp::bts::BufferManager &mgr);
   };
 
@@ -455,18 +536,40 @@ private:
     // If is_stencil: location in stencil chain (target of CALL).
     pepp::bts::Buffer::Location location;
   };
-  BodyResolution resolve_body(bits::span<const u8> body);
+  // Everything a recording touches that is not already in its Recording, kept per initiator so that recording needs
+  // no lock.
+  struct Initiator {
+    Recording rec;
+    std::unordered_map<u32, StencilEntry> stencils;
+    // Hashes seen once but not yet promoted. On second occurrence with
+    // body.size() >= PROMOTION_THRESHOLD, the body is promoted to _stencils.
+    std::unordered_set<u32> pending;
+    Footprint footprint;
+  };
+  Initiator &owner(const Recording &rec) { return *_initiators[rec.id.value]; }
+
+  BodyResolution resolve_body(Initiator &self, bits::span<const u8> body);
   // True when the stencil recorded in `entry` holds exactly `body`. resolve_body keys stencils on a truncated
   // 32-bit hash, so a map hit alone does not prove the bodies match; this is what makes a collision safe.
   static bool stencil_matches(const StencilEntry &entry, bits::span<const u8> body);
-  tvm::ProgramLocation flush_to_ring(Recording &rec, BodyResolution resolution);
+  tvm::ProgramLocation flush_to_ring(Initiator &self, BodyResolution resolution);
 
   // This recording's data chain in the ringbuffer's head slot, creating the chain on first use.
   pepp::bts::BufferChain &data_chain(Recording &rec);
 
-  // Advance _head to the next ring slot. Fires watermark callbacks as needed.
+  // Slow path of begin(), taken when the head slot `seen` was full or unclaimed. Under the ring lock, advances past a
+  // full slot and claims the next node, unless another initiator got there first. Throws RingOverflow.
+  void open_head(std::size_t seen);
+  // Advance _head to the next ring slot. Fires watermark callbacks as needed. Requires the ring lock.
   void advance_slot();
 
+  // Compress every slot that has left the hot window, up to the first one that still has a recording open.
+  void freeze_cold();
+  // Replace a slot's buffers with its compressed image.
+  void freeze(Node &node);
+  // Rebuild a cold slot's buffers from its image, releasing the least recently thawed slot if too many are.
+  void thaw(std::size_t absolute_slot);
+
   // Write a ProgramLocation into a slot's location buffer at position `entry`.
   void write_location(Node &node, u16 entry, tvm::ProgramLocation program);
   // Read back the ProgramLocation stored at an index in the location buffer.
@@ -484,12 +587,15 @@ private:
   // instead of two. _ring.size() is a runtime value, so we would have to idiv twice.
   const Node *resident_node(size_t absolute_slot) const {
     const Node &node = node_at(absolute_slot);
-    return node.slot == absolute_slot ? &node : nullptr;
+    return node.holds(absolute_slot) ? &node : nullptr;
   }
+  // resident_node(), with a cold slot's buffers rebuilt if they were released. Decompressing a slot leaves its
+  // contents as they were, so readers of a const TraceBuffer may do it; this is the only place that casts away const.
+  const Node *readable_node(size_t absolute_slot) const;
   // Entries readable at `absolute_slot`, or 0 when the ring has moved on and that slot is no longer resident.
   u16 count_at(size_t absolute_slot) const {
     const Node *node = resident_node(absolute_slot);
-    return node == nullptr ? 0 : node->count;
+    return node == nullptr ? 0 : node->count();
   }
 
   std::shared_ptr<pepp::bts::BufferManager> _mgr;
@@ -497,26 +603,32 @@ private:
   std::vector<Node> _ring;
   // _head and _tail may exceed the size of _ring.
   // they must always be taken % _ring.size().
-  std::size_t _head = 0; // Next slot to write
-  std::size_t _tail = 0; // Oldest unconsumed slot
-
-  // Only devices that actually initiate accesses ever appear. That set is not known until a device starts
-  // recording. Sizing this to the Device::ID space would allocate hundreds of idle std::vectors to serve the one or two
-  // are actual initiators. Entries are created on first begin() and then kept, so a device's scratch buffers
-  // keep their capacity across programs instead of reallocating on every instruction.
-  std::unordered_map<Device::ID, Recording, pepp::handle_hash<Device::ID>> _recordings;
-
-  // Stencils are only freed on TraceBuffer destruction to avoid lifetime management issues.
+  std::atomic<std::size_t> _head = 0; // Next slot to write
+  std::size_t _tail = 0;              // Oldest unconsumed slot
+  // Held to advance _head and claim the node it lands on. See open_head().
+  std::mutex _ring_lock;
+
+  // See set_hot_slots(). _cold_from is the oldest slot freeze_cold() has not yet compressed.
+  std::size_t _hot_slots = 0, _cold_from = 0;
+  // Absolute indices of cold slots whose buffers are rebuilt, oldest first. May name slots acknowledged since.
+  std::deque<std::size_t> _thawed;
+
+  // Indexed by Device::ID, so that an initiator finds its own entry without looking anything up in a structure another
+  // thread may be inserting into. Only the pointers are sized to the Device::ID space; an entry is created on the
+  // initiator's first begin() and then kept, so a device's scratch buffers keep their capacity across programs instead
+  // of reallocating on every instruction.
+  std::array<std::unique_ptr<Initiator>, 256> _initiators;
+
+  // Stencils are only freed on TraceBuffer destruction to avoid lifetime management issues. Shared by all initiators,
+  // so appending to it takes _stencil_lock; that only happens on a promotion.
   std::unique_ptr<pepp::bts::BufferChain> _stencils;
+  std::mutex _stencil_lock;
   // Buffer::ID{0} hard-stops the interpreter with InvalidIBuffer, which causes run_each to break. A single aborted
   // instruction halts the entire replay. To prevent ID==0 from appearing in reserved slots, point to a valid program
   // which contains only HALT. This program is allocated on the stencil chain in the ctor, and the location is stored
   // here.
   tvm::ProgramLocation _tombstone{};
-  std::unordered_map<u32, StencilEntry> _stencil_map;
-  // Hashes seen once but not yet promoted. On second occurrence with
-  // body.size() >= PROMOTION_THRESHOLD, the body is promoted to _stencils.
-  std::unordered_set<u32> _pending_hashes;
+  std::size_t _stencil_generation = 0;
 
   // Watermark callbacks are fired when the number of used ring slots crosses a threshold (0.0 to 1.0).
   struct Watermark {
@@ -528,13 +640,11 @@ private:
   TraceableFinder _finder = [](Device::ID) -> Traceable * { return nullptr; };
 
   std::vector<Watermark> _watermarks;
+  std::vector<SlotCallback> _slot_callbacks;
   // Both indexed by Device::ID, whose underlying type is u8. 32 bytes each, and a lookup is a word load plus a bit
   // test and cheap enough to sit on the per-write path.
   std::bitset<256> _traced;
   std::bitset<256> _address_in_payload;
-
-  // Accumulated performance counters.
-  Footprint _footprint;
 };
 
 } // namespace tvm
@@ -0,0 +1,67 @@
+#include "watchpoints.hpp"
+#include <stdexcept>
+
+std::size_t WatchpointSet::add(AddressSpan span, Kind kind) {
+  if (kind == Kind::None) throw std::logic_error("Watchpoint must watch reads, writes, or changes");
+  _watchpoints.emplace_back(Watchpoint{.span = span, .kind = kind});
+  rebuild_pages();
+  return _watchpoints.size() - 1;
+}
+
+void WatchpointSet::remove(std::size_t index) {
+  if (index >= _watchpoints.size()) return;
+  _watchpoints.erase(_watchpoints.begin() + index);
+  // A hit refers to a watchpoint by index, which may have just been invalidated.
+  _hit = std::nullopt;
+  rebuild_pages();
+}
+
+void WatchpointSet::clear() {
+  _watchpoints.clear();
+  _pages.clear();
+  _has_change = false;
+  _hit = std::nullopt;
+}
+
+std::span<const WatchpointSet::Watchpoint> WatchpointSet::watchpoints() const { return _watchpoints; }
+
+std::size_t WatchpointSet::count() const { return _watchpoints.size(); }
+
+const std::optional<WatchpointSet::Hit> &WatchpointSet::hit() const { return _hit; }
+
+void WatchpointSet::clear_hit() { _hit = std::nullopt; }
+
+bool WatchpointSet::check(Address address, std::size_t length, Kind kind, bits::span<const u8> prior,
+                          bits::span<const u8> src) {
+  using pepp::core::intersects;
+  const auto access = AddressSpan(address, Address(address + length - 1));
+  for (std::size_t it = 0; it < _watchpoints.size(); it++) {
+    const auto &wp = _watchpoints[it];
+    if (!intersects(access, wp.span)) continue;
+    Kind triggered = Kind::None;
+    if (kind == Kind::Read) triggered = static_cast<Kind>(wp.kind & Kind::Read);
+    else if (wp.kind & Kind::Write) triggered = Kind::Write;
+    else if (wp.kind & Kind::Change) {
+      // Only compare the bytes which fall inside the watched range.
+      const auto lower = std::max(access.lower(), wp.span.lower()), upper = std::min(access.upper(), wp.span.upper());
+      const auto offset = lower - address, overlap = upper - lower + 1;
+      if (!std::equal(prior.begin() + offset, prior.begin() + offset + overlap, src.begin() + offset))
+        triggered = Kind::Change;
+    }
+    if (triggered == Kind::None) continue;
+    if (!_hit) _hit = Hit{.index = it, .address = address, .kind = triggered};
+    return true;
+  }
+  return false;
+}
+
+void WatchpointSet::rebuild_pages() {
+  _pages.clear();
+  _has_change = false;
+  for (const auto &wp : _watchpoints) {
+    _has_change |= (wp.kind & Kind::Change) != 0;
+    const std::size_t first = wp.span.lower() >> PageBits, last = wp.span.upper() >> PageBits;
+    if (last / 64 >= _pages.size()) _pages.resize(last / 64 + 1, 0);
+    for (auto page = first; page <= last; page++) _pages[page / 64] |= u64{1} << (page % 64);
+  }
+}
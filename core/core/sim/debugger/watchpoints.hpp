@@ -0,0 +1,104 @@
+#pragma once
+#include <array>
+#include <optional>
+#include <vector>
+#include "core/math/bitmanip/span.hpp"
+#include "core/sim/api/memory.hpp"
+
+// Data watchpoints over address ranges of a single Target, checked by the target itself as guest accesses occur.
+// Addresses are in the address space of whatever Target the set is attached to (i.e., bus addresses when attached to
+// a SimpleBus, device-relative addresses when attached directly to a RAM).
+//
+// Targets hold a nullable pointer to a WatchpointSet, so a target with no watchpoints pays a single branch per access.
+// With a set attached, accesses are first filtered by a bitmap of watched pages, and only accesses which touch a
+// watched page walk the list of watchpoints.
+class WatchpointSet {
+public:
+  enum Kind : u8 {
+    None = 0,
+    Read = 1 << 0,
+    Write = 1 << 1,
+    // Only writes which change the contents of the range. Requires the target to read the prior value.
+    Change = 1 << 2,
+  };
+  struct Watchpoint {
+    AddressSpan span;
+    Kind kind = Kind::Write;
+  };
+  // The first access to trigger a watchpoint since the last clear_hit().
+  struct Hit {
+    std::size_t index;
+    Address address;
+    Kind kind;
+  };
+  // Watched pages are 256 bytes, which keeps the bitmap for a 16-bit address space within 32 bytes.
+  static constexpr u8 PageBits = 8;
+
+  // Returns the index of the new watchpoint. Indices are stable until remove() or clear().
+  std::size_t add(AddressSpan span, Kind kind);
+  void remove(std::size_t index);
+  void clear();
+  std::span<const Watchpoint> watchpoints() const;
+  std::size_t count() const;
+
+  const std::optional<Hit> &hit() const;
+  void clear_hit();
+
+  // Called by targets for every access which passes their bounds checks. Return true if a watchpoint was triggered.
+  inline bool on_read(Address address, std::size_t length, Operation op);
+  // read_prior(span<u8>) must fill its argument with the current contents at address. It is only called when the set
+  // contains a Change watchpoint and the access touches a watched page, so plain writes never read memory twice.
+  template <typename ReadPrior>
+  inline bool on_write(Address address, bits::span<const u8> src, Operation op, ReadPrior &&read_prior);
+
+  // Only accesses made by the guest trigger watchpoints. A debugger inspecting memory, or the trace buffer applying a
+  // step back, must not.
+  static constexpr bool is_watched_operation(Operation op) noexcept { return is_performance_countable(op); }
+
+private:
+  bool touches_watched_page(Address address, std::size_t length) const;
+  // Out of line, since it is only reached when an access touches a watched page.
+  bool check(Address address, std::size_t length, Kind kind, bits::span<const u8> prior, bits::span<const u8> src);
+  void rebuild_pages();
+
+  std::vector<Watchpoint> _watchpoints;
+  // Bit n is set if any watchpoint overlaps page n. Sized to the highest watched page.
+  std::vector<u64> _pages;
+  std::optional<Hit> _hit = std::nullopt;
+  bool _has_change = false;
+};
+
+inline constexpr WatchpointSet::Kind operator|(WatchpointSet::Kind lhs, WatchpointSet::Kind rhs) {
+  return static_cast<WatchpointSet::Kind>(static_cast<u8>(lhs) | static_cast<u8>(rhs));
+}
+
+/*
+ * Inline implementations
+ */
+inline bool WatchpointSet::touches_watched_page(Address address, std::size_t length) const {
+  const std::size_t first = address >> PageBits, last = (address + length - 1) >> PageBits;
+  for (auto page = first; page <= last; page++) {
+    if (page / 64 >= _pages.size()) return false;
+    else if (_pages[page / 64] & (u64{1} << (page % 64))) return true;
+  }
+  return false;
+}
+
+inline bool WatchpointSet::on_read(Address address, std::size_t length, Operation op) {
+  if (!is_watched_operation(op) || !touches_watched_page(address, length)) return false;
+  return check(address, length, Kind::Read, {}, {});
+}
+
+template <typename ReadPrior>
+inline bool WatchpointSet::on_write(Address address, bits::span<const u8> src, Operation op, ReadPrior &&read_prior) {
+  if (!is_watched_operation(op) || !touches_watched_page(address, src.size())) return false;
+  else if (!_has_change) return check(address, src.size(), Kind::Write, {}, src);
+  // Accesses are at most a few bytes wide in the common case. Larger ones (e.g., loading a program) spill to the heap.
+  std::array<u8, 8> small;
+  std::vector<u8> large;
+  bits::span<u8> prior{};
+  if (src.size() <= small.size()) prior = bits::span<u8>{small.data(), src.size()};
+  else large.resize(src.size()), prior = bits::span<u8>{large.data(), large.size()};
+  read_prior(prior);
+  return check(address, src.size(), Kind::Write, prior, src);
+}
@@ -165,6 +165,7 @@ Target::Result SimpleBus::read(Address address, bits::span<u8> dst, Operation op
   if (auto max_addr = (address + std::max<Address>(0, dst.size() - 1));
       address < span.lower() || max_addr > span.upper())
     throw E(E::Type::OOBAccess, address);
+  Result ret{};
   for (auto [offset, length] = T{0, dst.size()}; length > 0;) {
     auto region = _addrs.region_at(address + offset);
     if (!region) throw E(E::Type::Unmapped, address + offset);
@@ -174,11 +175,13 @@ Target::Result SimpleBus::read(Address address, bits::span<u8> dst, Operation op
     auto usable_len = std::min<size_t>(length, pepp::core::size_inclusive(dev->span()));
     // Convert bus address => device address
     auto src = offset_map<Address>(address + offset, region->from, region->to);
-    // TODO: stop ignoring the result of the write. If the device returns an error, we should propagate it.
-    (void)dev->read(src, dst.subspan(offset, usable_len), op);
+    // TODO: stop ignoring the delay of the read. If the device returns an error, we should propagate it.
+    ret.pause |= dev->read(src, dst.subspan(offset, usable_len), op).pause;
     offset += usable_len, length -= usable_len;
   }
-  return {};
+  if (_watch) [[unlikely]]
+    ret.pause |= _watch->on_read(address, dst.size(), op);
+  return ret;
 }
 
 Target::Result SimpleBus::write(Address address, bits::span<const u8> src, Operation op) {
@@ -189,6 +192,14 @@ Target::Result SimpleBus::write(Address address, bits::span<const u8> src, Opera
   if (auto max_addr = (address + std::max<Address>(0, src.size() - 1));
       address < span.lower() || max_addr > span.upper())
     throw E(E::Type::OOBAccess, address);
+  Result ret{};
+  // The bus holds no data of its own, so the prior value for change watchpoints must come from the mapped devices.
+  if (_watch) [[unlikely]] {
+    const auto read_prior = [&](bits::span<u8> prior) {
+      read(address, prior, Operation(Operation::Type::BufferInternal, Operation::Kind::data));
+    };
+    ret.pause = _watch->on_write(address, src, op, read_prior);
+  }
   for (auto [offset, length] = T{0, src.size()}; length > 0;) {
     auto region = _addrs.region_at(address + offset);
     if (!region) throw E(E::Type::Unmapped, address + offset);
@@ -198,17 +209,19 @@ Target::Result SimpleBus::write(Address address, bits::span<const u8> src, Opera
     auto usable_len = std::min<size_t>(length, pepp::core::size_inclusive(dev->span()));
     // Convert bus address => device address
     auto dst = offset_map<Address>(address + offset, region->from, region->to);
-    // TODO: stop ignoring the result of the write. If the device returns an error, we should propagate it.
-    (void)dev->write(dst, src.subspan(offset, usable_len), op);
+    // TODO: stop ignoring the delay of the write. If the device returns an error, we should propagate it.
+    ret.pause |= dev->write(dst, src.subspan(offset, usable_len), op).pause;
     offset += usable_len, length -= usable_len;
   }
-  return {};
+  return ret;
 }
 
 void SimpleBus::clear(u8 fill) {
   for (auto dev : _devices) dev.second->clear(fill);
 }
 
+void SimpleBus::set_watchpoints(WatchpointSet *watchpoints) { _watch = watchpoints; }
+
 void SimpleBus::dump(bits::span<u8> dest) const { throw std::logic_error("SimpleBus::dump not implemented"); }
 
 Target *SimpleBus::device(ID id) const {
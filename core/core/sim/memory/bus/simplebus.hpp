@@ -20,6 +20,7 @@
 #include "core/sim/api/memory.hpp"
 #include "core/sim/api/trace.hpp"
 #include "core/sim/debugger/trace_recorder.hpp"
+#include "core/sim/debugger/watchpoints.hpp"
 
 // D type allows sticking custom data in a given node.
 // As a class invariant, we ensure that no Nodes exist with overlapping from intervals.
@@ -166,6 +167,10 @@ public:
   void clear(u8 fill) override;
   void dump(bits::span<u8> dest) const override;
 
+  // Watchpoints are checked against guest accesses in bus addresses, before they are forwarded to a device.
+  // Pass nullptr to detach.
+  void set_watchpoints(WatchpointSet *watchpoints);
+
 private:
   Target *device(Device::ID id) const;
 
@@ -173,6 +178,7 @@ private:
   AddressTranslationMap<Configuration::Mapping::Access> _addrs;
   std::unordered_map<Device::ID, Target *> _devices;
   trace::Recorder _trace;
+  WatchpointSet *_watch = nullptr;
 };
 
 consteval void is_bitflags(SimpleBus::Configuration::Mapping::Access);
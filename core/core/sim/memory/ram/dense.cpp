@@ -108,50 +108,9 @@ bool Dense::traced() const { return _trace.traced(); }
 
 void Dense::on_traced_changed(bool enabled) { _may_trace = enabled; }
 
-AddressSpan Dense::span() const { return _config.span; }
-
-Target::Result Dense::read(Address address, bits::span<u8> dest, Operation op) const {
-  using E = Error;
-  const auto span = _config.span;
-  // Length is 1-indexed, address are 0, so must offset by -1.
-  const auto max_addr = (address + std::max<Address>(0, dest.size() - 1));
-  if (address < span.lower() || max_addr > span.upper()) throw E(E::Type::OOBAccess, address);
-  const auto offset = address - span.lower();
-  const u8 *src = _data.data() + offset;
-  // Switched on the width so the copy length is a constant the compiler can turn into a register operation for common
-  // register sizes rather than a trip through the actual C code of memcpy.
-  switch (dest.size()) {
-  case 1: dest[0] = src[0]; break;
-  case 2: std::memcpy(dest.data(), src, 2); break;
-  case 4: std::memcpy(dest.data(), src, 4); break;
-  case 8: std::memcpy(dest.data(), src, 8); break;
-  default: std::memcpy(dest.data(), src, dest.size()); break;
-  }
-  if (is_performance_countable(op)) _counters.rd_bytes += dest.size();
-  return {};
-}
+void Dense::set_watchpoints(WatchpointSet *watchpoints) { _watch = watchpoints; }
 
-Target::Result Dense::write(Address address, bits::span<const u8> src, Operation op) {
-  using E = Error;
-  auto span = _config.span;
-  // Length is 1-indexed, address are 0, so must offset by -1.
-  const auto max_addr = (address + std::max<Address>(0, src.size() - 1));
-  if (address < span.lower() || max_addr > span.upper()) throw E(E::Type::OOBAccess, address);
-  const auto offset = address - span.lower();
-  u8 *dest = _data.data() + offset;
-  if (_may_trace) _trace.emit_write(op, address, bits::span<const u8>{dest, src.size()}, src);
-  // Switched on the width so the copy length is a constant the compiler can turn into a register operation for common
-  // register sizes rather than a trip through the actual C code of memcpy.
-  switch (src.size()) {
-  case 1: dest[0] = src[0]; break;
-  case 2: std::memcpy(dest, src.data(), 2); break;
-  case 4: std::memcpy(dest, src.data(), 4); break;
-  case 8: std::memcpy(dest, src.data(), 8); break;
-  default: std::memcpy(dest, src.data(), src.size()); break;
-  }
-  if (is_performance_countable(op)) _counters.wr_bytes += src.size();
-  return {};
-}
+AddressSpan Dense::span() const { return _config.span; }
 
 Target::Result Dense::write_increment(Address address, bits::span<const u8> src, Operation op, bits::Order order) {
   using E = Error;
@@ -162,9 +121,14 @@ Target::Result Dense::write_increment(Address address, bits::span<const u8> src,
   const auto offset = address - span.lower();
   auto dest = bits::span<u8>{_data.data(), std::size_t(_data.size())}.subspan(offset);
   if (_may_trace) _trace.emit_write_increment(op, address, dest.first(src.size()), src, order);
+  Result ret{};
+  if (_watch) [[unlikely]] {
+    const auto read_prior = [&](bits::span<u8> prior) { bits::memcpy(prior, bits::span<const u8>{dest}); };
+    ret.pause = _watch->on_write(address, src, op, read_prior);
+  }
   bits::memcpy(dest, src);
   if (is_performance_countable(op)) _counters.wr_bytes += src.size();
-  return {};
+  return ret;
 }
 
 void Dense::clear(u8 fill) {
@@ -15,11 +15,14 @@
  */
 
 #pragma once
+#include <cstring>
 #include "core/math/bitmanip/copy.hpp"
 #include "core/sim/api/device.hpp"
 #include "core/sim/api/memory.hpp"
 #include "core/sim/api/trace.hpp"
 #include "core/sim/debugger/trace_recorder.hpp"
+#include "core/sim/debugger/watchpoints.hpp"
+#include "core/sim/memory/errors.hpp"
 
 class Dense final : public Target, public Device, public Traceable {
 public:
@@ -60,6 +63,10 @@ public:
   AddressSpan span() const override;
   Result read(Address address, bits::span<u8> dest, Operation op) const override;
   Result write(Address address, bits::span<const u8> src, Operation op) override;
+  // Same as Target's, but they hide them so that a caller holding a Dense* reaches the definitions below directly.
+  // Dense is final, so those calls need no virtual dispatch and fold the width switch down to a single load or store.
+  template <std::integral I, bool byteswap = false> std::pair<Result, I> read(Address address, Operation op) const;
+  template <std::integral I, bool byteswap = false> Result write(Address address, I src, Operation op);
 
   // Overloads which emit traces using an increment/offset encoding.
   // When Dense is used to hold registers, this can be a more efficient encoding than a full write.
@@ -73,6 +80,9 @@ public:
   void clear(u8 fill) override;
   void dump(bits::span<u8> dest) const override;
 
+  // Watchpoints are checked against guest accesses to this target. Pass nullptr to detach.
+  void set_watchpoints(WatchpointSet *watchpoints);
+
 private:
   mutable struct PerformanceCounters {
     u64 rd_bytes = 0;
@@ -87,11 +97,76 @@ private:
   // traced. Ideally this would be an optional and nullopt would express the "unknown" rather than using true, but that
   // gae up a good chunk of performance.
   bool _may_trace = true;
+  // Null unless a debugger has attached watchpoints, which keeps the untraced fast path to a single branch.
+  WatchpointSet *_watch = nullptr;
 };
 /*
  * Inline implementations
  */
 
+inline Target::Result Dense::read(Address address, bits::span<u8> dest, Operation op) const {
+  using E = Error;
+  const auto span = _config.span;
+  // Length is 1-indexed, address are 0, so must offset by -1.
+  const auto max_addr = (address + std::max<Address>(0, dest.size() - 1));
+  if (address < span.lower() || max_addr > span.upper()) throw E(E::Type::OOBAccess, address);
+  const auto offset = address - span.lower();
+  const u8 *src = _data.data() + offset;
+  // Switched on the width so the copy length is a constant the compiler can turn into a register operation for common
+  // register sizes rather than a trip through the actual C code of memcpy.
+  switch (dest.size()) {
+  case 1: dest[0] = src[0]; break;
+  case 2: std::memcpy(dest.data(), src, 2); break;
+  case 4: std::memcpy(dest.data(), src, 4); break;
+  case 8: std::memcpy(dest.data(), src, 8); break;
+  default: std::memcpy(dest.data(), src, dest.size()); break;
+  }
+  if (is_performance_countable(op)) _counters.rd_bytes += dest.size();
+  if (_watch) [[unlikely]]
+    return {.delay = 0, .pause = _watch->on_read(address, dest.size(), op)};
+  return {};
+}
+
+inline Target::Result Dense::write(Address address, bits::span<const u8> src, Operation op) {
+  using E = Error;
+  auto span = _config.span;
+  // Length is 1-indexed, address are 0, so must offset by -1.
+  const auto max_addr = (address + std::max<Address>(0, src.size() - 1));
+  if (address < span.lower() || max_addr > span.upper()) throw E(E::Type::OOBAccess, address);
+  const auto offset = address - span.lower();
+  u8 *dest = _data.data() + offset;
+  if (_may_trace) _trace.emit_write(op, address, bits::span<const u8>{dest, src.size()}, src);
+  Result ret{};
+  if (_watch) [[unlikely]] {
+    const auto read_prior = [dest](bits::span<u8> prior) { std::memcpy(prior.data(), dest, prior.size()); };
+    ret.pause = _watch->on_write(address, src, op, read_prior);
+  }
+  // Switched on the width so the copy length is a constant the compiler can turn into a register operation for common
+  // register sizes rather than a trip through the actual C code of memcpy.
+  switch (src.size()) {
+  case 1: dest[0] = src[0]; break;
+  case 2: std::memcpy(dest, src.data(), 2); break;
+  case 4: std::memcpy(dest, src.data(), 4); break;
+  case 8: std::memcpy(dest, src.data(), 8); break;
+  default: std::memcpy(dest, src.data(), src.size()); break;
+  }
+  if (is_performance_countable(op)) _counters.wr_bytes += src.size();
+  return ret;
+}
+
+template <std::integral I, bool byteswap>
+inline std::pair<Target::Result, I> Dense::read(Address address, Operation op) const {
+  I dest;
+  auto r = read(address, bits::span<u8>(reinterpret_cast<u8 *>(&dest), sizeof(I)), op);
+  if constexpr (byteswap) dest = bits::byteswap(dest);
+  return {r, dest};
+}
+
+template <std::integral I, bool byteswap> inline Target::Result Dense::write(Address address, I src, Operation op) {
+  if constexpr (byteswap) src = bits::byteswap(src);
+  return write(address, bits::span<const u8>(reinterpret_cast<const u8 *>(&src), sizeof(I)), op);
+}
+
 template <std::integral I, bool byteswap>
 inline Target::Result Dense::write_increment(Address address, I src, Operation op, bits::Order order) {
   if constexpr (byteswap) src = bits::byteswap(src);
@@ -113,6 +113,8 @@ bool Sparse::traced() const { return _trace.traced(); }
 
 AddressSpan Sparse::span() const { return _config.span; }
 
+void Sparse::set_watchpoints(WatchpointSet *watchpoints) { _watch = watchpoints; }
+
 Target::Result Sparse::read(Address address, bits::span<u8> dest, Operation op) const {
   using E = Error;
   const auto span = _config.span;
@@ -123,6 +125,8 @@ Target::Result Sparse::read(Address address, bits::span<u8> dest, Operation op)
   const auto offset = address - span.lower();
   _pool.read(offset, dest);
   if (is_performance_countable(op)) _counters.rd_bytes += dest.size();
+  if (_watch) [[unlikely]]
+    return {.delay = 0, .pause = _watch->on_read(address, dest.size(), op)};
   return {};
 }
 
@@ -139,9 +143,12 @@ Target::Result Sparse::write(Address address, bits::span<const u8> src, Operatio
   // ^ in place. The callback is only executed IF the write is recorded. We still pay the price of alloc'ing a lambda,
   // but we don't pay the cost of reading the data.
   _trace.emit_write(op, address, src, [&](bits::span<u8> prior) { _pool.read(offset, prior); });
+  Result ret{};
+  if (_watch) [[unlikely]]
+    ret.pause = _watch->on_write(address, src, op, [&](bits::span<u8> prior) { _pool.read(offset, prior); });
   _pool.write(offset, src);
   if (is_performance_countable(op)) _counters.wr_bytes += src.size();
-  return {};
+  return ret;
 }
 
 // `fill` is the caller's choice for this one operation and deliberately does not become the device's new default:
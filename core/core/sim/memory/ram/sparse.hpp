@@ -20,6 +20,7 @@
 #include "core/sim/api/memory.hpp"
 #include "core/sim/api/trace.hpp"
 #include "core/sim/debugger/trace_recorder.hpp"
+#include "core/sim/debugger/watchpoints.hpp"
 
 class Sparse final : public Target, public Device, public Traceable {
 public:
@@ -61,6 +62,9 @@ public:
   void clear(u8 fill) override;
   void dump(bits::span<u8> dest) const override;
 
+  // Watchpoints are checked against guest accesses to this target. Pass nullptr to detach.
+  void set_watchpoints(WatchpointSet *watchpoints);
+
 private:
   mutable struct PerformanceCounters {
     u64 rd_bytes = 0;
@@ -69,4 +73,5 @@ private:
   Configuration _config;
   pepp::bts::PagedPool<u8> _pool;
   trace::Recorder _trace;
+  WatchpointSet *_watch = nullptr;
 };
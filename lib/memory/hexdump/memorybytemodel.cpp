@@ -70,6 +70,8 @@ void MemoryByteModel::setMemory(ARawMemory *memory) {
   // Because of ownership changes, we must delete memory_ when we replace it.
   QQmlEngine::setObjectOwnership(memory_, QQmlEngine::CppOwnership);
   emit memoryChanged();
+  // Rows marked against the old memory are meaningless, and the reset repaints everything anyway.
+  dirtyRows_.clear();
   endResetModel();
 }
 
@@ -122,6 +124,8 @@ void MemoryByteModel::setNumBytesPerLine(quint8 bytesPerLine) {
 
   //  Signal that row count has changed
   emit dimensionsChanged();
+  // Dirty rows were numbered for the old width.
+  dirtyRows_.clear();
   endResetModel();
 }
 
@@ -308,16 +312,25 @@ QString MemoryByteModel::ascii(const int row) const {
 }
 
 void MemoryByteModel::onDataChanged(quint32 start, quint32 end) {
-  // Conservatively repaint the entire
-  auto startIndex = memoryIndex(start).siblingAtColumn(1);
-  auto endIndex = memoryIndex(end).siblingAtColumn(columnCount() - 1);
-  static const auto roles = QList<int>{Qt::DisplayRole, (int)MemoryRoles::Highlight};
-  if (!(startIndex.isValid() && endIndex.isValid())) return;
+  const auto size = memory_->byteCount();
+  if (start > end || start >= size) return;
+  end = std::min<quint32>(end, size - 1);
+  dirtyRows_.mark(start / width_, end / width_);
+  if (flushQueued_) return;
+  flushQueued_ = true;
+  QMetaObject::invokeMethod(this, &MemoryByteModel::flushDirtyRows, Qt::QueuedConnection);
+}
 
-  if (!(startIndex.isValid() && endIndex.isValid())) {
-    static const char *const e = "Bad column access";
-    qCritical(e);
-    throw std::logic_error(e);
-  }
-  emit dataChanged(startIndex, endIndex, roles);
+void MemoryByteModel::flushDirtyRows() {
+  static const auto roles = QList<int>{Qt::DisplayRole, (int)MemoryRoles::Highlight};
+  flushQueued_ = false;
+  // Skip the line number column.
+  const int lastColumn = columnCount() - 1, rows = rowCount();
+  dirtyRows_.for_each_run([&](u64 lower, u64 upper) {
+    // Rows may have been marked before the memory shrank.
+    if (std::cmp_greater_equal(lower, rows)) return;
+    upper = std::min<u64>(upper, rows - 1);
+    emit dataChanged(index(static_cast<int>(lower), 1), index(static_cast<int>(upper), lastColumn), roles);
+  });
+  dirtyRows_.clear();
 }
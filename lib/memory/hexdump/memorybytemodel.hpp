@@ -18,6 +18,7 @@
 #include <QAbstractTableModel>
 #include <QHash>
 #include <QSet>
+#include "core/ds/dirty_bitmap.hpp"
 #include "memorycolumns.hpp"
 #include "rawmemory.hpp"
 #include "utils/opcodemodel.hpp"
@@ -91,6 +92,8 @@ public:
   bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
   Qt::ItemFlags flags(const QModelIndex &index) const override;
 public slots:
+  // Marks the rows containing [start, end] as dirty. Rows are repainted together once control returns to the event
+  // loop, so a burst of changes (e.g., after a long run) costs one dataChanged per run of consecutive dirty rows.
   void onDataChanged(quint32 start, quint32 end);
 signals:
   void dimensionsChanged();
@@ -113,4 +116,8 @@ private:
 
   //  Clear model
   void clear();
+
+  void flushDirtyRows();
+  pepp::DirtyBitmap dirtyRows_;
+  bool flushQueued_ = false;
 };
@@ -16,6 +16,7 @@
 #include "rawmemory.hpp"
 
 #include <QQmlEngine>
+#include <algorithm>
 #include "sim3/trace/modified.hpp"
 
 ARawMemory::ARawMemory(QObject *parent) : QObject(parent) {}
@@ -83,6 +84,7 @@ SimulatorRawMemory::SimulatorRawMemory(sim::memory::SimpleBus<quint16> *memory,
 quint32 SimulatorRawMemory::byteCount() const { return pepp::core::size<quint16, false>(_memory->span()); }
 
 quint8 SimulatorRawMemory::read(quint32 address) const {
+  if (!_snapshot.empty()) return address < _snapshot.size() ? _snapshot[address] : 0;
   auto span = _memory->span();
   quint8 ret = 0;
   if (pepp::core::contains(span, static_cast<quint16>(address))) _memory->read(address, {&ret, sizeof(ret)}, gs);
@@ -113,6 +115,7 @@ MemoryHighlight::V SimulatorRawMemory::status(quint32 address) const {
 
 void SimulatorRawMemory::write(quint32 address, quint8 value) {
   using pepp::core::contains;
+  if (!_snapshot.empty()) return;
   auto span = _memory->span();
   if (contains(span, static_cast<quint16>(address))) _memory->write(address, {&value, sizeof(value)}, gs);
 }
@@ -130,7 +133,7 @@ void SimulatorRawMemory::clearModifiedAndUpdateGUI() {
 
 void SimulatorRawMemory::onUpdateGUI(sim::api2::trace::FrameIterator from) {
   // Remove highlighted cells from previous steps.
-  auto oldHighlights = std::set{_sink->intervals()};
+  auto oldHighlights = _sink->intervals();
   oldHighlights.insert({static_cast<quint16>(_lastSP.lower()), static_cast<quint16>(_lastSP.upper())});
   oldHighlights.insert({static_cast<quint16>(_lastPC.lower()), static_cast<quint16>(_lastPC.upper())});
   // Purge data from previous updates. Must be cleared before iterating and emitting events, or highlights are wrong.
@@ -146,13 +149,35 @@ void SimulatorRawMemory::onUpdateGUI(sim::api2::trace::FrameIterator from) {
     for (auto frame = from; frame != tb->cend(); ++frame)
       for (auto packet = frame.cbegin(); packet != frame.cend(); ++packet)
         _sink->analyze(packet, sim::api2::trace::Direction::Forward);
-    for (const auto &interval : _sink->intervals())
-      // Cache the previous value of the modified addresses.
-      emit dataChanged(interval.lower(), interval.upper());
+    // Cache the previous value of the modified addresses.
+    _sink->for_each_interval([this](auto interval) { emit dataChanged(interval.lower(), interval.upper()); });
     // And update intervals containing PC, SP to fix the highlighting.
     emit dataChanged(this->_SP.lower(), this->_SP.upper());
     emit dataChanged(this->_PC.lower(), this->_PC.upper());
   }
 }
 
+void SimulatorRawMemory::addModified(const sim::trace2::ModifiedAddressSink<quint16> &modified) {
+  _sink->merge(modified);
+  modified.for_each_interval([this](auto interval) { emit dataChanged(interval.lower(), interval.upper()); });
+}
+
+void SimulatorRawMemory::showSnapshot(std::span<const quint8> bytes) {
+  if (bytes.empty()) return;
+  else if (_snapshot.size() != bytes.size()) {
+    _snapshot.assign(bytes.begin(), bytes.end());
+    emit dataChanged(0, bytes.size() - 1);
+  } else if (auto first = std::mismatch(bytes.begin(), bytes.end(), _snapshot.begin()).first; first != bytes.end()) {
+    auto last = std::mismatch(bytes.rbegin(), bytes.rend(), _snapshot.rbegin()).first;
+    const quint32 lower = first - bytes.begin(), upper = bytes.rend() - last - 1;
+    std::copy(first, last.base(), _snapshot.begin() + lower);
+    emit dataChanged(lower, upper);
+  }
+  // Move the PC/SP highlights, since setPC/setSP do not repaint.
+  for (const auto &highlight : {_lastSP, _lastPC, _SP, _PC}) emit dataChanged(highlight.lower(), highlight.upper());
+  _lastSP = _SP, _lastPC = _PC;
+}
+
+void SimulatorRawMemory::clearSnapshot() { _snapshot.clear(); }
+
 void SimulatorRawMemory::onRepaintAddress(quint32 start, quint32 end) { emit dataChanged(start, end); }
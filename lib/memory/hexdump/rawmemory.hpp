@@ -17,6 +17,7 @@
 #include <QObject>
 #include <QtQmlIntegration>
 #include <QtTypes>
+#include <span>
 #include <vector>
 #include "sim3/subsystems/bus/simple.hpp"
 #include "sim3/trace/modified.hpp"
@@ -131,6 +132,13 @@ public:
 public slots:
   void clearModifiedAndUpdateGUI();
   void onUpdateGUI(sim::api2::trace::FrameIterator from);
+  // Also highlight addresses whose trace was discarded before onUpdateGUI, e.g., by a long run which kept its trace
+  // bounded. Must be called after onUpdateGUI, which clears the highlights.
+  void addModified(const sim::trace2::ModifiedAddressSink<quint16> &modified);
+  // While the simulator runs on another thread, show a copy of its memory instead of reading the bus.
+  // Only the bytes which differ from the previous snapshot, and the PC/SP highlights, are repainted.
+  void showSnapshot(std::span<const quint8> bytes);
+  void clearSnapshot();
   // Addresses were changed, but not tracked in the trace buffer.
   // We don't want to highlight them. We just want to make sure they get re-painted.
   void onRepaintAddress(quint32 start, quint32 end);
@@ -138,6 +146,8 @@ public slots:
 private:
   sim::memory::SimpleBus<quint16> *_memory;
   std::map<quint32, quint8> _modifiedCache;
+  // Empty unless showing a snapshot. Writes are dropped while it is non-empty, since the bus belongs to the worker.
+  std::vector<quint8> _snapshot;
   QSharedPointer<sim::trace2::ModifiedAddressSink<quint16>> _sink;
   static constexpr quint32 n1 = -1;
   sim::trace2::Interval<quint32> _PC = {n1, n1}, _SP = {n1, n1};
@@ -178,8 +178,11 @@ SystemAssembly make_asmb_system(project::Environment env, QString os, const pepp
   return ret;
 }
 
+using SnapshotFn = std::function<const Pep_ISA::Snapshot *()>;
+
 template <typename CPU, typename ISA>
-RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes, QObject *parent = nullptr) {
+RegisterModel *register_model(targets::isa::System *system, SnapshotFn snapshot, OpcodeModel *opcodes,
+                              QObject *parent = nullptr) {
   using RF = QSharedPointer<RegisterFormatter>;
   using TF = QSharedPointer<TextFormatter>;
   using AF = QSharedPointer<ASCIIFormatter>;
@@ -192,8 +195,9 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
   using VF = QSharedPointer<VariableByteLengthFormatter>;
   using VecF = QVector<RF>;
   auto ret = new RegisterModel(parent);
-  auto _register = [](typename ISA::Register r, auto *system) {
+  auto _register = [snapshot](typename ISA::Register r, auto *system) {
     if (system == nullptr) return quint16{0};
+    else if (auto shown = snapshot(); shown) return shown->reg(static_cast<quint8>(r));
     quint16 ret = 0;
     auto cpu = static_cast<CPU *>(system->cpu());
     targets::isa::readRegister<ISA>(cpu->regs(), r, ret, gs);
@@ -218,7 +222,10 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
     auto op = ISA::opcodeLUT[is];
     return !op.instr.unary;
   };
-  auto operand = [=]() { return cpu->currentOperand().value_or(0); };
+  auto operand = [=]() {
+    if (auto shown = snapshot(); shown) return shown->operand.value_or(0);
+    return cpu->currentOperand().value_or(0);
+  };
   auto cf = [](std::function<int64_t()> reg, qsizetype index) {
     return QSharedPointer<ChoiceFormatter>::create(
         VecF{SF::create(reg, 2), UF::create(reg, 2), BF::create(reg, 2), AF::create(reg, 2)}, index);
@@ -250,11 +257,13 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
   return ret;
 }
 
-template <typename CPU, typename ISA> FlagModel *flag_model(targets::isa::System *system, QObject *parent = nullptr) {
+template <typename CPU, typename ISA>
+FlagModel *flag_model(targets::isa::System *system, SnapshotFn snapshot, QObject *parent = nullptr) {
   using F = QSharedPointer<Flag>;
   auto ret = new FlagModel(parent);
-  auto _flag = [](typename ISA::CSR s, auto *system) {
+  auto _flag = [snapshot](typename ISA::CSR s, auto *system) {
     if (system == nullptr) return false;
+    else if (auto shown = snapshot(); shown) return shown->csr(static_cast<quint8>(s));
     bool ret = 0;
     auto cpu = static_cast<CPU *>(system->cpu());
     targets::isa::readCSR<ISA>(cpu->csrs(), s, ret, gs);
@@ -287,18 +296,36 @@ Pep_ISA::Pep_ISA(project::Environment env, QObject *parent, bool initializeSyste
     bindToSystem();
   }
   connect(this, &Pep_ISA::deferredExecution, this, &Pep_ISA::onDeferredExecution, Qt::QueuedConnection);
+  _worker = new SimulationWorker(this);
+  connect(_worker, &SimulationWorker::finished, this, &Pep_ISA::onWorkerFinished, Qt::QueuedConnection);
+  // The worker checks breakpoints, so editing them (including their conditions from the breakpoint pane) must wait
+  // for it to finish its batch.
+  _dbg->bps->setGuard([this]() { return _worker->lock(); });
+  _displayTimer = new QTimer(this);
+  _displayTimer->setInterval(SimulationWorker::publishInterval);
+  connect(_displayTimer, &QTimer::timeout, this, &Pep_ISA::onDisplayRefresh);
+}
+
+// The worker must not outlive the simulator it is running, and members are destroyed before QObject children.
+Pep_ISA::~Pep_ISA() {
+  _worker->requestPause();
+  _worker->wait();
+  // Others may hold on to the debugger, but not to the worker.
+  _dbg->bps->setGuard(nullptr);
 }
 
 void Pep_ISA::bindToSystem() {
   using enum pepp::Architecture;
+  // The CPU pane is painted from snapshots while the worker runs.
+  auto snapshot = [this]() { return displayedSnapshot(); };
   switch (_env.arch) {
   case PEP9:
-    _flags = flag_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, this);
-    _registers = register_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, mnemonics(), this);
+    _flags = flag_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, snapshot, this);
+    _registers = register_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, snapshot, mnemonics(), this);
     break;
   case PEP10:
-    _flags = flag_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, this);
-    _registers = register_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, mnemonics(), this);
+    _flags = flag_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, snapshot, this);
+    _registers = register_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, snapshot, mnemonics(), this);
     break;
   default: throw std::logic_error("Unimplemented");
   }
@@ -312,6 +339,7 @@ void Pep_ISA::bindToSystem() {
 
   using TMAS = sim::trace2::TranslatingModifiedAddressSink<quint16>;
   auto sink = QSharedPointer<TMAS>::create(_system->pathManager(), _system->bus());
+  _runModified = QSharedPointer<TMAS>::create(_system->pathManager(), _system->bus());
 
   _memory = new SimulatorRawMemory(_system->bus(), sink, this);
   connect(this, SIGNAL(updateGUI(sim::api2::trace::FrameIterator)), _memory,
@@ -426,6 +454,8 @@ void Pep_ISA::setCharIn(QString value) {
 }
 
 QString Pep_ISA::charOut() const {
+  // The endpoint belongs to the worker while it runs.
+  if (auto snapshot = displayedSnapshot(); snapshot) return snapshot->charOut;
   if (auto charOut = _system->output("charOut"); charOut) {
     auto charOutEndpoint = charOut->endpoint();
     charOutEndpoint->set_to_head();
@@ -472,6 +502,8 @@ pepp::debug::types::TypeInfo const *Pep_ISA::type_info() const { return &_typeIn
 
 uint8_t Pep_ISA::read_mem_u8(uint32_t address) const {
   if (_system == nullptr) return 0;
+  // Watch expressions are evaluated on this thread, breakpoint conditions on the worker.
+  else if (auto snapshot = displayedSnapshot(); snapshot) return snapshot->memory[address & 0xFFFF];
   quint8 temp = 0;
   _system->bus()->read((uint16_t)address, {&temp, 1}, gs);
   return temp;
@@ -479,6 +511,8 @@ uint8_t Pep_ISA::read_mem_u8(uint32_t address) const {
 
 uint16_t Pep_ISA::read_mem_u16(uint32_t address) const {
   if (_system == nullptr) return 0;
+  else if (auto snapshot = displayedSnapshot(); snapshot)
+    return (snapshot->memory[address & 0xFFFF] << 8) | snapshot->memory[(address + 1) & 0xFFFF];
   quint16 temp = 0;
   _system->bus()->read((uint16_t)address, {(quint8 *)&temp, 2}, gs);
   if (bits::hostOrder() != bits::Order::BigEndian) temp = bits::byteswap(temp);
@@ -501,30 +535,24 @@ uint32_t Pep_ISA::cache_debug_variable_name(QStringView name) const {
 
 pepp::debug::Value Pep_ISA::evaluate_debug_variable(uint32_t cache_id) const {
   using DV = Pep_ISA::DebugVariables;
+  using R = isa::Pep10::Register;
   if (_system == nullptr) return pepp::debug::VPrimitive::from_int((int16_t)0);
-  uint16_t reg16;
-  auto cpu = static_cast<targets::pep10::isa::CPU *>(_system->cpu());
+  R reg;
   switch (cache_id) {
-  case static_cast<uint32_t>(DV::A):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::A, reg16, gs);
-    break;
-  case static_cast<uint32_t>(DV::X):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::X, reg16, gs);
-    break;
-  case static_cast<uint32_t>(DV::SP):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::SP, reg16, gs);
-    break;
-  case static_cast<uint32_t>(DV::PC):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::PC, reg16, gs);
-    break;
-  case static_cast<uint32_t>(DV::IS):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::IS, reg16, gs);
-    break;
-  case static_cast<uint32_t>(DV::OS):
-    targets::isa::readRegister<isa::Pep10>(cpu->regs(), isa::Pep10::Register::OS, reg16, gs);
-    break;
+  case static_cast<uint32_t>(DV::A): reg = R::A; break;
+  case static_cast<uint32_t>(DV::X): reg = R::X; break;
+  case static_cast<uint32_t>(DV::SP): reg = R::SP; break;
+  case static_cast<uint32_t>(DV::PC): reg = R::PC; break;
+  case static_cast<uint32_t>(DV::IS): reg = R::IS; break;
+  case static_cast<uint32_t>(DV::OS): reg = R::OS; break;
   default: return pepp::debug::VPrimitive::from_int((int16_t)0);
   }
+  uint16_t reg16;
+  if (auto snapshot = displayedSnapshot(); snapshot) reg16 = snapshot->reg(static_cast<quint8>(reg));
+  else {
+    auto cpu = static_cast<targets::pep10::isa::CPU *>(_system->cpu());
+    targets::isa::readRegister<isa::Pep10>(cpu->regs(), reg, reg16, gs);
+  }
   return pepp::debug::VPrimitive::from_int((int16_t)reg16);
 }
 
@@ -535,6 +563,7 @@ QString Pep_ISA::contentsForExtension(const QString &ext) const {
 }
 
 bool Pep_ISA::onLoadObject() {
+  stopWorker();
   emit clearMessages();
   static ObjectUtilities utils;
   _tb->clear();
@@ -617,6 +646,9 @@ bool Pep_ISA::onDebuggingStart() {
 }
 
 bool Pep_ISA::onDebuggingContinue() {
+  // Continue and the steps below are only offered while paused. Refuse them until the worker has let go of the
+  // simulator, rather than touching state it reads.
+  if (_worker->running()) return false;
   _state = State::DebugExec;
   _pendingPause = false;
   _stepsSinceLastInteraction = 0;
@@ -626,9 +658,14 @@ bool Pep_ISA::onDebuggingContinue() {
   return true;
 }
 
-bool Pep_ISA::onDebuggingPause() { return _pendingPause = true; }
+bool Pep_ISA::onDebuggingPause() {
+  if (_worker->running()) _worker->requestPause();
+  else _pendingPause = true;
+  return true;
+}
 
 bool Pep_ISA::onDebuggingStop() {
+  stopWorker();
   _system->bus()->trace(false);
   _state = State::Halted;
   emit allowedDebuggingChanged();
@@ -658,6 +695,7 @@ auto generateStepCondition(targets::isa::System *system, qint16 offset, bool ign
 
 bool Pep_ISA::onISAStep() {
   using enum pepp::Architecture;
+  if (_worker->running()) return false;
   bool nextIsTrap = false;
   quint8 is;
   quint16 pc;
@@ -691,6 +729,7 @@ bool Pep_ISA::onISAStepOut() { return stepDepthHelper(-1); }
 
 bool Pep_ISA::onClearCPU() {
   using enum pepp::Architecture;
+  stopWorker();
   switch (_env.arch) {
   case PEP9: {
     auto cpu = static_cast<targets::pep9::isa::CPU *>(_system->cpu());
@@ -715,6 +754,7 @@ bool Pep_ISA::onClearCPU() {
 }
 
 bool Pep_ISA::onClearMemory() {
+  stopWorker();
   _system->bus()->clear(0);
   // Reset trace buffer, since its content is now meaningless.
   _tb->clear();
@@ -723,10 +763,11 @@ bool Pep_ISA::onClearMemory() {
 }
 
 void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
+  // A step or continue may be requested again before the previous run's finished() has been delivered.
+  if (_worker->running()) return;
   auto pwrOff = _system->output("pwrOff");
   auto endpoint = pwrOff->endpoint();
   auto from = _tb->cend();
-  bool err = false;
 
   State newState = _state;
   switch (_state) {
@@ -741,10 +782,33 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
     emit allowedStepsChanged();
   }
 
-  // If we exceed the number of steps, do we allow another deferredExecution?
-  bool allowsResume = true;
+#if QT_CONFIG(thread)
+  // Run at full speed on the worker. This thread only wakes up to repaint from snapshots until the worker stops.
+  _run = {.pwrOff = endpoint, .from = from, .result = {}};
+  _runModified->clear();
+  // From here until the worker stops, the GUI only reads snapshots. Show one before the worker can change anything.
+  publishSnapshot();
+  _snapshots.update();
+  showSnapshot(_snapshots.front());
+  _worker->start(
+      [this, endpoint, step]() {
+        const bool more = runTicks(endpoint, step, 4096, _run.result);
+        checkpointTrace();
+        return more;
+      },
+      [this]() { publishSnapshot(); });
+  _displayTimer->start();
+#else
+  // Without threads, run a slice at a time and yield to the event loop so that the GUI stays responsive.
+  RunResult result;
+  runTicks(endpoint, step, 1000, result);
+  finishExecution(endpoint, from, result, true, step);
+#endif
+}
+
+bool Pep_ISA::runTicks(const Endpoint &pwrOff, const std::function<bool()> &step, quint64 ticks, RunResult &result) {
   try {
-    auto ending = _system->currentTick() + 1000;
+    auto ending = _system->currentTick() + ticks;
     do {
       _system->tick(sim::api2::Scheduler::Mode::Jump);
       if (_dbg->bps->hit()) {
@@ -752,23 +816,28 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
         _pendingPause = true;
       }
       _pendingPause |= step();
-    } while (_system->currentTick() < ending && endpoint->at_end() && !_pendingPause);
+    } while (_system->currentTick() < ending && pwrOff->at_end() && !_pendingPause);
   } catch (const sim::api2::memory::Error &e) {
-    err = true;
+    result.err = true;
     if (e.type() == sim::api2::memory::Error::Type::NeedsMMI) {
-      emit message("Ran out of MMI");
+      result.message = "Ran out of MMI";
     } else std::cerr << "Memory error: " << e.what() << std::endl;
     // Handle illegal opcodes or program crashes.
   } catch (const std::logic_error &e) {
-    err = true;
-    emit message(e.what());
+    result.err = true;
+    result.message = e.what();
   } catch (const ::targets::isa::IllegalOpcode &e) {
-    err = true;
-    emit message(e.what());
+    result.err = true;
+    result.message = e.what();
   }
+  return !result.err && pwrOff->at_end() && !_pendingPause;
+}
 
+void Pep_ISA::finishExecution(const Endpoint &pwrOff, sim::api2::trace::FrameIterator from, const RunResult &result,
+                              bool resume, const std::function<bool()> &step) {
+  if (!result.message.isEmpty()) emit message(result.message);
   // Only terminates if something written to endpoint or there was an error
-  if (endpoint->next_value().has_value() || err) {
+  if (pwrOff->next_value().has_value() || result.err) {
     switch (_state) {
     case State::NormalExec:
       _system->bus()->trace(false);
@@ -782,14 +851,14 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
     }
   }
   // Trigger a BP if we exceed a resonable number of chained executions
-  else if (_stepsSinceLastInteraction++ > 10) {
+  else if (resume && _stepsSinceLastInteraction++ > 10) {
     _state = State::DebugPaused;
     emit allowedDebuggingChanged();
     emit allowedStepsChanged();
     emit message("Pausing, potential infinite loop detected.");
   }
   // Queued connection, so it will be evaluated after the display is updated.
-  else if (allowsResume && !_pendingPause)
+  else if (resume && !_pendingPause)
     emit deferredExecution(step);
   else {
     _pendingPause = false;
@@ -800,7 +869,98 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
   prepareGUIUpdate(from);
 }
 
+void Pep_ISA::onWorkerFinished() {
+  // Already handled by stopWorker(), or a new run started before this was delivered.
+  if (_worker->running() || !_run.from) return;
+  _displayTimer->stop();
+  _memory->clearSnapshot();
+  const auto from = *_run.from;
+  _run.from = std::nullopt;
+  finishExecution(_run.pwrOff, from, _run.result, false, {});
+  // The trace only covers the last batch, and finishExecution's GUI update has just highlighted it.
+  _memory->addModified(*_runModified);
+  _runModified->clear();
+}
+
+void Pep_ISA::onDisplayRefresh() {
+  if (_snapshots.update()) showSnapshot(_snapshots.front());
+}
+
+void Pep_ISA::showSnapshot(const Snapshot &snapshot) {
+  _memory->setSP(snapshot.pcsp.sp);
+  _memory->setPC(snapshot.pcsp.pc, snapshot.pcsp.pcEnd);
+  _memory->showSnapshot(snapshot.memory);
+  emit charOutChanged();
+  _flags->onUpdateGUI();
+  _registers->onUpdateGUI();
+}
+
+const Pep_ISA::Snapshot *Pep_ISA::displayedSnapshot() const {
+  // start() is only called from this thread, so the worker cannot start between the check and the read.
+  if (_worker == nullptr || !_worker->running() || QThread::currentThread() != thread()) return nullptr;
+  return &_snapshots.front();
+}
+
+quint16 Pep_ISA::Snapshot::reg(quint8 index) const {
+  // Registers are stored big-endian, see readRegister.
+  if (2 * index + 1 >= regs.size()) return 0;
+  return (regs[2 * index] << 8) | regs[2 * index + 1];
+}
+
+bool Pep_ISA::Snapshot::csr(quint8 index) const { return index < csrs.size() && csrs[index] != 0; }
+
+namespace {
+template <typename CPU> void snapshotCPU(targets::isa::System *system, Pep_ISA::Snapshot &snapshot) {
+  auto cpu = static_cast<CPU *>(system->cpu());
+  auto dump = [](sim::api2::memory::Target<u8> *target, std::vector<quint8> &out) {
+    out.resize(pepp::core::size<u8, false>(target->span()));
+    target->dump({out.data(), out.size()});
+  };
+  dump(cpu->regs(), snapshot.regs);
+  dump(cpu->csrs(), snapshot.csrs);
+  snapshot.operand = cpu->currentOperand();
+}
+} // namespace
+
+void Pep_ISA::publishSnapshot() {
+  auto &snapshot = _snapshots.back();
+  snapshot.memory.resize(0x10000);
+  _system->bus()->dump({snapshot.memory.data(), snapshot.memory.size()});
+  snapshot.pcsp = readPCSP();
+  using enum pepp::Architecture;
+  switch (_env.arch) {
+  case PEP9: snapshotCPU<targets::pep9::isa::CPU>(&*_system, snapshot); break;
+  case PEP10: snapshotCPU<targets::pep10::isa::CPU>(&*_system, snapshot); break;
+  default: throw std::logic_error("Unimplemented");
+  }
+  if (auto charOut = _system->output("charOut"); charOut) {
+    auto endpoint = charOut->endpoint();
+    endpoint->set_to_head();
+    snapshot.charOut.clear();
+    for (auto next = endpoint->next_value(); next.has_value(); next = endpoint->next_value())
+      snapshot.charOut.append(char(*next));
+  }
+  _snapshots.publish();
+}
+
+void Pep_ISA::checkpointTrace() {
+  for (auto frame = *_run.from; frame != _tb->cend(); ++frame)
+    for (auto packet = frame.cbegin(); packet != frame.cend(); ++packet)
+      _runModified->analyze(packet, sim::api2::trace::Direction::Forward);
+  _tb->clear();
+  _run.from = _tb->cend();
+}
+
+void Pep_ISA::stopWorker() {
+  if (!_worker->running()) return;
+  _worker->requestPause();
+  _worker->wait();
+  // Handle the pause now rather than when finished() is delivered, since our caller is about to touch the simulator.
+  onWorkerFinished();
+}
+
 void Pep_ISA::prepareSim() {
+  stopWorker();
   // Ensure latests changes to object code pane are reflected in simulator.
   onLoadObject();
   _system->init();
@@ -833,11 +993,17 @@ void Pep_ISA::prepareGUIUpdate(sim::api2::trace::FrameIterator from) {
 }
 
 void Pep_ISA::updateMemPCSP() const {
+  // Update cpu-dependent fields in memory before triggering a GUI update.
+  const auto pcsp = readPCSP();
+  _memory->setSP(pcsp.sp);
+  _memory->setPC(pcsp.pc, pcsp.pcEnd);
+}
+
+Pep_ISA::PCSP Pep_ISA::readPCSP() const {
   using enum pepp::Architecture;
   quint8 is;
   quint16 sp, pc;
   bool isUnary;
-  // Update cpu-dependent fields in memory before triggering a GUI update.
   switch (_env.arch) {
   case PEP9: {
     auto cpu = static_cast<targets::pep9::isa::CPU *>(_system->cpu());
@@ -857,13 +1023,12 @@ void Pep_ISA::updateMemPCSP() const {
   }
   default: throw std::logic_error("Unimplemented");
   }
-
-  _memory->setSP(sp);
-  _memory->setPC(pc, pc + (isUnary ? 0 : 2));
+  return {.pc = pc, .pcEnd = static_cast<quint16>(pc + (isUnary ? 0 : 2)), .sp = sp};
 }
 
 bool Pep_ISA::stepDepthHelper(qint16 offset) {
   using enum pepp::Architecture;
+  if (_worker->running()) return false;
   _state = State::DebugExec;
   _stepsSinceLastInteraction = 0;
   _pendingPause = false;
@@ -1016,6 +1181,8 @@ bool Pep_ASMB::onAssemble(bool doLoad) {
 
 bool Pep_ASMB::_onAssemble(bool doLoad) {
   using enum pepp::Architecture;
+  // Assembling replaces the system out from under the worker.
+  stopWorker();
   _userList = _osList = "";
   QSharedPointer<macro::Registry> macroRegistry = nullptr;
   switch (_env.arch) {
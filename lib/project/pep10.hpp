@@ -17,8 +17,10 @@
 
 #include <QQmlEngine>
 #include <QStringListModel>
+#include <QTimer>
 #include <qabstractitemmodel.h>
 #include "aproject.hpp"
+#include "core/ds/snapshot_buffer.hpp"
 #include "core/langs/ucode/ir_variant.hpp"
 #include "core/resources/figures/builtin_registry.hpp"
 #include "cpu/ma2/dataflow.hpp"
@@ -31,8 +33,10 @@
 #include "project/architectures.hpp"
 #include "project/levels.hpp"
 #include "sim/debug/watchexpressionmodel.hpp"
+#include "sim3/subsystems/ram/broadcast/mmo.hpp"
 #include "sim3/systems/traced_pep_isa3_system.hpp"
 #include "sim3/systems/traced_pep_ma2_system.hpp"
+#include "simulationworker.hpp"
 #include "text/editor/editbase.hpp"
 #include "text/editor/micro_line_numbers.hpp"
 #include "toolchain/helpers/asmb.hpp"
@@ -83,6 +87,25 @@ public:
     Full,
   };
   explicit Pep_ISA(project::Environment env, QObject *parent = nullptr, bool initializeSystem = true);
+  ~Pep_ISA() override;
+
+  struct PCSP {
+    quint16 pc, pcEnd, sp;
+  };
+  // Everything the GUI reads from the simulator while the worker is running. The trace buffer is read once it stops.
+  struct Snapshot {
+    std::vector<quint8> memory;
+    // Raw contents of the CPU's register and CSR banks, laid out as readRegister/readCSR expect.
+    std::vector<quint8> regs, csrs;
+    std::optional<quint16> operand = std::nullopt;
+    PCSP pcsp = {};
+    QString charOut = {};
+    quint16 reg(quint8 index) const;
+    bool csr(quint8 index) const;
+  };
+  // While the worker is running, the snapshot that the GUI thread must read instead of the simulator. Null when the
+  // simulator may be read directly, i.e., when the worker is idle or the caller is the worker itself.
+  const Snapshot *displayedSnapshot() const;
   virtual project::Environment env() const;
   int qml_architecture() const { return (int)architecture(); }
   virtual pepp::Architecture architecture() const;
@@ -142,6 +165,8 @@ public slots:
   bool onClearMemory();
 
   void onDeferredExecution(std::function<bool()> step);
+  void onWorkerFinished();
+  void onDisplayRefresh();
 
 signals:
   void objectCodeTextChanged();
@@ -178,6 +203,36 @@ protected:
   virtual void prepareGUIUpdate(sim::api2::trace::FrameIterator from);
   void updateMemPCSP() const;
   bool stepDepthHelper(qint16 offset);
+  PCSP readPCSP() const;
+
+  using Endpoint = QSharedPointer<sim::memory::detail::Channel<quint16, quint8>::Endpoint>;
+  struct RunResult {
+    bool err = false;
+    QString message = {};
+  };
+  // Run at most `ticks` ticks. Returns false once the program powers off, errors, or something requests a pause.
+  bool runTicks(const Endpoint &pwrOff, const std::function<bool()> &step, quint64 ticks, RunResult &result);
+  // Common tail of a run, once the simulator is idle again.
+  void finishExecution(const Endpoint &pwrOff, sim::api2::trace::FrameIterator from, const RunResult &result,
+                       bool resume, const std::function<bool()> &step);
+  // Block until the worker thread is no longer touching the simulator.
+  void stopWorker();
+  // Called on the worker thread between batches, and on this thread right before the worker starts.
+  void publishSnapshot();
+  // Called on the worker thread after each batch. Folds the batch's trace into _runModified and clears the trace
+  // buffer, so that a run of any length only ever buffers one batch.
+  void checkpointTrace();
+  void showSnapshot(const Snapshot &snapshot);
+  SimulationWorker *_worker = nullptr;
+  pepp::SnapshotBuffer<Snapshot> _snapshots;
+  QTimer *_displayTimer = nullptr;
+  struct {
+    Endpoint pwrOff = {};
+    std::optional<sim::api2::trace::FrameIterator> from = std::nullopt;
+    RunResult result = {};
+  } _run;
+  // Addresses written by the current run, up to the last checkpointTrace().
+  QSharedPointer<sim::trace2::ModifiedAddressSink<quint16>> _runModified = {};
   project::Environment _env;
   QString _charIn = {};
   QString _objectCodeText = {};
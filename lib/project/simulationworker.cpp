@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "simulationworker.hpp"
+
+SimulationWorker::SimulationWorker(QObject *parent) : QObject(parent), _context(new QObject) {
+  _thread.setObjectName("SimulationWorker");
+  _context->moveToThread(&_thread);
+#if QT_CONFIG(thread)
+  _thread.start();
+#endif
+}
+
+SimulationWorker::~SimulationWorker() {
+  requestPause();
+  wait();
+  _thread.quit();
+  _thread.wait();
+  // The thread has exited, so nothing else can touch the context.
+  delete _context;
+}
+
+void SimulationWorker::start(Batch batch, Publish publish) {
+  if (_running.exchange(true)) return;
+  _pauseRequested = false;
+  QMetaObject::invokeMethod(
+      _context, [this, batch = std::move(batch), publish = std::move(publish)]() { loop(batch, publish); },
+      Qt::QueuedConnection);
+}
+
+void SimulationWorker::requestPause() { _pauseRequested = true; }
+
+void SimulationWorker::wait() {
+  std::unique_lock guard(_idleLock);
+  _idle.wait(guard, [this]() { return !_running.load(); });
+}
+
+bool SimulationWorker::running() const { return _running; }
+
+std::unique_lock<std::mutex> SimulationWorker::lock() { return std::unique_lock(_simLock); }
+
+void SimulationWorker::loop(Batch batch, Publish publish) {
+  using clock = std::chrono::steady_clock;
+  auto lastPublish = clock::now();
+  for (bool more = true; more;) {
+    std::lock_guard guard(_simLock);
+    more = batch() && !_pauseRequested.load(std::memory_order_relaxed);
+    if (const auto now = clock::now(); !more || now - lastPublish >= publishInterval) publish(), lastPublish = now;
+  }
+  {
+    std::lock_guard guard(_idleLock);
+    _pauseRequested = false;
+    _running = false;
+  }
+  _idle.notify_all();
+  emit finished();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+// Runs a simulator on a dedicated thread, so that the GUI thread only wakes up to repaint.
+// The simulator is driven in batches. Between batches the worker checks for a pause request and, at most once per
+// publishInterval, lets the owner copy whatever the GUI displays out of the simulator.
+//
+// Both callbacks run on the worker thread while lock() is held. While running(), GUI-thread code must only read what
+// publish() copied out, and must hold lock() for anything it changes in the simulator (e.g., breakpoints). The lock is
+// only contended between batches, so this stays responsive.
+class SimulationWorker : public QObject {
+  Q_OBJECT
+public:
+  // Runs one slice of simulation. Returns false once the simulation should stop.
+  using Batch = std::function<bool()>;
+  using Publish = std::function<void()>;
+  static constexpr auto publishInterval = std::chrono::milliseconds(16);
+
+  explicit SimulationWorker(QObject *parent = nullptr);
+  ~SimulationWorker() override;
+
+  // Does nothing if the worker is already running.
+  void start(Batch batch, Publish publish);
+  // Asynchronous; finished() is still emitted once the current batch completes.
+  void requestPause();
+  // Block the calling thread until the worker is idle.
+  void wait();
+  bool running() const;
+  std::unique_lock<std::mutex> lock();
+
+signals:
+  // Emitted from the worker thread after the final publish().
+  void finished();
+
+private:
+  void loop(Batch batch, Publish publish);
+  QThread _thread;
+  // Lives on _thread, so that start() can queue work onto it.
+  QObject *_context = nullptr;
+  std::mutex _simLock, _idleLock;
+  std::condition_variable _idle;
+  std::atomic<bool> _running = false, _pauseRequested = false;
+};
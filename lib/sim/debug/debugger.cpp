@@ -9,8 +9,20 @@ pepp::debug::BreakpointSet::BreakpointSet(ExpressionCache *cache, Environment *e
   _bitmask.reset();
 }
 
+void pepp::debug::BreakpointSet::setGuard(Guard guard) { _guard = std::move(guard); }
+
+std::unique_lock<std::mutex> pepp::debug::BreakpointSet::guard() {
+  if (_guard) return _guard();
+  return {};
+}
+
 void pepp::debug::BreakpointSet::addBP(u16 address, pepp::debug::Term *condition) {
   if (hasBP(address)) return;
+  // Compile before taking the lock, so the simulator only waits for the insertion.
+  std::unique_ptr<CachedEvaluator> eval = nullptr;
+  if (condition) eval = std::make_unique<CachedEvaluator>(condition->evaluator());
+  auto compiled = compile(condition);
+  auto lock = guard();
   // Last element < address, since we've confirmed address is not in _breakpoints.
   auto lower = std::lower_bound(_breakpoints.cbegin(), _breakpoints.cend(), address);
   auto offset = std::distance(_breakpoints.cbegin(), lower);
@@ -18,11 +30,11 @@ void pepp::debug::BreakpointSet::addBP(u16 address, pepp::debug::Term *condition
   // Resorting would be hard, since we need sort conditions by breakpoints, which reduces to cylic permutations.
   // Preserving order is just easier.
   _breakpoints.insert(_breakpoints.begin() + offset, address);
-  std::unique_ptr<CachedEvaluator> eval = nullptr;
-  if (condition) eval = std::make_unique<CachedEvaluator>(condition->evaluator());
   _conditions.insert(_conditions.begin() + offset, std::move(eval));
+  _compiled.insert(_compiled.begin() + offset, std::move(compiled));
 
   _bitmask.set(address / 8);
+  lock = {};
   emit breakpointAdded(address);
 }
 
@@ -30,17 +42,26 @@ void pepp::debug::BreakpointSet::modify_condition(u16 address, Term *condition)
   if (!hasBP(address)) return;
   auto iter = std::lower_bound(_breakpoints.cbegin(), _breakpoints.cend(), address);
   auto offset = std::distance(_breakpoints.cbegin(), iter);
-  if (condition) _conditions[offset] = std::make_unique<CachedEvaluator>(condition->evaluator());
-  else _conditions[offset].reset();
+  std::unique_ptr<CachedEvaluator> eval = nullptr;
+  if (condition) eval = std::make_unique<CachedEvaluator>(condition->evaluator());
+  auto compiled = compile(condition);
+  {
+    // The simulator may be evaluating the old condition, so it must not be destroyed underneath it.
+    auto lock = guard();
+    std::swap(_conditions[offset], eval);
+    std::swap(_compiled[offset], compiled);
+  }
   emit conditionChanged(address, condition != nullptr);
 }
 
 void pepp::debug::BreakpointSet::removeBP(u16 address) {
   if (!hasBP(address)) return;
+  auto lock = guard();
   for (int it = 0; it < _breakpoints.size(); it++) {
     if (_breakpoints[it] == address) {
       _breakpoints.erase(_breakpoints.begin() + it);
       _conditions.erase(_conditions.begin() + it);
+      _compiled.erase(_compiled.begin() + it);
       break;
     }
   }
@@ -50,6 +71,7 @@ void pepp::debug::BreakpointSet::removeBP(u16 address) {
   auto maybe_lower = std::lower_bound(_breakpoints.cbegin(), _breakpoints.cend(), lower_address);
   // If lower bound is above upper_address, we remove the last breakpoint for this chunk.
   if (maybe_lower == _breakpoints.end() || *maybe_lower > upper_address) _bitmask.reset(address / 8);
+  lock = {};
   emit breakpointRemoved(address);
 }
 
@@ -62,15 +84,22 @@ bool pepp::debug::BreakpointSet::hasBP(u16 address) const {
 
 void pepp::debug::BreakpointSet::clearBPs() {
   emit breakpointsCleared();
+  auto lock = guard();
   _breakpoints.clear();
   _conditions.clear();
+  _compiled.clear();
+  _bitmask.reset();
 }
 
 void pepp::debug::BreakpointSet::notifyPCChanged(u16 newValue) {
+  // Most instructions are nowhere near a breakpoint, so avoid the binary search when possible.
+  if (!_bitmask[newValue / 8]) return;
   if (auto iter = std::lower_bound(_breakpoints.cbegin(), _breakpoints.cend(), newValue);
       iter != _breakpoints.cend() && *iter == newValue) {
     auto offset = std::distance(_breakpoints.cbegin(), iter);
-    if (_conditions[offset]) {
+    if (_compiled[offset]) {
+      _hit = pepp::debug::value_bits<uint64_t>(_compiled[offset]->evaluate(*_env)) != 0;
+    } else if (_conditions[offset]) {
       auto bits = pepp::debug::value_bits<uint64_t>(_conditions[offset]->evaluate(CachePolicy::UseNonVolatiles, *_env));
       _hit = bits != 0;
     } else _hit = true;
@@ -87,6 +116,11 @@ std::span<std::unique_ptr<pepp::debug::CachedEvaluator>> pepp::debug::Breakpoint
 
 pepp::debug::ExpressionCache *pepp::debug::BreakpointSet::expressionCache() { return _cache; }
 
+std::unique_ptr<pepp::debug::CompiledExpression> pepp::debug::BreakpointSet::compile(Term *condition) {
+  if (!condition || !_env) return nullptr;
+  return std::make_unique<CompiledExpression>(condition->shared_from_this(), *_env);
+}
+
 pepp::debug::Environment *pepp::debug::BreakpointSet::env() { return _env; }
 
 bool pepp::debug::BreakpointSet::hit() const { return _hit; }
@@ -2,7 +2,10 @@
 #include <QtCore>
 #include <QtQmlIntegration>
 #include <bitset>
+#include <functional>
+#include <mutex>
 #include <spdlog/logger.h>
+#include "sim/debug/expr_compile.hpp"
 #include "sim/debug/expr_parser.hpp"
 #include "sim/debug/line_map.hpp"
 #include "sim/debug/stack_tracer.hpp"
@@ -17,6 +20,10 @@ class BreakpointSet : public QObject {
 public:
   explicit BreakpointSet();
   explicit BreakpointSet(pepp::debug::ExpressionCache *cache, pepp::debug::Environment *env);
+  // Breakpoints are checked by whichever thread runs the simulator. If that is not the thread which edits them, the
+  // owner provides a lock which that thread holds while simulating, and every edit below takes it.
+  using Guard = std::function<std::unique_lock<std::mutex>()>;
+  void setGuard(Guard guard);
   void addBP(u16 address, pepp::debug::Term *condition = nullptr);
   void modify_condition(u16 address, pepp::debug::Term *condition);
   void removeBP(u16 address);
@@ -45,10 +52,16 @@ private:
   std::bitset<0x1'00'00 / 8> _bitmask;
   std::vector<u16> _breakpoints;
   std::vector<std::unique_ptr<pepp::debug::CachedEvaluator>> _conditions;
+  // Parallel to _conditions. notifyPCChanged runs for every instruction, so conditions are compiled when they are
+  // set rather than walking the AST on each hit. Null if there is no condition or no environment to compile against.
+  std::vector<std::unique_ptr<pepp::debug::CompiledExpression>> _compiled;
   // Need to be carried around because we hold terms
   pepp::debug::ExpressionCache *_cache = nullptr;
   pepp::debug::Environment *_env = nullptr;
   bool _hit = false;
+  Guard _guard = nullptr;
+  std::unique_lock<std::mutex> guard();
+  std::unique_ptr<pepp::debug::CompiledExpression> compile(pepp::debug::Term *condition);
 };
 
 class BreakpointTableModel : public QAbstractTableModel {
@@ -8,6 +8,17 @@ pepp::debug::Term::~Term() = default;
 
 pepp::debug::CachedEvaluator pepp::debug::Term::evaluator() { return CachedEvaluator(shared_from_this()); }
 
+u64 pepp::debug::read_memory_bits(const Environment &env, u64 address, u8 bytecount) {
+  u64 readBuf = 0;
+  switch (bytecount) {
+  case 1: readBuf = env.read_mem_u8(address); break;
+  case 4: readBuf |= (u32)(env.read_mem_u16(address += 2) << 16); [[fallthrough]];
+  case 2: readBuf |= env.read_mem_u16(address); break;
+  default: throw std::logic_error("MemoryRead: Unsupported size");
+  }
+  return readBuf;
+}
+
 std::strong_ordering pepp::debug::Variable::operator<=>(const Term &rhs) const {
   if (type() == rhs.type()) return this->operator<=>(static_cast<const Variable &>(rhs));
   return type() <=> rhs.type();
@@ -257,14 +268,7 @@ pepp::debug::Value pepp::debug::MemoryRead::evaluate(CachePolicy mode, Environme
   auto v = eval.evaluate(mode, env);
   auto ret_type = operators::op1_dereference_typeof(*rtti, v);
   auto address = value_bits(v);
-  auto bytecount = bitness(types::unbox(ret_type)) / 8;
-  u64 readBuf = 0;
-  switch (bytecount) {
-  case 1: readBuf = env.read_mem_u8(address); break;
-  case 4: readBuf |= (u32)(env.read_mem_u16(address += 2) << 16); [[fallthrough]];
-  case 2: readBuf |= env.read_mem_u16(address); break;
-  default: throw std::logic_error("MemoryRead: Unsupported size");
-  }
+  auto readBuf = read_memory_bits(env, address, bitness(types::unbox(ret_type)) / 8);
 
   _state.mark_clean();
 
@@ -805,15 +809,7 @@ pepp::debug::Value pepp::debug::MemoryReadCastDeref::evaluate(CachePolicy mode,
   auto eval = arg->evaluator();
   auto v = eval.evaluate(mode, env);
   auto address = value_bits(v);
-  auto bytecount = bitness(unbox(this->_cast_to)) / 8;
-
-  u64 readBuf = 0;
-  switch (bytecount) {
-  case 1: readBuf = env.read_mem_u8(address); break;
-  case 4: readBuf |= (u32)(env.read_mem_u16(address += 2) << 16); [[fallthrough]];
-  case 2: readBuf |= env.read_mem_u16(address); break;
-  default: throw std::logic_error("MemoryRead: Unsupported size");
-  }
+  auto readBuf = read_memory_bits(env, address, bitness(unbox(this->_cast_to)) / 8);
   auto mem_bits = from_bits(unbox(this->_cast_to), readBuf);
   auto casted = operators::op2_typecast(*env.type_info(), mem_bits, this->_cast_to);
   u64 vb = value_bits(casted);
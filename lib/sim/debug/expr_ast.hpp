@@ -10,6 +10,9 @@ namespace pepp::debug {
 struct ConstantTermVisitor;
 struct MutatingTermVisitor;
 class CachedEvaluator;
+namespace detail {
+struct CompileVisitor;
+}
 // When creating a shared_ptr<Term> (or derived), must immediately call link() to update _dependents.
 // Prefer creation through ExpressionCache, which handles this on your behalf.
 class Term : public std::enable_shared_from_this<Term> {
@@ -313,6 +316,7 @@ protected:
   EvaluationCache cached() const override;
 
 private:
+  friend struct detail::CompileVisitor;
   EvaluationCache _state{};
   const types::BoxedType _cast_to;
 };
@@ -343,6 +347,7 @@ protected:
   EvaluationCache cached() const override;
 
 private:
+  friend struct detail::CompileVisitor;
   EvaluationCache _state{};
   const types::BoxedType _cast_to;
 };
@@ -374,6 +379,7 @@ protected:
   EvaluationCache cached() const override;
 
 private:
+  friend struct detail::CompileVisitor;
   EvaluationCache _state{};
   QString _name{};
   types::TypeInfo::IndirectHandle _hnd{};
@@ -406,6 +412,9 @@ private:
   EvaluationCache _state{};
 };
 
+// Read bytecount bytes at address, as MemoryRead and MemoryReadCastDeref do. Throws if bytecount is unsupported.
+u64 read_memory_bits(const Environment &env, u64 address, u8 bytecount);
+
 // If you add a new AST node type, you'll need to add new handlers to these visitor classes.
 struct MutatingTermVisitor {
   virtual void accept(Variable &node) = 0;
@@ -0,0 +1,186 @@
+#include "expr_compile.hpp"
+#include "expr_ast_ops.hpp"
+#include "expr_parser.hpp"
+
+namespace {
+// Evaluating a term updates its cache, and the terms of a watch expression may be evaluated on another thread than
+// the compiled expression. Re-parse the term into a cache of its own, so that the copy shares no nodes.
+pepp::debug::CachedEvaluator privateEvaluator(const pepp::debug::Term &term, pepp::debug::Environment &env) {
+  pepp::debug::ExpressionCache cache;
+  pepp::debug::Parser parser(cache, *env.type_info());
+  if (auto copy = parser.compile(term.to_string()); copy) return copy->evaluator();
+  return {};
+}
+} // namespace
+
+pepp::debug::CompiledExpression::CompiledExpression(std::shared_ptr<Term> term, Environment &env)
+    : _term(std::move(term)) {
+  detail::CompileVisitor visitor(*this, env);
+  _term->accept(visitor);
+  _stack.reserve(visitor.max_depth);
+}
+
+pepp::debug::Value pepp::debug::CompiledExpression::evaluate(Environment &env) {
+  using namespace pepp::debug::operators;
+  const auto &info = *env.type_info();
+  _stack.clear();
+  for (const auto &ins : _program) {
+    switch (ins.op) {
+    case Op::Constant: _stack.emplace_back(_constants[ins.operand]); continue;
+    case Op::Variable: _stack.emplace_back(env.evaluate_variable(_names[ins.operand])); continue;
+    case Op::DebuggerVariable: _stack.emplace_back(env.evaluate_debug_variable(ins.operand)); continue;
+    case Op::Fallback:
+      // Nothing marks the private copies dirty, so their caches can never be trusted.
+      _stack.emplace_back(_fallbacks[ins.operand].evaluate(CachePolicy::UseNever, env));
+      continue;
+    default: break;
+    }
+
+    // Remaining instructions replace the top of the stack.
+    auto &top = _stack.back();
+    switch (ins.op) {
+    case Op::Unary:
+      switch (UnaryPrefix::Operators(ins.subop)) {
+      case UnaryPrefix::Operators::PLUS: top = op1_plus(info, top); break;
+      case UnaryPrefix::Operators::MINUS: top = op1_minus(info, top); break;
+      case UnaryPrefix::Operators::NOT: top = op1_not(info, top); break;
+      case UnaryPrefix::Operators::NEGATE: top = op1_negate(info, top); break;
+      default: throw std::logic_error("Unimplemented");
+      }
+      break;
+    case Op::Binary: {
+      // top is the rhs, which must be removed before the lhs can be replaced.
+      const auto rhs = std::move(top);
+      _stack.pop_back();
+      auto &lhs = _stack.back();
+      switch (BinaryInfix::Operators(ins.subop)) {
+      case BinaryInfix::Operators::MULTIPLY: lhs = op2_mul(info, lhs, rhs); break;
+      case BinaryInfix::Operators::DIVIDE: lhs = op2_div(info, lhs, rhs); break;
+      case BinaryInfix::Operators::MODULO: lhs = op2_mod(info, lhs, rhs); break;
+      case BinaryInfix::Operators::ADD: lhs = op2_add(info, lhs, rhs); break;
+      case BinaryInfix::Operators::SUBTRACT: lhs = op2_sub(info, lhs, rhs); break;
+      case BinaryInfix::Operators::SHIFT_LEFT: lhs = op2_bsl(info, lhs, rhs); break;
+      case BinaryInfix::Operators::SHIFT_RIGHT: lhs = op2_bsr(info, lhs, rhs); break;
+      case BinaryInfix::Operators::LESS: lhs = op2_lt(info, lhs, rhs); break;
+      case BinaryInfix::Operators::LESS_OR_EQUAL: lhs = op2_le(info, lhs, rhs); break;
+      case BinaryInfix::Operators::EQUAL: lhs = op2_eq(info, lhs, rhs); break;
+      case BinaryInfix::Operators::NOT_EQUAL: lhs = op2_ne(info, lhs, rhs); break;
+      case BinaryInfix::Operators::GREATER: lhs = op2_gt(info, lhs, rhs); break;
+      case BinaryInfix::Operators::GREATER_OR_EQUAL: lhs = op2_ge(info, lhs, rhs); break;
+      case BinaryInfix::Operators::BIT_AND: lhs = op2_bitand(info, lhs, rhs); break;
+      case BinaryInfix::Operators::BIT_OR: lhs = op2_bitor(info, lhs, rhs); break;
+      case BinaryInfix::Operators::BIT_XOR: lhs = op2_bitxor(info, lhs, rhs); break;
+      default: throw std::logic_error("Unimplemented");
+      }
+      break;
+    }
+    case Op::MemoryRead: {
+      const auto ret_type = types::unbox(op1_dereference_typeof(info, top));
+      top = from_bits(ret_type, read_memory_bits(env, value_bits(top), types::bitness(ret_type) / 8));
+      break;
+    }
+    case Op::MemoryReadCastDeref: {
+      const auto &cast_to = _types[ins.operand];
+      const auto mem_type = types::unbox(cast_to);
+      const auto bits = read_memory_bits(env, value_bits(top), types::bitness(mem_type) / 8);
+      top = op2_typecast(info, from_bits(mem_type, bits), cast_to);
+      break;
+    }
+    case Op::DirectCast: top = op2_typecast(info, top, _types[ins.operand]); break;
+    case Op::IndirectCast: top = op2_typecast(info, top, info.versioned_from(_indirect[ins.operand]).type); break;
+    default: throw std::logic_error("Unimplemented");
+    }
+  }
+  return _stack.back();
+}
+
+std::shared_ptr<pepp::debug::Term> pepp::debug::CompiledExpression::term() const { return _term; }
+
+std::size_t pepp::debug::CompiledExpression::size() const { return _program.size(); }
+
+pepp::debug::detail::CompileVisitor::CompileVisitor(CompiledExpression &target, Environment &env)
+    : target(target), env(env) {}
+
+bool pepp::debug::detail::CompileVisitor::fold(Term &node) {
+  if (!is_constant_expression(node)) return false;
+  try {
+    target._constants.emplace_back(node.evaluator().evaluate(CachePolicy::UseNever, env));
+  } catch (const std::exception &) {
+    // Leave the error to be reported each time the expression is evaluated, as it would be without compilation.
+    return false;
+  }
+  emit(CompiledExpression::Op::Constant, 1, 0, target._constants.size() - 1);
+  return true;
+}
+
+void pepp::debug::detail::CompileVisitor::emit(CompiledExpression::Op op, i8 stack_delta, u8 subop, u32 operand) {
+  target._program.emplace_back(CompiledExpression::Instruction{.op = op, .subop = subop, .operand = operand});
+  depth += stack_delta;
+  max_depth = std::max(max_depth, depth);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(Variable &node) {
+  target._names.emplace_back(node.name);
+  emit(CompiledExpression::Op::Variable, 1, 0, target._names.size() - 1);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(DebuggerVariable &node) {
+  emit(CompiledExpression::Op::DebuggerVariable, 1, 0, env.cache_debug_variable_name(node.name));
+}
+
+void pepp::debug::detail::CompileVisitor::accept(Constant &node) {
+  target._constants.emplace_back(node.value);
+  emit(CompiledExpression::Op::Constant, 1, 0, target._constants.size() - 1);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(BinaryInfix &node) {
+  if (fold(node)) return;
+  node.lhs->accept(*this);
+  node.rhs->accept(*this);
+  emit(CompiledExpression::Op::Binary, -1, static_cast<u8>(node.op));
+}
+
+void pepp::debug::detail::CompileVisitor::accept(MemberAccess &node) {
+  target._fallbacks.emplace_back(privateEvaluator(node, env));
+  emit(CompiledExpression::Op::Fallback, 1, 0, target._fallbacks.size() - 1);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(UnaryPrefix &node) {
+  switch (node.op) {
+  case UnaryPrefix::Operators::DEREFERENCE: [[fallthrough]];
+  case UnaryPrefix::Operators::ADDRESS_OF:
+    // Let the AST report these as unimplemented.
+    target._fallbacks.emplace_back(privateEvaluator(node, env));
+    return emit(CompiledExpression::Op::Fallback, 1, 0, target._fallbacks.size() - 1);
+  default: break;
+  }
+  if (fold(node)) return;
+  node.arg->accept(*this);
+  emit(CompiledExpression::Op::Unary, 0, static_cast<u8>(node.op));
+}
+
+void pepp::debug::detail::CompileVisitor::accept(MemoryRead &node) {
+  node.arg->accept(*this);
+  emit(CompiledExpression::Op::MemoryRead, 0);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(MemoryReadCastDeref &node) {
+  node.arg->accept(*this);
+  target._types.emplace_back(node._cast_to);
+  emit(CompiledExpression::Op::MemoryReadCastDeref, 0, 0, target._types.size() - 1);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(Parenthesized &node) { node.term->accept(*this); }
+
+void pepp::debug::detail::CompileVisitor::accept(DirectCast &node) {
+  if (fold(node)) return;
+  node.arg->accept(*this);
+  target._types.emplace_back(node._cast_to);
+  emit(CompiledExpression::Op::DirectCast, 0, 0, target._types.size() - 1);
+}
+
+void pepp::debug::detail::CompileVisitor::accept(IndirectCast &node) {
+  node.arg->accept(*this);
+  target._indirect.emplace_back(node._hnd);
+  emit(CompiledExpression::Op::IndirectCast, 0, 0, target._indirect.size() - 1);
+}
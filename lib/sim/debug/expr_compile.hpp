@@ -0,0 +1,80 @@
+#pragma once
+#include "./expr_ast.hpp"
+
+namespace pepp::debug {
+// A Term flattened into a postfix program, for expressions that are re-evaluated far more often than they are
+// edited (e.g., breakpoint conditions, which are checked every time the PC reaches their address).
+//
+// Evaluation neither reads nor updates the caches of the underlying terms, so compiling a term does not steal dirty
+// bits from a watch expression which shares it. Constant subexpressions are folded and debugger variable names are
+// resolved when the expression is compiled, which means the expression must be re-compiled if the environment changes.
+// Terms without a compiled form (e.g., member access) are delegated to a CachedEvaluator over a private copy of the
+// term, so that a breakpoint condition checked on the simulator's thread never touches a watch expression's terms.
+class CompiledExpression {
+public:
+  CompiledExpression(std::shared_ptr<Term> term, Environment &env);
+  CompiledExpression(const CompiledExpression &) = delete;
+  CompiledExpression &operator=(const CompiledExpression &) = delete;
+  CompiledExpression(CompiledExpression &&) = default;
+  CompiledExpression &operator=(CompiledExpression &&) = default;
+
+  Value evaluate(Environment &env);
+  std::shared_ptr<Term> term() const;
+  // Number of instructions in the compiled program.
+  std::size_t size() const;
+
+private:
+  friend struct detail::CompileVisitor;
+  enum class Op : u8 {
+    Constant,            // Push _constants[operand]
+    Variable,            // Push env.evaluate_variable(_names[operand])
+    DebuggerVariable,    // Push env.evaluate_debug_variable(operand)
+    Fallback,            // Push _fallbacks[operand].evaluate(...)
+    Unary,               // Apply UnaryPrefix::Operators(subop) to the top of the stack
+    Binary,              // Pop rhs, then apply BinaryInfix::Operators(subop) to lhs and rhs
+    MemoryRead,          // Replace an address with the value it points to
+    MemoryReadCastDeref, // Replace an address with the value it points to, read as _types[operand]
+    DirectCast,          // Cast the top of the stack to _types[operand]
+    IndirectCast,        // Cast the top of the stack to the current version of _indirect[operand]
+  };
+  struct Instruction {
+    Op op;
+    u8 subop = 0;
+    u32 operand = 0;
+  };
+
+  std::shared_ptr<Term> _term = nullptr;
+  std::vector<Instruction> _program;
+  std::vector<Value> _constants;
+  std::vector<QString> _names;
+  std::vector<types::BoxedType> _types;
+  std::vector<types::TypeInfo::IndirectHandle> _indirect;
+  std::vector<CachedEvaluator> _fallbacks;
+  // Kept between evaluations to avoid re-allocating on every call.
+  std::vector<Value> _stack;
+};
+
+namespace detail {
+struct CompileVisitor : public MutatingTermVisitor {
+  CompileVisitor(CompiledExpression &target, Environment &env);
+  CompiledExpression &target;
+  Environment &env;
+  // Deepest the stack may grow while evaluating the program.
+  std::size_t depth = 0, max_depth = 0;
+  // Returns true if the term was folded into a constant.
+  bool fold(Term &node);
+  void emit(CompiledExpression::Op op, i8 stack_delta, u8 subop = 0, u32 operand = 0);
+  void accept(Variable &node) override;
+  void accept(DebuggerVariable &node) override;
+  void accept(Constant &node) override;
+  void accept(BinaryInfix &node) override;
+  void accept(MemberAccess &node) override;
+  void accept(UnaryPrefix &node) override;
+  void accept(MemoryRead &node) override;
+  void accept(MemoryReadCastDeref &node) override;
+  void accept(Parenthesized &node) override;
+  void accept(DirectCast &node) override;
+  void accept(IndirectCast &node) override;
+};
+} // namespace detail
+} // namespace pepp::debug
@@ -38,8 +38,10 @@
 #include "core/arch/riscv/isa/rvfd.hpp"
 #include "core/arch/riscv/isa/rvi.hpp"
 #include "decoder_cache_impl.hpp"
+#include "superinstructions.hpp"
 #include "sim3/systems/notraced_riscv_isa3_system.hpp"
 #include "threaded_bytecodes.hpp"
+#include "../translate/block_translator.hpp"
 
 #define DISPATCH_MODE_SWITCH_BASED
 #define DISPATCH_FUNC simulate_bytecode
@@ -108,6 +110,17 @@ static constexpr bool FUZZING = false;
 
 #define OVERFLOW_CHECKED_JUMP() goto check_jump
 
+// Superinstructions: move from the first to the second instruction of the pair.
+#define FUSED_SECOND(len) decoder += (len) >> DecoderCache<address_t>::SHIFT;
+#define FUSION_HIT(idiom)                                                                                              \
+  if constexpr (fusion_counters_enabled) fusion_counters().hit(FusedIdiom::idiom);
+// Forward BEQ/BNE were rewritten to the _FW bytecodes, which skip the counter check
+#define PERFORM_FUSED_BRANCH()                                                                                         \
+  if (fi.signed_imm() > 0) {                                                                                           \
+    PERFORM_FORWARD_BRANCH();                                                                                          \
+  }                                                                                                                    \
+  PERFORM_BRANCH();
+
 template <AddressType address_t>
 PEPP_HOT_PATH()
 bool CPU<address_t>::simulate(address_t pc, uint64_t inscounter, uint64_t maxcounter) {
@@ -357,6 +370,109 @@ continue_segment:
       NEXT_BLOCK(4, false);
     }
 
+    case RV32I_BC_LUI_ADDI: {
+      VIEW_INSTR_AS(fu, FasterJtype);
+      REG(fu.rd) = fu.upper_imm();
+      FUSED_SECOND(4);
+      VIEW_INSTR_AS(fi, FasterItype);
+      REG(fi.get_rs1()) = REG(fi.get_rs2()) + fi.signed_imm();
+      FUSION_HIT(LuiAddi);
+      NEXT_INSTR();
+    }
+    case RV64I_BC_LUI_ADDIW: {
+      if constexpr (W >= 8) {
+        VIEW_INSTR_AS(fu, FasterJtype);
+        REG(fu.rd) = fu.upper_imm();
+        FUSED_SECOND(4);
+        VIEW_INSTR_AS(fi, FasterItype);
+        REG(fi.get_rs1()) = (int32_t)((uint32_t)REG(fi.get_rs2()) + fi.signed_imm());
+        FUSION_HIT(LuiAddi);
+        NEXT_INSTR();
+      } else PEPP_UNREACHABLE();
+    }
+    case RV32I_BC_AUIPC_JALR: {
+      VIEW_INSTR_AS(fu, FasterJtype);
+      REG(fu.rd) = (pc - (*decoder).block_bytes()) + fu.upper_imm();
+      FUSED_SECOND(4);
+      VIEW_INSTR_AS(fi, FasterItype);
+      const auto address = REG(fi.rs2) + fi.signed_imm();
+      if (fi.rs1 != 0) REG(fi.rs1) = pc + 4;
+      FUSION_HIT(AuipcJalr);
+      static constexpr addr_t ALIGN_MASK = (compressed_enabled) ? 0x1 : 0x3;
+      pc = address & ~ALIGN_MASK;
+      OVERFLOW_CHECKED_JUMP();
+    }
+    case RV32I_BC_LDW_BEQ: {
+      VIEW_INSTR_AS(fl, FasterItype);
+      REG(fl.get_rs1()) = (int32_t)(*this).memory().template read<uint32_t>(REG(fl.get_rs2()) + fl.signed_imm());
+      FUSED_SECOND(4);
+      FUSION_HIT(LoadBranch);
+      VIEW_INSTR_AS(fi, FasterItype);
+      if (REG(fi.get_rs1()) == REG(fi.get_rs2())) {
+        PERFORM_FUSED_BRANCH();
+      }
+      NEXT_BLOCK(4, false);
+    }
+    case RV32I_BC_LDW_BNE: {
+      VIEW_INSTR_AS(fl, FasterItype);
+      REG(fl.get_rs1()) = (int32_t)(*this).memory().template read<uint32_t>(REG(fl.get_rs2()) + fl.signed_imm());
+      FUSED_SECOND(4);
+      FUSION_HIT(LoadBranch);
+      VIEW_INSTR_AS(fi, FasterItype);
+      if (REG(fi.get_rs1()) != REG(fi.get_rs2())) {
+        PERFORM_FUSED_BRANCH();
+      }
+      NEXT_BLOCK(4, false);
+    }
+    case RV32I_BC_LDD_BEQ: {
+      if constexpr (W >= 8) {
+        VIEW_INSTR_AS(fl, FasterItype);
+        REG(fl.get_rs1()) = (int64_t)(*this).memory().template read<uint64_t>(REG(fl.get_rs2()) + fl.signed_imm());
+        FUSED_SECOND(4);
+        FUSION_HIT(LoadBranch);
+        VIEW_INSTR_AS(fi, FasterItype);
+        if (REG(fi.get_rs1()) == REG(fi.get_rs2())) {
+          PERFORM_FUSED_BRANCH();
+        }
+        NEXT_BLOCK(4, false);
+      } else PEPP_UNREACHABLE();
+    }
+    case RV32I_BC_LDD_BNE: {
+      if constexpr (W >= 8) {
+        VIEW_INSTR_AS(fl, FasterItype);
+        REG(fl.get_rs1()) = (int64_t)(*this).memory().template read<uint64_t>(REG(fl.get_rs2()) + fl.signed_imm());
+        FUSED_SECOND(4);
+        FUSION_HIT(LoadBranch);
+        VIEW_INSTR_AS(fi, FasterItype);
+        if (REG(fi.get_rs1()) != REG(fi.get_rs2())) {
+          PERFORM_FUSED_BRANCH();
+        }
+        NEXT_BLOCK(4, false);
+      } else PEPP_UNREACHABLE();
+    }
+    case RV32I_BC_ADDI_BNE: {
+      VIEW_INSTR_AS(fa, FasterItype);
+      REG(fa.get_rs1()) = REG(fa.get_rs2()) + fa.signed_imm();
+      FUSED_SECOND(4);
+      FUSION_HIT(AddiBranch);
+      VIEW_INSTR_AS(fi, FasterItype);
+      if (REG(fi.get_rs1()) != REG(fi.get_rs2())) {
+        PERFORM_FUSED_BRANCH();
+      }
+      NEXT_BLOCK(4, false);
+    }
+    case RV32C_BC_ADDI_BNEZ: {
+      VIEW_INSTR_AS(fa, FasterItype);
+      REG(fa.get_rs1()) = REG(fa.get_rs2()) + fa.signed_imm();
+      FUSED_SECOND(2);
+      FUSION_HIT(AddiBranch);
+      VIEW_INSTR_AS(fi, FasterItype);
+      if (REG(fi.get_rs1()) != 0) {
+        PERFORM_BRANCH();
+      }
+      NEXT_BLOCK(2, false);
+    }
+
     case RV32I_BC_LDW: {
       VIEW_INSTR_AS(fi, FasterItype);
       const auto addr = REG(fi.get_rs2()) + fi.signed_imm();
@@ -1007,6 +1123,15 @@ continue_segment:
       return true;
     }
 
+    case RV32I_BC_TRANSLATOR: {
+      // Entry point of a translated block. The counter already includes the block, as with any other entry.
+      const address_t block_pc = (decoder - exec_decoder) << DecoderCache<address_t>::SHIFT;
+      if (exec->translation()->run(*this, *exec, block_pc, pc, counter)) {
+        NEXT_SEGMENT();
+      }
+      goto check_jump;
+    }
+
     default: goto execute_invalid;
     } // switch case
   } // while loop
@@ -34,6 +34,7 @@
 #pragma once
 #include <memory>
 #include <stdexcept>
+#include <vector>
 #include "../notraced_cpu.hpp"
 #include "./threaded_bytecodes.hpp"
 #include "core/arch/riscv/isa/rv_base.hpp"
@@ -48,6 +49,7 @@ namespace riscv
 {
 	template<AddressType address_t> struct DecoderCache;
 	template<AddressType address_t> struct DecoderData;
+	template<AddressType address_t> struct TranslatedSegment;
 
 	// A fully decoded execute segment
 	template <AddressType address_t>
@@ -83,6 +85,13 @@ namespace riscv
 			m_decoder_cache_size = size;
 			return m_decoder_cache.get();
 		}
+		// Adopt a decoder cache which was not allocated with new[], eg. one mapped from a file
+		template <typename Deleter>
+		auto* create_decoder_cache(DecoderCache<address_t>* cache, size_t size, Deleter deleter) {
+			m_decoder_cache.reset(cache, std::move(deleter));
+			m_decoder_cache_size = size;
+			return m_decoder_cache.get();
+		}
 		void set_decoder(DecoderData<address_t>* dec) { m_exec_decoder = dec; }
 
 		size_t size_bytes() const noexcept {
@@ -100,7 +109,14 @@ namespace riscv
 		uint32_t crc32c_hash() const noexcept { return m_crc32c_hash; }
 		void set_crc32c_hash(uint32_t hash) { m_crc32c_hash = hash; }
 
-    bool is_binary_translated() const noexcept { return false; }
+    bool is_binary_translated() const noexcept { return m_translation != nullptr; }
+    auto *translation() const noexcept { return m_translation.get(); }
+    void set_translation(std::shared_ptr<TranslatedSegment<address_t>> translation) {
+      m_translation = std::move(translation);
+    }
+    /// @brief Restore the decoder cache entries rewritten by the block translator, and drop the translation.
+    /// Must be called before patching the decoder cache (breakpoints, live-patching).
+    void revert_translation();
 		bool is_libtcc() const noexcept { return false; }
 
 		bool is_execute_only() const noexcept { return m_is_execute_only; }
@@ -127,7 +143,11 @@ namespace riscv
 
 		// Decoder cache is used to run bytecode simulation at a high speed
 		size_t          m_decoder_cache_size = 0;
-		std::unique_ptr<DecoderCache<address_t>[]> m_decoder_cache = nullptr;
+		std::shared_ptr<DecoderCache<address_t>[]> m_decoder_cache = nullptr;
+
+		// Native code for (some of) the blocks in the decoder cache
+		std::shared_ptr<TranslatedSegment<address_t>> m_translation = nullptr;
+		std::vector<std::shared_ptr<TranslatedSegment<address_t>>> m_retired_translations;
 
 		uint32_t m_crc32c_hash = 0x0; // CRC32-C of the execute segment
 		bool m_is_execute_only = false;
@@ -162,6 +182,8 @@ namespace riscv
 
 		m_decoder_cache_size = other.m_decoder_cache_size;
 		m_decoder_cache = std::move(other.m_decoder_cache);
+		m_translation = std::move(other.m_translation);
+		m_retired_translations = std::move(other.m_retired_translations);
 	}
 
   template <AddressType address_t> inline DecodedExecuteSegment<address_t>::~DecodedExecuteSegment() {}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "decoder_cache_file.hpp"
+#include <cinttypes>
+#include <cstring>
+#include <filesystem>
+#include "decoded_exec_segment.hpp"
+#include "decoder_cache.hpp"
+#include "threaded_bytecodes.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+#include "sim3/utils/crc32.hpp"
+#include "sim3/utils/private_cache.hpp"
+#include "sim3/utils/sha256.hpp"
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RISCV_DECODER_CACHE_FILES
+#endif
+
+namespace riscv {
+static constexpr char DECODER_CACHE_MAGIC[8] = {'P', 'E', 'P', 'P', 'R', 'V', 'D', 'C'};
+
+namespace {
+// Instructions which exercise every part of the decoder: random words for each major opcode, random compressed
+// instructions for each quadrant and funct3, and adjacent pairs whose second instruction reads the register the
+// first one writes, which is the shape of every idiom we fuse. The generator is seeded, so the corpus never changes.
+std::vector<uint32_t> probe_corpus() {
+  uint64_t state = 0x5045505052564443; // "PEPPRVDC"
+  auto next = [&state] {
+    uint64_t z = (state += 0x9E3779B97F4A7C15);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+    return uint32_t(z ^ (z >> 31));
+  };
+  std::vector<uint32_t> code;
+  for (uint32_t op = 0; op < 32; op++)
+    for (int i = 0; i < 256; i++) code.push_back((next() & ~0x7Fu) | (op << 2) | 0b11);
+  for (uint32_t first = 0; first < 32; first++) {
+    for (uint32_t second = 0; second < 32; second++) {
+      for (int i = 0; i < 4; i++) {
+        const uint32_t rd = next() & 0x1F;
+        code.push_back((next() & ~0xFFFu) | (rd << 7) | (first << 2) | 0b11);
+        code.push_back((next() & ~0xF807Fu) | (rd << 15) | (second << 2) | 0b11);
+      }
+    }
+  }
+  if constexpr (compressed_enabled) {
+    // Two compressed instructions per word, so the 32-bit instructions above stay aligned
+    auto compressed = [&next](uint32_t quadrant, uint32_t funct3) {
+      return (next() & 0x1FFC) | (funct3 << 13) | quadrant;
+    };
+    for (uint32_t quadrant = 0; quadrant < 3; quadrant++)
+      for (uint32_t funct3 = 0; funct3 < 8; funct3++)
+        for (int i = 0; i < 64; i++) code.push_back(compressed(quadrant, funct3) | (compressed(quadrant, funct3) << 16));
+    // Full register field of the first instruction (bits 11:7) matching the 3-bit field of the second (bits 9:7)
+    for (uint32_t first = 0; first < 24; first++) {
+      for (uint32_t second = 0; second < 24; second++) {
+        const uint32_t reg = next() & 7;
+        const uint32_t a = (compressed(first / 8, first % 8) & ~0xF80u) | ((8 + reg) << 7);
+        const uint32_t b = (compressed(second / 8, second % 8) & ~0x380u) | (reg << 7);
+        code.push_back(a | (b << 16));
+      }
+    }
+  }
+  return code;
+}
+
+// Decode the probe corpus on a throwaway machine, and hash the decoder cache it produced
+template <AddressType address_t> void hash_probe_decoding(Sha256 &hash, bool fused) {
+  static constexpr address_t PROBE_BASE = 0x10000;
+  const auto code = probe_corpus();
+  MachineOptions<address_t> options;
+  options.memory_max = 1ull << 20;
+  options.use_memory_arena = false;
+  options.use_shared_execute_segments = false;
+  options.persistent_decoder_cache = false;
+  options.translate_enabled = false;
+  options.decoder_threads = 1;
+  options.fuse_superinstructions = fused;
+  Machine<address_t> machine{options};
+  auto &exec = machine.cpu.init_execute_area(code.data(), PROBE_BASE, code.size() * sizeof(uint32_t));
+  hash.update(exec.decoder_cache_base(), exec.decoder_cache_size() * sizeof(DecoderCache<address_t>));
+}
+} // namespace
+
+template <AddressType address_t> const DecoderCacheBuildId &decoder_cache_build_id() {
+  static const DecoderCacheBuildId id = [] {
+    Sha256 hash;
+    hash.update_value(DECODER_CACHE_FILE_VERSION);
+    hash.update_value(uint32_t(8 * sizeof(address_t)));
+    hash.update_value(uint32_t(BYTECODES_MAX));
+    hash.update_value(uint32_t(compressed_enabled));
+    hash.update_value(uint32_t(sizeof(DecoderData<address_t>)));
+    hash.update_value(uint32_t(sizeof(DecoderCache<address_t>)));
+    hash.update_value(uint32_t(DecoderCache<address_t>::DIVISOR));
+    hash_probe_decoding<address_t>(hash, false);
+    hash_probe_decoding<address_t>(hash, true);
+    return hash.finish();
+  }();
+  return id;
+}
+template const DecoderCacheBuildId &decoder_cache_build_id<uint32_t>();
+template const DecoderCacheBuildId &decoder_cache_build_id<uint64_t>();
+
+template <AddressType address_t>
+std::string DecoderCacheFile<address_t>::path_for(const MachineOptions<address_t> &options, const SegmentKey &key) {
+  const std::string dir = private_cache_directory(options.decoder_cache_dir, "rvdc");
+  if (dir.empty()) return {};
+
+  char name[96];
+  snprintf(name, sizeof(name), "rv%zu-%" PRIx64 "-%08x-%" PRIx64 ".rvdc", 8 * sizeof(address_t), key.pc, key.crc,
+           key.arena_size);
+  return (std::filesystem::path(dir) / name).string();
+}
+
+#ifdef RISCV_DECODER_CACHE_FILES
+template <AddressType address_t>
+static void fill_header(DecoderCacheFileHeader &hdr, const DecodedExecuteSegment<address_t> &exec,
+                        const MachineOptions<address_t> &options, uint64_t arena_size) {
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, DECODER_CACHE_MAGIC, sizeof(hdr.magic));
+  hdr.version = DECODER_CACHE_FILE_VERSION;
+  const auto &build_id = decoder_cache_build_id<address_t>();
+  std::memcpy(hdr.build_id, build_id.data(), sizeof(hdr.build_id));
+  hdr.xlen = 8 * sizeof(address_t);
+  hdr.compressed = compressed_enabled;
+  hdr.fused = options.fuse_superinstructions;
+  hdr.exec_begin = exec.exec_begin();
+  hdr.exec_end = exec.exec_end();
+  hdr.pagedata_base = exec.pagedata_base();
+  hdr.arena_size = arena_size;
+  hdr.segment_crc = exec.crc32c_hash();
+  hdr.page_bytes = sizeof(DecoderCache<address_t>);
+}
+#endif
+
+template <AddressType address_t>
+DecoderCache<address_t> *DecoderCacheFile<address_t>::load(const std::string &path,
+                                                            DecodedExecuteSegment<address_t> &exec,
+                                                            const MachineOptions<address_t> &options,
+                                                            uint64_t arena_size, size_t page_count) {
+#ifdef RISCV_DECODER_CACHE_FILES
+  const int fd = open_private_file(path);
+  if (fd < 0) return nullptr;
+  const size_t payload_bytes = page_count * sizeof(DecoderCache<address_t>);
+  const size_t total = DECODER_CACHE_FILE_ALIGN + payload_bytes;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) != total) {
+    close(fd);
+    return nullptr;
+  }
+  // Private and writable: decoder cache entries are patched at runtime, and those changes must stay in this process
+  void *base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return nullptr;
+
+  DecoderCacheFileHeader expected;
+  fill_header(expected, exec, options, arena_size);
+  expected.page_count = page_count;
+  DecoderCacheFileHeader actual;
+  std::memcpy(&actual, base, sizeof(actual));
+  expected.payload_crc = actual.payload_crc;
+
+  auto *payload = static_cast<uint8_t *>(base) + DECODER_CACHE_FILE_ALIGN;
+  if (std::memcmp(&expected, &actual, sizeof(actual)) != 0 ||
+      crc32c(payload, payload_bytes) != actual.payload_crc) {
+    munmap(base, total);
+    return nullptr;
+  }
+  return exec.create_decoder_cache(reinterpret_cast<DecoderCache<address_t> *>(payload), page_count,
+                                   [base, total](DecoderCache<address_t> *) { munmap(base, total); });
+#else
+  (void)path, (void)exec, (void)options, (void)arena_size, (void)page_count;
+  return nullptr;
+#endif
+}
+
+template <AddressType address_t>
+bool DecoderCacheFile<address_t>::store(const std::string &path, const DecodedExecuteSegment<address_t> &exec,
+                                        const MachineOptions<address_t> &options, uint64_t arena_size) {
+#ifdef RISCV_DECODER_CACHE_FILES
+  const auto *payload = exec.decoder_cache_base();
+  const size_t payload_bytes = exec.decoder_cache_size() * sizeof(DecoderCache<address_t>);
+  if (payload == nullptr) return false;
+
+  std::vector<uint8_t> head(DECODER_CACHE_FILE_ALIGN, 0);
+  DecoderCacheFileHeader hdr;
+  fill_header(hdr, exec, options, arena_size);
+  hdr.page_count = exec.decoder_cache_size();
+  hdr.payload_crc = crc32c(payload, payload_bytes);
+  std::memcpy(head.data(), &hdr, sizeof(hdr));
+
+  // Written aside and renamed, so that concurrent emulators never map a partial file
+  return write_private_file(path, {{head.data(), head.size()}, {payload, payload_bytes}});
+#else
+  (void)path, (void)exec, (void)options, (void)arena_size;
+  return false;
+#endif
+}
+
+template struct DecoderCacheFile<uint32_t>;
+template struct DecoderCacheFile<uint64_t>;
+} // namespace riscv
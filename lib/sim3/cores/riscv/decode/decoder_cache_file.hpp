@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include "sim3/common_macros.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system/rv_common.hpp"
+
+namespace riscv {
+template <AddressType address_t> struct DecoderCache;
+template <AddressType address_t> struct DecodedExecuteSegment;
+struct SegmentKey;
+
+/*
+ * Persistent decoder caches.
+ *
+ * A freshly generated decoder cache only depends on the bytes of the execute segment, its placement, and the
+ * emulator build: handler indices are resolved lazily, so every m_handler is still zero when generation finishes.
+ * That makes the pages safe to write to disk verbatim and to map back in on a later run of the same program.
+ *
+ * File layout: a DecoderCacheFileHeader, zero padding up to DECODER_CACHE_FILE_ALIGN, then the DecoderCache pages.
+ * The payload offset is a multiple of any host page size we run on, so the pages are mapped privately straight from
+ * the file. Later patches (breakpoints, live-patching, translation, lazy handler indices) are copy-on-write and never
+ * reach the file.
+ */
+
+static constexpr uint32_t DECODER_CACHE_FILE_VERSION = 2;
+static constexpr size_t DECODER_CACHE_FILE_ALIGN = 65536;
+
+struct DecoderCacheFileHeader {
+  char magic[8]; // "PEPPRVDC"
+  uint32_t version;
+  uint8_t build_id[32]; // decoder_cache_build_id<address_t>()
+  uint32_t xlen;
+  uint32_t compressed;
+  uint32_t fused; // MachineOptions::fuse_superinstructions
+  uint32_t reserved;
+  uint64_t exec_begin;
+  uint64_t exec_end;
+  uint64_t pagedata_base;
+  uint64_t arena_size;
+  uint32_t segment_crc; // CRC32-C of the execute segment, as in SegmentKey
+  uint32_t payload_crc; // CRC32-C of the DecoderCache pages
+  uint64_t page_count;
+  uint64_t page_bytes; // sizeof(DecoderCache<address_t>)
+};
+
+using DecoderCacheBuildId = std::array<uint8_t, 32>;
+
+/// @brief Identifies how this emulator build generates decoder caches.
+/// @details A SHA-256 of the decoder cache layout and of the caches generated for a fixed corpus of instructions,
+/// with and without fusion. Bytecode numbering and instruction rewrites are not versioned individually, so this
+/// catches changes to them without invalidating the files on every rebuild, and identical builds agree on it.
+/// Computed on first use.
+template <AddressType address_t> const DecoderCacheBuildId &decoder_cache_build_id();
+
+template <AddressType address_t> struct DecoderCacheFile {
+  /// @brief The file which holds the decoder cache of the segment identified by key.
+  static std::string path_for(const MachineOptions<address_t> &options, const SegmentKey &key);
+
+  /// @brief Map a stored decoder cache into exec, which must not have a decoder cache yet.
+  /// @return The first page of the mapped cache, or nullptr if the file is missing, stale or corrupt.
+  static DecoderCache<address_t> *load(const std::string &path, DecodedExecuteSegment<address_t> &exec,
+                                       const MachineOptions<address_t> &options, uint64_t arena_size,
+                                       size_t page_count);
+
+  /// @brief Write the decoder cache of exec, which must not have been patched since it was generated.
+  /// @return False if the file could not be written. The cache is an optimization, so callers may ignore failures.
+  static bool store(const std::string &path, const DecodedExecuteSegment<address_t> &exec,
+                    const MachineOptions<address_t> &options, uint64_t arena_size);
+};
+
+} // namespace riscv
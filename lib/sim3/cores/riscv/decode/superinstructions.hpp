@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "decoder_cache.hpp"
+#include "threaded_bytecodes.hpp"
+
+namespace riscv {
+/*
+ * Superinstructions.
+ *
+ * After the blocks of a decoder cache are realized, pairs of adjacent instructions which form a common idiom are
+ * fused: the first entry's bytecode is replaced by a fused bytecode, whose handler executes both instructions and
+ * then moves past the second one. Neither entry's instruction bits change, so the fused handler reads the second
+ * instruction from the next entry, and jumps directly into the second instruction still work.
+ *
+ * Fusion never crosses a block boundary, and instruction counting is unchanged because it happens per block.
+ * Anything which patches the decoder cache must call unfuse_superinstruction_before() first, as the fused handler
+ * would otherwise execute the original second instruction instead of the patch.
+ */
+
+enum class FusedIdiom : unsigned {
+  LuiAddi,    // lui + addi(w) on the same register: 32-bit constants and addresses
+  AuipcJalr,  // auipc + jalr: far calls and tail calls
+  LoadBranch, // load + beq/bne on the loaded value: null checks and sentinels
+  AddiBranch, // addi + bne on the incremented register: counted loop tails
+  Count
+};
+static constexpr std::array<const char *, size_t(FusedIdiom::Count)> FUSED_IDIOM_NAMES = {"lui+addi", "auipc+jalr",
+                                                                                          "load+branch", "addi+bne"};
+
+// Process-wide tallies. Sites are counted while fusing. Hits are only counted by the dispatcher when built with
+// RISCV_FUSION_COUNTERS, as they would otherwise cost an atomic increment per fused instruction.
+struct FusionCounters {
+  std::array<std::atomic<uint64_t>, size_t(FusedIdiom::Count)> sites{};
+  std::array<std::atomic<uint64_t>, size_t(FusedIdiom::Count)> hits{};
+
+  void site(FusedIdiom idiom) noexcept { sites[size_t(idiom)].fetch_add(1, std::memory_order_relaxed); }
+  void hit(FusedIdiom idiom) noexcept { hits[size_t(idiom)].fetch_add(1, std::memory_order_relaxed); }
+  void reset() noexcept {
+    for (auto &value : sites) value.store(0, std::memory_order_relaxed);
+    for (auto &value : hits) value.store(0, std::memory_order_relaxed);
+  }
+};
+inline FusionCounters &fusion_counters() {
+  static FusionCounters counters;
+  return counters;
+}
+
+/// @brief The bytecode the first instruction of a superinstruction had before fusing, or bytecode if not fused.
+inline unsigned unfused_bytecode(unsigned bytecode) noexcept {
+  switch (bytecode) {
+  case RV32I_BC_LUI_ADDI:
+  case RV64I_BC_LUI_ADDIW: return RV32I_BC_LUI;
+  case RV32I_BC_AUIPC_JALR: return RV32I_BC_AUIPC;
+  case RV32I_BC_LDW_BEQ:
+  case RV32I_BC_LDW_BNE: return RV32I_BC_LDW;
+  case RV32I_BC_LDD_BEQ:
+  case RV32I_BC_LDD_BNE: return RV32I_BC_LDD;
+  case RV32I_BC_ADDI_BNE: return RV32I_BC_ADDI;
+  case RV32C_BC_ADDI_BNEZ: return RV32C_BC_ADDI;
+  default: return bytecode;
+  }
+}
+
+// The fused bytecode for first followed by second, or RV32I_BC_INVALID if they are not an idiom we fuse.
+template <AddressType address_t>
+static unsigned fused_bytecode_for(const DecoderData<address_t> &first, const DecoderData<address_t> &second,
+                                   FusedIdiom &idiom) {
+  static constexpr bool RV64 = sizeof(address_t) >= 8;
+  // The second instruction may already be the first half of the next pair, as pairs which straddle two decoder
+  // chunks are fused last
+  const unsigned bc1 = first.get_bytecode(), bc2 = unfused_bytecode(second.get_bytecode());
+  const FasterItype a{first.instr}, b{second.instr};
+  const FasterJtype upper{first.instr};
+  // Branches compare rs1 and rs2, everything else in FasterItype writes rs1 and reads rs2
+  const bool branch_reads_a = b.get_rs1() == a.get_rs1() || b.get_rs2() == a.get_rs1();
+
+  switch (bc1) {
+  case RV32I_BC_LUI:
+    idiom = FusedIdiom::LuiAddi;
+    if (bc2 == RV32I_BC_ADDI && b.get_rs2() == upper.rd) return RV32I_BC_LUI_ADDI;
+    if (RV64 && bc2 == RV64I_BC_ADDIW && b.get_rs2() == upper.rd) return RV64I_BC_LUI_ADDIW;
+    break;
+  case RV32I_BC_AUIPC:
+    idiom = FusedIdiom::AuipcJalr;
+    if (bc2 == RV32I_BC_JALR && b.get_rs2() == upper.rd) return RV32I_BC_AUIPC_JALR;
+    break;
+  case RV32I_BC_LDW:
+  case RV32I_BC_LDD:
+    idiom = FusedIdiom::LoadBranch;
+    if (!branch_reads_a || (bc1 == RV32I_BC_LDD && !RV64)) break;
+    if (bc2 == RV32I_BC_BEQ || bc2 == RV32I_BC_BEQ_FW) return bc1 == RV32I_BC_LDW ? RV32I_BC_LDW_BEQ : RV32I_BC_LDD_BEQ;
+    if (bc2 == RV32I_BC_BNE || bc2 == RV32I_BC_BNE_FW) return bc1 == RV32I_BC_LDW ? RV32I_BC_LDW_BNE : RV32I_BC_LDD_BNE;
+    break;
+  case RV32I_BC_ADDI:
+    idiom = FusedIdiom::AddiBranch;
+    if (branch_reads_a && (bc2 == RV32I_BC_BNE || bc2 == RV32I_BC_BNE_FW)) return RV32I_BC_ADDI_BNE;
+    break;
+  case RV32C_BC_ADDI:
+    idiom = FusedIdiom::AddiBranch;
+    if (bc2 == RV32C_BC_BNEZ && b.get_rs1() == a.get_rs1()) return RV32C_BC_ADDI_BNEZ;
+    break;
+  }
+  return RV32I_BC_INVALID;
+}
+
+// Fuse idioms starting in [begin, end) of a freshly realized decoder cache, where begin starts an instruction and
+// last_pc is the end of the execute segment. Returns the number of sites.
+// Fusing reads the entry after each instruction, so ranges fused concurrently must not read each other's entries:
+// with boundary set, the last instruction of the range, whose second half starts at or after end, is left alone and
+// its address is stored in boundary (last_pc if there is none). Callers fuse those afterwards, one at a time.
+template <AddressType address_t>
+static size_t fuse_superinstructions(address_t begin, address_t end, address_t last_pc, const uint8_t *exec_segment,
+                                     DecoderData<address_t> *exec_decoder, address_t *boundary = nullptr) {
+  auto length = [exec_segment](address_t pc) -> unsigned {
+    if constexpr (compressed_enabled) return (exec_segment[pc] & 0x3) == 0x3 ? 4 : 2;
+    else return 4;
+  };
+  size_t fused = 0;
+  if (boundary != nullptr) *boundary = last_pc;
+  for (address_t pc = begin; pc < end;) {
+    const unsigned len = length(pc);
+    if (boundary != nullptr && pc + len >= end) {
+      *boundary = pc;
+      break;
+    }
+    auto &first = exec_decoder[pc / DecoderCache<address_t>::DIVISOR];
+    // The second instruction must be in the same block, which ends no earlier than the next instruction
+    if (pc + len < last_pc && unsigned(first.block_bytes()) >= len) {
+      const unsigned len2 = length(pc + len);
+      auto &second = exec_decoder[(pc + len) / DecoderCache<address_t>::DIVISOR];
+      FusedIdiom idiom = FusedIdiom::Count;
+      const unsigned bytecode = fused_bytecode_for(first, second, idiom);
+      // The handlers assume 4-byte instructions, except for the compressed pair
+      const bool lengths_ok = (bytecode == RV32C_BC_ADDI_BNEZ) ? (len == 2 && len2 == 2) : (len == 4 && len2 == 4);
+      if (bytecode != RV32I_BC_INVALID && lengths_ok && pc + len + len2 <= last_pc) {
+        first.set_bytecode(bytecode);
+        fusion_counters().site(idiom);
+        fused++;
+      }
+    }
+    pc += len;
+  }
+  return fused;
+}
+
+/// @brief Split any superinstruction whose second half is the instruction at addr, before addr is patched.
+template <AddressType address_t> inline void unfuse_superinstruction_before(DecoderData<address_t> *exec_decoder,
+                                                                           address_t begin, address_t addr) {
+  for (const address_t len : {address_t(4), address_t(2)}) {
+    if (addr < begin + len) continue;
+    auto &first = exec_decoder[(addr - len) / DecoderCache<address_t>::DIVISOR];
+    const unsigned original = unfused_bytecode(first.get_bytecode());
+    const unsigned first_len = (original == RV32C_BC_ADDI) ? 2 : 4;
+    if (original != first.get_bytecode() && first_len == len) first.set_bytecode(original);
+  }
+}
+
+} // namespace riscv
@@ -158,10 +158,23 @@ namespace riscv
 		RV32V_BC_VSE32,
 		RV32V_BC_VFADD_VV,
 		RV32V_BC_VFMUL_VF,
+
+		// Superinstructions, see superinstructions.hpp
+		RV32I_BC_LUI_ADDI,
+		RV64I_BC_LUI_ADDIW,
+		RV32I_BC_AUIPC_JALR,
+		RV32I_BC_LDW_BEQ,
+		RV32I_BC_LDW_BNE,
+		RV32I_BC_LDD_BEQ,
+		RV32I_BC_LDD_BNE,
+		RV32I_BC_ADDI_BNE,
+		RV32C_BC_ADDI_BNEZ,
+
 		RV32I_BC_FUNCTION,
 		RV32I_BC_FUNCBLOCK,
 		RV32I_BC_LIVEPATCH,
 		RV32I_BC_SYSTEM,
+		RV32I_BC_TRANSLATOR,
 		BYTECODES_MAX
 	};
 	static_assert(BYTECODES_MAX <= 256, "A bytecode must fit in a byte");
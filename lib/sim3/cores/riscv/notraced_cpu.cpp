@@ -34,6 +34,7 @@
 #include "./notraced_cpu.hpp"
 #include "./decode/cpu_dispatch.hpp"
 #include "./decode/decoder_cache.hpp"
+#include "./decode/superinstructions.hpp"
 #include "./decode/threaded_bytecodes.hpp"
 #include "./instructions/instr_decoder.hpp"
 #include "core/arch/riscv/isa/rv_types.hpp"
@@ -372,6 +373,8 @@ DecoderData<address_t> &CPU<address_t>::create_block_ending_entry_at(DecodedExec
   auto *decoder_begin = &exec_decoder[exec.exec_begin() / DecoderCache<address_t>::DIVISOR];
 
   auto &cache_entry = exec_decoder[addr / DecoderCache<address_t>::DIVISOR];
+  // A superinstruction may not straddle the new block end
+  unfuse_superinstruction_before(exec_decoder, exec.exec_begin(), addr);
 
   // The last instruction will be the current entry
   // Later instructions will work as normal
@@ -410,6 +413,8 @@ DecoderData<address_t> &CPU<address_t>::create_block_ending_entry_at(DecodedExec
 // Install an ebreak instruction at the given address
 template <AddressType address_t>
 uint32_t CPU<address_t>::install_ebreak_for(DecodedExecuteSegment<address_t> &exec, address_t breakpoint_addr) {
+  // Translated entry points would bypass the breakpoint
+  exec.revert_translation();
   // Get a reference to the decoder cache
   auto &cache_entry = CPU<address_t>::create_block_ending_entry_at(exec, breakpoint_addr);
   const auto old_instruction = cache_entry.instr;
@@ -444,6 +449,7 @@ bool CPU<address_t>::create_fast_path_function(DecodedExecuteSegment<address_t>
                            block_pc);
   }
 
+  exec.revert_translation();
   auto *exec_decoder = exec.decoder_cache();
   // The beginning of the function:
   auto *cache_entry = &exec_decoder[block_pc / DecoderCache<address_t>::DIVISOR];
@@ -470,6 +476,7 @@ bool CPU<address_t>::create_fast_path_function(DecodedExecuteSegment<address_t>
                                  block_pc);
         // We found the (potential) end of the function
         // Now rewrite it to a speculative live-patch STOP instruction
+        unfuse_superinstruction_before(exec_decoder, exec.exec_begin(), block_pc);
         cache_entry->set_atomic_bytecode_and_handler(RV32I_BC_LIVEPATCH, 1);
         return true;
       } else {
@@ -493,6 +500,7 @@ bool CPU<address_t>::create_fast_path_function(DecodedExecuteSegment<address_t>
                                  block_pc);
         // We found the (potential) end of the function
         // Now rewrite it to a speculative live-patch STOP instruction
+        unfuse_superinstruction_before(exec_decoder, exec.exec_begin(), block_pc);
         cache_entry->set_atomic_bytecode_and_handler(RV32I_BC_LIVEPATCH, 2);
         return true;
       } else {
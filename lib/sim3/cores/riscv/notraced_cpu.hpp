@@ -134,9 +134,9 @@ template <AddressType address_type> struct alignas(32) CPU {
 		void serialize_to(std::vector<uint8_t>& vec) const;
 
 		/// @brief Returns the CPU to a previously stored state. Used by Machine::deserialize_from.
-		/// @param vec The vector to deserialize from
+		/// @param bytes The serialized machine to deserialize from
 		/// @param sm The serialized machine header to get metadata from
-    void deserialize_from(const std::vector<uint8_t> &vec, const SerializedMachine<address_t> &sm);
+    void deserialize_from(std::string_view bytes, const SerializedMachine<address_t> &sm);
 
     // Binary translation functions
     int load_translation(const MachineOptions<address_t> &, std::string *filename,
@@ -0,0 +1,775 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "./block_translator.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <unordered_set>
+#include "../decode/decoded_exec_segment.hpp"
+#include "../decode/decoder_cache.hpp"
+#include "../decode/superinstructions.hpp"
+#include "../decode/threaded_bytecodes.hpp"
+#include "../instruction_counter.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+#include "sim3/utils/private_cache.hpp"
+#include "sim3/utils/sha256.hpp"
+#if defined(__linux__) || defined(__APPLE__)
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define RISCV_TRANSLATION_SUPPORTED
+#endif
+
+namespace riscv {
+namespace {
+// Blocks per emitted C function. Gotos never cross a function, so this trades chaining distance for compile time.
+constexpr size_t BLOCKS_PER_FUNCTION = 256;
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void append(std::string &out, const char *fmt, ...) {
+  va_list args, retry;
+  va_start(args, fmt);
+  va_copy(retry, args);
+  char buffer[256];
+  const int len = vsnprintf(buffer, sizeof(buffer), fmt, args);
+  if (len > 0 && size_t(len) < sizeof(buffer)) {
+    out.append(buffer, len);
+  } else if (len > 0) {
+    const size_t offset = out.size();
+    out.resize(offset + len + 1);
+    vsnprintf(&out[offset], len + 1, fmt, retry);
+    out.pop_back();
+  }
+  va_end(retry);
+  va_end(args);
+}
+
+template <AddressType address_t> struct Emitter {
+  using addr_t = address_t;
+  static constexpr unsigned XLEN = 8 * sizeof(address_t);
+  static constexpr unsigned SHIFT = DecoderCache<address_t>::SHIFT;
+
+  struct Block {
+    address_t begin;
+    address_t terminator;
+    address_t next;
+  };
+
+  const DecodedExecuteSegment<address_t> &exec;
+  const DecoderData<address_t> *decoder;
+  std::string &out;
+  std::vector<Block> blocks{};
+  std::unordered_set<address_t> instructions{}; // Every instruction inside a translated block
+  std::unordered_set<address_t> labels{};       // Entry points: block starts and direct branch targets
+  std::vector<address_t> function_ends{};       // Exclusive end address of each emitted function
+  size_t instruction_total = 0;
+
+  const DecoderData<address_t> &entry(address_t pc) const { return decoder[pc >> SHIFT]; }
+  uint32_t bits(address_t pc) const {
+    uint32_t value;
+    std::memcpy(&value, exec.exec_data(pc), sizeof(value));
+    return value;
+  }
+  unsigned length(address_t pc) const {
+    if constexpr (compressed_enabled) return (bits(pc) & 0x3) == 0x3 ? 4 : 2;
+    else return 4;
+  }
+
+  static bool is_body(unsigned bytecode) {
+    switch (bytecode) {
+    case RV32I_BC_ADDI: case RV32I_BC_LI: case RV32I_BC_MV:
+    case RV32I_BC_SLLI: case RV32I_BC_SLTI: case RV32I_BC_SLTIU: case RV32I_BC_XORI:
+    case RV32I_BC_SRLI: case RV32I_BC_SRAI: case RV32I_BC_ORI: case RV32I_BC_ANDI:
+    case RV32I_BC_LUI: case RV32I_BC_AUIPC:
+    case RV32I_BC_LDB: case RV32I_BC_LDBU: case RV32I_BC_LDH: case RV32I_BC_LDHU: case RV32I_BC_LDW:
+    case RV32I_BC_STB: case RV32I_BC_STH: case RV32I_BC_STW:
+    case RV32I_BC_LDWU: case RV32I_BC_LDD: case RV32I_BC_STD:
+    case RV32I_BC_OP_ADD: case RV32I_BC_OP_SUB: case RV32I_BC_OP_SLL: case RV32I_BC_OP_SLT:
+    case RV32I_BC_OP_SLTU: case RV32I_BC_OP_XOR: case RV32I_BC_OP_SRL: case RV32I_BC_OP_OR:
+    case RV32I_BC_OP_AND: case RV32I_BC_OP_MUL: case RV32I_BC_OP_DIV: case RV32I_BC_OP_DIVU:
+    case RV32I_BC_OP_REM: case RV32I_BC_OP_REMU: case RV32I_BC_OP_SRA: case RV32I_BC_OP_ZEXT_H:
+    case RV32I_BC_OP_SH1ADD: case RV32I_BC_OP_SH2ADD: case RV32I_BC_OP_SH3ADD:
+    case RV32I_BC_SEXT_B: case RV32I_BC_SEXT_H: case RV32I_BC_BSETI: case RV32I_BC_BEXTI:
+    case RV64I_BC_ADDIW: case RV64I_BC_SLLIW: case RV64I_BC_SRLIW: case RV64I_BC_SRAIW:
+    case RV64I_BC_OP_ADDW: case RV64I_BC_OP_SUBW: case RV64I_BC_OP_MULW: case RV64I_BC_OP_ADD_UW:
+    case RV64I_BC_OP_SH1ADD_UW: case RV64I_BC_OP_SH2ADD_UW:
+    case RV32C_BC_ADDI: case RV32C_BC_MV: case RV32C_BC_SLLI:
+    case RV32C_BC_LDD: case RV32C_BC_STD: case RV32C_BC_LDW: case RV32C_BC_STW:
+    case RV32C_BC_SRLI: case RV32C_BC_ANDI: case RV32C_BC_ADD: case RV32C_BC_XOR: case RV32C_BC_OR:
+    case RV32C_BC_FUNCTION: case RV32I_BC_FUNCTION:
+    case RV32F_BC_FLW: case RV32F_BC_FLD: case RV32F_BC_FSW: case RV32F_BC_FSD:
+    case RV32F_BC_FADD: case RV32F_BC_FSUB: case RV32F_BC_FMUL: case RV32F_BC_FDIV: case RV32F_BC_FMADD:
+    case RV32V_BC_VLE32: case RV32V_BC_VSE32: case RV32V_BC_VFADD_VV: case RV32V_BC_VFMUL_VF:
+      return true;
+    case RV32C_BC_JAL_ADDIW: return sizeof(address_t) >= 8; // C.ADDIW
+    default: return false;
+    }
+  }
+  static bool is_terminator(unsigned bytecode) {
+    switch (bytecode) {
+    case RV32I_BC_BEQ: case RV32I_BC_BNE: case RV32I_BC_BLT: case RV32I_BC_BGE: case RV32I_BC_BLTU:
+    case RV32I_BC_BGEU: case RV32I_BC_BEQ_FW: case RV32I_BC_BNE_FW:
+    case RV32I_BC_JAL: case RV32I_BC_JALR: case RV32I_BC_FAST_JAL: case RV32I_BC_FAST_CALL:
+    case RV32C_BC_BEQZ: case RV32C_BC_BNEZ: case RV32C_BC_JMP: case RV32C_BC_JR: case RV32C_BC_JALR:
+      return true;
+    case RV32C_BC_JAL_ADDIW: return sizeof(address_t) == 4; // C.JAL
+    default: return false;
+    }
+  }
+
+  // The target of a direct jump at pc, or 0 when the terminator jumps indirectly.
+  address_t direct_target(address_t pc) const {
+    const auto &e = entry(pc);
+    switch (unfused_bytecode(e.get_bytecode())) {
+    case RV32I_BC_JAL: return pc + FasterJtype{e.instr}.signed_imm();
+    case RV32I_BC_FAST_JAL:
+    case RV32I_BC_FAST_CALL: return pc + int32_t(e.instr);
+    case RV32I_BC_JALR:
+    case RV32C_BC_JR:
+    case RV32C_BC_JALR: return 0;
+    default: return pc + FasterItype{e.instr}.signed_imm();
+    }
+  }
+
+  size_t function_of(address_t pc) const {
+    return std::upper_bound(function_ends.begin(), function_ends.end(), pc) - function_ends.begin();
+  }
+
+  void scan(size_t max_blocks) {
+    const address_t end = exec.exec_end();
+    address_t pc = exec.exec_begin();
+    while (pc < end && blocks.size() < max_blocks) {
+      const address_t terminator = pc + entry(pc).block_bytes();
+      if (terminator >= end) break;
+      const address_t next = terminator + length(terminator);
+
+      // Superinstructions are translated as their two separate halves
+      bool translatable = is_terminator(unfused_bytecode(entry(terminator).get_bytecode()));
+      address_t ipc = pc;
+      for (; translatable && ipc < terminator; ipc += length(ipc))
+        translatable = is_body(unfused_bytecode(entry(ipc).get_bytecode()));
+      // A block that doesn't decode into whole instructions up to its terminator is left alone
+      if (translatable && ipc == terminator) {
+        blocks.push_back({pc, terminator, next});
+        for (ipc = pc; ipc <= terminator; ipc += length(ipc)) {
+          instructions.insert(ipc);
+          instruction_total++;
+        }
+      }
+      pc = next;
+    }
+
+    for (size_t i = 0; i < blocks.size(); i += BLOCKS_PER_FUNCTION) {
+      const size_t last = std::min(blocks.size(), i + BLOCKS_PER_FUNCTION) - 1;
+      function_ends.push_back(blocks[last].next);
+    }
+    for (const auto &block : blocks) {
+      labels.insert(block.begin);
+      const address_t target = direct_target(block.terminator);
+      if (target != 0 && instructions.count(target)) labels.insert(target);
+    }
+  }
+
+  static unsigned long long u64(address_t value) { return static_cast<unsigned long long>(value); }
+
+  // Continue at target after a counter check, as PERFORM_BRANCH and NEXT_BLOCK(x, true) do.
+  void checked_jump(size_t func, address_t target) {
+    if (labels.count(target) && function_of(target) == func) {
+      append(out, "  if (ic < max) { ic += %u; goto L_%llx; }\n", unsigned(entry(target).instruction_count()),
+             u64(target));
+    }
+    append(out, "  pc = 0x%llxu; goto leave;\n", u64(target));
+  }
+  // Continue at target without a counter check, as NEXT_BLOCK(x, false) does.
+  void unchecked_jump(size_t func, address_t target) {
+    if (labels.count(target) && function_of(target) == func) {
+      append(out, "  ic += %u; goto L_%llx;\n", unsigned(entry(target).instruction_count()), u64(target));
+    } else {
+      append(out, "  pc = 0x%llxu; c->unchecked = 1; goto leave;\n", u64(target));
+    }
+  }
+
+  void body(address_t pc) {
+    const auto &e = entry(pc);
+    const FasterItype fi{e.instr};
+    const FasterOpType fo{e.instr};
+    const unsigned a = fi.get_rs1(), b = fi.get_rs2();
+    const unsigned d = fo.get_rd(), s1 = fo.get_rs1(), s2 = fo.get_rs2();
+    const auto K = u64(address_t(fi.signed_imm()));
+    const unsigned U = fi.unsigned_imm();
+    const unsigned M = XLEN - 1;
+#define OP(expr) append(out, "  { const A s1 = r[%u], s2 = r[%u]; r[%u] = " expr "; }\n", s1, s2, d)
+    switch (unfused_bytecode(e.get_bytecode())) {
+    case RV32C_BC_ADDI:
+    case RV32I_BC_ADDI: append(out, "  r[%u] = r[%u] + (A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_LI: {
+      const FasterImmediate fm{e.instr};
+      append(out, "  r[%u] = (A)0x%llxu;\n", fm.get_rd(), u64(address_t(fm.signed_imm())));
+    } break;
+    case RV32C_BC_MV:
+    case RV32I_BC_MV: {
+      const FasterMove fm{e.instr};
+      append(out, "  r[%u] = r[%u];\n", fm.get_rd(), fm.get_rs1());
+    } break;
+    case RV32C_BC_SLLI: append(out, "  r[%u] <<= %u;\n", a, U); break;
+    case RV32I_BC_SLLI: append(out, "  r[%u] = r[%u] << %u;\n", a, b, U); break;
+    case RV32I_BC_SLTI: append(out, "  r[%u] = (S)r[%u] < (S)(A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_SLTIU: append(out, "  r[%u] = r[%u] < (A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_XORI: append(out, "  r[%u] = r[%u] ^ (A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_SRLI: append(out, "  r[%u] = r[%u] >> %u;\n", a, b, U); break;
+    case RV32I_BC_SRAI: append(out, "  r[%u] = (A)((S)r[%u] >> %u);\n", a, b, U); break;
+    case RV32I_BC_ORI: append(out, "  r[%u] = r[%u] | (A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_ANDI: append(out, "  r[%u] = r[%u] & (A)0x%llxu;\n", a, b, K); break;
+    case RV32I_BC_LUI: {
+      const FasterJtype fj{e.instr};
+      append(out, "  r[%u] = (A)0x%llxu;\n", unsigned(fj.rd), u64(address_t(fj.upper_imm())));
+    } break;
+    case RV32I_BC_AUIPC: {
+      const FasterJtype fj{e.instr};
+      append(out, "  r[%u] = (A)0x%llxu;\n", unsigned(fj.rd), u64(pc + fj.upper_imm()));
+    } break;
+    case RV32I_BC_LDB: append(out, "  r[%u] = (A)(S)(int8_t)ld8(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32I_BC_LDBU: append(out, "  r[%u] = (A)ld8(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32I_BC_LDH: append(out, "  r[%u] = (A)(S)(int16_t)ld16(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32I_BC_LDHU: append(out, "  r[%u] = (A)ld16(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32C_BC_LDW:
+    case RV32I_BC_LDW: append(out, "  r[%u] = (A)(S)(int32_t)ld32(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32I_BC_LDWU: append(out, "  r[%u] = (A)ld32(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32C_BC_LDD:
+    case RV32I_BC_LDD: append(out, "  r[%u] = (A)ld64(c, r[%u] + (A)0x%llxu);\n", a, b, K); break;
+    case RV32I_BC_STB: append(out, "  st8(c, r[%u] + (A)0x%llxu, r[%u]);\n", a, K, b); break;
+    case RV32I_BC_STH: append(out, "  st16(c, r[%u] + (A)0x%llxu, r[%u]);\n", a, K, b); break;
+    case RV32C_BC_STW:
+    case RV32I_BC_STW: append(out, "  st32(c, r[%u] + (A)0x%llxu, r[%u]);\n", a, K, b); break;
+    case RV32C_BC_STD:
+    case RV32I_BC_STD: append(out, "  st64(c, r[%u] + (A)0x%llxu, r[%u]);\n", a, K, b); break;
+    case RV32I_BC_OP_ADD: OP("s1 + s2"); break;
+    case RV32I_BC_OP_SUB: OP("s1 - s2"); break;
+    case RV32I_BC_OP_SLL: append(out, "  { const A s1 = r[%u], s2 = r[%u]; r[%u] = s1 << (s2 & %u); }\n", s1, s2, d, M); break;
+    case RV32I_BC_OP_SLT: OP("(S)s1 < (S)s2"); break;
+    case RV32I_BC_OP_SLTU: OP("s1 < s2"); break;
+    case RV32I_BC_OP_XOR: OP("s1 ^ s2"); break;
+    case RV32I_BC_OP_SRL: append(out, "  { const A s1 = r[%u], s2 = r[%u]; r[%u] = s1 >> (s2 & %u); }\n", s1, s2, d, M); break;
+    case RV32I_BC_OP_OR: OP("s1 | s2"); break;
+    case RV32I_BC_OP_AND: OP("s1 & s2"); break;
+    case RV32I_BC_OP_MUL: OP("s1 * s2"); break;
+    case RV32I_BC_OP_SH1ADD: OP("s2 + (s1 << 1)"); break;
+    case RV32I_BC_OP_SH2ADD: OP("s2 + (s1 << 2)"); break;
+    case RV32I_BC_OP_SH3ADD: OP("s2 + (s1 << 3)"); break;
+    case RV32I_BC_OP_SRA:
+      append(out, "  { const A s1 = r[%u], s2 = r[%u]; r[%u] = (A)((S)s1 >> (s2 & %u)); }\n", s1, s2, d, M);
+      break;
+    case RV32I_BC_OP_ZEXT_H: OP("(A)(uint16_t)s1"); break;
+    // Division mirrors the interpreter: the overflowing case leaves rd untouched
+    case RV32I_BC_OP_DIV:
+      append(out,
+             "  { const A s1 = r[%u], s2 = r[%u]; if ((S)s2 != 0) { if (!(s1 == SMIN && s2 == (A)-1)) "
+             "r[%u] = (A)((S)s1 / (S)s2); } else r[%u] = (A)-1; }\n",
+             s1, s2, d, d);
+      break;
+    case RV32I_BC_OP_DIVU: OP("s2 != 0 ? s1 / s2 : (A)-1"); break;
+    case RV32I_BC_OP_REM:
+      append(out,
+             "  { const A s1 = r[%u], s2 = r[%u]; if (s2 != 0 && !(s1 == SMIN && s2 == (A)-1)) "
+             "r[%u] = (A)((S)s1 %% (S)s2); }\n",
+             s1, s2, d);
+      break;
+    case RV32I_BC_OP_REMU: OP("s2 != 0 ? s1 %% s2 : (A)-1"); break;
+    case RV32I_BC_SEXT_B: append(out, "  r[%u] = (A)(S)(int8_t)r[%u];\n", a, b); break;
+    case RV32I_BC_SEXT_H: append(out, "  r[%u] = (A)(S)(int16_t)r[%u];\n", a, b); break;
+    case RV32I_BC_BSETI: append(out, "  r[%u] = r[%u] | ((A)1 << %u);\n", a, b, U); break;
+    case RV32I_BC_BEXTI: append(out, "  r[%u] = (r[%u] >> %u) & 1;\n", a, b, U); break;
+    case RV32C_BC_JAL_ADDIW: // C.ADDIW
+    case RV64I_BC_ADDIW:
+      append(out, "  r[%u] = (A)(S)(int32_t)((uint32_t)r[%u] + (uint32_t)0x%xu);\n", a, b, uint32_t(fi.signed_imm()));
+      break;
+    case RV64I_BC_SLLIW: append(out, "  r[%u] = (A)(S)(int32_t)((uint32_t)r[%u] << %u);\n", a, b, U); break;
+    case RV64I_BC_SRLIW: append(out, "  r[%u] = (A)(S)(int32_t)((uint32_t)r[%u] >> %u);\n", a, b, U); break;
+    case RV64I_BC_SRAIW: append(out, "  r[%u] = (A)(S)((int32_t)r[%u] >> %u);\n", a, b, U); break;
+    case RV64I_BC_OP_ADDW: OP("(A)(S)(int32_t)((uint32_t)s1 + (uint32_t)s2)"); break;
+    case RV64I_BC_OP_SUBW: OP("(A)(S)(int32_t)((uint32_t)s1 - (uint32_t)s2)"); break;
+    case RV64I_BC_OP_MULW: OP("(A)(S)(int32_t)((uint32_t)s1 * (uint32_t)s2)"); break;
+    case RV64I_BC_OP_ADD_UW: OP("(A)(uint32_t)s1 + s2"); break;
+    case RV64I_BC_OP_SH1ADD_UW: OP("s2 + ((A)(uint32_t)s1 << 1)"); break;
+    case RV64I_BC_OP_SH2ADD_UW: OP("s2 + ((A)(uint32_t)s1 << 2)"); break;
+    case RV32C_BC_SRLI: append(out, "  r[%u] >>= %u;\n", a, U); break;
+    case RV32C_BC_ANDI: append(out, "  r[%u] &= (A)0x%llxu;\n", a, K); break;
+    case RV32C_BC_ADD: append(out, "  r[%u] += r[%u];\n", a, b); break;
+    case RV32C_BC_XOR: append(out, "  r[%u] ^= r[%u];\n", a, b); break;
+    case RV32C_BC_OR: append(out, "  r[%u] |= r[%u];\n", a, b); break;
+    case RV32C_BC_FUNCTION:
+    case RV32I_BC_FUNCTION: append(out, "  c->execute(c, 0x%llxu);\n", u64(pc)); break;
+    default: // Floating-point and vector bytecodes
+      append(out, "  c->execute_original(c, 0x%llxu);\n", u64(pc));
+      break;
+    }
+#undef OP
+  }
+
+  void terminator(size_t func, const Block &block) {
+    const address_t pc = block.terminator;
+    const auto &e = entry(pc);
+    const FasterItype fi{e.instr};
+    const unsigned a = fi.get_rs1(), b = fi.get_rs2();
+    const address_t target = direct_target(pc);
+    const char *cond = nullptr;
+    bool forward = false;
+    switch (unfused_bytecode(e.get_bytecode())) {
+    case RV32I_BC_BEQ: cond = "r[%u] == r[%u]"; break;
+    case RV32I_BC_BNE: cond = "r[%u] != r[%u]"; break;
+    case RV32I_BC_BLT: cond = "(S)r[%u] < (S)r[%u]"; break;
+    case RV32I_BC_BGE: cond = "(S)r[%u] >= (S)r[%u]"; break;
+    case RV32I_BC_BLTU: cond = "r[%u] < r[%u]"; break;
+    case RV32I_BC_BGEU: cond = "r[%u] >= r[%u]"; break;
+    case RV32I_BC_BEQ_FW:
+      cond = "r[%u] == r[%u]";
+      forward = true;
+      break;
+    case RV32I_BC_BNE_FW:
+      cond = "r[%u] != r[%u]";
+      forward = true;
+      break;
+    case RV32C_BC_BEQZ: cond = "r[%u] == 0"; break;
+    case RV32C_BC_BNEZ: cond = "r[%u] != 0"; break;
+    case RV32C_BC_JAL_ADDIW: // C.JAL
+      append(out, "  r[%u] = 0x%llxu;\n", unsigned(REG_RA), u64(pc + 2));
+      [[fallthrough]];
+    case RV32C_BC_JMP:
+    case RV32I_BC_FAST_JAL: checked_jump(func, target); return;
+    case RV32I_BC_FAST_CALL:
+      append(out, "  r[%u] = 0x%llxu;\n", unsigned(REG_RA), u64(pc + 4));
+      checked_jump(func, target);
+      return;
+    case RV32I_BC_JAL:
+      append(out, "  r[%u] = 0x%llxu;\n", unsigned(FasterJtype{e.instr}.rd), u64(pc + 4));
+      checked_jump(func, target);
+      return;
+    case RV32I_BC_JALR: {
+      static constexpr address_t ALIGN_MASK = (compressed_enabled) ? 0x1 : 0x3;
+      append(out, "  { const A t = r[%u] + (A)0x%llxu;\n", b, u64(address_t(fi.signed_imm())));
+      if (a != 0) append(out, "  r[%u] = 0x%llxu;\n", a, u64(pc + 4));
+      append(out, "  pc = t & ~(A)%u; goto leave; }\n", unsigned(ALIGN_MASK));
+      return;
+    }
+    case RV32C_BC_JALR: append(out, "  r[%u] = 0x%llxu;\n", unsigned(REG_RA), u64(pc + 2)); [[fallthrough]];
+    case RV32C_BC_JR: append(out, "  pc = r[%u] & ~(A)1; goto leave;\n", unsigned(e.instr)); return;
+    default: throw MachineException(INVALID_PROGRAM, "Block translator reached an unknown terminator", pc);
+    }
+    // Conditional branches: taken, then fall through to the next block
+    out += "  if (";
+    append(out, cond, a, b);
+    out += ") {\n";
+    if (forward) unchecked_jump(func, target);
+    else checked_jump(func, target);
+    out += "  }\n";
+    unchecked_jump(func, block.next);
+  }
+
+  void emit() {
+    static constexpr const char *prologue = R"C(#include <stdint.h>
+typedef %s A;
+typedef %s S;
+#define SMIN ((A)1 << %u)
+struct ctx {
+  A *regs;
+  void *cpu;
+  void *segment;
+  uint8_t *arena;
+  A arena_read_begin, arena_read_boundary;
+  A arena_write_begin, arena_write_boundary;
+  uint64_t counter, max_counter;
+  A (*load)(struct ctx *, A, unsigned);
+  void (*store)(struct ctx *, A, A, unsigned);
+  void (*execute)(struct ctx *, A);
+  void (*execute_original)(struct ctx *, A);
+  uint32_t unchecked;
+};
+#define LOAD(N, T) static inline T ld##N(struct ctx *c, A a) { \
+  if (__builtin_expect(a - c->arena_read_begin < c->arena_read_boundary, 1)) { \
+    T v; __builtin_memcpy(&v, c->arena + a, sizeof(T)); return v; } \
+  return (T)c->load(c, a, sizeof(T)); }
+#define STORE(N, T) static inline void st##N(struct ctx *c, A a, A v) { \
+  if (__builtin_expect(a - c->arena_write_begin < c->arena_write_boundary, 1)) { \
+    T t = (T)v; __builtin_memcpy(c->arena + a, &t, sizeof(T)); return; } \
+  c->store(c, a, v, sizeof(T)); }
+LOAD(8, uint8_t) LOAD(16, uint16_t) LOAD(32, uint32_t)
+STORE(8, uint8_t) STORE(16, uint16_t) STORE(32, uint32_t)
+)C";
+    if constexpr (sizeof(address_t) == 8) {
+      append(out, prologue, "uint64_t", "int64_t", XLEN - 1);
+      out += "LOAD(64, uint64_t) STORE(64, uint64_t)\n";
+    } else append(out, prologue, "uint32_t", "int32_t", XLEN - 1);
+    append(out, "const uint32_t pepp_rvbt_abi = %u;\nconst uint32_t pepp_rvbt_xlen = %u;\n", TRANSLATION_ABI, XLEN);
+    append(out, "const uint64_t pepp_rvbt_blocks = %zu;\nconst uint64_t pepp_rvbt_instructions = %zu;\n",
+           blocks.size(), instruction_total);
+
+    for (size_t func = 0; func < function_ends.size(); func++) {
+      const size_t first = func * BLOCKS_PER_FUNCTION;
+      const size_t last = std::min(blocks.size(), first + BLOCKS_PER_FUNCTION);
+      append(out, "\nstatic A f%zu(struct ctx *c, A pc) {\n", func);
+      out += "  A *const r = c->regs;\n  uint64_t ic = c->counter;\n  const uint64_t max = c->max_counter;\n";
+      out += "  switch (pc) {\n";
+      for (size_t i = first; i < last; i++) {
+        for (address_t pc = blocks[i].begin; pc <= blocks[i].terminator; pc += length(pc))
+          if (labels.count(pc)) append(out, "  case 0x%llxu: goto L_%llx;\n", u64(pc), u64(pc));
+      }
+      out += "  default: c->unchecked = 2; return pc;\n  }\n";
+      for (size_t i = first; i < last; i++) {
+        const auto &block = blocks[i];
+        for (address_t pc = block.begin; pc < block.terminator; pc += length(pc)) {
+          if (labels.count(pc)) append(out, "L_%llx:\n", u64(pc));
+          body(pc);
+        }
+        if (labels.count(block.terminator)) append(out, "L_%llx:\n", u64(block.terminator));
+        terminator(func, block);
+      }
+      out += "leave:\n  c->counter = ic;\n  return pc;\n}\n";
+    }
+
+    out += "\nA pepp_rvbt_run(struct ctx *c, A pc) {\n";
+    for (size_t func = 0; func + 1 < function_ends.size(); func++)
+      append(out, "  if (pc < 0x%llxu) return f%zu(c, pc);\n", u64(function_ends[func]), func);
+    append(out, "  return f%zu(c, pc);\n}\n", function_ends.size() - 1);
+
+    out += "const A pepp_rvbt_entries[] = {\n";
+    for (const auto &block : blocks) {
+      for (address_t pc = block.begin; pc <= block.terminator; pc += length(pc))
+        if (labels.count(pc)) append(out, "  0x%llxu,\n", u64(pc));
+    }
+    append(out, "};\nconst uint64_t pepp_rvbt_entry_count = %zu;\n", labels.size());
+  }
+};
+
+template <AddressType address_t> address_t translated_load(TranslationContext<address_t> *ctx, address_t addr,
+                                                           unsigned size) {
+  auto &memory = static_cast<CPU<address_t> *>(ctx->cpu)->machine().memory;
+  switch (size) {
+  case 1: return memory.template read<uint8_t>(addr);
+  case 2: return memory.template read<uint16_t>(addr);
+  case 4: return memory.template read<uint32_t>(addr);
+  default: return memory.template read<address_t>(addr);
+  }
+}
+template <AddressType address_t>
+void translated_store(TranslationContext<address_t> *ctx, address_t addr, address_t value, unsigned size) {
+  auto &memory = static_cast<CPU<address_t> *>(ctx->cpu)->machine().memory;
+  switch (size) {
+  case 1: memory.template write<uint8_t>(addr, value); break;
+  case 2: memory.template write<uint16_t>(addr, value); break;
+  case 4: memory.template write<uint32_t>(addr, value); break;
+  default: memory.template write<address_t>(addr, value); break;
+  }
+}
+template <AddressType address_t> void translated_execute(TranslationContext<address_t> *ctx, address_t pc) {
+  auto &exec = *static_cast<DecodedExecuteSegment<address_t> *>(ctx->segment);
+  auto &entry = exec.decoder_cache()[pc >> DecoderCache<address_t>::SHIFT];
+  static_cast<CPU<address_t> *>(ctx->cpu)->execute(entry.m_handler, entry.instr);
+}
+template <AddressType address_t> void translated_execute_original(TranslationContext<address_t> *ctx, address_t pc) {
+  auto &exec = *static_cast<DecodedExecuteSegment<address_t> *>(ctx->segment);
+  rv32i_instruction instr;
+  std::memcpy(&instr.whole, exec.exec_data(pc), sizeof(instr.whole));
+  static_cast<CPU<address_t> *>(ctx->cpu)->execute(instr);
+}
+
+#ifdef RISCV_TRANSLATION_SUPPORTED
+// -fexceptions: machine exceptions thrown from the callbacks unwind through translated frames
+const char *const COMPILER_FLAGS[] = {"-O2", "-fPIC", "-shared", "-fexceptions"};
+
+// The compiler and its own arguments. No shell is involved, so the words are split on spaces only.
+std::vector<std::string> compiler_command(const std::string &configured) {
+  std::string command = configured;
+  if (command.empty()) {
+    const char *cc = getenv("CC");
+    command = (cc != nullptr && cc[0] != '\0') ? cc : "cc";
+  }
+  std::vector<std::string> words;
+  std::istringstream stream(command);
+  for (std::string word; stream >> word;) words.push_back(word);
+  return words;
+}
+
+// Where execvp would find the program, plus enough of its metadata to notice when it is upgraded or replaced.
+std::string compiler_identity(const std::string &program) {
+  std::string path = program;
+  if (program.find('/') == std::string::npos) {
+    path.clear();
+    const char *env = getenv("PATH");
+    std::istringstream dirs(env != nullptr ? env : "/usr/bin:/bin");
+    for (std::string dir; std::getline(dirs, dir, ':');) {
+      const std::string candidate = (dir.empty() ? std::string(".") : dir) + "/" + program;
+      if (access(candidate.c_str(), X_OK) == 0) {
+        path = candidate;
+        break;
+      }
+    }
+  }
+  struct stat st;
+  if (path.empty() || stat(path.c_str(), &st) != 0) return {};
+  char identity[64];
+  snprintf(identity, sizeof(identity), ":%llu:%lld:%llu", (unsigned long long)st.st_size, (long long)st.st_mtime,
+           (unsigned long long)st.st_ino);
+  return path + identity;
+}
+
+// Only async-signal-safe calls from here on, since the emulator may have other threads.
+pid_t spawn(char *const argv[], int log_fd) {
+  const pid_t pid = fork();
+  if (pid == 0) {
+    if (log_fd >= 0) dup2(log_fd, STDOUT_FILENO), dup2(log_fd, STDERR_FILENO);
+    execvp(argv[0], argv);
+    _exit(127);
+  }
+  return pid;
+}
+bool wait_for(pid_t pid) {
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0)
+    if (errno != EINTR) return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+// The compiler creates its output according to the umask, while the cache only trusts files private to the user.
+bool compile(char *const argv[], int log_fd, const char *temporary, const char *filename) {
+  const pid_t pid = spawn(argv, log_fd);
+  const bool ok = pid > 0 && wait_for(pid) && chmod(temporary, 0600) == 0 && rename(temporary, filename) == 0;
+  if (!ok) unlink(temporary);
+  return ok;
+}
+
+template <AddressType address_t>
+bool load_shared_object(const std::string &filename, DecodedExecuteSegment<address_t> &exec,
+                        const MachineOptions<address_t> &options) {
+  const int fd = open_private_file(filename);
+  if (fd < 0) return false;
+#ifdef __linux__
+  // Load the file which was just checked, even if the name is replaced in the meantime
+  void *dylib = dlopen(("/proc/self/fd/" + std::to_string(fd)).c_str(), RTLD_NOW | RTLD_LOCAL);
+#else
+  void *dylib = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+#endif
+  close(fd);
+  if (dylib == nullptr) return false;
+
+  auto translation = std::make_shared<TranslatedSegment<address_t>>();
+  translation->m_dylib = dylib; // Closed by the destructor from here on
+  const auto *abi = (const uint32_t *)dlsym(dylib, "pepp_rvbt_abi");
+  const auto *xlen = (const uint32_t *)dlsym(dylib, "pepp_rvbt_xlen");
+  const auto *blocks = (const uint64_t *)dlsym(dylib, "pepp_rvbt_blocks");
+  const auto *instructions = (const uint64_t *)dlsym(dylib, "pepp_rvbt_instructions");
+  const auto *entries = (const address_t *)dlsym(dylib, "pepp_rvbt_entries");
+  const auto *entry_count = (const uint64_t *)dlsym(dylib, "pepp_rvbt_entry_count");
+  translation->m_entry = (typename TranslatedSegment<address_t>::entry_t)dlsym(dylib, "pepp_rvbt_run");
+  if (!abi || !xlen || !blocks || !instructions || !entries || !entry_count || !translation->m_entry) return false;
+  if (*abi != TRANSLATION_ABI || *xlen != 8 * sizeof(address_t)) return false;
+
+  translation->m_blocks = *blocks;
+  translation->m_instructions = *instructions;
+  translation->m_entries.reserve(*entry_count);
+  for (uint64_t i = 0; i < *entry_count; i++) {
+    if (!exec.is_within(entries[i])) return false;
+    translation->m_entries.push_back({entries[i], 0});
+  }
+  translation->activate(exec);
+  exec.set_translation(std::move(translation));
+
+  if (options.verbose_loader) {
+    printf("libriscv: Loaded translation %s (%zu blocks, %zu instructions)\n", filename.c_str(),
+           exec.translation()->block_count(), exec.translation()->instruction_count());
+  }
+  return true;
+}
+#endif
+} // namespace
+
+template <AddressType address_t>
+std::string emit_translation(const DecodedExecuteSegment<address_t> &exec, const MachineOptions<address_t> &options) {
+  std::string out;
+  Emitter<address_t> emitter{exec, exec.decoder_cache(), out};
+  emitter.scan(options.translate_blocks_max);
+  if (emitter.blocks.empty()) return out;
+  emitter.emit();
+  return out;
+}
+
+template <AddressType address_t> TranslatedSegment<address_t>::~TranslatedSegment() {
+#ifdef RISCV_TRANSLATION_SUPPORTED
+  if (m_dylib != nullptr) dlclose(m_dylib);
+#endif
+}
+
+template <AddressType address_t>
+bool TranslatedSegment<address_t>::run(CPU<address_t> &cpu, DecodedExecuteSegment<address_t> &exec,
+                                       address_t block_pc, address_t &pc, InstrCounter &counter) const {
+  auto &memory = cpu.machine().memory;
+  TranslationContext<address_t> ctx;
+  ctx.regs = cpu.registers().get().data();
+  ctx.cpu = &cpu;
+  ctx.segment = &exec;
+  if (!unaligned_memory_slowpaths && memory.uses_flat_memory_arena()) {
+    ctx.arena = (uint8_t *)memory.memory_arena_ptr();
+    ctx.arena_read_begin = Memory<address_t>::RWREAD_BEGIN;
+    ctx.arena_read_boundary = memory.memory_arena_read_boundary();
+    ctx.arena_write_begin = memory.initial_rodata_end();
+    ctx.arena_write_boundary = memory.memory_arena_write_boundary();
+  } else {
+    // Every access takes the callbacks
+    ctx.arena = nullptr;
+    ctx.arena_read_begin = ctx.arena_read_boundary = 0;
+    ctx.arena_write_begin = ctx.arena_write_boundary = 0;
+  }
+  ctx.counter = counter.value();
+  ctx.max_counter = counter.max();
+  ctx.load = translated_load<address_t>;
+  ctx.store = translated_store<address_t>;
+  ctx.execute = translated_execute<address_t>;
+  ctx.execute_original = translated_execute_original<address_t>;
+  ctx.unchecked = 0;
+
+  pc = m_entry(&ctx, block_pc);
+  counter.set_counters(ctx.counter, counter.max());
+  if (UNLIKELY(ctx.unchecked > 1))
+    throw MachineException(INVALID_PROGRAM, "Translated segment has no such entry point", block_pc);
+  return ctx.unchecked != 0;
+}
+
+template <AddressType address_t> void TranslatedSegment<address_t>::activate(DecodedExecuteSegment<address_t> &exec) {
+  for (auto &entry : m_entries) {
+    auto &data = exec.decoder_cache()[entry.pc >> DecoderCache<address_t>::SHIFT];
+    entry.bytecode = data.get_bytecode();
+    data.set_bytecode(RV32I_BC_TRANSLATOR);
+  }
+}
+
+template <AddressType address_t>
+void TranslatedSegment<address_t>::deactivate(DecodedExecuteSegment<address_t> &exec) const {
+  for (const auto &entry : m_entries) {
+    auto &data = exec.decoder_cache()[entry.pc >> DecoderCache<address_t>::SHIFT];
+    if (data.get_bytecode() == RV32I_BC_TRANSLATOR) data.set_bytecode(entry.bytecode);
+  }
+}
+
+template <AddressType address_t> void DecodedExecuteSegment<address_t>::revert_translation() {
+  if (m_translation == nullptr) return;
+  m_translation->deactivate(*this);
+  // The translated code may still be on the stack (eg. a breakpoint installed from a system call handler),
+  // so the shared object stays loaded for as long as the segment lives.
+  m_retired_translations.push_back(std::move(m_translation));
+}
+
+template <AddressType address_t>
+int CPU<address_t>::load_translation(const MachineOptions<address_t> &options, std::string *filename,
+                                     DecodedExecuteSegment<address_t> &exec) const {
+#ifdef RISCV_TRANSLATION_SUPPORTED
+  const std::string source = emit_translation(exec, options);
+  if (source.empty()) return -1;
+
+  const std::string dir = private_cache_directory(options.translation_cache_dir, "rvbt");
+  const auto command = compiler_command(options.translation_compiler);
+  const std::string compiler = command.empty() ? std::string{} : compiler_identity(command[0]);
+  if (dir.empty() || compiler.empty()) {
+    if (options.verbose_loader) printf("libriscv: No private cache directory or C compiler for translations\n");
+    return -1;
+  }
+  // The source encodes everything about the guest code, including its addresses. The rest is how it is compiled.
+  Sha256 key;
+  key.update_value(TRANSLATION_ABI).update_value(uint32_t(8 * sizeof(address_t)));
+  key.update(compiler).update("\0", 1);
+  for (size_t i = 1; i < command.size(); i++) key.update(command[i]).update("\0", 1);
+  for (const char *flag : COMPILER_FLAGS) key.update(flag).update("\0", 1);
+  key.update(source);
+  *filename = (std::filesystem::path(dir) / ("rv" + std::to_string(8 * sizeof(address_t)) + "-" + key.hex() + ".so"))
+                  .string();
+  if (load_shared_object(*filename, exec, options)) return 0;
+
+  if (!write_private_file(*filename + ".c", {{source.data(), source.size()}})) return -1;
+  return 1;
+#else
+  (void)options, (void)filename, (void)exec;
+  return -1;
+#endif
+}
+
+template <AddressType address_t>
+void CPU<address_t>::try_translate(const MachineOptions<address_t> &options, const std::string &filename,
+                                   std::shared_ptr<DecodedExecuteSegment<address_t>> &shared_segment) const {
+#ifdef RISCV_TRANSLATION_SUPPORTED
+  static std::atomic<unsigned> counter = 0;
+  const std::string temporary = filename + "." + std::to_string(getpid()) + "-" + std::to_string(counter++) + ".tmp";
+  const std::string source = filename + ".c", log = filename + ".log";
+  // Everything the child processes need is prepared before forking
+  std::vector<std::string> args = compiler_command(options.translation_compiler);
+  args.insert(args.end(), std::begin(COMPILER_FLAGS), std::end(COMPILER_FLAGS));
+  args.insert(args.end(), {"-o", temporary, source});
+  std::vector<char *> argv;
+  for (auto &arg : args) argv.push_back(arg.data());
+  argv.push_back(nullptr);
+  // Compiler diagnostics are kept next to the translation, unless the loader is verbose and waits for them
+  const bool to_terminal = options.translation_wait && options.verbose_loader;
+  const int log_fd = to_terminal ? -1 : open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+
+  if (options.translation_wait) {
+    const bool ok = compile(argv.data(), log_fd, temporary.c_str(), filename.c_str());
+    if (log_fd >= 0) close(log_fd);
+    if (!ok) {
+      if (options.verbose_loader) printf("libriscv: Could not compile translation %s\n", source.c_str());
+    } else if (!load_shared_object(filename, *shared_segment, options) && options.verbose_loader) {
+      printf("libriscv: Could not load translation %s\n", filename.c_str());
+    }
+    return;
+  }
+  // Double fork: the compile outlives this call without leaving a zombie, and nobody has to wait for it.
+  // The translation is found in the cache the next time this segment is loaded.
+  const pid_t runner = fork();
+  if (runner == 0) {
+    if (fork() != 0) _exit(0);
+    compile(argv.data(), log_fd, temporary.c_str(), filename.c_str());
+    _exit(0);
+  }
+  if (log_fd >= 0) close(log_fd);
+  if (runner > 0) wait_for(runner);
+  if (options.verbose_loader) printf("libriscv: Compiling translation %s in the background\n", filename.c_str());
+#else
+  (void)options, (void)filename, (void)shared_segment;
+#endif
+}
+
+template struct TranslatedSegment<uint32_t>;
+template struct TranslatedSegment<uint64_t>;
+template std::string emit_translation<uint32_t>(const DecodedExecuteSegment<uint32_t> &,
+                                                const MachineOptions<uint32_t> &);
+template std::string emit_translation<uint64_t>(const DecodedExecuteSegment<uint64_t> &,
+                                                const MachineOptions<uint64_t> &);
+template void DecodedExecuteSegment<uint32_t>::revert_translation();
+template void DecodedExecuteSegment<uint64_t>::revert_translation();
+template int CPU<uint32_t>::load_translation(const MachineOptions<uint32_t> &, std::string *,
+                                             DecodedExecuteSegment<uint32_t> &) const;
+template int CPU<uint64_t>::load_translation(const MachineOptions<uint64_t> &, std::string *,
+                                             DecodedExecuteSegment<uint64_t> &) const;
+template void CPU<uint32_t>::try_translate(const MachineOptions<uint32_t> &, const std::string &,
+                                           std::shared_ptr<DecodedExecuteSegment<uint32_t>> &) const;
+template void CPU<uint64_t>::try_translate(const MachineOptions<uint64_t> &, const std::string &,
+                                           std::shared_ptr<DecodedExecuteSegment<uint64_t>> &) const;
+} // namespace riscv
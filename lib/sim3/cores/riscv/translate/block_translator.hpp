@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sim3/common_macros.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system/rv_common.hpp"
+
+namespace riscv {
+template <AddressType address_t> struct CPU;
+template <AddressType address_t> struct DecodedExecuteSegment;
+struct InstrCounter;
+
+/*
+ * Block-level binary translation.
+ *
+ * The translator walks the blocks which realize_fastsim() carved out of the decoder cache and emits one C function
+ * per execute segment. Each block becomes a straight-line run of statements; direct branches between translated
+ * blocks become gotos, so hot loops never return to the bytecode dispatcher. Indirect jumps, blocks containing
+ * system instructions, and anything else the emitter does not understand are left to the dispatcher.
+ *
+ * The emitted code mirrors the bytecode handlers in cpu_dispatch.hpp statement for statement, including where
+ * instruction counter overflow is checked, so a translated segment retires exactly the same instructions (and stops
+ * at exactly the same PC) as the interpreter for a given instruction budget.
+ *
+ * The C source is compiled with the host C compiler into a shared object. Shared objects are cached in a private
+ * per-user directory, named by a SHA-256 of the emitted source, the compiler and its flags. A segment without a cached
+ * translation is compiled in a detached process and runs on the dispatcher until it is loaded again, unless
+ * MachineOptions::translation_wait asks to wait for the compiler. Entry points are rewritten to RV32I_BC_TRANSLATOR
+ * in the decoder cache. The original bytecodes are kept so that debugging helpers which patch the decoder cache can
+ * restore them first.
+ */
+
+// Version of the contract between TranslationContext and the emitted C code. Bump when either side changes.
+static constexpr uint32_t TRANSLATION_ABI = 1;
+
+// Passed to every translated function. The field order is the ABI and is duplicated in the emitted C prologue.
+template <AddressType address_t> struct TranslationContext {
+  address_t *regs;
+  void *cpu;
+  void *segment;
+  uint8_t *arena;
+  address_t arena_read_begin;
+  address_t arena_read_boundary;
+  address_t arena_write_begin;
+  address_t arena_write_boundary;
+  uint64_t counter;
+  uint64_t max_counter;
+  address_t (*load)(TranslationContext *, address_t addr, unsigned size);
+  void (*store)(TranslationContext *, address_t addr, address_t value, unsigned size);
+  // Run the decoder cache handler of the instruction at pc (RV32I_BC_FUNCTION and friends).
+  void (*execute)(TranslationContext *, address_t pc);
+  // Decode and run the original instruction bits at pc, for rewritten bytecodes without a C equivalent.
+  void (*execute_original)(TranslationContext *, address_t pc);
+  // Set when the returned PC was reached without an instruction counter check.
+  uint32_t unchecked;
+};
+
+template <AddressType address_t> struct TranslatedSegment {
+  using entry_t = address_t (*)(TranslationContext<address_t> *, address_t);
+
+  TranslatedSegment() = default;
+  TranslatedSegment(const TranslatedSegment &) = delete;
+  TranslatedSegment &operator=(const TranslatedSegment &) = delete;
+  ~TranslatedSegment();
+
+  /// @brief Run translated code starting at the entry point block_pc.
+  /// @param pc Receives the PC the dispatcher should continue from.
+  /// @return True if pc is a block inside the segment which must be entered without an overflow check.
+  bool run(CPU<address_t> &cpu, DecodedExecuteSegment<address_t> &exec, address_t block_pc, address_t &pc,
+           InstrCounter &counter) const;
+
+  /// @brief Rewrite every entry point in the decoder cache to RV32I_BC_TRANSLATOR.
+  void activate(DecodedExecuteSegment<address_t> &exec);
+  /// @brief Restore the bytecodes which activate() replaced.
+  void deactivate(DecodedExecuteSegment<address_t> &exec) const;
+
+  size_t entry_count() const noexcept { return m_entries.size(); }
+  size_t block_count() const noexcept { return m_blocks; }
+  size_t instruction_count() const noexcept { return m_instructions; }
+
+  struct Entry {
+    address_t pc;
+    uint8_t bytecode;
+  };
+
+  void *m_dylib = nullptr;
+  entry_t m_entry = nullptr;
+  std::vector<Entry> m_entries;
+  size_t m_blocks = 0;
+  size_t m_instructions = 0;
+};
+
+/// @brief Emit C source for every translatable block in an execute segment.
+/// @return An empty string if no block could be translated.
+template <AddressType address_t>
+std::string emit_translation(const DecodedExecuteSegment<address_t> &exec, const MachineOptions<address_t> &options);
+
+} // namespace riscv
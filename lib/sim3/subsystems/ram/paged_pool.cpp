@@ -33,6 +33,9 @@
  */
 #include "sim3/subsystems/ram/paged_pool.hpp"
 #include "core/arch/riscv/isa/rv_types.hpp"
+#ifdef __linux__
+#include <unistd.h>
+#endif
 #include "./paged_pool/memory_decoder.hpp"
 #include "./paged_pool/memory_elf.hpp"
 #include "./paged_pool/memory_mmap.hpp"
@@ -43,6 +46,38 @@
 
 namespace riscv {
 
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+// Reserves anonymous memory that starts on a huge page boundary, so that the kernel can back all of it with
+// transparent huge pages. Returns MAP_FAILED on failure, like mmap().
+static void *map_huge_page_arena(size_t len) {
+  static constexpr size_t HUGE_PAGE = size_t(2) << 20;
+  const size_t reserved = len + HUGE_PAGE;
+  auto *base = (char *)mmap(NULL, reserved, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) return MAP_FAILED;
+  auto *data = (char *)((uintptr_t(base) + HUGE_PAGE - 1) & ~uintptr_t(HUGE_PAGE - 1));
+  // Trim the reservation so that munmap(data, len) releases all of it
+  if (data != base) munmap(base, data - base);
+  munmap(data + len, base + reserved - (data + len));
+  madvise(data, len, MADV_HUGEPAGE);
+  return data;
+}
+#endif
+
+#ifdef MFD_CLOEXEC
+// Backs an arena by a memory file, which forks map privately to get a copy-on-write view of the arena.
+// Falls back to anonymous memory, leaving fd at -1, when there is no memory file.
+static void *map_forkable_arena(size_t len, int &fd) {
+  fd = memfd_create("pepp-arena", MFD_CLOEXEC);
+  if (fd >= 0 && ftruncate(fd, len) == 0) {
+    void *data = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+    if (data != MAP_FAILED) return data;
+  }
+  if (fd >= 0) close(fd);
+  fd = -1;
+  return mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+}
+#endif
+
 // The zero-page and guarded page share backing
 static const Page zeroed_page{PageAttributes{.read = true, .write = false, .exec = false, .is_cow = true}};
 static const Page guarded_page{
@@ -72,15 +107,31 @@ Memory<address_t>::Memory(Machine<address_t> &mach, std::string_view bin, Machin
   } else if (options.memory_max != 0) {
     const address_t pages_max = options.memory_max / Page::size();
     assert(pages_max >= 1);
+    // A flat arena spans the whole address space of 32-bit guests
+    const size_t arena_pages = (options.flat_memory_arena && sizeof(address_t) == 4)
+                                   ? (size_t(1) << 32) / Page::size()
+                                   : size_t(pages_max);
 
     if (options.use_memory_arena) {
 #if defined(__linux__) || defined(__FreeBSD__)
 
       // Over-allocate by 1 page in order to avoid bounds-checking with size
-      const size_t len = (pages_max + 1) * Page::size();
-      this->m_arena.data =
-          (PageData *)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
-      this->m_arena.pages = pages_max;
+      const size_t len = (arena_pages + 1) * Page::size();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+      if (options.memory_arena_huge_pages) {
+        this->m_arena.data = (PageData *)map_huge_page_arena(len);
+      } else
+#endif
+#ifdef MFD_CLOEXEC
+      if (options.forkable_memory_arena) {
+        this->m_arena.data = (PageData *)map_forkable_arena(len, this->m_arena.fd);
+      } else
+#endif
+      {
+        this->m_arena.data =
+            (PageData *)mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+      }
+      this->m_arena.pages = arena_pages;
       // mmap() returns MAP_FAILED (-1) when mapping fails
       if (UNLIKELY(this->m_arena.data == MAP_FAILED)) {
         this->m_arena.data = nullptr;
@@ -88,10 +139,15 @@ Memory<address_t>::Memory(Machine<address_t> &mach, std::string_view bin, Machin
       }
 #else
       // TODO: XXX: Investigate if this is a time sink
-      this->m_arena.data = new PageData[pages_max + 1];
-      this->m_arena.pages = pages_max;
+      this->m_arena.data = new PageData[arena_pages + 1];
+      this->m_arena.pages = arena_pages;
 #endif
     }
+    if (options.flat_memory_arena && this->m_arena.pages > 0) {
+      // Without a program there are no read-only segments, but page zero stays behind the page table
+      this->m_arena.initial_rodata_end = RWREAD_BEGIN;
+      this->set_arena_boundaries();
+    }
 
     if (this->m_arena.pages > 0) {
       // There is now a sequential arena, but we should make room for
@@ -143,10 +199,11 @@ template <AddressType address_t> Memory<address_t>::~Memory() {
   }
   // Potentially deallocate execute segments that are no longer referenced
   this->evict_execute_segments();
-  // only the original machine owns arena
-  if (this->m_arena.data != nullptr && !is_forked()) {
+  // only the original machine owns arena, and forks own their private view of it
+  if (this->m_arena.data != nullptr && (!is_forked() || this->m_arena.private_view)) {
 #if defined(__linux__) || defined(__FreeBSD__)
     munmap(this->m_arena.data, (this->m_arena.pages + 1) * Page::size());
+    if (this->m_arena.fd >= 0 && !is_forked()) close(this->m_arena.fd);
 #else
     delete[] this->m_arena.data;
 #endif
@@ -404,13 +461,7 @@ RISCV_INTERNAL void Memory<address_t>::binary_loader(const MachineOptions<addres
     this->m_exit_address = host_page;
   }
 
-  if (this->uses_flat_memory_arena() && this->memory_arena_size() >= m_arena.initial_rodata_end) {
-    this->m_arena.read_boundary = std::min(this->memory_arena_size(), size_t(this->memory_arena_size() - RWREAD_BEGIN));
-    this->m_arena.write_boundary =
-        std::min(this->memory_arena_size(), size_t(this->memory_arena_size() - m_arena.initial_rodata_end));
-  } else {
-    this->m_arena.initial_rodata_end = 0;
-  }
+  this->set_arena_boundaries();
 
   // Now that we know the boundries of the program, generate
   // efficient execute segments (if loadable).
@@ -438,6 +489,13 @@ RISCV_INTERNAL void Memory<address_t>::machine_loader(const Machine<address_t> &
   // Some machines don't need custom PF handlers
   this->m_page_fault_handler = master.memory.m_page_fault_handler;
 
+  // A fork of a fork would write into its master's private view of the arena
+  if (options.use_memory_arena && master.memory.m_arena.private_view)
+    throw MachineException(FEATURE_DISABLED, "Forking a fork with a memory arena is not supported");
+  // A private mapping of the master's arena makes the kernel copy the arena pages this fork writes to
+  const bool private_arena = options.use_memory_arena && this->map_private_arena(master.memory);
+  const auto *master_arena = master.memory.m_arena.data;
+
   if (options.minimal_fork == false) {
     // Hardly any pages are dont_fork, so we estimate that
     // all master pages will be loaned.
@@ -449,13 +507,29 @@ RISCV_INTERNAL void Memory<address_t>::machine_loader(const Machine<address_t> &
       if (page.attr.dont_fork) continue;
       // Make every page non-owning
       auto attr = page.attr;
+      attr.non_owning = true;
+      if (private_arena && page.m_page.get() >= master_arena && page.m_page.get() < master_arena + m_arena.pages) {
+        // Arena pages stay writable, in this fork's view of the arena
+        m_pages.try_emplace(it.first, attr, &m_arena.data[page.m_page.get() - master_arena]);
+        continue;
+      }
       if (attr.write) {
         attr.write = false;
         attr.is_cow = true;
       }
-      attr.non_owning = true;
       m_pages.try_emplace(it.first, attr, page.m_page.get());
     }
+    // The master's flat arena fast paths write without creating pages, so without a view of its own the fork
+    // borrows every page of the writable part of the arena. Pages the master already has were loaned above.
+    const auto &arena = master.memory.m_arena;
+    if (!private_arena && arena.data != nullptr && arena.write_boundary > 0) {
+      const address_t first = page_number(arena.initial_rodata_end);
+      const address_t last = std::min<size_t>(page_number(arena.initial_rodata_end + arena.write_boundary - 1) + 1,
+                                              arena.pages);
+      m_pages.reserve(m_pages.size() + (last - first));
+      const PageAttributes attr{.read = true, .write = false, .is_cow = true, .non_owning = true};
+      for (address_t pageno = first; pageno < last; pageno++) m_pages.try_emplace(pageno, attr, &arena.data[pageno]);
+    }
   }
   this->m_start_address = master.memory.m_start_address;
   this->m_stack_address = master.memory.m_stack_address;
@@ -468,9 +542,9 @@ RISCV_INTERNAL void Memory<address_t>::machine_loader(const Machine<address_t> &
   this->m_main_exec_segment = master.memory.m_main_exec_segment;
   this->m_exec = master.memory.m_exec;
 
-  if (options.use_memory_arena) {
-    this->m_arena.data = master.memory.m_arena.data;
-    this->m_arena.pages = master.memory.m_arena.pages;
+  // Without a view of its own, the fork has no arena: sharing the master's would let the fork write into it.
+  // The master's arena pages are then copy-on-write pages like any other.
+  if (private_arena) {
     this->m_arena.read_boundary = master.memory.m_arena.read_boundary;
     this->m_arena.write_boundary = master.memory.m_arena.write_boundary;
     this->m_arena.initial_rodata_end = master.memory.m_arena.initial_rodata_end;
@@ -480,6 +554,34 @@ RISCV_INTERNAL void Memory<address_t>::machine_loader(const Machine<address_t> &
   this->invalidate_reset_cache();
 }
 
+template <AddressType address_t> void Memory<address_t>::set_arena_boundaries() {
+  if (this->uses_flat_memory_arena() && this->memory_arena_size() >= m_arena.initial_rodata_end) {
+    this->m_arena.read_boundary = std::min(this->memory_arena_size(), size_t(this->memory_arena_size() - RWREAD_BEGIN));
+    this->m_arena.write_boundary =
+        std::min(this->memory_arena_size(), size_t(this->memory_arena_size() - m_arena.initial_rodata_end));
+  } else {
+    this->m_arena.initial_rodata_end = 0;
+    this->m_arena.read_boundary = 0;
+    this->m_arena.write_boundary = 0;
+  }
+}
+
+template <AddressType address_t> bool Memory<address_t>::map_private_arena(const Memory &master) {
+#if defined(__linux__)
+  if (master.m_arena.fd < 0 || master.m_arena.data == nullptr) return false;
+  const size_t len = (master.m_arena.pages + 1) * Page::size();
+  void *data = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE, master.m_arena.fd, 0);
+  if (data == MAP_FAILED) return false;
+  this->m_arena.data = (PageData *)data;
+  this->m_arena.pages = master.m_arena.pages;
+  this->m_arena.private_view = true;
+  return true;
+#else
+  (void)master;
+  return false;
+#endif
+}
+
 template <AddressType address_t> std::string Memory<address_t>::get_page_info(address_t addr) const {
   char buffer[1024];
   int len;
@@ -113,6 +113,10 @@ struct vBuffer {
 		   Returns the number of buffers filled, or an exception if not enough. */
 		size_t gather_buffers_from_range(size_t cnt, vBuffer[], address_t addr, size_t len) const;
 		size_t gather_writable_buffers_from_range(size_t cnt, vBuffer[], address_t addr, size_t len);
+		/* The longest prefix of [addr, len] that cnt buffers can always cover, even if
+		   no two pages are adjacent on the host. Clamping I/O to it turns a range too
+		   fragmented to gather into a short read or write instead of an exception. */
+		static size_t gather_limit(size_t cnt, address_t addr, size_t len) noexcept;
 		// Gather fragmented virtual memory into a buffer abstraction that can output
 		// to a vector, a string and check sequentiality.
 		riscv::Buffer membuffer(address_t addr, size_t len, size_t maxlen = 16ul << 20) const;
@@ -303,9 +307,23 @@ struct vBuffer {
 
     // Serializes the current memory state to an existing vector
     // Returns the final size of the serialized state
-    size_t serialize_to(std::vector<uint8_t> &vec) const;
-    // Returns memory to a previously stored state
-		void deserialize_from(const std::vector<uint8_t>&, const SerializedMachine<address_t>&);
+    // A delta only carries data for pages that are dirty, and all
+    // other pages are restored from the previous snapshot.
+    // flags are the SerializedMachine flags of the snapshot.
+    size_t serialize_to(std::vector<uint8_t> &vec, uint16_t flags = 0) const;
+    // Returns memory to a previously stored state. When mapping owns
+    // the memory behind bytes, pages of an aligned snapshot point into
+    // it instead of being copied, and the mapping is kept alive.
+    void deserialize_from(std::string_view bytes, const SerializedMachine<address_t> &,
+                          std::shared_ptr<void> mapping = nullptr);
+    // Marks every page clean, so that the next delta snapshot only
+    // carries pages written from now on, relative to snapshot_id.
+    void clear_dirty_pages(uint64_t snapshot_id);
+    // True once the dirty bits describe changes since a snapshot
+    // that was taken or restored, so a delta can be built on it.
+    bool tracks_dirty_pages() const noexcept { return m_tracks_dirty_pages; }
+    // The snapshot the dirty bits are relative to, if tracked.
+    uint64_t snapshot_id() const noexcept { return m_snapshot_id; }
 
 		Memory(Machine<address_t>&, std::string_view, MachineOptions<address_t>);
 		Memory(Machine<address_t>&, const Machine<address_t>&, MachineOptions<address_t>);
@@ -364,6 +382,10 @@ struct vBuffer {
 
 		const bool m_original_machine;
 		bool m_is_dynamic = false;
+		bool m_tracks_dirty_pages = false;
+		uint64_t m_snapshot_id = 0;
+		// Snapshot file that restored pages may point into
+		std::shared_ptr<void> m_snapshot_mapping;
 
 		const std::string_view m_binary;
 
@@ -388,7 +410,14 @@ struct vBuffer {
 			address_t write_boundary = 0;
 			address_t initial_rodata_end = 0;
 			size_t    pages = 0;
+			// Memory file backing the arena of the main machine, or -1. Forks map it privately, and the
+			// kernel copies the arena pages a fork writes to.
+			int       fd = -1;
+			bool      private_view = false; // A fork's own copy-on-write mapping of the arena
 		} m_arena;
+		bool map_private_arena(const Memory& master);
+		// Derives the fast-path bounds of the arena from initial_rodata_end
+		void set_arena_boundaries();
 
 		friend struct CPU<address_t>;
   };
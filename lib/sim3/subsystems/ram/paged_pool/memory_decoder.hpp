@@ -32,9 +32,13 @@
  * <https://opensource.org/license/bsd-3-clause>
  */
 #pragma once
+#include <latch>
 #include "sim3/common_macros.hpp"
+#include "sim3/cores/riscv/decode/decoder_cache_file.hpp"
 #include "sim3/cores/riscv/decode/decoder_cache_impl.hpp"
+#include "sim3/cores/riscv/decode/superinstructions.hpp"
 #include "sim3/subsystems/ram/paged_pool.hpp"
+#include "sim3/utils/threadpool.h"
 
 namespace riscv {
 template <AddressType address_t> void Memory<address_t>::evict_execute_segments() {
@@ -187,6 +191,122 @@ const std::shared_ptr<DecodedExecuteSegment<address_t>> &Memory<address_t>::exec
   return const_cast<Memory<address_t> *>(this)->exec_segment_for(vaddr);
 }
 
+// Decode the instructions in [begin, end) into their decoder cache entries. was_full_instruction tells whether
+// begin is the start of an instruction, as opposed to the upper half of a 32-bit instruction.
+// Each entry only depends on its own instruction bits, so disjoint ranges may be decoded concurrently.
+template <AddressType address_t>
+static void decode_instructions(DecodedExecuteSegment<address_t> &exec, const uint8_t *exec_segment,
+                                DecoderData<address_t> *exec_decoder, address_t begin, address_t end,
+                                address_t end_addr, bool was_full_instruction) {
+  /* Generate all instruction pointers for executable code.
+     Cannot step outside of this area when pregen is enabled,
+     so it's fine to leave the boundries alone. */
+  for (address_t dst = begin; dst < end;) {
+    auto &entry = exec_decoder[dst / DecoderCache<address_t>::DIVISOR];
+    entry.m_handler = 0;
+    entry.idxend = 0;
+
+    // Load unaligned instruction from execute segment
+    const auto instruction = read_instruction(exec_segment, dst, end_addr);
+    rv32i_instruction rewritten = instruction;
+
+    if (!compressed_enabled || was_full_instruction) {
+      // Cache the (modified) instruction bits
+      auto bytecode = CPU<address_t>::computed_index_for(instruction);
+      // Threaded rewrites are **always** enabled
+      bytecode = exec.threaded_rewrite(bytecode, dst, rewritten);
+      entry.set_bytecode(bytecode);
+      entry.instr = rewritten.whole;
+    } else {
+      // WARNING: If we don't ignore this instruction,
+      // it will get *wrong* idxend values, and cause *invalid jumps*
+      entry.m_handler = 0;
+      entry.set_bytecode(0);
+      // ^ Must be made invalid, even if technically possible to jump to!
+    }
+    if constexpr (VERBOSE_DECODER) {
+      if (entry.get_bytecode() >= RV32I_BC_BEQ && entry.get_bytecode() <= RV32I_BC_BGEU) {
+        fprintf(stderr, "Detected branch bytecode at 0x%lX\n", dst);
+      }
+      if (entry.get_bytecode() == RV32I_BC_BEQ_FW || entry.get_bytecode() == RV32I_BC_BNE_FW) {
+        fprintf(stderr, "Detected forward branch bytecode at 0x%lX\n", dst);
+      }
+    }
+
+    // Increment PC after everything
+    if constexpr (compressed_enabled) {
+      // With compressed we always step forward 2 bytes at a time
+      dst += 2;
+      if (was_full_instruction) {
+        // For it to be a full instruction again,
+        // the length needs to match.
+        was_full_instruction = (instruction.length() == 2);
+      } else {
+        // If it wasn't a full instruction last time, it
+        // will for sure be one now.
+        was_full_instruction = true;
+      }
+    } else dst += 4;
+  }
+}
+
+// Segments smaller than this are decoded on the calling thread, as handing them out costs more than it saves.
+static constexpr size_t PARALLEL_DECODE_MIN_BYTES = 256 * 1024;
+
+inline ThreadPool &decoder_thread_pool() {
+  static ThreadPool pool;
+  return pool;
+}
+
+// A page-aligned range of the execute segment, decoded and fused by one worker.
+template <AddressType address_t> struct DecoderChunk {
+  address_t begin;
+  address_t end;
+  bool was_full_instruction; // begin starts an instruction, rather than being inside a 32-bit one
+};
+
+// Split [begin, end) into one chunk per thread. Whether each chunk starts an instruction is the only state carried
+// from one entry to the next, and is found up front by walking the instruction lengths. Workers then write disjoint
+// entries, so the decoder cache is identical to the one produced by a single chunk.
+template <AddressType address_t>
+static std::vector<DecoderChunk<address_t>> decoder_chunks(const uint8_t *exec_segment, address_t begin,
+                                                           address_t end, unsigned threads) {
+  if (threads <= 1 || end - begin < PARALLEL_DECODE_MIN_BYTES) return {{begin, end, true}};
+  constexpr address_t PMASK = Page::size() - 1;
+  const address_t chunk = std::max<address_t>(((end - begin) / threads + PMASK) & ~PMASK, Page::size());
+
+  std::vector<DecoderChunk<address_t>> chunks;
+  address_t pc = begin;
+  for (address_t cbegin = begin; cbegin < end;) {
+    const address_t cend = std::min<address_t>(((cbegin + chunk) & ~PMASK), end);
+    if constexpr (compressed_enabled) {
+      while (pc < cbegin) pc += (exec_segment[pc] & 0x3) == 0x3 ? 4 : 2;
+    }
+    chunks.push_back({cbegin, cend, !compressed_enabled || pc == cbegin});
+    cbegin = cend;
+  }
+  return chunks;
+}
+
+// Run func on every chunk, on the decoder thread pool unless there is only one.
+template <AddressType address_t, typename Func>
+static void for_each_decoder_chunk(const std::vector<DecoderChunk<address_t>> &chunks, Func func) {
+  if (chunks.size() == 1) {
+    func(chunks.front());
+    return;
+  }
+  std::latch done(chunks.size());
+  std::vector<std::function<void()>> work;
+  for (const auto &chunk : chunks) {
+    work.push_back([&func, &chunk, &done] {
+      func(chunk);
+      done.count_down();
+    });
+  }
+  decoder_thread_pool().enqueue(std::move(work));
+  done.wait();
+}
+
 // The decoder cache is a sequential array of DecoderData<address_t> entries
 // each of which (currently) serves a dual purpose of enabling
 // threaded dispatch (m_bytecode) and fallback to callback function
@@ -226,16 +346,6 @@ Memory<address_t>::generate_decoder_cache([[maybe_unused]] const MachineOptions<
   if (n_pages == 0) {
     throw MachineException(INVALID_PROGRAM, "Program produced empty decoder cache");
   }
-  // Here we allocate the decoder cache which is page-sized
-  auto *decoder_cache = exec.create_decoder_cache(new DecoderCache<address_t>[n_pages], n_pages);
-  // Clear the decoder cache! (technically only needed when binary translation is enabled)
-  std::memset(decoder_cache, 0, n_pages * sizeof(DecoderCache<address_t>));
-  // Get a base address relative pointer to the decoder cache
-  // Eg. exec_decoder[pbase] is the first entry in the decoder cache
-  // so that PC with a simple shift can be used as a direct index.
-  auto *exec_decoder = decoder_cache[0].get_base() - pbase / DecoderCache<address_t>::DIVISOR;
-  exec.set_decoder(exec_decoder);
-
   DecoderData<address_t> invalid_op;
   invalid_op.set_handler(this->machine().cpu.decode({0}));
   if (UNLIKELY(invalid_op.m_handler != 0)) {
@@ -243,77 +353,74 @@ Memory<address_t>::generate_decoder_cache([[maybe_unused]] const MachineOptions<
                            invalid_op.m_handler);
   }
 
+  // A previous run may have stored the decoder cache of this very segment, which we can map instead of decoding
+  std::string cache_path;
+  DecoderCache<address_t> *decoder_cache = nullptr;
+  if (options.persistent_decoder_cache) {
+    cache_path = DecoderCacheFile<address_t>::path_for(options, SegmentKey::from(exec, memory_arena_size()));
+    decoder_cache = DecoderCacheFile<address_t>::load(cache_path, exec, options, memory_arena_size(), n_pages);
+    if (decoder_cache != nullptr && options.verbose_loader) {
+      printf("libriscv: Mapped decoder cache %s\n", cache_path.c_str());
+    }
+  }
+  const bool is_cached = decoder_cache != nullptr;
+  if (!is_cached) {
+    // Here we allocate the decoder cache which is page-sized
+    decoder_cache = exec.create_decoder_cache(new DecoderCache<address_t>[n_pages], n_pages);
+    // Clear the decoder cache! (technically only needed when binary translation is enabled)
+    std::memset(decoder_cache, 0, n_pages * sizeof(DecoderCache<address_t>));
+  }
+  // Get a base address relative pointer to the decoder cache
+  // Eg. exec_decoder[pbase] is the first entry in the decoder cache
+  // so that PC with a simple shift can be used as a direct index.
+  auto *exec_decoder = decoder_cache[0].get_base() - pbase / DecoderCache<address_t>::DIVISOR;
+  exec.set_decoder(exec_decoder);
+
   // PC-relative pointer to instruction bits
   auto *exec_segment = exec.exec_data();
   TIME_POINT(t1);
 
-  // When compressed instructions are enabled, many decoder
-  // entries are illegal because they are between instructions.
-  bool was_full_instruction = true;
-
-  /* Generate all instruction pointers for executable code.
-     Cannot step outside of this area when pregen is enabled,
-     so it's fine to leave the boundries alone. */
   TIME_POINT(t2);
-  address_t dst = addr;
-  const address_t end_addr = addr + len;
-  for (; dst < addr + len;) {
-    auto &entry = exec_decoder[dst / DecoderCache<address_t>::DIVISOR];
+  if (!is_cached) {
+    const address_t end_addr = addr + len;
+    const unsigned threads =
+        options.decoder_threads != 0 ? options.decoder_threads : std::max(1u, std::thread::hardware_concurrency());
+    const auto chunks = decoder_chunks<address_t>(exec_segment, addr, end_addr, threads);
+    for_each_decoder_chunk(chunks, [&](const DecoderChunk<address_t> &chunk) {
+      decode_instructions<address_t>(exec, exec_segment, exec_decoder, chunk.begin, chunk.end, end_addr,
+                                     chunk.was_full_instruction);
+    });
+
+    // Make sure the last entry is an invalid instruction
+    // This simplifies many other sub-systems
+    auto &entry = exec_decoder[(addr + len) / DecoderCache<address_t>::DIVISOR];
+    entry.set_bytecode(0);
     entry.m_handler = 0;
     entry.idxend = 0;
 
-    // Load unaligned instruction from execute segment
-    const auto instruction = read_instruction(exec_segment, dst, end_addr);
-    rv32i_instruction rewritten = instruction;
-
-    if (!compressed_enabled || was_full_instruction) {
-      // Cache the (modified) instruction bits
-      auto bytecode = CPU<address_t>::computed_index_for(instruction);
-      // Threaded rewrites are **always** enabled
-      bytecode = exec.threaded_rewrite(bytecode, dst, rewritten);
-      entry.set_bytecode(bytecode);
-      entry.instr = rewritten.whole;
-    } else {
-      // WARNING: If we don't ignore this instruction,
-      // it will get *wrong* idxend values, and cause *invalid jumps*
-      entry.m_handler = 0;
-      entry.set_bytecode(0);
-      // ^ Must be made invalid, even if technically possible to jump to!
-    }
-    if constexpr (VERBOSE_DECODER) {
-      if (entry.get_bytecode() >= RV32I_BC_BEQ && entry.get_bytecode() <= RV32I_BC_BGEU) {
-        fprintf(stderr, "Detected branch bytecode at 0x%lX\n", dst);
-      }
-      if (entry.get_bytecode() == RV32I_BC_BEQ_FW || entry.get_bytecode() == RV32I_BC_BNE_FW) {
-        fprintf(stderr, "Detected forward branch bytecode at 0x%lX\n", dst);
-      }
+    realize_fastsim<address_t>(addr, end_addr, exec_segment, exec_decoder);
+    if (options.fuse_superinstructions) {
+      std::atomic<size_t> fused = 0;
+      std::vector<address_t> boundaries(chunks.size());
+      for_each_decoder_chunk(chunks, [&](const DecoderChunk<address_t> &chunk) {
+        const address_t first = chunk.was_full_instruction ? chunk.begin : chunk.begin + 2;
+        fused += fuse_superinstructions<address_t>(first, chunk.end, end_addr, exec_segment, exec_decoder,
+                                                   &boundaries[&chunk - chunks.data()]);
+      });
+      // The pairs which straddle two chunks, now that no worker writes their second halves
+      for (const address_t pc : boundaries)
+        if (pc < end_addr) fused += fuse_superinstructions<address_t>(pc, pc + 1, end_addr, exec_segment, exec_decoder);
+      if (options.verbose_loader) printf("libriscv: Fused %zu instruction pairs\n", fused.load());
     }
 
-    // Increment PC after everything
-    if constexpr (compressed_enabled) {
-      // With compressed we always step forward 2 bytes at a time
-      dst += 2;
-      if (was_full_instruction) {
-        // For it to be a full instruction again,
-        // the length needs to match.
-        was_full_instruction = (instruction.length() == 2);
-      } else {
-        // If it wasn't a full instruction last time, it
-        // will for sure be one now.
-        was_full_instruction = true;
-      }
-    } else dst += 4;
+    // Stored before anything patches the decoder cache (breakpoints, translation, resolved handlers)
+    if (!cache_path.empty() && !DecoderCacheFile<address_t>::store(cache_path, exec, options, memory_arena_size()) &&
+        options.verbose_loader) {
+      printf("libriscv: Could not store decoder cache %s\n", cache_path.c_str());
+    }
   }
-  // Make sure the last entry is an invalid instruction
-  // This simplifies many other sub-systems
-  auto &entry = exec_decoder[(addr + len) / DecoderCache<address_t>::DIVISOR];
-  entry.set_bytecode(0);
-  entry.m_handler = 0;
-  entry.idxend = 0;
   TIME_POINT(t3);
 
-  realize_fastsim<address_t>(addr, dst, exec_segment, exec_decoder);
-
   // Debugging: EBREAK locations
   for (auto &loc : options.ebreak_locations) {
     address_t addr = 0;
@@ -328,6 +435,13 @@ Memory<address_t>::generate_decoder_cache([[maybe_unused]] const MachineOptions<
     }
   }
 
+  // Native code for the blocks, falling back to the decoder cache for the rest
+  if (options.translate_enabled && !exec.is_likely_jit()) {
+    std::string filename;
+    if (machine().cpu.load_translation(options, &filename, exec) > 0)
+      machine().cpu.try_translate(options, filename, shared_segment);
+  }
+
   TIME_POINT(t4);
 #ifdef ENABLE_TIMINGS
   const long t1t0 = nanodiff(t0, t1);
@@ -39,6 +39,14 @@ namespace riscv {
 template <AddressType address_t> inline
 void Memory<address_t>::memset(address_t dst, uint8_t value, size_t len)
 {
+	if constexpr (flat_readwrite_arena) {
+		// Fast-path: The whole range is in the writable part of the arena
+		if (dst - initial_rodata_end() < memory_arena_write_boundary()
+			&& dst + len - initial_rodata_end() <= memory_arena_write_boundary() && dst <= dst + len) {
+			std::memset(&((char *)m_arena.data)[RISCV_SPECSAFE(dst)], value, len);
+			return;
+		}
+	}
 	while (len > 0)
 	{
 		const size_t offset = dst & (Page::size()-1); // offset within page
@@ -56,6 +64,13 @@ template <AddressType address_t> inline
 void Memory<address_t>::memcpy(address_t dst, const void* vsrc, size_t len)
 {
 	auto* src = (uint8_t*) vsrc;
+	if constexpr (flat_readwrite_arena) {
+		if (dst - initial_rodata_end() < memory_arena_write_boundary()
+			&& dst + len - initial_rodata_end() <= memory_arena_write_boundary() && dst <= dst + len) {
+			std::copy(src, src + len, &((uint8_t *)m_arena.data)[RISCV_SPECSAFE(dst)]);
+			return;
+		}
+	}
 	while (len != 0)
 	{
 		const size_t offset = dst & (Page::size()-1); // offset within page
@@ -74,6 +89,14 @@ template <AddressType address_t> inline
 void Memory<address_t>::memcpy_out(void* vdst, address_t src, size_t len) const
 {
 	auto* dst = (uint8_t*) vdst;
+	if constexpr (flat_readwrite_arena) {
+		if (src - RWREAD_BEGIN < memory_arena_read_boundary()
+			&& src + len - RWREAD_BEGIN <= memory_arena_read_boundary() && src <= src + len) {
+			const auto* begin = &((const uint8_t *)m_arena.data)[RISCV_SPECSAFE(src)];
+			std::copy(begin, begin + len, dst);
+			return;
+		}
+	}
 	while (len != 0)
 	{
 		const size_t offset = src & (Page::size()-1);
@@ -488,6 +511,15 @@ void Memory<address_t>::memcpy(
   }
 }
 
+template <AddressType address_t> inline
+size_t Memory<address_t>::gather_limit(size_t cnt, address_t addr, size_t len) noexcept
+{
+	if (cnt == 0)
+		return 0;
+	const size_t first = Page::SIZE - (addr & (Page::SIZE-1));
+	return std::min(len, first + (cnt - 1) * Page::SIZE);
+}
+
 template <AddressType address_t> inline
 size_t Memory<address_t>::gather_buffers_from_range(
 	size_t cnt, vBuffer buffers[], address_t addr, size_t len) const
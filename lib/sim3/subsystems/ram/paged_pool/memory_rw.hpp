@@ -47,12 +47,14 @@ template <AddressType address_t> Page &Memory<address_t>::create_writable_pageno
   if (LIKELY(it != m_pages.end())) {
     Page &page = it->second;
     if (LIKELY(page.attr.write)) {
+      page.dirty = true;
       return page;
     } else if (page.attr.is_cow) {
       m_page_write_handler(*this, pageno, page);
       // The page may be read-cached at this time
       // and the page data has likely changed now.
       this->invalidate_cache(pageno, &page);
+      page.dirty = true;
       return page;
     }
   } else {
@@ -60,6 +62,7 @@ template <AddressType address_t> Page &Memory<address_t>::create_writable_pageno
     Page &page = m_page_fault_handler(*this, pageno, init);
     if (LIKELY(page.attr.write)) {
       this->invalidate_cache(pageno, &page);
+      page.dirty = true;
       return page;
     }
   }
@@ -124,6 +127,7 @@ void Memory<address_t>::memdiscard(address_t dst, size_t len, bool ignore_protec
           m_page_write_handler(*this, pageno, page);
         }
         if (page.attr.write || ignore_protections) {
+          page.dirty = true;
 
           if constexpr (MADVISE_ENABLED) {
             // madvise "fast-path" (XXX: doesn't scale on busy server)
@@ -125,9 +125,10 @@ struct Page
 	Page(const PageAttributes& a, const PageData& d = {})
 		: attr(a), m_page(new PageData{d}) { attr.non_owning = false; }
 	Page(Page&& other) noexcept
-		: attr(other.attr), m_page(std::move(other.m_page)) {}
+		: attr(other.attr), dirty(other.dirty), m_page(std::move(other.m_page)) {}
 	Page& operator= (Page&& other) noexcept {
 		attr = other.attr;
+		dirty = other.dirty;
 		m_page = std::move(other.m_page);
 		return *this;
 	}
@@ -201,6 +202,9 @@ struct Page
 	// this combination has been benchmarked to be faster than
 	// page-aligning the PageData struct and putting it first
 	PageAttributes attr;
+	// Set whenever the page is handed out for writing, and cleared by
+	// Memory::clear_dirty_pages(). Used by delta snapshots.
+	bool dirty = false;
 	std::unique_ptr<PageData> m_page;
 
 	bool has_trap() const noexcept { return m_trap != nullptr; }
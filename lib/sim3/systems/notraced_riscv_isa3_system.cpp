@@ -175,9 +175,11 @@ template struct riscv::Thread<uint64_t>;
 template struct riscv::MultiThreading<uint32_t>;
 template struct riscv::MultiThreading<uint64_t>;
 
-template size_t riscv::Memory<uint32_t>::serialize_to(std::vector<uint8_t> &) const;
-template void riscv::Memory<uint32_t>::deserialize_from(const std::vector<uint8_t> &,
-                                                        const SerializedMachine<uint32_t> &);
-template size_t riscv::Memory<uint64_t>::serialize_to(std::vector<uint8_t> &) const;
-template void riscv::Memory<uint64_t>::deserialize_from(const std::vector<uint8_t> &,
-                                                        const SerializedMachine<uint64_t> &);
+template size_t riscv::Memory<uint32_t>::serialize_to(std::vector<uint8_t> &, uint16_t) const;
+template void riscv::Memory<uint32_t>::deserialize_from(std::string_view, const SerializedMachine<uint32_t> &,
+                                                        std::shared_ptr<void>);
+template void riscv::Memory<uint32_t>::clear_dirty_pages(uint64_t);
+template size_t riscv::Memory<uint64_t>::serialize_to(std::vector<uint8_t> &, uint16_t) const;
+template void riscv::Memory<uint64_t>::deserialize_from(std::string_view, const SerializedMachine<uint64_t> &,
+                                                        std::shared_ptr<void>);
+template void riscv::Memory<uint64_t>::clear_dirty_pages(uint64_t);
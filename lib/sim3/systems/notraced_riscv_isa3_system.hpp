@@ -128,6 +128,17 @@ template <AddressType address_t> struct alignas(RISCV_MACHINE_ALIGNMENT) Machine
 		/// modified while the fork is running. Forks consume very little resources.
 		Machine(const Machine& main, const MachineOptions<address_t>& opts = {});
 
+		/// @brief Create a copy-on-write fork of this machine, see the forking constructor.
+		/// @details Guest memory, including the memory arena, is shared with this machine until
+		/// the fork writes to it. Many forks of one machine may run concurrently, each on its own thread.
+		/// Forks of a machine created with MachineOptions::forkable_memory_arena also use the arena fast
+		/// paths; other forks go through the page table.
+		/// @param opts Machine options for the fork
+		/// @return The fork, which must not outlive this machine.
+		std::unique_ptr<Machine> fork(const MachineOptions<address_t>& opts = {}) const {
+			return std::make_unique<Machine>(*this, opts);
+		}
+
 		/// @brief Tears down the machine, freeing all owned memory and pages.
 		~Machine();
 
@@ -487,6 +498,15 @@ template <AddressType address_t> struct alignas(RISCV_MACHINE_ALIGNMENT) Machine
 		/// @return Returns the total number of serialized bytes
 		size_t serialize_to(std::vector<uint8_t>& vec) const;
 
+		/// @brief Serializes only what changed since the previous snapshot
+		/// that was taken with this function or restored with deserialize_from.
+		/// Page attributes are always written, but page data only for pages
+		/// written since then. If there is no such snapshot yet, a full
+		/// snapshot is written instead, which can start a chain.
+		/// @param vec The vector to serialize into (append)
+		/// @return Returns the total number of serialized bytes
+		size_t serialize_delta_to(std::vector<uint8_t>& vec);
+
 		/// @brief Returns the machine to a previously stored state
 		/// NOTE: All previous memory traps are lost, syscall handlers,
 		/// destructor callbacks are kept. Page fault handler and
@@ -495,6 +515,31 @@ template <AddressType address_t> struct alignas(RISCV_MACHINE_ALIGNMENT) Machine
 		/// @return Returns 0 on success, otherwise a non-zero integer
 		int deserialize_from(const std::vector<uint8_t>& vec);
 
+		/// @brief Restores a full snapshot followed by the deltas taken
+		/// after it, in order. A single delta may also be passed to the
+		/// function above, but only while the machine is still exactly
+		/// at the state of the snapshot preceding it. Every delta records
+		/// which snapshot that was, and is rejected on top of any other.
+		/// @param chain The full snapshot, then zero or more deltas
+		/// @return Returns 0 on success, otherwise a non-zero integer
+		/// (-7 when a delta was not taken against the snapshot before it)
+		int deserialize_from(const std::vector<std::vector<uint8_t>>& chain);
+
+		/// @brief Writes a full snapshot to a file, laid out so that
+		/// deserialize_from_file can map it instead of reading it.
+		/// @param path The file to (over)write
+		/// @return Returns the number of bytes written, or 0 on failure
+		size_t serialize_to_file(const std::string& path) const;
+
+		/// @brief Restores a snapshot written by serialize_to_file. Guest
+		/// pages are backed copy-on-write by a private mapping of the file,
+		/// so restoring costs O(pages) and the file is never modified.
+		/// Deltas taken against this snapshot, eg. by a machine which
+		/// restored the same file, may be restored on top with deserialize_from.
+		/// @param path The snapshot file
+		/// @return Returns 0 on success, otherwise a non-zero integer
+		int deserialize_from_file(const std::string& path);
+
 		std::pair<uint64_t&, uint64_t&> get_counters() noexcept { return {m_counter, m_max_counter}; }
 		template <bool Throw = true>
 		bool simulate_with(uint64_t max_instructions, uint64_t counter, address_t pc);
@@ -231,27 +231,24 @@ static void syscall_read(Machine<address_t>& machine)
 	const size_t len   = machine.sysarg(2);
 	SYSPRINT("SYSCALL read, vfd: %d addr: 0x%lX, len: %zu\n",
 		vfd, (long)address, len);
+	// Zero-copy: the host reads straight into guest pages. A range too
+	// fragmented for the buffers becomes a short read.
+	std::array<riscv::vBuffer, 256> buffers;
+	const size_t gather_len = machine.memory.gather_limit(buffers.size(), address, len);
 	// We have special stdin handling
 	if (vfd == 0) {
-		// Arbitrary maximum read length
-		if (len > 1024 * 1024 * 16) {
-			machine.set_result(-ENOMEM);
-			return;
-		}
-		// TODO: We can use gather buffers here to avoid the copy
-		auto buffer = std::unique_ptr<char[]> (new char[len]);
-		long result = machine.stdin_read(buffer.get(), len);
-		if (result > 0) {
-			machine.copy_to_guest(address, buffer.get(), result);
-		}
+		const size_t cnt =
+			machine.memory.gather_writable_buffers_from_range(buffers.size(), buffers.data(), address, gather_len);
+		// The stdin callback is not vectored, and a second call could block after
+		// the first succeeded, so only the first contiguous buffer is filled.
+		const long result = (cnt > 0) ? machine.stdin_read(buffers[0].ptr, buffers[0].len) : 0;
 		machine.set_result_or_error(result);
 		return;
 	} else if (machine.has_file_descriptors()) {
 		const int real_fd = machine.fds().translate(vfd);
 
-		std::array<riscv::vBuffer, 512> buffers;
-		size_t cnt =
-			machine.memory.gather_writable_buffers_from_range(buffers.size(), buffers.data(), address, len);
+		const size_t cnt =
+			machine.memory.gather_writable_buffers_from_range(buffers.size(), buffers.data(), address, gather_len);
 		const ssize_t res =
 			readv(real_fd, (const iovec *)&buffers[0], cnt);
 		machine.set_result_or_error(res);
@@ -274,9 +271,9 @@ static void syscall_pread64(Machine<address_t>& machine)
 	if (machine.has_file_descriptors()) {
 		const int real_fd = machine.fds().translate(vfd);
 
-		std::array<riscv::vBuffer, 512> buffers;
-		const size_t cnt =
-			machine.memory.gather_writable_buffers_from_range(buffers.size(), buffers.data(), address, len);
+		std::array<riscv::vBuffer, 256> buffers;
+		const size_t cnt = machine.memory.gather_writable_buffers_from_range(
+			buffers.size(), buffers.data(), address, machine.memory.gather_limit(buffers.size(), address, len));
 #if defined(__linux__) && defined(SYS_preadv)
 		const ssize_t res =
 			syscall(SYS_preadv, real_fd, (const iovec *)&buffers[0], cnt, offset);
@@ -312,20 +309,22 @@ static void syscall_write(Machine<address_t>& machine)
 	const size_t len   = machine.sysarg(2);
 	SYSPRINT("SYSCALL write, fd: %d addr: 0x%lX, len: %zu\n",
 		vfd, (long)address, len);
-	// Zero-copy retrieval of buffers
-	std::array<riscv::vBuffer, 64> buffers;
+	// Zero-copy retrieval of buffers. A range too fragmented
+	// for the buffers becomes a short write.
+	std::array<riscv::vBuffer, 256> buffers;
+	const size_t gather_len = machine.memory.gather_limit(buffers.size(), address, len);
 
 	if (vfd == 1 || vfd == 2) {
 		size_t cnt =
-			machine.memory.gather_buffers_from_range(buffers.size(), buffers.data(), address, len);
+			machine.memory.gather_buffers_from_range(buffers.size(), buffers.data(), address, gather_len);
 		for (size_t i = 0; i < cnt; i++) {
 			machine.print(buffers[i].ptr, buffers[i].len);
 		}
-		machine.set_result(len);
+		machine.set_result(gather_len);
 	} else if (machine.has_file_descriptors() && machine.fds().permit_write(vfd)) {
 		int real_fd = machine.fds().translate(vfd);
 		size_t cnt =
-			machine.memory.gather_buffers_from_range(buffers.size(), buffers.data(), address, len);
+			machine.memory.gather_buffers_from_range(buffers.size(), buffers.data(), address, gather_len);
 		const ssize_t res =
 			writev(real_fd, (struct iovec *)&buffers[0], cnt);
 		SYSPRINT("SYSCALL write(real fd: %d iovec: %zu) = %ld\n",
@@ -336,6 +335,49 @@ static void syscall_write(Machine<address_t>& machine)
 	}
 }
 
+template <AddressType address_t>
+static void syscall_pwrite64(Machine<address_t>& machine)
+{
+	const int  vfd     = machine.template sysarg<int>(0);
+	const auto address = machine.sysarg(1);
+	const size_t len   = machine.sysarg(2);
+	const auto offset  = machine.sysarg(3);
+	SYSPRINT("SYSCALL pwrite64, vfd: %d addr: 0x%lX, len: %zu, offset: %lu\n",
+		vfd, (long)address, len, (long)offset);
+	if (machine.has_file_descriptors() && machine.fds().permit_write(vfd)) {
+		const int real_fd = machine.fds().translate(vfd);
+
+		std::array<riscv::vBuffer, 256> buffers;
+		const size_t cnt = machine.memory.gather_buffers_from_range(
+			buffers.size(), buffers.data(), address, machine.memory.gather_limit(buffers.size(), address, len));
+#if defined(__linux__) && defined(SYS_pwritev)
+		const ssize_t res =
+			syscall(SYS_pwritev, real_fd, (const iovec *)&buffers[0], cnt, offset);
+#elif defined(__wasm__)
+		const ssize_t res = -ENOSYS;
+#else
+		ssize_t res = 0;
+		for (size_t i = 0; i < cnt; i++) {
+			const ssize_t written = pwrite(real_fd, buffers[i].ptr, buffers[i].len, offset + res);
+			if (written < 0) {
+				if (res == 0)
+					res = written;
+				break;
+			}
+			res += written;
+			if ((size_t)written < buffers[i].len)
+				break;
+		}
+#endif
+		machine.set_result_or_error(res);
+		SYSPRINT("SYSCALL pwrite64, fd: %d from vfd: %d => %ld\n",
+				 real_fd, vfd, (long)machine.return_value());
+	} else {
+		machine.set_result(-EBADF);
+		SYSPRINT("SYSCALL pwrite64, vfd: %d => -EBADF\n", vfd);
+	}
+}
+
 template <AddressType address_t>
 static void syscall_readv(Machine<address_t>& machine)
 {
@@ -364,13 +406,18 @@ static void syscall_readv(Machine<address_t>& machine)
 		machine.copy_from_guest(g_vec.data(), iov_g, iov_size);
 
 		// Convert each iovec buffer to host buffers
-		std::array<riscv::vBuffer, 64> buffers;
+		std::array<riscv::vBuffer, 256> buffers;
 		size_t vec_cnt = 0;
 
-		for (int i = 0; i < count; i++) {
-			// The host buffers come directly from guest memory
+		for (int i = 0; i < count && vec_cnt < buffers.size(); i++) {
+			// The host buffers come directly from guest memory. Once they
+			// run out, the remaining iovecs are left for a short read.
+			const size_t room = buffers.size() - vec_cnt;
+			const size_t len = machine.memory.gather_limit(room, g_vec[i].iov_base, g_vec[i].iov_len);
 			vec_cnt += machine.memory.gather_writable_buffers_from_range(
-				buffers.size() - vec_cnt, &buffers[vec_cnt], g_vec[i].iov_base, g_vec[i].iov_len);
+				room, &buffers[vec_cnt], g_vec[i].iov_base, len);
+			if (len < g_vec[i].iov_len)
+				break;
 		}
 
 		const ssize_t res = readv(real_fd, (struct iovec *)&buffers[0], vec_cnt);
@@ -408,17 +455,21 @@ static void syscall_writev(Machine<address_t>& machine)
 		machine.memory.memcpy_out(vec.data(), iov_g, sizeof(guest_iovec<address_t>) * count);
 
 		/* Zero-copy retrieval of buffers */
-		std::array<riscv::vBuffer, 64> buffers;
+		std::array<riscv::vBuffer, 256> buffers;
 		size_t vec_cnt = 0;
 
-		for (int i = 0; i < count; i++)
+		for (int i = 0; i < count && vec_cnt < buffers.size(); i++)
 		{
 			auto& iov = vec.at(i);
 			auto src_g = (address_t) iov.iov_base;
 			auto len_g = (size_t) iov.iov_len;
 
+			const size_t room = buffers.size() - vec_cnt;
+			const size_t len = machine.memory.gather_limit(room, src_g, len_g);
 			vec_cnt +=
-				machine.memory.gather_buffers_from_range(buffers.size() - vec_cnt, &buffers[vec_cnt], src_g, len_g);
+				machine.memory.gather_buffers_from_range(room, &buffers[vec_cnt], src_g, len);
+			if (len < len_g)
+				break; // Short write
 		}
 
 		ssize_t res = 0;
@@ -1230,6 +1281,7 @@ void Machine<address_t>::setup_linux_syscalls(bool filesystem, bool sockets)
 	install_syscall_handler(65, syscall_readv<address_t>);
 	install_syscall_handler(66, syscall_writev<address_t>);
 	install_syscall_handler(67, syscall_pread64<address_t>);
+	install_syscall_handler(68, syscall_pwrite64<address_t>);
 	install_syscall_handler(72, syscall_pselect<address_t>);
 #ifdef __wasm__
 	install_syscall_handler(73, syscall_stub_zero<address_t>);
@@ -354,8 +354,8 @@ static void syscall_sendto(Machine<address_t>& machine)
 #ifdef __linux__
 		// Gather up to 1MB of pages we can read into
 		std::array<riscv::vBuffer, 256> buffers;
-		const size_t buffer_cnt =
-			machine.memory.gather_buffers_from_range(buffers.size(), buffers.data(), g_buf, buflen);
+		const size_t buffer_cnt = machine.memory.gather_buffers_from_range(
+			buffers.size(), buffers.data(), g_buf, machine.memory.gather_limit(buffers.size(), g_buf, buflen));
 
 		struct msghdr msg;
 		msg.msg_name = dest_addr;
@@ -396,8 +396,8 @@ static void syscall_recvfrom(Machine<address_t>& machine)
 #ifdef __linux__
 		// Gather up to 1MB of pages we can read into
 		std::array<riscv::vBuffer, 256> buffers;
-		const size_t buffer_cnt =
-			machine.memory.gather_writable_buffers_from_range(buffers.size(), buffers.data(), g_buf, buflen);
+		const size_t buffer_cnt = machine.memory.gather_writable_buffers_from_range(
+			buffers.size(), buffers.data(), g_buf, machine.memory.gather_limit(buffers.size(), g_buf, buflen));
 
 		alignas(16) char dest_addr[128];
 		struct msghdr hdr;
@@ -432,6 +432,70 @@ static void syscall_recvfrom(Machine<address_t>& machine)
 			 vfd, real_fd, (long)buflen, flags, (long)machine.return_value());
 }
 
+template <AddressType address_t>
+static void syscall_sendmsg(Machine<address_t>& machine)
+{
+	// ssize_t sendmsg(int sockfd, const struct msghdr *msg, int flags)
+	const auto [vfd, g_msg, flags] =
+		machine.template sysargs<int, address_t, int>();
+	int real_fd = -1;
+
+	if (machine.has_file_descriptors() && machine.fds().permit_sockets) {
+
+		real_fd = machine.fds().translate(vfd);
+
+#ifdef __linux__
+		std::array<riscv::vBuffer, 256> buffers;
+		std::array<guest_iovec<address_t>, 256> g_iov;
+		guest_msghdr<address_t> msg;
+		machine.copy_from_guest(&msg, g_msg, sizeof(msg));
+
+		if (msg.msg_iovlen > g_iov.size() || msg.msg_namelen > 128) {
+			machine.set_result(-ENOMEM);
+			return;
+		}
+		machine.copy_from_guest(g_iov.data(), msg.msg_iov, msg.msg_iovlen * sizeof(guest_iovec<address_t>));
+
+		unsigned vec_cnt = 0;
+		for (unsigned i = 0; i < msg.msg_iovlen && vec_cnt < buffers.size(); i++) {
+			const address_t g_buf = g_iov[i].iov_base;
+			const address_t g_len = g_iov[i].iov_len;
+			// Once the buffers run out, the rest is left for a short send
+			const size_t room = buffers.size() - vec_cnt;
+			const size_t len = machine.memory.gather_limit(room, g_buf, g_len);
+			vec_cnt +=
+				machine.memory.gather_buffers_from_range(room, &buffers[vec_cnt], g_buf, len);
+			if (len < g_len)
+				break;
+		}
+
+		alignas(16) char dest_addr[128];
+		if (msg.msg_name != 0x0)
+			machine.copy_from_guest(dest_addr, msg.msg_name, msg.msg_namelen);
+
+		struct msghdr hdr;
+		hdr.msg_name = (msg.msg_name != 0x0) ? dest_addr : nullptr;
+		hdr.msg_namelen = (msg.msg_name != 0x0) ? msg.msg_namelen : 0;
+		hdr.msg_iov = (struct iovec *)buffers.data();
+		hdr.msg_iovlen = vec_cnt;
+		hdr.msg_control = nullptr;
+		hdr.msg_controllen = 0;
+		hdr.msg_flags = 0;
+
+		const ssize_t res = sendmsg(real_fd, &hdr, flags);
+#else
+		// XXX: Write me
+		(void)real_fd;
+		const ssize_t res = -1;
+#endif
+		machine.set_result_or_error(res);
+	} else {
+		machine.set_result(-EBADF);
+	}
+	SYSPRINT("SYSCALL sendmsg, fd: %d (real fd: %d) msg: 0x%lX flags: %#x = %ld\n",
+			 vfd, real_fd, (long)g_msg, flags, (long)machine.return_value());
+}
+
 template <AddressType address_t>
 static void syscall_recvmsg(Machine<address_t>& machine)
 {
@@ -458,12 +522,17 @@ static void syscall_recvmsg(Machine<address_t>& machine)
 
 		unsigned vec_cnt = 0;
 		size_t total = 0;
-		for (unsigned i = 0; i < msg.msg_iovlen; i++) {
+		for (unsigned i = 0; i < msg.msg_iovlen && vec_cnt < buffers.size(); i++) {
 			const address_t g_buf = g_iov[i].iov_base;
 			const address_t g_len = g_iov[i].iov_len;
+			// Once the buffers run out, the rest of the message is truncated
+			const size_t room = buffers.size() - vec_cnt;
+			const size_t len = machine.memory.gather_limit(room, g_buf, g_len);
 			vec_cnt +=
-				machine.memory.gather_writable_buffers_from_range(buffers.size() - vec_cnt, &buffers[vec_cnt], g_buf, g_len);
-			total += g_len;
+				machine.memory.gather_writable_buffers_from_range(room, &buffers[vec_cnt], g_buf, len);
+			total += len;
+			if (len < g_len)
+				break;
 		}
 	#if 0
 		printf("recvmsg(buffers: %u, total: %zu)\n", vec_cnt, total);
@@ -482,9 +551,11 @@ static void syscall_recvmsg(Machine<address_t>& machine)
 		const ssize_t res = recvmsg(real_fd, &hdr, flags);
 		if (res >= 0) {
 			if (msg.msg_name != 0x0) {
-				machine.copy_to_guest(msg.msg_name, hdr.msg_name, hdr.msg_namelen);
+				machine.copy_to_guest(msg.msg_name, hdr.msg_name, std::min<uint32_t>(hdr.msg_namelen, msg.msg_namelen));
 				msg.msg_namelen = hdr.msg_namelen;
 			}
+			msg.msg_flags = hdr.msg_flags;
+			machine.copy_to_guest(g_msg, &msg, sizeof(msg));
 		}
 #else
 		// XXX: Write me
@@ -650,6 +721,7 @@ void add_socket_syscalls(Machine<address_t>& machine)
 	machine.install_syscall_handler(207, syscall_recvfrom<address_t>);
 	machine.install_syscall_handler(208, syscall_setsockopt<address_t>);
 	machine.install_syscall_handler(209, syscall_getsockopt<address_t>);
+	machine.install_syscall_handler(211, syscall_sendmsg<address_t>);
 	machine.install_syscall_handler(212, syscall_recvmsg<address_t>);
 	machine.install_syscall_handler(269, syscall_sendmmsg<address_t>);
 }
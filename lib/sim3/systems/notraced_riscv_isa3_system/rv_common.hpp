@@ -124,6 +124,25 @@ template <AddressType address_t> struct MachineOptions {
   /// locality and also enables read-write arena if the CMake option is ON.
   bool use_memory_arena = true;
 
+  /// @brief Make the memory arena cover the whole address space of a 32-bit
+  /// guest, or the first memory_max bytes of a 64-bit guest, and let loads and
+  /// stores inside it skip the page table even when no program is loaded.
+  /// @details Page zero and read-only program segments still go through the
+  /// page table. Page protections inside the arena are otherwise not enforced.
+  bool flat_memory_arena = false;
+
+  /// @brief Ask the kernel to back the memory arena with transparent huge pages.
+  /// @details The arena is then anonymous memory even with forkable_memory_arena.
+  bool memory_arena_huge_pages = false;
+
+  /// @brief Back the memory arena by a shared memory file, so that forks of this
+  /// machine can map the arena copy-on-write and keep using it. Linux only.
+  /// @details Otherwise the arena is private anonymous memory, and forks have
+  /// no arena: they read the arena pages of this machine, and copy the ones
+  /// they write to, through the page table. Forks of a flat_memory_arena then
+  /// borrow every writable arena page up front, one page table entry each.
+  bool forkable_memory_arena = false;
+
   /// @brief Enable sharing of execute segments between machines.
   /// @details This will allow multiple machines to share the same execute
   /// segment, reducing memory usage and increasing performance.
@@ -131,6 +150,51 @@ template <AddressType address_t> struct MachineOptions {
   /// translated code between machines. (Prevents some optimizations)
   bool use_shared_execute_segments = true;
 
+  /// @brief Number of threads which decode large execute segments.
+  /// @details 0 uses one thread per hardware thread, and 1 decodes on the calling thread. The decoder cache is
+  /// identical either way.
+  unsigned decoder_threads = 0;
+
+  /// @brief Fuse common pairs of instructions into single bytecodes when decoding.
+  /// @details Fused pairs (lui+addi, auipc+jalr, load+branch, addi+bne) are dispatched once instead of twice.
+  /// Instruction counting and debugging are unaffected.
+  bool fuse_superinstructions = true;
+
+  /// @brief Persist decoder caches on disk, and map them back in when the same execute segment is loaded again.
+  /// @details Files are keyed like shared execute segments (address, CRC32-C and arena size), and are ignored when
+  /// they were written by an emulator which decodes differently.
+  bool persistent_decoder_cache = false;
+
+  /// @brief Directory for persistent decoder caches.
+  /// @details When empty, a per-user cache directory (~/.cache/pepp/rvdc) is used.
+  /// The directory must belong to the current user, and is restricted to mode 0700.
+  std::string decoder_cache_dir{};
+
+  /// @brief Translate the blocks of each new execute segment into native code.
+  /// @details The blocks are emitted as C, compiled into a shared object by
+  /// translation_compiler and loaded at runtime. Blocks the translator does not
+  /// handle (system calls, breakpoints, ...) stay on the bytecode dispatcher,
+  /// and instruction counting remains exact. Only available on Linux and macOS.
+  bool translate_enabled = false;
+
+  /// @brief The maximum number of blocks translated per execute segment.
+  unsigned translate_blocks_max = 16384;
+
+  /// @brief Directory where compiled translations are cached between runs.
+  /// @details When empty, a per-user cache directory (~/.cache/pepp/rvbt) is used.
+  /// The directory must belong to the current user, and is restricted to mode 0700.
+  std::string translation_cache_dir{};
+
+  /// @brief C compiler used to build translations. When empty, $CC is used, then "cc".
+  /// @details Split on spaces and run without a shell, eg. "ccache cc".
+  std::string translation_compiler{};
+
+  /// @brief Wait for the compiler when a segment has no cached translation.
+  /// @details By default the compiler runs detached from the emulator, the current run
+  /// stays on the bytecode dispatcher, and the translation is picked up the next time
+  /// the same segment is loaded. Waiting stalls machine creation for the whole compile.
+  bool translation_wait = false;
+
   /// @brief Override a default-injected exit function with another function
   /// that is found by looking up the provided symbol name in the current program.
   /// Eg. if default_exit_function is "fast_exit", then the ELF binary must have
@@ -182,6 +246,11 @@ static constexpr size_t PageMask = RISCV_PAGE_SIZE - 1;
 	static constexpr bool fcsr_emulation = true;
 #else
 	static constexpr bool fcsr_emulation = false;
+#endif
+#ifdef RISCV_FUSION_COUNTERS
+	static constexpr bool fusion_counters_enabled = true;
+#else
+	static constexpr bool fusion_counters_enabled = false;
 #endif
 	static constexpr bool binary_translation_enabled = false;
 	static constexpr bool flat_readwrite_arena = true;
@@ -36,6 +36,16 @@
 #include "sim3/common_macros.hpp"
 #include "sim3/cores/riscv/notraced_cpu.hpp"
 #include "sim3/systems/notraced_riscv_isa3_system.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RISCV_MAPPED_SNAPSHOTS
+#endif
 #ifdef __GNUG__
 #define RISCV_PACKED __attribute__((packed))
 #else
@@ -44,6 +54,12 @@
 
 namespace riscv {
 static const uint64_t MAGiC_V4LUE = 0x9c36ab9301aed873;
+// SerializedMachine::flags
+static constexpr uint16_t SERIALIZED_DELTA = 0x1;
+// All page data follows the page table, starting at the first offset
+// past it that is a multiple of the page size. Lets a snapshot file be
+// mapped instead of copied.
+static constexpr uint16_t SERIALIZED_ALIGNED = 0x2;
 template <AddressType address_t> struct SerializedMachine {
   uint64_t magic;
   uint32_t n_pages;
@@ -52,9 +68,13 @@ template <AddressType address_t> struct SerializedMachine {
   uint16_t page_size;
   uint16_t attr_size;
   uint16_t serp_size;
-  uint16_t reserved;
+  uint16_t flags;
   uint16_t cpu_offset;
   uint32_t mem_offset;
+  // Random and never zero. Deltas also record the snapshot they were
+  // taken against, and only restore on top of exactly that one.
+  uint64_t snapshot_id;
+  uint64_t base_id;
 
   Registers<address_t> registers;
   uint64_t counter;
@@ -69,15 +89,42 @@ struct SerializedPage {
   uint64_t addr;
   PageAttributes attr;
   bool is_cow_page = false;
-  uint8_t padding[3]{0};
+  // Only in deltas: the page data is unchanged since the previous snapshot.
+  bool is_clean = false;
+  uint8_t padding[2]{0};
+
+  bool has_data() const noexcept { return !is_cow_page && !is_clean; }
 } RISCV_PACKED;
 
-template <AddressType address_t> size_t Machine<address_t>::serialize_to(std::vector<uint8_t> &vec) const {
+// Where page data begins. Interleaved snapshots store each page's
+// data right after its SerializedPage, so there it is the page table.
+template <AddressType address_t> static size_t serialized_data_offset(const SerializedMachine<address_t> &state) {
+  if (!(state.flags & SERIALIZED_ALIGNED)) return state.mem_offset;
+  const size_t table_end = state.mem_offset + size_t(state.n_pages) * sizeof(SerializedPage);
+  return (table_end + Page::size() - 1) & ~size_t(Page::size() - 1);
+}
+
+// Random, so that snapshots of other machines or earlier runs never
+// pass for the base of a delta.
+static uint64_t new_snapshot_id() {
+  thread_local std::mt19937_64 rng{(uint64_t(std::random_device{}()) << 32) | std::random_device{}()};
+  uint64_t id = 0;
+  while (id == 0) id = rng();
+  return id;
+}
+
+// Aligned snapshots align page data to the start of vec, so vec must be empty.
+template <AddressType address_t>
+static size_t serialize_machine(const Machine<address_t> &machine, std::vector<uint8_t> &vec, uint16_t flags,
+                                uint64_t snapshot_id = new_snapshot_id(), uint64_t base_id = 0) {
+  const auto &cpu = machine.cpu;
+  const auto &memory = machine.memory;
   const size_t before = vec.size();
+  const bool delta = flags & SERIALIZED_DELTA;
 
   unsigned datapage_count = 0;
   for (const auto &it : memory.pages()) {
-    if (!it.second.is_cow_page()) datapage_count++;
+    if (!it.second.is_cow_page() && (!delta || it.second.dirty)) datapage_count++;
   }
 
   const SerializedMachine<address_t> header{
@@ -88,12 +135,14 @@ template <AddressType address_t> size_t Machine<address_t>::serialize_to(std::ve
       .page_size = Page::size(),
       .attr_size = sizeof(PageAttributes),
       .serp_size = sizeof(SerializedPage),
-      .reserved = 0,
+      .flags = flags,
       .cpu_offset = sizeof(SerializedMachine<address_t>),
       .mem_offset = sizeof(SerializedMachine<address_t>) + 0x0,
+      .snapshot_id = snapshot_id,
+      .base_id = base_id,
 
       .registers = cpu.registers(),
-      .counter = this->instruction_counter(),
+      .counter = machine.instruction_counter(),
 
       .start_address = memory.start_address(),
       .stack_address = memory.stack_initial(),
@@ -103,22 +152,54 @@ template <AddressType address_t> size_t Machine<address_t>::serialize_to(std::ve
   };
   const auto *hptr = (const uint8_t *)&header;
   vec.insert(vec.end(), hptr, hptr + sizeof(header));
-  this->cpu.serialize_to(vec);
-  this->memory.serialize_to(vec);
+  cpu.serialize_to(vec);
+  memory.serialize_to(vec, flags);
 
   const size_t after = vec.size();
   return after - before;
 }
+template <AddressType address_t> size_t Machine<address_t>::serialize_to(std::vector<uint8_t> &vec) const {
+  return serialize_machine(*this, vec, 0);
+}
+template <AddressType address_t> size_t Machine<address_t>::serialize_delta_to(std::vector<uint8_t> &vec) {
+  const bool delta = memory.tracks_dirty_pages();
+  const uint64_t id = new_snapshot_id();
+  const size_t size = serialize_machine(*this, vec, delta ? SERIALIZED_DELTA : 0, id, delta ? memory.snapshot_id() : 0);
+  memory.clear_dirty_pages(id);
+  return size;
+}
+template <AddressType address_t> size_t Machine<address_t>::serialize_to_file(const std::string &path) const {
+  std::vector<uint8_t> vec;
+  serialize_machine(*this, vec, SERIALIZED_ALIGNED);
+  // Write-then-rename, so that a machine restoring from the same path never maps a partial file
+  const std::string tmp = path + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.write((const char *)vec.data(), vec.size())) return 0;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    return 0;
+  }
+  return vec.size();
+}
 template <AddressType address_t> void CPU<address_t>::serialize_to(std::vector<uint8_t> & /* vec */) const {}
-template <AddressType address_t> size_t Memory<address_t>::serialize_to(std::vector<uint8_t> &vec) const {
+template <AddressType address_t>
+size_t Memory<address_t>::serialize_to(std::vector<uint8_t> &vec, uint16_t flags) const {
   const size_t before = vec.size();
   if (this->m_arena.pages > 0 && riscv::flat_readwrite_arena) {
     throw MachineException(FEATURE_DISABLED, "Serialize is incompatible with flat read-write arena");
   }
+  const bool delta = flags & SERIALIZED_DELTA, aligned = flags & SERIALIZED_ALIGNED;
 
-  const size_t est_page_bytes = this->m_pages.size() * (sizeof(SerializedPage) + sizeof(PageData));
+  size_t est_page_bytes = this->m_pages.size() * sizeof(SerializedPage);
+  if (!delta) est_page_bytes += this->m_pages.size() * sizeof(PageData);
+  if (aligned) est_page_bytes += Page::size();
   vec.reserve(vec.size() + est_page_bytes);
 
+  std::vector<const Page *> data_pages;
   for (const auto &it : this->m_pages) {
     const auto &page = it.second;
 
@@ -127,6 +208,7 @@ template <AddressType address_t> size_t Memory<address_t>::serialize_to(std::vec
         .addr = static_cast<uint64_t>(it.first),
         .attr = page.attr,
         .is_cow_page = page.is_cow_page(),
+        .is_clean = delta && !page.dirty && !page.is_cow_page(),
     };
     // Make all pages owned from now on
     spage.attr.is_cow = false;
@@ -137,41 +219,104 @@ template <AddressType address_t> size_t Memory<address_t>::serialize_to(std::vec
     vec.insert(vec.end(), sptr, sptr + sizeof(SerializedPage));
 
     // The zero-page (and other guard pages) may not have data
-    if (page.is_cow_page()) continue;
+    if (!spage.has_data()) continue;
 
     // Serialize page data
-    vec.insert(vec.end(), page.data(), page.data() + sizeof(PageData));
+    if (aligned) data_pages.push_back(&page);
+    else vec.insert(vec.end(), page.data(), page.data() + sizeof(PageData));
+  }
+  if (aligned) {
+    vec.resize((vec.size() + Page::size() - 1) & ~size_t(Page::size() - 1), 0);
+    for (const auto *page : data_pages) vec.insert(vec.end(), page->data(), page->data() + sizeof(PageData));
   }
 
   const size_t after = vec.size();
   return after - before;
 }
+template <AddressType address_t> void Memory<address_t>::clear_dirty_pages(uint64_t snapshot_id) {
+  for (auto &it : this->m_pages) it.second.dirty = false;
+  // The cached write page would otherwise be written without
+  // passing through create_writable_pageno(), which marks it dirty.
+  this->invalidate_reset_cache();
+  this->m_tracks_dirty_pages = true;
+  this->m_snapshot_id = snapshot_id;
+}
 
-template <AddressType address_t> int Machine<address_t>::deserialize_from(const std::vector<uint8_t> &vec) {
-  if (vec.size() < sizeof(SerializedMachine<address_t>)) {
+template <AddressType address_t>
+static int deserialize_machine(Machine<address_t> &machine, std::string_view bytes, std::shared_ptr<void> mapping) {
+  if (bytes.size() < sizeof(SerializedMachine<address_t>)) {
     return -1;
   }
-  const auto &header = *(const SerializedMachine<address_t> *)vec.data();
+  const auto &header = *(const SerializedMachine<address_t> *)bytes.data();
   if (header.magic != MAGiC_V4LUE) return -1;
   if (header.reg_size != sizeof(Registers<address_t>)) return -2;
   if (header.page_size != Page::size()) return -3;
   if (header.attr_size != sizeof(PageAttributes)) return -4;
   if (header.serp_size != sizeof(SerializedPage)) return -5;
-  this->m_counter = header.counter;
-  this->m_max_counter = 0;
-  cpu.deserialize_from(vec, header);
-  memory.deserialize_from(vec, header);
+  // Snapshots from before snapshot IDs have a shorter header
+  if (header.cpu_offset != sizeof(SerializedMachine<address_t>)) return -1;
+  const bool delta = (header.flags & SERIALIZED_DELTA) != 0;
+  if (delta && (!machine.memory.tracks_dirty_pages() || header.base_id != machine.memory.snapshot_id())) return -7;
+  auto counters = machine.get_counters();
+  counters.first = header.counter;
+  counters.second = 0;
+  machine.cpu.deserialize_from(bytes, header);
+  machine.memory.deserialize_from(bytes, header, std::move(mapping));
   return 0;
 }
+template <AddressType address_t> int Machine<address_t>::deserialize_from(const std::vector<uint8_t> &vec) {
+  return deserialize_machine(*this, std::string_view((const char *)vec.data(), vec.size()), nullptr);
+}
+template <AddressType address_t>
+int Machine<address_t>::deserialize_from(const std::vector<std::vector<uint8_t>> &chain) {
+  if (chain.empty()) return -1;
+  // Check the links before touching the machine, so that a broken
+  // chain leaves it as it was
+  for (size_t i = 0; i < chain.size(); i++) {
+    const auto &vec = chain[i];
+    if (vec.size() < sizeof(SerializedMachine<address_t>)) return -1;
+    // Only the first link may be a full snapshot
+    const auto &header = *(const SerializedMachine<address_t> *)vec.data();
+    const bool delta = (header.flags & SERIALIZED_DELTA) != 0;
+    if (delta != (i > 0)) return -6;
+    if (delta && header.base_id != ((const SerializedMachine<address_t> *)chain[i - 1].data())->snapshot_id) return -7;
+  }
+  for (const auto &vec : chain) {
+    if (const int res = deserialize_from(vec); res != 0) return res;
+  }
+  return 0;
+}
+template <AddressType address_t> int Machine<address_t>::deserialize_from_file(const std::string &path) {
+#ifdef RISCV_MAPPED_SNAPSHOTS
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(SerializedMachine<address_t>)) {
+    close(fd);
+    return -1;
+  }
+  // Private and writable: the kernel copies a page only once the guest writes to it
+  const size_t len = st.st_size;
+  void *base = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return -1;
+  std::shared_ptr<void> mapping(base, [len](void *base) { munmap(base, len); });
+  return deserialize_machine(*this, std::string_view((const char *)base, len), std::move(mapping));
+#else
+  std::ifstream in(path, std::ios::binary);
+  std::vector<uint8_t> vec((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  return deserialize_from(vec);
+#endif
+}
 template <AddressType address_t>
-void CPU<address_t>::deserialize_from(const std::vector<uint8_t> & /* vec */,
-                                      const SerializedMachine<address_t> &state) {
+void CPU<address_t>::deserialize_from(std::string_view /* bytes */, const SerializedMachine<address_t> &state) {
   // restore CPU registers and counters
   this->m_regs = state.registers;
   this->m_exec = CPU::empty_execute_segment().get();
 }
 template <AddressType address_t>
-void Memory<address_t>::deserialize_from(const std::vector<uint8_t> &vec, const SerializedMachine<address_t> &state) {
+void Memory<address_t>::deserialize_from(std::string_view bytes, const SerializedMachine<address_t> &state,
+                                         std::shared_ptr<void> mapping) {
   this->m_start_address = state.start_address;
   this->m_stack_address = state.stack_address;
   this->m_mmap_address = state.mmap_address;
@@ -180,44 +325,99 @@ void Memory<address_t>::deserialize_from(const std::vector<uint8_t> &vec, const
 
   this->m_atomics = {};
 
-  const size_t page_bytes = state.n_pages * sizeof(SerializedPage) + state.n_datapages * sizeof(PageData);
-  if (vec.size() < state.mem_offset + page_bytes) {
+  const bool delta = (state.flags & SERIALIZED_DELTA) != 0;
+  const bool aligned = (state.flags & SERIALIZED_ALIGNED) != 0;
+  // Mapped pages must be page-aligned within the mapping
+  if (!aligned) mapping = nullptr;
+
+  const size_t page_bytes = aligned ? serialized_data_offset(state) - state.mem_offset
+                                    : state.n_pages * sizeof(SerializedPage);
+  if (bytes.size() < state.mem_offset + page_bytes + state.n_datapages * sizeof(PageData)) {
     throw MachineException(INVALID_PROGRAM, "Serialized machine state was invalid");
   }
+  const auto *data = (const uint8_t *)bytes.data();
+  // Interleaved page data follows each SerializedPage, so the page
+  // table is walked with the same cursor as the data.
+  auto data_size = [aligned](const SerializedPage &page) -> size_t {
+    return (!aligned && page.has_data()) ? sizeof(PageData) : 0;
+  };
 
-  // completely reset the paging system as
-  // all pages will be completely replaced
-  this->clear_all_pages();
+  if (delta) {
+    // Clean pages are kept as they are, so this memory must still be
+    // exactly at the snapshot the delta was taken against.
+    size_t off = state.mem_offset;
+    for (size_t p = 0; p < state.n_pages; p++) {
+      if (off + sizeof(SerializedPage) > bytes.size()) {
+        throw MachineException(INVALID_PROGRAM, "Serialized machine state was invalid");
+      }
+      const SerializedPage page = *(const SerializedPage *)&data[off];
+      off += sizeof(SerializedPage) + data_size(page);
+      if (!page.is_clean) continue;
+      auto it = m_pages.find(page.addr);
+      if (!m_tracks_dirty_pages || it == m_pages.end() || it->second.dirty || it->second.is_cow_page()) {
+        throw MachineException(INVALID_PROGRAM, "Delta snapshot does not apply to the current machine state");
+      }
+    }
+  } else {
+    // completely reset the paging system as
+    // all pages will be completely replaced
+    this->clear_all_pages();
+    this->m_snapshot_mapping = nullptr;
+  }
   this->evict_execute_segments();
 
-  size_t off = state.mem_offset;
+  std::vector<address_t> listed;
+  if (delta) listed.reserve(state.n_pages);
+
+  size_t off = state.mem_offset, data_off = serialized_data_offset(state);
   for (size_t p = 0; p < state.n_pages; p++) {
-    const SerializedPage page = *(SerializedPage *)&vec[off];
+    const SerializedPage page = *(const SerializedPage *)&data[off];
     off += sizeof(SerializedPage);
+    if (!aligned) data_off = off;
+    if (delta) listed.push_back(page.addr);
 
     PageAttributes new_attr = page.attr;
+    if (page.is_clean) {
+      // Pages with unchanged data
+      m_pages.at(page.addr).attr.apply_regular_attributes(new_attr);
+      continue;
+    }
+    if (delta) m_pages.erase(page.addr);
     // Pages with data
-    if (!page.is_cow_page) {
-      Page *new_page = nullptr;
+    if (page.has_data()) {
       if (page.addr < this->m_arena.pages) {
         // Create new non-owning arena page
         new_attr.non_owning = true;
         auto result = m_pages.try_emplace(page.addr, new_attr, &this->m_arena.data[page.addr]);
-        new_page = &result.first->second;
+        // Copy unaligned data into new PageData
+        std::copy(&data[data_off], &data[data_off] + sizeof(PageData), result.first->second.data());
+      } else if (mapping != nullptr) {
+        // Back the page by the mapped snapshot, which the kernel copies on write
+        m_pages.try_emplace(page.addr, new_attr, (PageData *)&data[data_off]);
       } else {
         // Create new uninitialized page
         auto result = m_pages.try_emplace(page.addr, new_attr, PageData::UNINITIALIZED);
-        new_page = &result.first->second;
+        // Copy unaligned data into new PageData
+        std::copy(&data[data_off], &data[data_off] + sizeof(PageData), result.first->second.data());
       }
-      // Copy unaligned data into new PageData
-      const auto *data = &vec[off];
-      std::copy(data, data + sizeof(PageData), new_page->data());
-      off += sizeof(PageData);
+      data_off += sizeof(PageData);
+      if (!aligned) off = data_off;
     } else {
       // Pages without data
       m_pages.try_emplace(page.addr, new_attr, Page::cow_page().m_page.get());
     }
   }
+  // Pages missing from a delta were freed after the previous snapshot
+  if (delta && m_pages.size() != listed.size()) {
+    std::sort(listed.begin(), listed.end());
+    std::erase_if(m_pages, [&](const auto &it) { return !std::binary_search(listed.begin(), listed.end(), it.first); });
+  }
+  // Deltas restored later may keep pointing into this mapping, so it
+  // is only released by the next full restore.
+  if (mapping != nullptr) this->m_snapshot_mapping = std::move(mapping);
+  // Everything now matches this snapshot, so later deltas can build on it
+  this->m_tracks_dirty_pages = true;
+  this->m_snapshot_id = state.snapshot_id;
   // page tables have been changed
   this->invalidate_reset_cache();
 }
@@ -43,6 +43,7 @@ namespace riscv {
 template <AddressType> struct Machine;
 
 template <AddressType> struct MultiThreading;
+template <AddressType> struct Thread;
 static const uint32_t PARENT_SETTID  = 0x00100000; /* set the TID in the parent */
 static const uint32_t CHILD_CLEARTID = 0x00200000; /* clear the TID in the child */
 static const uint32_t CHILD_SETTID   = 0x01000000; /* set the TID in the child */
@@ -56,6 +57,29 @@ static const uint32_t CHILD_SETTID   = 0x01000000; /* set the TID in the child *
 #define THPRINT(fmt, ...) /* fmt */
 #endif
 
+// Intrusive FIFO of threads, linked through the threads themselves. A thread
+// is in at most one queue at a time, so pushing, popping and removing any
+// thread are O(1) and never allocate.
+template <AddressType address_t> struct ThreadQueue {
+  using thread_t = Thread<address_t>;
+
+  ThreadQueue() = default;
+  ThreadQueue(const ThreadQueue &) = delete;
+  ThreadQueue &operator=(const ThreadQueue &) = delete;
+
+  thread_t *front() const noexcept { return m_head; }
+  bool empty() const noexcept { return m_head == nullptr; }
+  size_t size() const noexcept { return m_size; }
+  void push_back(thread_t *);
+  thread_t *pop_front();
+  void remove(thread_t *);
+
+private:
+  thread_t *m_head = nullptr;
+  thread_t *m_tail = nullptr;
+  size_t m_size = 0;
+};
+
 template <AddressType address_t> struct Thread {
 
   MultiThreading<address_t> &threading;
@@ -71,6 +95,10 @@ template <AddressType address_t> struct Thread {
   // The current or last blocked word
   uint32_t block_word = 0;
   uint32_t block_extra = 0;
+  // The run queue or wait queue holding this thread, if any
+  ThreadQueue<address_t> *queue = nullptr;
+  Thread *queue_prev = nullptr;
+  Thread *queue_next = nullptr;
 
   Thread(MultiThreading<address_t> &, int tid, address_t tls, address_t stack, address_t stkbase, address_t stksize);
   Thread(MultiThreading<address_t> &, const Thread &other);
@@ -101,18 +129,44 @@ template <AddressType address_t> struct MultiThreading {
 	size_t    wakeup_blocked(size_t max, uint32_t reason, uint32_t mask = ~0U);
 	/* A suspended thread can at any time be resumed. */
 	auto&     suspended_threads() { return m_suspended; }
-	/* A blocked thread can only be resumed by unblocking it. */
+	/* A blocked thread can only be resumed by unblocking it. Keyed by block reason (the futex address),
+	   and may hold empty wait queues. */
 	auto&     blocked_threads() { return m_blocked; }
 
+	/* Instructions a thread may run before simulate() preempts it, or 0 to only switch
+	   threads when they yield, block or exit. Every resumed thread starts a new slice. */
+	void      set_time_slice(uint64_t instructions) noexcept { m_time_slice = instructions; }
+	uint64_t  time_slice() const noexcept { return m_time_slice; }
+	/* Like Machine::simulate(), but round-robins between threads whose time slice ran out. */
+	template <bool Throw = true>
+	bool      simulate(uint64_t max_instructions = UINT64_MAX, uint64_t counter = 0u);
+
   MultiThreading(Machine<address_t> &);
   MultiThreading(Machine<address_t> &, const MultiThreading &);
   Machine<address_t> &machine;
-  std::vector<thread_t*> m_blocked;
-	std::vector<thread_t*> m_suspended;
+  std::unordered_map<uint32_t, ThreadQueue<address_t>> m_blocked;
+	ThreadQueue<address_t> m_suspended;
 	std::unordered_map<int, thread_t> m_threads;
 	unsigned   m_thread_counter = 0;
 	unsigned   m_max_threads = 50;
 	thread_t*  m_current = nullptr;
+	uint64_t   m_time_slice = 0;
+	// Instruction limit of the running simulate(), or 0 outside of it
+	uint64_t   m_deadline = 0;
+	// The wait queue used last. A futex handoff between two threads waits and wakes on the same
+	// address over and over, which this serves without hashing.
+	uint32_t   m_last_reason = 0;
+	ThreadQueue<address_t>* m_last_queue = nullptr;
+
+	// Removes a thread from the run queue or its wait queue
+	void      dequeue(thread_t *);
+	// The wait queue of a block reason, created on demand. Emptied wait queues are kept, since the
+	// same futex is usually waited on again soon, and are pruned once there are many of them.
+	ThreadQueue<address_t>& wait_queue(uint32_t reason);
+	// The wait queue of a block reason, or nullptr if nothing ever waited on it
+	ThreadQueue<address_t>* find_wait_queue(uint32_t reason);
+	// Where the time slice of a thread resumed now ends
+	uint64_t  slice_end() const noexcept;
 };
 } // riscv
 
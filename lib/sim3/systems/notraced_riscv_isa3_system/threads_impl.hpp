@@ -39,6 +39,33 @@
 /** Implementation **/
 
 namespace riscv {
+template <AddressType address_t> inline void ThreadQueue<address_t>::push_back(thread_t *thread) {
+  thread->queue = this;
+  thread->queue_prev = m_tail;
+  thread->queue_next = nullptr;
+  if (m_tail) m_tail->queue_next = thread;
+  else m_head = thread;
+  m_tail = thread;
+  m_size++;
+}
+
+template <AddressType address_t> inline Thread<address_t> *ThreadQueue<address_t>::pop_front() {
+  auto *thread = m_head;
+  if (thread) this->remove(thread);
+  return thread;
+}
+
+template <AddressType address_t> inline void ThreadQueue<address_t>::remove(thread_t *thread) {
+  assert(thread->queue == this);
+  if (thread->queue_prev) thread->queue_prev->queue_next = thread->queue_next;
+  else m_head = thread->queue_next;
+  if (thread->queue_next) thread->queue_next->queue_prev = thread->queue_prev;
+  else m_tail = thread->queue_prev;
+  thread->queue = nullptr;
+  thread->queue_prev = thread->queue_next = nullptr;
+  m_size--;
+}
+
 template <AddressType address_t> inline MultiThreading<address_t>::MultiThreading(Machine<address_t> &mach) : machine(mach) {
   // Best guess for default stack boundries
   const address_t base = 0x1000;
@@ -50,20 +77,22 @@ template <AddressType address_t> inline MultiThreading<address_t>::MultiThreadin
 
 template <AddressType address_t>
 inline MultiThreading<address_t>::MultiThreading(Machine<address_t> &mach, const MultiThreading<address_t> &other)
-    : machine(mach), m_thread_counter(other.m_thread_counter), m_max_threads(other.m_max_threads) {
+    : machine(mach), m_thread_counter(other.m_thread_counter), m_max_threads(other.m_max_threads),
+      m_time_slice(other.m_time_slice) {
   for (const auto &it : other.m_threads) {
     const int tid = it.first;
     m_threads.try_emplace(tid, *this, it.second);
   }
   /* Copy each suspended by pointer lookup */
-  m_suspended.reserve(other.m_suspended.size());
-  for (const auto *t : other.m_suspended) {
+  for (const auto *t = other.m_suspended.front(); t != nullptr; t = t->queue_next) {
     m_suspended.push_back(get_thread(t->tid));
   }
-  /* Copy each blocked by pointer lookup */
-  m_blocked.reserve(other.m_blocked.size());
-  for (const auto *t : other.m_blocked) {
-    m_blocked.push_back(get_thread(t->tid));
+  /* Copy each wait queue by pointer lookup */
+  for (const auto &it : other.m_blocked) {
+    auto &queue = this->wait_queue(it.first);
+    for (const auto *t = it.second.front(); t != nullptr; t = t->queue_next) {
+      queue.push_back(get_thread(t->tid));
+    }
   }
   /* Copy current thread */
   m_current = get_thread(other.m_current->tid);
@@ -76,6 +105,9 @@ template <AddressType address_t> inline void Thread<address_t>::resume() {
   auto &m = threading.machine;
   // restore registers
   m.cpu.registers().copy_from(Registers<address_t>::Options::NoVectors, this->stored_regs);
+  // start a new time slice, unless the machine is stopping
+  if (threading.m_deadline != 0 && threading.m_time_slice != 0 && m.max_instructions() != 0)
+    m.set_max_instructions(threading.slice_end());
   THPRINT(threading.machine, "Returning to tid=%d tls=0x%lX stack=0x%lX\n", this->tid,
           (long)this->stored_regs.get(REG_TP), (long)this->stored_regs.get(REG_SP));
   // this will ensure PC is executable in all cases
@@ -100,8 +132,8 @@ template <AddressType address_t> inline void Thread<address_t>::block(uint32_t r
   this->stored_regs.copy_from(Registers<address_t>::Options::NoVectors, threading.machine.cpu.registers());
   this->block_word = reason;
   this->block_extra = extra;
-  // add to blocked (NB: can throw)
-  threading.m_blocked.push_back(this);
+  // add to the wait queue of the reason (NB: can throw)
+  threading.wait_queue(reason).push_back(this);
 }
 
 template <AddressType address_t> inline void Thread<address_t>::block_return(address_t return_value, uint32_t reason, uint32_t extra) {
@@ -121,8 +153,7 @@ template <AddressType address_t> inline Thread<address_t> *MultiThreading<addres
 template <AddressType address_t> inline void MultiThreading<address_t>::wakeup_next() {
   // resume a waiting thread
   if (!m_suspended.empty()) {
-    auto *next = m_suspended.front();
-    m_suspended.erase(m_suspended.begin());
+    auto *next = m_suspended.pop_front();
     // resume next thread
     next->resume();
   } else {
@@ -257,49 +288,107 @@ template <AddressType address_t> inline bool MultiThreading<address_t>::yield_to
   if (store_retval) thread->suspend(0);
   else thread->suspend();
   // remove the next thread from suspension
-  for (auto it = m_suspended.begin(); it != m_suspended.end(); ++it) {
-    if (*it == next) {
-      m_suspended.erase(it);
-      break;
-    }
-  }
+  this->dequeue(next);
   // resume next thread
   next->resume();
   return true;
 }
 
 template <AddressType address_t> inline void MultiThreading<address_t>::unblock(int tid) {
-  for (auto it = m_blocked.begin(); it != m_blocked.end();) {
-    if ((*it)->tid == tid) {
-      // suspend current thread
-      get_thread()->suspend(0);
-      // resume this thread
-      (*it)->resume();
-      m_blocked.erase(it);
-      return;
-    } else ++it;
+  auto *thread = get_thread(tid);
+  if (thread == nullptr || thread->queue == nullptr || thread->queue == &m_suspended) {
+    // given thread id was not blocked
+    machine.cpu.reg(REG_ARG0) = -1;
+    return;
   }
-  // given thread id was not blocked
-  machine.cpu.reg(REG_ARG0) = -1;
+  this->dequeue(thread);
+  // suspend current thread
+  get_thread()->suspend(0);
+  // resume this thread
+  thread->resume();
 }
 template <AddressType address_t> inline size_t MultiThreading<address_t>::wakeup_blocked(size_t max, uint32_t reason, uint32_t mask) {
+  auto *found = this->find_wait_queue(reason);
+  if (found == nullptr) return 0;
+  auto &queue = *found;
   size_t awakened = 0;
-  for (auto it = m_blocked.begin(); it != m_blocked.end() && awakened < max;) {
-    // compare against block reason
-    const auto bits = (*it)->block_extra;
-    if ((*it)->block_word == reason && (bits == 0 || (bits & mask) != 0)) {
+  for (auto *thread = queue.front(); thread != nullptr && awakened < max;) {
+    auto *next = thread->queue_next;
+    // compare against block bitset
+    const auto bits = thread->block_extra;
+    if (bits == 0 || (bits & mask) != 0) {
       // move to suspended
-      m_suspended.push_back(*it);
-      m_blocked.erase(it);
+      queue.remove(thread);
+      m_suspended.push_back(thread);
       awakened++;
-    } else ++it;
+    }
+    thread = next;
   }
   return awakened;
 }
 
+template <AddressType address_t> inline void MultiThreading<address_t>::dequeue(thread_t *thread) {
+  auto *queue = thread->queue;
+  if (queue == nullptr) return;
+  queue->remove(thread);
+}
+
+template <AddressType address_t> inline ThreadQueue<address_t> &MultiThreading<address_t>::wait_queue(uint32_t reason) {
+  if (auto *queue = this->find_wait_queue(reason)) return *queue;
+  // At most m_max_threads queues are in use, so pruning frees at least half of them
+  if (m_blocked.size() >= 2 * m_max_threads) {
+    m_last_queue = nullptr;
+    std::erase_if(m_blocked, [](const auto &it) { return it.second.empty(); });
+  }
+  m_last_reason = reason;
+  m_last_queue = &m_blocked.try_emplace(reason).first->second;
+  return *m_last_queue;
+}
+
+template <AddressType address_t> inline ThreadQueue<address_t> *MultiThreading<address_t>::find_wait_queue(uint32_t reason) {
+  if (m_last_queue != nullptr && m_last_reason == reason) return m_last_queue;
+  auto it = m_blocked.find(reason);
+  if (it == m_blocked.end()) return nullptr;
+  // Map nodes stay put when the map rehashes, only pruning invalidates this
+  m_last_reason = reason;
+  m_last_queue = &it->second;
+  return m_last_queue;
+}
+
 template <AddressType address_t> inline void MultiThreading<address_t>::erase_thread(int tid) {
   auto it = m_threads.find(tid);
   assert(it != m_threads.end());
+  this->dequeue(&it->second);
   m_threads.erase(it);
 }
+
+template <AddressType address_t> inline uint64_t MultiThreading<address_t>::slice_end() const noexcept {
+  const uint64_t now = machine.instruction_counter();
+  if (now >= m_deadline || m_deadline - now <= m_time_slice) return m_deadline;
+  return now + m_time_slice;
+}
+
+template <AddressType address_t>
+template <bool Throw>
+inline bool MultiThreading<address_t>::simulate(uint64_t max_instructions, uint64_t counter) {
+  if (m_time_slice == 0) return machine.template simulate<Throw>(max_instructions, counter);
+  m_deadline = max_instructions;
+  machine.set_instruction_counter(counter);
+  while (true) {
+    if (machine.template simulate<false>(this->slice_end(), machine.instruction_counter())) {
+      m_deadline = 0;
+      return true;
+    }
+    if (machine.instruction_counter() >= m_deadline) break;
+    // The time slice ran out. Threads are stored as if they were switched
+    // by a system call, which resumes them at the instruction after PC.
+    machine.cpu.aligned_jump(machine.cpu.pc() - 4);
+    this->preempt();
+    machine.cpu.aligned_jump(machine.cpu.pc() + 4);
+  }
+  m_deadline = 0;
+  if constexpr (Throw)
+    throw MachineTimeoutException(MAX_INSTRUCTIONS_REACHED, "Instruction count limit reached", max_instructions);
+  return false;
+}
 } // namespace riscv
@@ -18,6 +18,7 @@
 #include <ostream>
 #include <set>
 #include "./packet_utils.hpp"
+#include "core/ds/dirty_bitmap.hpp"
 #include "core/math/bitmanip/mask.hpp"
 #include "sim3/api/memory_address.hpp"
 #include "sim3/api/traced/memory_path.hpp"
@@ -186,6 +187,8 @@ private:
   std::vector<Node> _elements;
 };
 
+// Accumulates the addresses written by trace packets, e.g., to highlight the bytes changed by the last step.
+// A run may emit millions of writes between GUI updates, so addresses are kept in a bitmap rather than an interval set.
 template <typename Address> class ModifiedAddressSink : public ::sim::api2::trace::Sink {
 public:
   virtual ~ModifiedAddressSink() = default;
@@ -208,26 +211,27 @@ public:
       if (end < start) {
         // TODO: This is probably wrong when intermediate addresses have more bytes.
         Address maxAddr = (1ull << (startAddrBytes->len * 8)) - 1;
-        _iset.insert(start, maxAddr);
-        _iset.insert(0, end);
-      } else _iset.insert(start, end);
+        _dirty.mark(start, maxAddr);
+        _dirty.mark(0, end);
+      } else _dirty.mark(start, end);
     }
     return true;
   }
-  void clear() { _iset.clear(); }
-  const std::set<Interval<Address>> &intervals() const { return _iset.intervals(); }
-  bool contains(Address addr) const {
-    using pepp::core::contains;
-    auto i = _iset.intervals();
-    if (i.size() == 0) return false;
-    // Use O(lg n) search to find glb.
-    // If glb is at the start, this is the only interval which could contain addr.
-    else if (auto lb = i.lower_bound(Interval<Address>{addr, addr}); lb == i.cbegin()) return contains(*lb, addr);
-    else if (lb != i.cend() && lb->lower() <= addr) return contains(*lb, addr);
-    // prev might fail if lb is cbegin.
-    else if (auto prev = std::prev(lb); prev == i.cend()) return false;
-    else return contains(*prev, addr);
+  void clear() { _dirty.clear(); }
+  // Adds the addresses modified in other, e.g., to combine a trace which was analyzed in pieces.
+  void merge(const ModifiedAddressSink &other) {
+    other.for_each_interval([this](Interval<Address> interval) { _dirty.mark(interval.lower(), interval.upper()); });
+  }
+  // Calls fn(Interval<Address>) for each maximal run of modified addresses, in ascending order.
+  template <typename Fn> void for_each_interval(Fn &&fn) const {
+    _dirty.for_each_run([&fn](u64 lower, u64 upper) { fn(Interval<Address>(lower, upper)); });
+  }
+  std::set<Interval<Address>> intervals() const {
+    std::set<Interval<Address>> ret;
+    for_each_interval([&ret](Interval<Address> interval) { ret.insert(ret.end(), interval); });
+    return ret;
   }
+  bool contains(Address addr) const { return _dirty.test(addr); }
 
 protected:
   using path_t = api2::packet::path_t;
@@ -235,7 +239,7 @@ protected:
   virtual Address translate(device_id_t, path_t, Address addr) const { return addr; }
 
 private:
-  IntervalSet<Address, true> _iset;
+  pepp::DirtyBitmap _dirty;
 };
 
 template <typename Address> class TranslatingModifiedAddressSink : public ModifiedAddressSink<Address> {
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "private_cache.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define RISCV_PRIVATE_CACHE
+#endif
+
+namespace riscv {
+#ifdef RISCV_PRIVATE_CACHE
+namespace {
+// Create dir if needed, then make sure it is a real directory owned by us that nobody else can enter.
+bool make_private_directory(const std::string &dir) {
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+  struct stat before;
+  if (lstat(dir.c_str(), &before) != 0 || !S_ISDIR(before.st_mode)) return false;
+  // O_NOFOLLOW: the directory may have been swapped for a symlink since lstat
+  const int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat st;
+  bool ok = fstat(fd, &st) == 0 && st.st_dev == before.st_dev && st.st_ino == before.st_ino &&
+            st.st_uid == geteuid();
+  if (ok && (st.st_mode & 077) != 0) ok = fchmod(fd, 0700) == 0;
+  close(fd);
+  return ok;
+}
+} // namespace
+
+std::string private_cache_directory(const std::string &configured, const char *name) {
+  std::error_code ec;
+  if (!configured.empty()) {
+    std::filesystem::path dir = configured;
+    if (dir.has_parent_path()) std::filesystem::create_directories(dir.parent_path(), ec);
+    return make_private_directory(dir.string()) ? dir.string() : std::string{};
+  }
+
+  std::filesystem::path base;
+  if (const char *xdg = getenv("XDG_CACHE_HOME"); xdg != nullptr && xdg[0] == '/') base = xdg;
+  else if (const char *home = getenv("HOME"); home != nullptr && home[0] == '/')
+    base = std::filesystem::path(home) / ".cache";
+  if (!base.empty()) {
+    std::filesystem::create_directories(base, ec);
+    base /= "pepp";
+  } else {
+    base = std::filesystem::temp_directory_path(ec);
+    if (ec) base = "/tmp";
+    base /= "pepp-" + std::to_string(geteuid());
+  }
+  const auto dir = base / name;
+  if (!make_private_directory(base.string()) || !make_private_directory(dir.string())) return {};
+  return dir.string();
+}
+
+int open_private_file(const std::string &path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0) return -1;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() || (st.st_mode & 022) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool write_private_file(const std::string &path, std::initializer_list<std::pair<const void *, size_t>> parts) {
+  static std::atomic<unsigned> counter = 0;
+  const std::string temporary = path + "." + std::to_string(getpid()) + "-" + std::to_string(counter++) + ".tmp";
+  // O_EXCL: never write through whatever already sits under the temporary name
+  unlink(temporary.c_str());
+  const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+  if (fd < 0) return false;
+  bool ok = true;
+  for (auto [data, len] : parts) {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    while (ok && len > 0) {
+      const ssize_t written = write(fd, bytes, len);
+      if (written <= 0) ok = false;
+      else bytes += written, len -= written;
+    }
+  }
+  ok = (close(fd) == 0) && ok;
+  if (ok) ok = rename(temporary.c_str(), path.c_str()) == 0;
+  if (!ok) unlink(temporary.c_str());
+  return ok;
+}
+#else
+std::string private_cache_directory(const std::string &, const char *) { return {}; }
+int open_private_file(const std::string &) { return -1; }
+bool write_private_file(const std::string &, std::initializer_list<std::pair<const void *, size_t>>) { return false; }
+#endif
+} // namespace riscv
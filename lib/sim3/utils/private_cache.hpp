@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstddef>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace riscv {
+/*
+ * On-disk caches whose contents the emulator trusts (mapped decoder caches, dlopen'ed translations) must not be
+ * writable by anyone but the current user. Otherwise another local user could plant a file under the expected name.
+ * These helpers are only implemented on Linux and macOS; elsewhere every call fails, which disables caching.
+ */
+
+/// @brief Find or create a cache directory that only the current user can access.
+/// @param configured Directory chosen by the user. When empty, $XDG_CACHE_HOME/pepp/<name> or ~/.cache/pepp/<name>
+/// is used, falling back to <temp>/pepp-<uid>/<name>.
+/// @return The directory, or an empty string if it is a symlink, is owned by another user, or cannot be created.
+/// Directories owned by the current user but accessible by others are restricted to mode 0700.
+std::string private_cache_directory(const std::string &configured, const char *name);
+
+/// @brief Open a file inside a private cache directory for reading.
+/// @return A file descriptor, or -1 if the file is missing, a symlink, not a regular file, owned by another user,
+/// or writable by the group or others.
+int open_private_file(const std::string &path);
+
+/// @brief Atomically replace path with the concatenation of parts, readable and writable only by the current user.
+/// @details The data is written to a fresh temporary file next to path, which is then renamed over it, so concurrent
+/// readers never observe a partial file.
+bool write_private_file(const std::string &path, std::initializer_list<std::pair<const void *, size_t>> parts);
+} // namespace riscv
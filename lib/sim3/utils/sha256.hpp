@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace riscv {
+// Incremental SHA-256 (FIPS 180-4). Used to name files in on-disk caches, where a collision would load the wrong
+// contents, so a checksum such as crc32c is not enough.
+class Sha256 {
+public:
+  using Digest = std::array<uint8_t, 32>;
+
+  Sha256 &update(const void *data, size_t len);
+  Sha256 &update(std::string_view text) { return update(text.data(), text.size()); }
+  // Hashes the bytes of a trivially copyable value, eg. a version number.
+  template <typename T> Sha256 &update_value(const T &value) { return update(&value, sizeof(value)); }
+  Digest finish();
+  // Lower-case hex of finish().
+  std::string hex();
+
+private:
+  void block(const uint8_t *data);
+
+  std::array<uint32_t, 8> m_state = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  std::array<uint8_t, 64> m_buffer{};
+  size_t m_buffered = 0;
+  uint64_t m_length = 0;
+};
+} // namespace riscv
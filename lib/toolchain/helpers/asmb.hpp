@@ -26,6 +26,7 @@ public:
   Lines2Addresses address2Lines(bool os);
   QSet<quint16> callViaRets();
 
+  QSharedPointer<const pas::ast::Node> osRoot() const { return _osRoot; }
   QSharedPointer<const pas::ast::Node> userRoot() const { return _userRoot; }
 
 private:
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/compile/lex/arena.hpp"
+#include <catch/catch.hpp>
+#include "core/compile/lex/buffer.hpp"
+#include "core/langs/asmb_pep/lexer.hpp"
+
+namespace {
+static auto idpool = []() { return std::make_shared<std::unordered_set<std::string>>(); };
+static auto data = [](std::string str) { return pepp::tc::support::SeekableData{std::move(str)}; };
+
+struct Recorder : public pepp::tc::lex::ALexer::Listener {
+  std::vector<pepp::tc::lex::Token *> seen;
+  void consumed(pepp::tc::lex::Token *t) override { seen.emplace_back(t); }
+};
+} // namespace
+
+TEST_CASE("Token arena", "[kind:unit][arch:*][scope:core][scope:core.compile]") {
+  using namespace pepp::tc::lex;
+  const auto loc = pepp::tc::support::LocationInterval{};
+  SECTION("Tokens span blocks and are destroyed on clear") {
+    TokenArena arena;
+    std::vector<Literal *> tokens;
+    // Enough tokens to require several blocks.
+    for (int it = 0; it < 2048; it++) tokens.emplace_back(arena.make<Literal>(loc, std::to_string(it)));
+    CHECK(arena.size() == 2048);
+    CHECK(arena.capacity() > TokenArena::BLOCK_SIZE);
+    for (int it = 0; it < 2048; it++) CHECK(tokens[it]->literal == std::to_string(it));
+    arena.clear();
+    CHECK(arena.size() == 0);
+    CHECK(arena.capacity() == TokenArena::BLOCK_SIZE);
+    auto reused = arena.make<Literal>(loc, "hi");
+    CHECK(reused->literal == "hi");
+  }
+  SECTION("Moving an arena keeps tokens in place") {
+    TokenArena arena;
+    auto tok = arena.make<Literal>(loc, "hi");
+    TokenArena moved(std::move(arena));
+    CHECK(moved.size() == 1);
+    CHECK(arena.size() == 0);
+    CHECK(tok->literal == "hi");
+    CHECK(arena.make<Literal>(loc, "world")->literal == "world");
+  }
+  SECTION("Tokens outlive the buffer clearing them") {
+    PepLexer l(idpool(), data("LDWA 10,d\nSTWA 12,d\n"));
+    Recorder r;
+    l.register_listener(&r);
+    Buffer b(&l);
+    Token *first = nullptr;
+    {
+      Checkpoint cp(b);
+      first = b.match<Identifier>();
+      REQUIRE(first);
+      b.match_until<Empty>();
+      b.match<Empty>();
+    }
+    // The buffer forgot its tokens when the last checkpoint closed, but the lexer still owns them.
+    CHECK(b.count_buffered_tokens() == 0);
+    CHECK(first->to_string() == "LDWA");
+    REQUIRE(r.seen.size() == 5);
+    CHECK(r.seen[0] == first);
+    auto second = b.match<Identifier>();
+    REQUIRE(second);
+    CHECK(second->to_string() == "STWA");
+    CHECK(r.seen.back() == second);
+  }
+}
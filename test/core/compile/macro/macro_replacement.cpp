@@ -16,6 +16,7 @@
 
 #include "core/compile/macro/macro_replacement.hpp"
 #include <catch/catch.hpp>
+#include "core/compile/macro/macro_registry.hpp"
 
 TEST_CASE("Macro textual substitution", "[scope:core][scope:core.compile][kind:unit][arch:*]") {
   const auto test_string = "\\hello\\world";
@@ -58,3 +59,39 @@ TEST_CASE("Macro textual substitution", "[scope:core][scope:core.compile][kind:u
     CHECK(pepp::tc::replace_macro_arguments(input_2, {{"\\arg1", "foo"}, {"\\()", ""}}) == "\\arg1");
   }
 }
+
+TEST_CASE("Compiled macro templates", "[scope:core][scope:core.compile][kind:unit][arch:*]") {
+  using namespace pepp::tc;
+  MacroDefinition def{.name = "M", .arguments = {{.name = "arg1"}, {.name = "arg"}}, .body = ""};
+  auto expand = [&](std::string body, std::vector<std::string_view> args, u32 unique = 7, u16 count = 3) {
+    def.body = body;
+    return MacroTemplate::compile(def).expand(args, unique, count);
+  };
+  // Must agree with replace_macro_arguments given the same values.
+  auto replace = [](std::string body, std::string arg1, std::string arg) {
+    return replace_macro_arguments(body, {{"\\arg1", arg1}, {"\\arg", arg}, {"\\@", "7"}, {"\\+", "3"}, {"\\()", ""}});
+  };
+
+  SECTION("Arguments and counters") {
+    for (const auto body : {"\\arg1\\arg", "LDWA \\arg1,\\arg\n", "l\\@_\\+: .WORD \\arg", "\\arg\\()1", "\\arg2\\ar",
+                            "\\( )\\\\arg1", "\\", "no escapes", ""}) {
+      CHECK(expand(body, {"foo", "bar"}) == replace(body, "foo", "bar"));
+    }
+  }
+  SECTION("Missing arguments are empty") { CHECK(expand("[\\arg1|\\arg]", {"foo"}) == "[foo|]"); }
+  SECTION("Compiled templates can still expand by key") {
+    def.body = "\\arg1 \\other \\@";
+    auto compiled = MacroTemplate::compile(def);
+    CHECK(compiled.expand({{"\\arg1", "a"}, {"\\other", "b"}, {"\\@", "c"}}) == "a b c");
+  }
+  SECTION("Registries compile on insert") {
+    auto reg = std::make_shared<MacroRegistry>();
+    auto md = std::make_shared<MacroDefinition>();
+    md->name = "M", md->arguments = {{.name = "a"}}, md->body = "\\a";
+    CHECK(reg->insert(md));
+    REQUIRE(reg->find("M")->compiled != nullptr);
+    std::vector<std::string_view> args{"x"};
+    CHECK(reg->find("M")->compiled->expand(args, 0, 0) == "x");
+  }
+}
+
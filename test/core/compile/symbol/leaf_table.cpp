@@ -16,6 +16,7 @@
 
 #include "core/compile/symbol/leaf_table.hpp"
 #include <catch/catch.hpp>
+#include <chrono>
 #include "core/compile/symbol/entry.hpp"
 #include "core/compile/symbol/value.hpp"
 
@@ -126,4 +127,71 @@ TEST_CASE("Leaf symbol tables", "[scope:core][scope:core.compile][kind:unit][arc
     auto x2 = st->define("h2");
     REQUIRE_NOTHROW(table_listing(*st, 2));
   }
+  SECTION("handles are stable and agree with find()") {
+    auto st = std::make_shared<pepp::core::symbol::LeafTable>(2);
+    std::vector<LeafTable::handle_t> handles;
+    // Enough symbols to force the index to grow several times.
+    for (int it = 0; it < 1000; it++) handles.emplace_back(st->reference_handle("s" + std::to_string(it)));
+    for (int it = 0; it < 1000; it++) {
+      const auto name = "s" + std::to_string(it);
+      CHECK(st->reference_handle(name) == handles[it]);
+      CHECK(st->find(name) == handles[it]);
+      CHECK((*st)[handles[it]]->name == name);
+      CHECK(st->get(name).value() == (*st)[handles[it]]);
+    }
+    CHECK(st->find("missing") == std::nullopt);
+    CHECK(st->entries().size() == 1000);
+  }
+  SECTION("erase_if() keeps other handles intact") {
+    auto st = std::make_shared<pepp::core::symbol::LeafTable>(2);
+    auto h0 = st->reference_handle("h0"), h1 = st->reference_handle("h1"), h2 = st->reference_handle("h2");
+    CHECK(st->erase_if([](const auto &kv) { return kv.second->name == "h1"; }) == 1);
+    CHECK(!st->exists("h1"));
+    CHECK((*st)[h1] == nullptr);
+    CHECK(st->find("h0") == h0);
+    CHECK(st->find("h2") == h2);
+    CHECK(st->entries().size() == 2);
+    for (const auto &[name, entry] : st->entries()) CHECK(entry != nullptr);
+    // A name which was erased gets a new entry, rather than reviving the old one.
+    auto h1_again = st->reference_handle("h1");
+    CHECK((*st)[h1_again] != nullptr);
+    CHECK(st->find("h1") == h1_again);
+    CHECK(st->find("h0") == h0);
+    CHECK(st->find("h2") == h2);
+  }
+  SECTION("erase_if() re-uses the storage of erased entries") {
+    auto st = std::make_shared<pepp::core::symbol::LeafTable>(2);
+    auto keep = st->reference("keep");
+    auto handle = st->reference_handle("temp");
+    const auto *address = st->reference("temp").get();
+    // What the incremental assembler does on every edit: drop unreferenced symbols, then re-create them.
+    for (int it = 0; it < 1000; it++) {
+      CHECK(st->erase_if([](const auto &kv) { return kv.second.use_count() == 1; }) == 1);
+      CHECK(st->reference_handle("temp" + std::to_string(it)) == handle);
+      CHECK(st->reference("temp" + std::to_string(it)).get() == address);
+    }
+    CHECK(st->entries().size() == 2);
+    CHECK(st->get("keep").value() == keep);
+  }
+}
+
+TEST_CASE("Leaf symbol table throughput", "[.][benchmark][scope:core][scope:core.compile][arch:*]") {
+  using clock = std::chrono::steady_clock;
+  constexpr int count = 100'000;
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (int it = 0; it < count; it++) names.emplace_back("symbol_" + std::to_string(it));
+
+  auto st = std::make_shared<pepp::core::symbol::LeafTable>(2);
+  auto start = clock::now();
+  for (const auto &name : names) st->define(name);
+  const auto insert = std::chrono::duration<double>(clock::now() - start).count();
+
+  size_t found = 0;
+  start = clock::now();
+  for (int pass = 0; pass < 10; pass++)
+    for (const auto &name : names) found += st->get(name).has_value();
+  const auto lookup = std::chrono::duration<double>(clock::now() - start).count();
+  CHECK(found == 10 * count);
+  printf("insert: %.0f symbols/s, lookup: %.0f symbols/s\n", count / insert, 10 * count / lookup);
 }
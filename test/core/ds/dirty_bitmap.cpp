@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <set>
+#include <utility>
+#include <vector>
+#include "core/ds/dirty_bitmap.hpp"
+
+namespace {
+using Runs = std::vector<std::pair<u64, u64>>;
+Runs runs(const pepp::DirtyBitmap &bitmap) {
+  Runs ret;
+  bitmap.for_each_run([&](u64 lower, u64 upper) { ret.emplace_back(lower, upper); });
+  return ret;
+}
+} // namespace
+
+TEST_CASE("DirtyBitmap", "[scope:core][kind:unit][arch:*]") {
+  using namespace pepp;
+  DirtyBitmap bitmap;
+  SECTION("Empty") {
+    CHECK(!bitmap.any());
+    CHECK(!bitmap.test(0));
+    CHECK(runs(bitmap).empty());
+  }
+  SECTION("Adjacent marks coalesce") {
+    bitmap.mark(3);
+    bitmap.mark(4, 6);
+    bitmap.mark(8);
+    CHECK(runs(bitmap) == Runs{{3, 6}, {8, 8}});
+    CHECK(bitmap.test(6));
+    CHECK(!bitmap.test(7));
+  }
+  SECTION("Runs across word boundaries") {
+    bitmap.mark(60, 70);
+    bitmap.mark(127, 128);
+    bitmap.mark(192, 255);
+    CHECK(runs(bitmap) == Runs{{60, 70}, {127, 128}, {192, 255}});
+    bitmap.mark(256, 300);
+    CHECK(runs(bitmap) == Runs{{60, 70}, {127, 128}, {192, 300}});
+    bitmap.mark(0, 400);
+    CHECK(runs(bitmap) == Runs{{0, 400}});
+  }
+  SECTION("Clear") {
+    bitmap.mark(100, 1000);
+    bitmap.clear();
+    CHECK(!bitmap.any());
+    CHECK(!bitmap.test(500));
+    CHECK(runs(bitmap).empty());
+    bitmap.mark(5);
+    CHECK(runs(bitmap) == Runs{{5, 5}});
+  }
+  SECTION("Matches a reference set") {
+    std::set<u64> reference;
+    u64 state = 0x1234;
+    for (int it = 0; it < 500; it++) {
+      state = state * 6364136223846793005ull + 1442695040888963407ull;
+      const u64 lower = (state >> 33) % 4096, length = (state >> 20) % 24;
+      bitmap.mark(lower, lower + length);
+      for (u64 addr = lower; addr <= lower + length; addr++) reference.insert(addr);
+    }
+    std::set<u64> seen;
+    u64 previous_upper = 0;
+    bool first = true, maximal = true;
+    bitmap.for_each_run([&](u64 lower, u64 upper) {
+      // Runs are disjoint, ascending, and never adjacent.
+      if (!first && lower <= previous_upper + 1) maximal = false;
+      first = false, previous_upper = upper;
+      for (u64 addr = lower; addr <= upper; addr++) seen.insert(addr);
+    });
+    CHECK(maximal);
+    CHECK(seen == reference);
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <random>
+#include <vector>
+#include "core/ds/compress/lz.hpp"
+
+namespace {
+std::vector<u8> round_trip(const std::vector<u8> &src) {
+  const auto packed = pepp::lz::compress(src);
+  CHECK(packed.size() <= pepp::lz::bound(src.size()));
+  std::vector<u8> ret(src.size());
+  CHECK(pepp::lz::decompress(packed, ret));
+  return ret;
+}
+} // namespace
+
+TEST_CASE("LZ codec", "[scope:core][scope:core.ds][kind:unit][arch:*]") {
+  std::mt19937 rng(0);
+  SECTION("Empty and tiny inputs") {
+    for (std::size_t size = 0; size < 20; ++size) {
+      std::vector<u8> src(size);
+      for (auto &byte : src) byte = rng() % 3;
+      CHECK(round_trip(src) == src);
+    }
+  }
+
+  SECTION("Runs compress, and overlap their own output") {
+    std::vector<u8> src(100'000, 0xAA);
+    CHECK(pepp::lz::compress(src).size() < 1'000);
+    CHECK(round_trip(src) == src);
+  }
+
+  SECTION("Incompressible data stays near its original size") {
+    std::vector<u8> src(100'000);
+    for (auto &byte : src) byte = rng();
+    CHECK(pepp::lz::compress(src).size() <= pepp::lz::bound(src.size()));
+    CHECK(round_trip(src) == src);
+  }
+
+  SECTION("Long literal runs and long matches") {
+    // Random blocks repeated at distances either side of the window, so some matches are out of reach.
+    std::vector<u8> block(300);
+    for (auto &byte : block) byte = rng();
+    std::vector<u8> src;
+    for (int it = 0; it < 400; ++it) {
+      src.insert(src.end(), block.begin(), block.end());
+      for (std::size_t pad = rng() % 700; pad > 0; --pad) src.push_back(rng());
+    }
+    const auto packed = pepp::lz::compress(src);
+    CHECK(packed.size() < src.size());
+    CHECK(round_trip(src) == src);
+  }
+
+  SECTION("Malformed streams are rejected") {
+    std::vector<u8> src(5'000);
+    for (std::size_t it = 0; it < src.size(); ++it) src[it] = (it % 17) ^ (it % 5);
+    const auto packed = pepp::lz::compress(src);
+    std::vector<u8> out(src.size());
+    // Wrong sizes.
+    std::vector<u8> small(src.size() - 1), large(src.size() + 1);
+    CHECK_FALSE(pepp::lz::decompress(packed, small));
+    CHECK_FALSE(pepp::lz::decompress(packed, large));
+    // Truncation anywhere.
+    for (std::size_t len = 0; len < packed.size(); ++len)
+      CHECK_FALSE(pepp::lz::decompress(bits::span<const u8>{packed.data(), len}, out));
+    // An offset reaching before the start of the output.
+    const std::vector<u8> bad{0x00, 0x10, 0x00};
+    CHECK_FALSE(pepp::lz::decompress(bad, out));
+  }
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <thread>
+#include <vector>
+#include "core/ds/snapshot_buffer.hpp"
+
+TEST_CASE("SnapshotBuffer", "[scope:core][kind:unit][arch:*]") {
+  using namespace pepp;
+  SECTION("Nothing published") {
+    SnapshotBuffer<int> buf;
+    CHECK(!buf.update());
+    CHECK(buf.front() == 0);
+  }
+  SECTION("Only the latest value is seen") {
+    SnapshotBuffer<int> buf;
+    buf.back() = 1, buf.publish();
+    buf.back() = 2, buf.publish();
+    REQUIRE(buf.update());
+    CHECK(buf.front() == 2);
+    // The value stays readable until the next update.
+    CHECK(!buf.update());
+    CHECK(buf.front() == 2);
+    buf.back() = 3, buf.publish();
+    REQUIRE(buf.update());
+    CHECK(buf.front() == 3);
+  }
+  SECTION("Concurrent producer") {
+    // Each value is internally consistent, and values only move forward.
+    SnapshotBuffer<std::vector<u32>> buf;
+    static constexpr u32 count = 20'000;
+    std::thread producer([&buf]() {
+      for (u32 it = 1; it <= count; it++) {
+        buf.back().assign(64, it);
+        buf.publish();
+      }
+    });
+    u32 last = 0;
+    bool consistent = true;
+    while (last != count) {
+      if (!buf.update()) continue;
+      const auto &front = buf.front();
+      if (front.empty() || front.front() < last) consistent = false;
+      for (const auto value : front) consistent &= value == front.front();
+      if (!front.empty()) last = front.front();
+    }
+    producer.join();
+    CHECK(consistent);
+  }
+}
@@ -44,7 +44,7 @@ auto check_next_int(pepp::tc::lex::AsmbLexer &l, int64_t val, pepp::tc::lex::Int
   auto next = l.next_token();
   REQUIRE(next);
   CHECK(next->type() == (int)pepp::tc::lex::CommonTokenType::Integer);
-  auto intval = std::dynamic_pointer_cast<pepp::tc::lex::Integer>(next);
+  auto intval = dynamic_cast<pepp::tc::lex::Integer *>(next);
   REQUIRE(intval);
   CHECK(intval->value == val);
   CHECK(intval->format == fmt);
@@ -63,7 +63,7 @@ auto check_char_sequence(pepp::tc::lex::AsmbLexer &l, QString body) {
   auto next = l.next_token();
   REQUIRE(next);
   CHECK(next->type() == (int)pepp::tc::lex::AsmTokenType::CharacterConstant);
-  auto charconst = std::dynamic_pointer_cast<pepp::tc::lex::CharacterConstant>(next);
+  auto charconst = dynamic_cast<pepp::tc::lex::CharacterConstant *>(next);
   REQUIRE(charconst);
   CHECK(charconst->value == body.toStdString());
   return charconst;
@@ -72,7 +72,7 @@ auto check_str_sequence(pepp::tc::lex::AsmbLexer &l, QString body) {
   auto next = l.next_token();
   REQUIRE(next);
   CHECK(next->type() == (int)pepp::tc::lex::AsmTokenType::StringConstant);
-  auto strconst = std::dynamic_pointer_cast<pepp::tc::lex::StringConstant>(next);
+  auto strconst = dynamic_cast<pepp::tc::lex::StringConstant *>(next);
   REQUIRE(strconst);
   CHECK(strconst->view() == body.toStdString());
   return strconst;
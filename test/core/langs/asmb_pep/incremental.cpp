@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "core/langs/asmb_pep/incremental.hpp"
+#include <catch.hpp>
+#include "core/compile/ir_linear/line_dot.hpp"
+#include "core/compile/symbol/entry.hpp"
+#include "core/compile/symbol/leaf_table.hpp"
+#include "core/langs/asmb/diagnostic_table.hpp"
+#include "core/langs/asmb_pep/parser.hpp"
+#include "core/langs/asmb_pep/text_format.hpp"
+
+namespace {
+using Incremental = pepp::tc::parser::IncrementalPepAssembler;
+using MR = pepp::tc::MacroRegistry;
+
+// Uses \@ so that inserting or removing an invocation changes the expansion of every later invocation.
+std::shared_ptr<MR> registry() {
+  auto ret = std::make_shared<MR>();
+  auto def = std::make_shared<pepp::tc::MacroDefinition>();
+  def->name = "LBL";
+  def->body = "l\\@: .WORD \\@\n";
+  ret->insert(def);
+  return ret;
+}
+
+static const auto base = R"(         .SECTION "data", "rw"
+num:     .WORD   5
+         LBL
+;comment
+         .SECTION "text", "rx"
+main:    LDWA    num,d
+         ADDA    1,i
+         LBL
+         STWA    num,d
+         RET
+         LBL
+)";
+
+// Catch cannot print locations, so compare them outside of CHECK.
+bool same_location(const pepp::tc::support::LocationInterval &lhs, const pepp::tc::support::LocationInterval &rhs) {
+  return lhs == rhs;
+}
+
+// Assemble text from scratch and compare every observable result against the incremental assembler.
+void check_matches_full(Incremental &inc, const std::string &text, std::shared_ptr<MR> reg) {
+  using namespace pepp::tc;
+  using pepp::core::symbol::DefinitionState;
+  DiagnosticTable diag;
+  parser::PepParser p(support::SeekableData{std::string{text}}, reg);
+  auto ir = p.parse(diag);
+  auto flat = parser::flatten_macros(ir);
+  auto inc_flat = inc.flattened();
+  auto inc_diag = inc.diagnostics();
+
+  REQUIRE(inc.program().size() == ir.size());
+  REQUIRE(inc_flat.size() == flat.size());
+  REQUIRE(inc_diag.count() == diag.count());
+  for (auto lhs = inc_diag.cbegin(), rhs = diag.cbegin(); rhs != diag.cend(); ++lhs, ++rhs) {
+    CHECK(same_location(lhs->first, rhs->first));
+    CHECK(lhs->second == rhs->second);
+  }
+  for (size_t it = 0; it < flat.size(); it++) {
+    REQUIRE(inc_flat[it]->type() == flat[it]->type());
+    // format_source does not support conditionals.
+    if (flat[it]->type() != DotConditional::TYPE)
+      CHECK(format_source(inc_flat[it].get()) == format_source(flat[it].get()));
+    CHECK(same_location(inc_flat[it]->source_interval, flat[it]->source_interval));
+  }
+
+  // Every symbol which a full parse creates must exist with the same definition state, and vice versa.
+  const auto &lhs = inc.symbol_table()->entries(), &rhs = p.symbol_table()->entries();
+  CHECK(lhs.size() == rhs.size());
+  for (const auto &[_, entry] : rhs) {
+    auto other = inc.symbol_table()->get(entry->name);
+    REQUIRE(other.has_value());
+    CHECK((*other)->state == entry->state);
+  }
+
+  const auto multiply_defined =
+      std::any_of(rhs.cbegin(), rhs.cend(), [](auto &kv) { return kv.second->state > DefinitionState::Single; });
+  if (diag.count() != 0 || multiply_defined) {
+    CHECK(inc.sections().empty());
+    return;
+  }
+  auto split = pepp_split_to_sections(diag, flat);
+  auto addresses = pepp_assign_addresses(split.grouped_ir);
+  REQUIRE(inc.sections().size() == split.grouped_ir.size());
+  for (size_t it = 0; it < flat.size(); it++) {
+    auto lhs_addr = inc.addresses().find(inc_flat[it].get());
+    auto rhs_addr = addresses.find(flat[it].get());
+    REQUIRE((lhs_addr == inc.addresses().end()) == (rhs_addr == addresses.end()));
+    if (rhs_addr == addresses.end()) continue;
+    CHECK(lhs_addr->second.address == rhs_addr->second.address);
+    CHECK(lhs_addr->second.size == rhs_addr->second.size);
+  }
+}
+} // namespace
+
+TEST_CASE("Pepp ASM incremental re-assembly", "[scope:core][scope:core.langs][kind:unit][arch:pep10]") {
+  auto reg = registry();
+  Incremental inc(reg);
+  auto stats = inc.update(base);
+  CHECK(stats.full_parse);
+  check_matches_full(inc, base, reg);
+  std::string text = base;
+  auto replace = [&](std::string_view from, std::string_view to) {
+    auto pos = text.find(from);
+    REQUIRE(pos != std::string::npos);
+    text.replace(pos, from.size(), to);
+    return inc.update(text);
+  };
+
+  SECTION("Editing one line re-parses one line") {
+    stats = replace("ADDA    1,i", "ADDA    2,i");
+    CHECK(!stats.full_parse);
+    CHECK(stats.first_line == 6);
+    CHECK(stats.parsed_lines == 1);
+    // The edit is in the "text" section, so "data" keeps its addresses.
+    CHECK(stats.first_section == 2);
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Inserting and deleting lines shifts later lines") {
+    stats = replace("         RET\n", "         NOP\n         NOP\n         RET\n");
+    CHECK(!stats.full_parse);
+    CHECK(stats.parsed_lines == 2);
+    check_matches_full(inc, text, reg);
+    stats = replace("         NOP\n         NOP\n", "");
+    CHECK(!stats.full_parse);
+    CHECK(stats.parsed_lines == 0);
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Adding a macro invocation re-expands later invocations") {
+    stats = replace(";comment\n", "         LBL\n");
+    CHECK(!stats.full_parse);
+    // The edited line, plus the two invocations after it whose \@ changed.
+    CHECK(stats.parsed_lines == 3);
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Symbols follow their definitions") {
+    stats = replace("main:    LDWA", "         LDWA");
+    CHECK(!inc.symbol_table()->exists("main"));
+    check_matches_full(inc, text, reg);
+    stats = replace("         ADDA    1,i", "num:     ADDA    1,i");
+    CHECK(inc.symbol_table()->get("num").value()->state == pepp::core::symbol::DefinitionState::Multiple);
+    CHECK(inc.sections().empty());
+    check_matches_full(inc, text, reg);
+    stats = replace("num:     ADDA    1,i", "         ADDA    1,i");
+    CHECK(inc.symbol_table()->get("num").value()->is_singly_defined());
+    CHECK(!inc.sections().empty());
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Errors are attributed to the edited line") {
+    stats = replace("STWA    num,d", "STWA    num,q");
+    CHECK(!stats.full_parse);
+    CHECK(inc.diagnostics().count() == 1);
+    check_matches_full(inc, text, reg);
+    stats = replace("         RET\n", "\n\n         RET\n");
+    check_matches_full(inc, text, reg);
+    stats = replace("STWA    num,q", "STWA    num,d");
+    CHECK(inc.diagnostics().count() == 0);
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Conditionals force a full parse") {
+    stats = replace("         RET\n", "         .IF 0\n         RET\n         .ENDIF\n");
+    CHECK(stats.full_parse);
+    check_matches_full(inc, text, reg);
+    stats = replace("ADDA    1,i", "ADDA    3,i");
+    CHECK(stats.full_parse);
+    check_matches_full(inc, text, reg);
+  }
+  SECTION("Unchanged text does nothing") {
+    stats = inc.update(text);
+    CHECK(!stats.full_parse);
+    CHECK(stats.parsed_lines == 0);
+    check_matches_full(inc, text, reg);
+  }
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "core/compile/symbol/entry.hpp"
+#include "core/langs/asmb/codegen.hpp"
+#include "core/langs/asmb/diagnostic_table.hpp"
+#include "core/langs/asmb_pep/codegen.hpp"
+#include "core/langs/asmb_pep/parser.hpp"
+#include "core/langs/asmb_pep/text_format.hpp"
+
+namespace {
+using MR = pepp::tc::MacroRegistry;
+
+std::shared_ptr<MR> registry() {
+  auto ret = std::make_shared<MR>();
+  auto def = std::make_shared<pepp::tc::MacroDefinition>();
+  def->name = "LBL";
+  def->body = "l\\@: .WORD \\@\n";
+  ret->insert(def);
+  return ret;
+}
+
+// Large enough to cross both the flatten and code generation thresholds, with several sections, macro invocations
+// which carry a symbol, and references to an undefined symbol so that relocations are emitted.
+std::string program() {
+  std::string ret;
+  for (int sec = 0; sec < 6; sec++) {
+    ret += fmt::format(".SECTION \"s{}\", \"rwx\"\n", sec);
+    for (int it = 0; it < 400; it++) {
+      ret += fmt::format("a{}_{}: LDWA a{}_{},d\n", sec, it, sec, (it * 7) % 400);
+      ret += fmt::format("m{}_{}: LBL\n", sec, it);
+      ret += "         ADDA ext,i\n";
+      ret += fmt::format("         .WORD m{}_{}\n", sec, it);
+    }
+  }
+  return ret;
+}
+
+struct Assembled {
+  // Symbol names refer to storage owned by the parser.
+  std::unique_ptr<pepp::tc::parser::PepParser> parser;
+  pepp::tc::IRProgram flat;
+  std::vector<std::pair<pepp::tc::SectionDescriptor, pepp::tc::IRProgram>> sections;
+  pepp::tc::IRMemoryAddressTable<pepp::tc::PeppAddress> addresses;
+  pepp::tc::ProgramObjectCodeResult code;
+};
+
+// flatten_macros moves symbols into macro bodies, so each path needs its own parse.
+Assembled assemble(const std::string &text, unsigned threads) {
+  using namespace pepp::tc;
+  DiagnosticTable diag;
+  Assembled ret;
+  ret.parser = std::make_unique<parser::PepParser>(support::SeekableData{std::string{text}}, registry());
+  auto ir = ret.parser->parse(diag);
+  REQUIRE(diag.count() == 0);
+  ret.flat = threads != 1 ? parser::flatten_macros(ir, threads) : parser::flatten_macros(ir);
+  ret.sections = pepp_split_to_sections(diag, ret.flat).grouped_ir;
+  ret.addresses = pepp_assign_addresses(ret.sections);
+  ret.code = threads != 1 ? pepp_to_object_code(ret.addresses, ret.sections, threads)
+                          : pepp_to_object_code(ret.addresses, ret.sections);
+  return ret;
+}
+} // namespace
+
+TEST_CASE("Pepp ASM parallel code generation", "[scope:core][scope:core.langs][kind:unit][arch:pep10]") {
+  const auto text = program();
+  auto serial = assemble(text, 1), parallel = assemble(text, 4);
+
+  SECTION("Flattening") {
+    REQUIRE(serial.flat.size() == parallel.flat.size());
+    for (size_t it = 0; it < serial.flat.size(); it++) {
+      REQUIRE(serial.flat[it]->type() == parallel.flat[it]->type());
+      CHECK(pepp::tc::format_source(serial.flat[it].get()) == pepp::tc::format_source(parallel.flat[it].get()));
+    }
+  }
+  SECTION("Object code") {
+    REQUIRE(serial.sections.size() == 7);
+    CHECK(serial.code.object_code == parallel.code.object_code);
+    // Spans must point to the same offsets, and must be in the same order as the lines which produced them.
+    const auto &lhs = serial.code.ir_to_object_code.container, &rhs = parallel.code.ir_to_object_code.container;
+    REQUIRE(lhs.size() == rhs.size());
+    auto flat_index = [](const Assembled &a) {
+      std::map<const pepp::tc::LinearIR *, size_t> ret;
+      for (size_t it = 0; it < a.flat.size(); it++) ret[a.flat[it].get()] = it;
+      return ret;
+    };
+    auto lhs_index = flat_index(serial), rhs_index = flat_index(parallel);
+    std::vector<std::tuple<size_t, ptrdiff_t, size_t>> lhs_spans, rhs_spans;
+    for (const auto &[line, span] : lhs)
+      lhs_spans.emplace_back(lhs_index.at(line), span.data() - serial.code.object_code.data(), span.size());
+    for (const auto &[line, span] : rhs)
+      rhs_spans.emplace_back(rhs_index.at(line), span.data() - parallel.code.object_code.data(), span.size());
+    std::sort(lhs_spans.begin(), lhs_spans.end());
+    std::sort(rhs_spans.begin(), rhs_spans.end());
+    CHECK(lhs_spans == rhs_spans);
+
+    // Relocations for one symbol must be emitted in the same order.
+    REQUIRE(serial.code.relocations.size() == 6 * 400);
+    REQUIRE(serial.code.relocations.size() == parallel.code.relocations.size());
+    for (auto l = serial.code.relocations.cbegin(), r = parallel.code.relocations.cbegin();
+         l != serial.code.relocations.cend(); ++l, ++r) {
+      CHECK(l->first->name == r->first->name);
+      CHECK(l->second.section_idx == r->second.section_idx);
+      CHECK(l->second.section_offset == r->second.section_offset);
+    }
+  }
+}
@@ -327,7 +327,7 @@ TEST_CASE("Pepp ASM source formatting", "[scope:core][scope:core.langs][level:as
     auto b = Buffer(&l);
     while (b.input_remains()) b.match(-1);
     auto sp = b.matched_tokens();
-    auto pred = [](const std::shared_ptr<Token> &t) { return t->type() == Empty::TYPE; };
+    auto pred = [](const Token *t) { return t->type() == Empty::TYPE; };
     auto [l1, rest1] = pepp::tc::split_inclusive(sp, pred);
     auto [l2, rest2] = pepp::tc::split_inclusive(rest1, pred);
     auto [l3, rest3] = pepp::tc::split_inclusive(rest2, pred);
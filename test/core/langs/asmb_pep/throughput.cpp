@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <catch.hpp>
+#include <chrono>
+#include "core/integers.h"
+#include "core/langs/asmb/diagnostic_table.hpp"
+#include "core/langs/asmb_pep/codegen.hpp"
+#include "core/langs/asmb_pep/incremental.hpp"
+#include "core/langs/asmb_pep/parser.hpp"
+#include "core/resources/figures/book.hpp"
+#include "core/resources/figures/builtin_registry.hpp"
+#include "core/resources/figures/figure.hpp"
+#include "core/resources/figures/fragment.hpp"
+#include "help/builtins/figure_wrappers.hpp"
+
+TEST_CASE("Pepp ASM parser throughput", "[.][benchmark][scope:core][scope:core.langs][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  using Parser = pepp::tc::parser::PepParser;
+  using MR = pepp::tc::MacroRegistry;
+  auto bookReg = pepp::BuiltinRegistry(builtins::QtFilesystemProvider::create());
+  auto book = bookReg.find_book("Computer Systems, 6th Edition");
+  REQUIRE(book != nullptr);
+
+  for (const auto &name : {"pep10os", "assembler", "pep10baremetal"}) {
+    auto fig = book->find_figure("os", name);
+    REQUIRE(fig != nullptr);
+    const auto text = fig->find_fragment("pep")->contents();
+    const auto lines = std::count(text.cbegin(), text.cend(), '\n');
+    // Repeat until a fixed time has elapsed so that small listings are measured over as many lines as large ones.
+    u64 parsed_lines = 0;
+    const auto start = clock::now();
+    while (clock::now() - start < std::chrono::seconds(1)) {
+      pepp::tc::DiagnosticTable diag;
+      auto p = Parser(pepp::tc::support::SeekableData{std::string{text}}, std::make_shared<MR>());
+      CHECK(!p.parse(diag).empty());
+      parsed_lines += lines;
+    }
+    const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    printf("%s: %lld lines, %.0f lines/s\n", name, (long long)lines, parsed_lines / elapsed);
+  }
+}
+
+TEST_CASE("Pepp ASM incremental re-assembly throughput", "[.][benchmark][scope:core][scope:core.langs][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  using Parser = pepp::tc::parser::PepParser;
+  using MR = pepp::tc::MacroRegistry;
+  auto bookReg = pepp::BuiltinRegistry(builtins::QtFilesystemProvider::create());
+  auto book = bookReg.find_book("Computer Systems, 6th Edition");
+  REQUIRE(book != nullptr);
+
+  for (const auto &name : {"pep10os", "assembler"}) {
+    auto fig = book->find_figure("os", name);
+    REQUIRE(fig != nullptr);
+    const auto text = fig->find_fragment("pep")->contents();
+    // Replay typing a new instruction into the middle of the listing one keystroke at a time, then deleting it again.
+    // Partially typed lines produce errors, just like in the editor.
+    const std::string typed = "         LDWA    0x0010,d    ;typed";
+    auto pos = text.size() / 2;
+    pos = text.find('\n', pos) + 1;
+    std::vector<std::string> edits;
+    for (size_t it = 0; it <= typed.size(); it++)
+      edits.emplace_back(text.substr(0, pos) + typed.substr(0, it) + "\n" + text.substr(pos));
+    for (size_t it = typed.size(); it-- > 0;) edits.emplace_back(std::string{edits[it]});
+    edits.emplace_back(text);
+
+    // What the editor must do today: re-assemble the whole program on every keystroke.
+    auto start = clock::now();
+    for (const auto &edit : edits) {
+      pepp::tc::DiagnosticTable diag;
+      auto p = Parser(pepp::tc::support::SeekableData{std::string{edit}}, std::make_shared<MR>());
+      auto flat = pepp::tc::parser::flatten_macros(p.parse(diag));
+      if (diag.count() != 0) continue;
+      auto split = pepp::tc::pepp_split_to_sections(diag, flat);
+      (void)pepp::tc::pepp_assign_addresses(split.grouped_ir);
+    }
+    const auto full = std::chrono::duration<double, std::micro>(clock::now() - start).count() / edits.size();
+
+    pepp::tc::parser::IncrementalPepAssembler inc(std::make_shared<MR>());
+    inc.update(text);
+    u64 parsed_lines = 0;
+    start = clock::now();
+    for (const auto &edit : edits) parsed_lines += inc.update(edit).parsed_lines;
+    const auto incremental = std::chrono::duration<double, std::micro>(clock::now() - start).count() / edits.size();
+    printf("%s: %zu edits, full %.0f us/edit, incremental %.0f us/edit (%llu lines re-parsed)\n", name, edits.size(),
+           full, incremental, (unsigned long long)parsed_lines);
+  }
+}
+
+TEST_CASE("Pepp ASM macro expansion throughput", "[.][benchmark][scope:core][scope:core.langs][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  using Parser = pepp::tc::parser::PepParser;
+  using MR = pepp::tc::MacroRegistry;
+  auto define = [](std::string name, std::vector<std::string> args, std::string body) {
+    auto ret = std::make_shared<pepp::tc::MacroDefinition>();
+    ret->name = name, ret->body = body;
+    for (auto &arg : args) ret->arguments.emplace_back(pepp::tc::MacroDefinition::Argument{.name = arg});
+    return ret;
+  };
+  // Shaped like the builtin SCALL/USCALL wrappers, but with more arguments and escapes per body.
+  std::vector<std::shared_ptr<pepp::tc::MacroDefinition>> defs = {
+      define("PUSH2", {"a", "b"}, "LDWA \\a,i\nSTWA -2,s\nLDWA \\b,i\nSTWA -4,s\nSUBSP 4,i\n"),
+      define("CALL3", {"fn", "x", "y"}, "PUSH2 \\x, \\y\nCALL \\fn\nADDSP 4,i\n"),
+      define("LOOP", {"n"}, "l\\@: LDWX \\n,i\nSUBX 1,i\nBRNE l\\@\n")};
+  std::string text;
+  for (int it = 0; it < 2000; it++)
+    text += "CALL3 f" + std::to_string(it % 7) + ", " + std::to_string(it) + ", 0x10\nLOOP 5\n";
+  for (int it = 0; it < 7; it++) text += "f" + std::to_string(it) + ": RET\n";
+
+  // Compare against bodies which are re-scanned on every instantiation, as before macro templates.
+  for (const auto compiled : {false, true}) {
+    auto reg = std::make_shared<MR>();
+    for (auto &def : defs) {
+      auto copy = std::make_shared<pepp::tc::MacroDefinition>(*def);
+      REQUIRE(reg->insert(copy));
+      if (!compiled) copy->compiled = nullptr;
+    }
+    u64 expansions = 0;
+    const auto start = clock::now();
+    while (clock::now() - start < std::chrono::seconds(1)) {
+      pepp::tc::DiagnosticTable diag;
+      auto p = Parser(pepp::tc::support::SeekableData{std::string{text}}, std::make_shared<MR>(reg));
+      CHECK(!p.parse(diag).empty());
+      CHECK(diag.count() == 0);
+      expansions += 3 * 2000; // CALL3 expands PUSH2, plus one LOOP, per iteration.
+    }
+    const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    printf("%s: %.0f expansions/s\n", compiled ? "compiled" : "re-scanned", expansions / elapsed);
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <catch.hpp>
+#include <chrono>
+#include <vector>
+
+#include "./instr/api.hpp"
+
+namespace {
+// Both ISAs lay out the operand specifiers of these instructions the same way, and number the modes from the same base.
+enum class Mode : u8 { i = 0, d = 1, n = 2, s = 3, sf = 4, x = 5 };
+template <typename M> constexpr u8 op(M m, Mode mode = Mode::i) {
+  return static_cast<u8>(static_cast<u8>(m) + static_cast<u8>(mode));
+}
+
+//   0x0000  LDWX 0,i          X = 0
+//   0x0003  ADDA 1,i          A += 1          <- loop
+//   0x0006  STWA 0x9000,x     mem[0x9000 + X] = A
+//   0x0009  CALL 0x0020
+//   0x000C  ADDX 2,i          X += 2
+//   0x000F  CPWX 0x0100,i
+//   0x0012  BRLT 0x0003
+//   0x0015  BR   0x0000
+//   0x0020  ASLA                              <- subroutine
+//   0x0021  LDBA 0x9001,d
+//   0x0024  RET
+template <typename M> std::array<u8, 0x25> program() {
+  std::array<u8, 0x25> ret{
+      op(M::LDWX), 0x00, 0x00, //
+      op(M::ADDA), 0x00, 0x01, //
+      op(M::STWA, Mode::x), 0x90, 0x00, //
+      op(M::CALL), 0x00, 0x20, //
+      op(M::ADDX), 0x00, 0x02, //
+      op(M::CPWX), 0x01, 0x00, //
+      op(M::BRLT), 0x00, 0x03, //
+      op(M::BR),   0x00, 0x00, //
+  };
+  ret[0x20] = op(M::ASLA), ret[0x21] = op(M::LDBA, Mode::d), ret[0x22] = 0x90, ret[0x23] = 0x01;
+  ret[0x24] = op(M::RET);
+  return ret;
+}
+
+template <typename M> auto make_machine(PepISA3CPU::ISA isa, bool traced) {
+  auto ret = make_cpu(isa);
+  auto &[sys, mem, cpu] = ret;
+  const auto code = program<M>();
+  mem->write(0, {code.data(), code.size()}, rw);
+  cpu->write_register(isa::Pep10::Register::SP, 0x8000);
+  if (!traced) cpu->on_traced_changed(false), mem->on_traced_changed(false);
+  return ret;
+}
+
+std::vector<u8> capture(Dense *mem, PepISA3CPU *cpu) {
+  using R = isa::Pep10::Register;
+  std::vector<u8> ret(0x10000);
+  mem->dump({ret.data(), ret.size()});
+  for (const auto r : {R::A, R::X, R::SP, R::PC, R::IS, R::OS}) {
+    const u16 value = cpu->read_register_uncached(r);
+    ret.emplace_back(value >> 8), ret.emplace_back(value & 0xff);
+  }
+  ret.emplace_back(cpu->read_packed_csr());
+  return ret;
+}
+
+template <typename M> void inner_run(PepISA3CPU::ISA isa, bool traced) {
+  // Enough instructions to wrap the outer loop a few times, and not a multiple of its length.
+  constexpr u64 TICKS = 4567;
+  auto [lhs_sys, lhs_mem, lhs_cpu] = make_machine<M>(isa, traced);
+  auto [rhs_sys, rhs_mem, rhs_cpu] = make_machine<M>(isa, traced);
+  for (u64 tick = 0; tick < TICKS; ++tick) lhs_cpu->clock_tick(PulseSchedule::PulseIndex{0}, tick);
+  // In uneven pieces, since run() must stop cleanly between instructions.
+  rhs_cpu->run(1), rhs_cpu->run(TICKS / 2), rhs_cpu->run(TICKS - TICKS / 2 - 1);
+  CHECK(lhs_cpu->read_register_uncached(isa::Pep10::Register::X) != 0);
+  CHECK(capture(lhs_mem, lhs_cpu) == capture(rhs_mem, rhs_cpu));
+}
+} // namespace
+
+TEST_CASE("PepISA3CPU::run matches clock_tick", "[scope:core][scope:core.sim][kind:unit][arch:pep10]") {
+  const bool traced = GENERATE(false, true);
+  SECTION("Pep/10") { inner_run<isa::Pep10::Mnemonic>(PepISA3CPU::ISA::Pep10, traced); }
+  SECTION("Pep/9") { inner_run<isa::Pep9::Mnemonic>(PepISA3CPU::ISA::Pep9, traced); }
+}
+
+TEST_CASE("PepISA3CPU::run throughput", "[.][benchmark][scope:core][scope:core.sim][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  constexpr u64 TICKS = 20'000'000;
+  auto [sys, mem, cpu] = make_machine<isa::Pep10::Mnemonic>(PepISA3CPU::ISA::Pep10, false);
+  const auto t0 = clock::now();
+  for (u64 tick = 0; tick < TICKS; ++tick) cpu->clock_tick(PulseSchedule::PulseIndex{0}, tick);
+  const auto t1 = clock::now();
+  cpu->run(TICKS);
+  const auto t2 = clock::now();
+  auto mips = [&](auto d) { return TICKS / std::chrono::duration<double>(d).count() / 1e6; };
+  printf("untraced: clock_tick %.1f MIPS, run %.1f MIPS\n", mips(t1 - t0), mips(t2 - t1));
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <catch.hpp>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/arch/pep/isa/pep10.hpp"
+#include "core/sim/cores/cpu/pep_isa.hpp"
+#include "core/sim/debugger/trace_device.hpp"
+#include "core/sim/debugger/tvm_checkpoints.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+#include "core/sim/memory/ram/dense.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+using M = isa::Pep10::Mnemonic;
+using R = isa::Pep10::Register;
+enum class Mode : u8 { i = 0, d = 1, n = 2, s = 3, sf = 4, x = 5 };
+constexpr u8 op(M m, Mode mode = Mode::i) { return static_cast<u8>(static_cast<u8>(m) + static_cast<u8>(mode)); }
+
+const Operation app(Operation::Type::Application, Operation::Kind::data);
+constexpr std::size_t SLOT = tvm::TraceBuffer::MAX_LOCATION_ENTRIES;
+
+//   0x0000  LDWX 0,i        X = 0
+//   0x0003  ADDA 1,i        A += 1        <- loop
+//   0x0006  STWA 0x9000,x   mem[0x9000 + X] = A
+//   0x0009  ADDX 2,i        X += 2
+//   0x000C  BR   0x0003
+const std::array<u8, 15> walking_program{
+    op(M::LDWX, Mode::i), 0x00, 0x00, //
+    op(M::ADDA, Mode::i), 0x00, 0x01, //
+    op(M::STWA, Mode::x), 0x90, 0x00, //
+    op(M::ADDX, Mode::i), 0x00, 0x02, //
+    op(M::BR, Mode::i),   0x00, 0x03, //
+};
+
+struct Harness {
+  std::unique_ptr<System> sys;
+  Dense *mem = nullptr;
+  PepISA3CPU *cpu = nullptr;
+  trace::BufferDevice *tbdev = nullptr;
+  u64 ticks = 0;
+
+  Harness(std::size_t ring_size, std::size_t checkpoint_interval) {
+    PepISA3CPU::Configuration cpu_cfg{
+        Device::Configuration{.basename = "cpu", .compatible = PepISA3CPU::compatible}, PepISA3CPU::ISA::Pep10,
+        "/memory"};
+    System::Configuration root_cfg{{.basename = "/", .compatible = System::compatible}};
+    Dense::Configuration mem_cfg{Device::Configuration{.basename = "memory", .compatible = Dense::compatible}, 0x00,
+                                 AddressSpan(0x0000, 0xffff)};
+    trace::BufferDevice::Configuration tb_cfg{Device::Configuration{.basename = "trace"}, ring_size,
+                                              checkpoint_interval};
+    sys = std::make_unique<System>(root_cfg);
+    mem = sys->make_device<Dense>(mem_cfg);
+    cpu = sys->make_device<PepISA3CPU>(cpu_cfg, sys.get());
+    tbdev = sys->make_device<trace::BufferDevice>(tb_cfg);
+    sys->initialize();
+    tbdev->trace(mem->id(), true);
+    cpu->trace(true);
+
+    mem->write(0, {walking_program.data(), walking_program.size()}, app);
+    cpu->write_register_uncached(R::A, 0xAAAA);
+    cpu->write_register_uncached(R::SP, 0xCCCC);
+  }
+
+  void run(u64 count) {
+    for (u64 end = ticks + count; ticks < end; ++ticks) cpu->clock_tick(PulseSchedule::PulseIndex{0}, ticks);
+  }
+
+  // Registers from the bank rather than the CPU's PC shadow, and all of memory.
+  std::vector<u8> capture() const {
+    std::vector<u8> ret(0x10000);
+    mem->dump({ret.data(), ret.size()});
+    for (const auto reg : {R::A, R::X, R::SP, R::PC}) {
+      const u16 value = cpu->read_register_uncached(reg);
+      ret.emplace_back(value >> 8), ret.emplace_back(value & 0xff);
+    }
+    ret.emplace_back(cpu->read_packed_csr());
+    return ret;
+  }
+};
+} // namespace
+
+TEST_CASE("Trace checkpoints", "[scope:core][scope:core.dbg][kind:unit][arch:pep10]") {
+  Harness h(8, 1);
+  auto &tb = h.tbdev->buffer();
+  auto &cps = h.tbdev->checkpoints();
+
+  // Remember the machine at a handful of ticks, including both sides of every slot boundary.
+  std::map<u64, std::pair<tvm::Cursor, std::vector<u8>>> expected;
+  for (const u64 tick : {0ul, 5ul, SLOT - 1, SLOT, SLOT + 1, SLOT + 900, 2 * SLOT + 4000, 3 * SLOT, 3 * SLOT + 700}) {
+    h.run(tick - h.ticks);
+    expected[tick] = {tb.cursor(), h.capture()};
+  }
+  const auto end = tb.cursor();
+
+  SECTION("Taken at the start of every slot") {
+    REQUIRE(cps.size() == 4);
+    for (std::size_t it = 0; it < cps.size(); ++it) CHECK(cps[it].at == tvm::Cursor{it, 0});
+    CHECK(cps.find(tvm::Cursor{2, 0}) == &cps[2]);
+    CHECK(cps.find(tvm::Cursor{2, 1}) == nullptr);
+    // The loop dirties a few pages per slot; everything else is shared with the checkpoint before.
+    CHECK(cps.bytes() > 0);
+    CHECK(cps.bytes() < 2 * 0x10000);
+  }
+
+  SECTION("Seeking reaches the recorded state") {
+    // Out of order, so seeks go both forward and backward, and from checkpoints on either side of the target.
+    auto current = end;
+    for (const u64 tick : {SLOT + 900, 5ul, 3 * SLOT + 700, SLOT, 2 * SLOT + 4000, 0ul, SLOT - 1, 3 * SLOT, SLOT + 1}) {
+      INFO("Tick " << tick);
+      const auto &[cursor, state] = expected.at(tick);
+      const auto replayed = h.tbdev->seek(current, cursor);
+      CHECK(h.capture() == state);
+      // Never more than half a slot from a checkpoint, except past the last one.
+      CHECK(replayed <= SLOT / 2 + 1);
+      current = cursor;
+    }
+  }
+
+  SECTION("Without a nearby checkpoint, seek replays from the current position") {
+    cps.set_budget(0);
+    REQUIRE(cps.size() == 1);
+    CHECK(cps[0].at == tvm::Cursor{3, 0});
+    const auto &[cursor, state] = expected.at(SLOT + 1);
+    CHECK(h.tbdev->seek(end, cursor) == 2 * SLOT - 1);
+    CHECK(h.capture() == state);
+    // And now the checkpoint is the closer of the two.
+    CHECK(h.tbdev->seek(cursor, end) == 700);
+    CHECK(h.capture() == expected.at(3 * SLOT + 700).second);
+  }
+
+  SECTION("Acknowledged slots take their checkpoints with them") {
+    tb.acknowledge(tvm::Cursor{2, 0});
+    const auto *cp = cps.nearest(tvm::Cursor{0, 0});
+    CHECK(cp == &cps[0]);
+    CHECK(cps[0].at == tvm::Cursor{2, 0});
+    CHECK(cps.size() == 2);
+  }
+
+  SECTION("Cleared with the trace buffer") {
+    h.tbdev->reset();
+    CHECK(cps.size() == 0);
+    CHECK(cps.bytes() == 0);
+    // The next recording starts a fresh slot 0.
+    h.run(1);
+    CHECK(cps.size() == 1);
+  }
+}
+
+TEST_CASE("Trace checkpoint seek latency", "[.][benchmark][scope:core][scope:core.dbg][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  for (const std::size_t slots : {2u, 8u, 32u}) {
+    for (const std::size_t interval : {0u, 1u, 4u}) {
+      Harness h(slots + 1, interval);
+      auto &tb = h.tbdev->buffer();
+      h.run(slots * SLOT);
+      std::vector<tvm::Cursor> targets;
+      std::mt19937 rng(slots);
+      for (int it = 0; it < 16; ++it) targets.push_back({rng() % slots, static_cast<u16>(rng() % SLOT)});
+
+      auto current = tb.cursor();
+      std::size_t replayed = 0;
+      const auto start = clock::now();
+      for (const auto target : targets) replayed += h.tbdev->seek(current, target), current = target;
+      const std::chrono::duration<double, std::milli> elapsed = clock::now() - start;
+      printf("seek: %zu programs, checkpoint every %zu slots (%zu KiB): %.2f ms/seek, %zu programs replayed/seek\n",
+             slots * SLOT, interval, h.tbdev->checkpoints().bytes() / 1024, elapsed.count() / targets.size(),
+             replayed / targets.size());
+    }
+  }
+}
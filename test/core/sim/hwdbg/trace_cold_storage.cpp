@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <catch.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "core/arch/pep/isa/pep10.hpp"
+#include "core/sim/cores/cpu/pep_isa.hpp"
+#include "core/sim/debugger/trace_device.hpp"
+#include "core/sim/debugger/tvm_encoding.hpp"
+#include "core/sim/debugger/tvm_interpreter.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+#include "core/sim/memory/ram/dense.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+using M = isa::Pep10::Mnemonic;
+using R = isa::Pep10::Register;
+enum class Mode : u8 { i = 0, d = 1, n = 2, s = 3, sf = 4, x = 5 };
+constexpr u8 op(M m, Mode mode = Mode::i) { return static_cast<u8>(static_cast<u8>(m) + static_cast<u8>(mode)); }
+
+const Operation app(Operation::Type::Application, Operation::Kind::data);
+constexpr std::size_t SLOT = tvm::TraceBuffer::MAX_LOCATION_ENTRIES;
+
+//   0x0000  LDWX 0,i        X = 0
+//   0x0003  ADDA 1,i        A += 1        <- loop
+//   0x0006  STWA 0x9000,x   mem[0x9000 + X] = A
+//   0x0009  ADDX 2,i        X += 2
+//   0x000C  BR   0x0003
+const std::array<u8, 15> walking_program{
+    op(M::LDWX, Mode::i), 0x00, 0x00, //
+    op(M::ADDA, Mode::i), 0x00, 0x01, //
+    op(M::STWA, Mode::x), 0x90, 0x00, //
+    op(M::ADDX, Mode::i), 0x00, 0x02, //
+    op(M::BR, Mode::i),   0x00, 0x03, //
+};
+
+struct Harness {
+  std::unique_ptr<System> sys;
+  Dense *mem = nullptr;
+  PepISA3CPU *cpu = nullptr;
+  trace::BufferDevice *tbdev = nullptr;
+  u64 ticks = 0;
+
+  Harness(std::size_t ring_size, std::size_t hot_slots) {
+    PepISA3CPU::Configuration cpu_cfg{
+        Device::Configuration{.basename = "cpu", .compatible = PepISA3CPU::compatible}, PepISA3CPU::ISA::Pep10,
+        "/memory"};
+    System::Configuration root_cfg{{.basename = "/", .compatible = System::compatible}};
+    Dense::Configuration mem_cfg{Device::Configuration{.basename = "memory", .compatible = Dense::compatible}, 0x00,
+                                 AddressSpan(0x0000, 0xffff)};
+    trace::BufferDevice::Configuration tb_cfg{Device::Configuration{.basename = "trace"}, ring_size};
+    tb_cfg.hot_slots = hot_slots;
+    sys = std::make_unique<System>(root_cfg);
+    mem = sys->make_device<Dense>(mem_cfg);
+    cpu = sys->make_device<PepISA3CPU>(cpu_cfg, sys.get());
+    tbdev = sys->make_device<trace::BufferDevice>(tb_cfg);
+    sys->initialize();
+    tbdev->trace(mem->id(), true);
+    cpu->trace(true);
+
+    mem->write(0, {walking_program.data(), walking_program.size()}, app);
+    cpu->write_register_uncached(R::A, 0xAAAA);
+    cpu->write_register_uncached(R::SP, 0xCCCC);
+  }
+
+  void run(u64 count) {
+    for (u64 end = ticks + count; ticks < end; ++ticks) cpu->clock_tick(PulseSchedule::PulseIndex{0}, ticks);
+  }
+
+  // Registers from the bank rather than the CPU's PC shadow, and all of memory.
+  std::vector<u8> capture() const {
+    std::vector<u8> ret(0x10000);
+    mem->dump({ret.data(), ret.size()});
+    for (const auto reg : {R::A, R::X, R::SP, R::PC}) {
+      const u16 value = cpu->read_register_uncached(reg);
+      ret.emplace_back(value >> 8), ret.emplace_back(value & 0xff);
+    }
+    ret.emplace_back(cpu->read_packed_csr());
+    return ret;
+  }
+
+  std::unique_ptr<tvm::Interpreter> blaster() const {
+    auto ret = sys->make_trace_interpreter();
+    // Else replaying would record into the trace being replayed.
+    ret->backend().set_access_mode(tvm::AccessMode::ReplaceWithInternal);
+    return ret;
+  }
+};
+} // namespace
+
+TEST_CASE("Trace cold storage", "[scope:core][scope:core.dbg][kind:unit][arch:pep10]") {
+  constexpr u64 TICKS = 3 * SLOT + 700;
+  Harness hot(8, 0), cold(8, 1);
+  const auto before = cold.capture();
+  hot.run(TICKS), cold.run(TICKS);
+  const auto after = cold.capture();
+  REQUIRE(hot.capture() == after);
+  auto &tb = cold.tbdev->buffer();
+  const auto begin = tb.oldest_cursor(), end = tb.cursor();
+
+  SECTION("Slots behind the hot window give their buffers back") {
+    CHECK(hot.tbdev->buffer().cold_footprint().slots == 0);
+    const auto footprint = tb.cold_footprint();
+    CHECK(footprint.slots == 3);
+    CHECK(footprint.ratio() > 2);
+    CHECK(tb.buffer_footprint() < hot.tbdev->buffer().buffer_footprint() / 2);
+    CHECK(cold.sys->buffer_manager()->allocated_buffers() < hot.sys->buffer_manager()->allocated_buffers());
+  }
+
+  SECTION("Replay decompresses on demand") {
+    auto blaster = cold.blaster();
+    CHECK(blaster->replay(tb, begin, end, tvm::Direction::Backward) == TICKS);
+    CHECK(blaster->csrs().F == 0);
+    CHECK(cold.capture() == before);
+    CHECK(blaster->replay(tb, begin, end, tvm::Direction::Forward) == TICKS);
+    CHECK(blaster->csrs().F == 0);
+    CHECK(cold.capture() == after);
+    // Reading every slot leaves no more than the hot window and THAWED_SLOTS cold slots with buffers.
+    CHECK(tb.cold_footprint().slots == 3);
+    CHECK(tb.buffer_footprint() < hot.tbdev->buffer().buffer_footprint());
+  }
+
+  SECTION("Compressing and decompressing preserve every program") {
+    // Buffer ids change when a slot is rebuilt, so compare what the programs do rather than where they live. Undo one
+    // cold program at a time on both machines, and they must agree after each.
+    auto hot_blaster = hot.blaster(), cold_blaster = cold.blaster();
+    hot_blaster->backend().set_direction(tvm::Direction::Backward);
+    cold_blaster->backend().set_direction(tvm::Direction::Backward);
+    const auto hot_range = hot.tbdev->buffer().range(begin, end), cold_range = tb.range(begin, end);
+    auto h = hot_range.end(), c = cold_range.end();
+    for (std::size_t it = 0; it < TICKS && h != hot_range.begin(); ++it) {
+      hot_blaster->run(*--h, tvm::RegisterRetention::None);
+      cold_blaster->run(*--c, tvm::RegisterRetention::None);
+      // A full capture every program would take a while; the slot boundaries and a sample in between are enough.
+      if (it % 997 == 0 || it % SLOT == 0) REQUIRE(hot.capture() == cold.capture());
+    }
+    CHECK(cold.capture() == before);
+  }
+
+  SECTION("Lowering the window compresses at once, and acknowledge frees compressed slots") {
+    tb.set_hot_slots(0);
+    cold.run(SLOT);
+    CHECK(tb.cold_footprint().slots == 3);
+    hot.tbdev->buffer().set_hot_slots(2);
+    CHECK(hot.tbdev->buffer().cold_footprint().slots == 2);
+    tb.acknowledge(tvm::Cursor{2, 0});
+    CHECK(tb.cold_footprint().slots == 1);
+    tb.clear();
+    CHECK(tb.cold_footprint().slots == 0);
+    CHECK(tb.cold_footprint().compressed == 0);
+  }
+}
+
+TEST_CASE("Trace cold storage renames buffers", "[scope:core][scope:core.dbg][kind:unit][arch:pep10]") {
+  auto mgr = std::make_shared<pepp::bts::BufferManager>();
+  tvm::TraceBuffer tb(mgr, 4);
+  constexpr Device::ID S{1};
+
+  // A program whose data rolls onto a second buffer, so its code has to name that buffer with an LDP.
+  const std::vector<u8> payload(40'000, 0x5A);
+  tb.begin(S);
+  const auto first = tb.append_data(S, {payload.data(), payload.size()});
+  const auto second = tb.append_data(S, {payload.data(), payload.size()});
+  REQUIRE(first.id.value != second.id.value);
+  const auto ldp = tvm::EncodedOp::LDP<3>{tvm::SegmentPair{.hi = second.id.value, .lo = second.offset}, 1}.encode();
+  tb.emit_body(S, {ldp.data(), ldp.size()});
+  tb.commit(S);
+  for (std::size_t it = 1; it < SLOT; ++it) tb.begin(S), tb.commit(S);
+
+  tb.set_hot_slots(1);
+  REQUIRE(tb.cold_footprint().slots == 1);
+  CHECK(mgr->find(first.id) == nullptr);
+  CHECK(mgr->find(second.id) == nullptr);
+
+  const auto loc = *tb.range(tvm::Cursor{0, 0}, tvm::Cursor{0, 1}).begin();
+  REQUIRE(mgr->find(loc.data.id) != nullptr);
+  const auto successor = tb.data_successor(loc.data.id);
+  REQUIRE(mgr->find(successor) != nullptr);
+  CHECK(mgr->find(successor)->data()[second.offset] == 0x5A);
+  // DP.hi is the LDP's third operand.
+  const u8 *code = mgr->find(loc.code.id)->data() + loc.code.offset;
+  CHECK((code[6] | (code[7] << 8)) == successor.value);
+}
+
+TEST_CASE("Trace cold storage throughput", "[.][benchmark][scope:core][scope:core.dbg][arch:pep10]") {
+  using clock = std::chrono::steady_clock;
+  constexpr std::size_t SLOTS = 32;
+  Harness h(SLOTS + 1, 0);
+  h.run(SLOTS * SLOT);
+  auto &tb = h.tbdev->buffer();
+  const auto buffers = h.sys->buffer_manager()->allocated_buffers();
+
+  const auto t0 = clock::now();
+  tb.set_hot_slots(1);
+  const auto t1 = clock::now();
+  const auto footprint = tb.cold_footprint();
+  std::size_t programs = 0;
+  // Dereferencing is what decompresses a slot, and nothing else here is more than a memcpy.
+  for (const auto loc : tb.range(tb.oldest_cursor(), tb.cursor())) programs += loc.code.id.value != 0;
+  const auto t2 = clock::now();
+
+  auto mib_per_s = [&](auto d) {
+    return (double)footprint.raw / (1 << 20) / std::chrono::duration<double>(d).count();
+  };
+  printf("cold storage: %zu programs in %zu slots, %zu KiB -> %zu KiB (ratio %.2f), compress %.0f MiB/s, "
+         "decompress %.0f MiB/s, live buffers %u -> %u\n",
+         programs, footprint.slots, footprint.raw / 1024, footprint.compressed / 1024, footprint.ratio(),
+         mib_per_s(t1 - t0), mib_per_s(t2 - t1), buffers, h.sys->buffer_manager()->allocated_buffers());
+}
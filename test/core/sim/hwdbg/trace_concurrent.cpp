@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <array>
+#include <catch.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "core/sim/debugger/trace_device.hpp"
+#include "core/sim/debugger/trace_recorder.hpp"
+#include "core/sim/debugger/tvm_interpreter.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+#include "core/sim/memory/ram/dense.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+const Operation internal(Operation::Type::BufferInternal, Operation::Kind::data);
+constexpr std::size_t SLOT = tvm::TraceBuffer::MAX_LOCATION_ENTRIES;
+constexpr std::size_t INITIATORS = 4;
+// Each initiator owns a region of memory, so the machine ends in the same state however the threads interleave.
+constexpr Address REGION = 0x1000;
+
+// The address and value the n-th program of an initiator writes. A small working set, so that bodies repeat and get
+// promoted to stencils, while the values never do.
+Address target(std::size_t initiator, std::size_t n) {
+  return initiator * REGION + (n * 2) % 0x100 + (n % 3 == 0 ? 0x800 : 0);
+}
+std::array<u8, 2> value(std::size_t initiator, std::size_t n) {
+  return {static_cast<u8>(n), static_cast<u8>((n >> 8) ^ (initiator << 4))};
+}
+
+struct Harness {
+  std::unique_ptr<System> sys;
+  Dense *mem = nullptr;
+  trace::BufferDevice *tbdev = nullptr;
+
+  Harness(std::size_t ring_size, std::size_t hot_slots) {
+    System::Configuration root_cfg{{.basename = "/", .compatible = System::compatible}};
+    Dense::Configuration mem_cfg{Device::Configuration{.basename = "memory", .compatible = Dense::compatible}, 0x00,
+                                 AddressSpan(0x0000, 0xffff)};
+    trace::BufferDevice::Configuration tb_cfg{Device::Configuration{.basename = "trace"}, ring_size};
+    tb_cfg.hot_slots = hot_slots;
+    sys = std::make_unique<System>(root_cfg);
+    mem = sys->make_device<Dense>(mem_cfg);
+    tbdev = sys->make_device<trace::BufferDevice>(tb_cfg);
+    sys->initialize();
+    tbdev->trace(mem->id(), true);
+  }
+
+  // Run `programs` single-write programs on each initiator, one thread per initiator, and leave memory in the state
+  // they produced. Returns the entries each initiator reserved, in the order it reserved them.
+  std::vector<std::vector<tvm::Cursor>> record(std::size_t programs) {
+    auto &tb = tbdev->buffer();
+    std::vector<u8> shadow(0x10000);
+    std::vector<std::vector<tvm::Cursor>> claimed(INITIATORS);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < INITIATORS; ++i) {
+      threads.emplace_back([&, i] {
+        const Device::ID id{static_cast<u8>(0x80 + i)};
+        Operation op(Operation::Type::Standard, Operation::Kind::data);
+        op.initiator = id;
+        trace::Recorder recorder(&tb, mem->id());
+        for (std::size_t n = 0; n < programs; ++n) {
+          tb.begin(id);
+          const auto *rec = tb.find_recording(id);
+          claimed[i].push_back({rec->slot, rec->entry});
+          // Each thread only touches its own region of the shadow.
+          const Address at = target(i, n);
+          const std::array<u8, 2> prior{shadow[at], shadow[at + 1]}, now = value(i, n);
+          recorder.emit_write(op, at, prior, now);
+          shadow[at] = now[0], shadow[at + 1] = now[1];
+          tb.commit(id);
+        }
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    mem->write(0, {shadow.data(), shadow.size()}, internal);
+    return claimed;
+  }
+
+  std::vector<u8> capture() const {
+    std::vector<u8> ret(0x10000);
+    mem->dump({ret.data(), ret.size()});
+    return ret;
+  }
+
+  std::unique_ptr<tvm::Interpreter> blaster() const {
+    auto ret = sys->make_trace_interpreter();
+    ret->backend().set_access_mode(tvm::AccessMode::ReplaceWithInternal);
+    return ret;
+  }
+};
+} // namespace
+
+TEST_CASE("Trace concurrent initiators", "[scope:core][scope:core.dbg][kind:unit][arch:*]") {
+  constexpr std::size_t PROGRAMS = 3 * SLOT;
+  constexpr std::size_t TOTAL = INITIATORS * PROGRAMS;
+  // Enough slots that the ring advances several times under contention, and a hot window so that slots are compressed
+  // while other initiators are still recording.
+  Harness h(16, 2);
+  auto &tb = h.tbdev->buffer();
+  const auto claimed = h.record(PROGRAMS);
+  const auto after = h.capture();
+  const auto begin = tb.oldest_cursor(), end = tb.cursor();
+  REQUIRE(tb.committed_cursor() == end);
+  REQUIRE(tb.instruction_count() == TOTAL);
+  REQUIRE(tb.cold_footprint().slots > 0);
+
+  SECTION("Every entry is reserved once, in begin order") {
+    std::vector<tvm::Cursor> all;
+    for (const auto &mine : claimed) {
+      CHECK(std::ranges::is_sorted(mine));
+      CHECK(std::ranges::adjacent_find(mine) == mine.end());
+      all.insert(all.end(), mine.begin(), mine.end());
+    }
+    std::ranges::sort(all);
+    REQUIRE(all.size() == TOTAL);
+    std::size_t gaps = 0;
+    for (std::size_t it = 0; it < TOTAL; ++it) gaps += all[it] != tvm::Cursor{it / SLOT, static_cast<u16>(it % SLOT)};
+    CHECK(gaps == 0);
+    CHECK(end == tvm::Cursor{TOTAL / SLOT, static_cast<u16>(TOTAL % SLOT)});
+  }
+
+  SECTION("Replay is deterministic") {
+    auto blaster = h.blaster();
+    for (int round = 0; round < 2; ++round) {
+      CHECK(blaster->replay(tb, begin, end, tvm::Direction::Backward) == TOTAL);
+      CHECK(std::ranges::all_of(h.capture(), [](u8 byte) { return byte == 0; }));
+      CHECK(blaster->replay(tb, begin, end, tvm::Direction::Forward) == TOTAL);
+      CHECK(h.capture() == after);
+    }
+  }
+
+  SECTION("Every entry replays the program that reserved it") {
+    // Undo everything, then step forward one entry at a time. Whichever thread committed it, each entry must apply
+    // exactly the write its initiator made when it reserved that entry.
+    auto blaster = h.blaster();
+    REQUIRE(blaster->replay(tb, begin, end, tvm::Direction::Backward) == TOTAL);
+    std::vector<std::pair<std::size_t, std::size_t>> owner(TOTAL);
+    for (std::size_t i = 0; i < INITIATORS; ++i)
+      for (std::size_t n = 0; n < PROGRAMS; ++n) owner[claimed[i][n].slot * SLOT + claimed[i][n].entry] = {i, n};
+
+    blaster->backend().set_direction(tvm::Direction::Forward);
+    const auto range = tb.range(begin, end);
+    std::size_t index = 0, mismatches = 0;
+    for (auto it = range.begin(); it != range.end(); ++it, ++index) {
+      blaster->run(*it, tvm::RegisterRetention::None);
+      const auto [i, n] = owner[index];
+      std::array<u8, 2> now{};
+      h.mem->read(target(i, n), {now.data(), now.size()}, internal);
+      mismatches += now != value(i, n);
+    }
+    CHECK(index == TOTAL);
+    CHECK(mismatches == 0);
+    CHECK(h.capture() == after);
+  }
+
+  SECTION("Recording again interleaves differently and costs the same") {
+    // Dedup state is per initiator, so the bytes each one emits do not depend on the schedule.
+    Harness again(16, 2);
+    again.record(PROGRAMS);
+    CHECK(again.capture() == after);
+    const auto lhs = tb.footprint(), rhs = again.tbdev->buffer().footprint();
+    CHECK(lhs.programs == rhs.programs);
+    CHECK(lhs.code == rhs.code);
+    CHECK(lhs.stencils == rhs.stencils);
+    CHECK(lhs.data == rhs.data);
+    CHECK(tb.stencil_count() == again.tbdev->buffer().stencil_count());
+    CHECK(tb.stencil_count() > 0);
+  }
+}
@@ -68,11 +68,10 @@ TEST_CASE("tvm::Interpreter:  Interleaved submissions", "[scope:core][scope:core
     ++it;
     auto loc_s1 = *it;
 
-    // Code is laid out in *commit* order, which here is the opposite: S1 finished first, so its subroutine was
-    // appended to the chain first. The two orders being independent is the point -- the index is claimed at begin(),
-    // the bytes it names are written at commit().
-    CHECK(loc_s1.code.id == loc_s0.code.id);
-    CHECK(loc_s0.code.offset > loc_s1.code.offset);
+    // Code, like data, goes to a chain of the initiator's own, so the order the two finished in does not matter: the
+    // index is claimed at begin(), the bytes it names are written at commit(), and neither subroutine lands inside
+    // the other's.
+    CHECK(loc_s1.code.id != loc_s0.code.id);
 
     // Execute each subroutine independently — if code were interleaved,
     // these would produce wrong results or crash.
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <array>
+#include <catch.hpp>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "core/arch/pep/isa/pep10.hpp"
+#include "core/sim/cores/cpu/pep_isa.hpp"
+#include "core/sim/debugger/trace_device.hpp"
+#include "core/sim/debugger/tvm_interpreter.hpp"
+#include "core/sim/debugger/tvm_tracebuffer.hpp"
+#include "core/sim/memory/ram/dense.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+using M = isa::Pep10::Mnemonic;
+using R = isa::Pep10::Register;
+enum class Mode : u8 { i = 0, d = 1, n = 2, s = 3, sf = 4, x = 5 };
+constexpr u8 op(M m, Mode mode = Mode::i) { return static_cast<u8>(static_cast<u8>(m) + static_cast<u8>(mode)); }
+
+const Operation app(Operation::Type::Application, Operation::Kind::data);
+constexpr Address STORE = 0x9000;
+
+//   0x0000  LDWX 0,i        X = 0
+//   0x0003  ADDA 1,i        A += 1        <- loop
+//   0x0006  STWA 0x9000,x   mem[0x9000 + X] = A
+//   0x0009  ADDX 2,i        X += 2
+//   0x000C  BR   0x0003
+const std::array<u8, 15> walking_program{
+    op(M::LDWX, Mode::i), 0x00, 0x00, //
+    op(M::ADDA, Mode::i), 0x00, 0x01, //
+    op(M::STWA, Mode::x), 0x90, 0x00, //
+    op(M::ADDX, Mode::i), 0x00, 0x02, //
+    op(M::BR, Mode::i),   0x00, 0x03, //
+};
+
+struct Harness {
+  std::unique_ptr<System> sys;
+  Dense *mem = nullptr;
+  PepISA3CPU *cpu = nullptr;
+  trace::BufferDevice *tbdev = nullptr;
+  tvm::Cursor begin{}, end{};
+
+  // Record `ticks` instructions of the walking loop into a ring of `slots` slots.
+  Harness(int ticks, std::size_t slots) {
+    PepISA3CPU::Configuration cpu_cfg{
+        Device::Configuration{.basename = "cpu", .compatible = PepISA3CPU::compatible}, PepISA3CPU::ISA::Pep10,
+        "/memory"};
+    System::Configuration root_cfg{{.basename = "/", .compatible = System::compatible}};
+    Dense::Configuration mem_cfg{Device::Configuration{.basename = "memory", .compatible = Dense::compatible}, 0x00,
+                                 AddressSpan(0x0000, 0xffff)};
+    trace::BufferDevice::Configuration tb_cfg{Device::Configuration{.basename = "trace"}, slots};
+    sys = std::make_unique<System>(root_cfg);
+    mem = sys->make_device<Dense>(mem_cfg);
+    cpu = sys->make_device<PepISA3CPU>(cpu_cfg, sys.get());
+    tbdev = sys->make_device<trace::BufferDevice>(tb_cfg);
+    sys->initialize();
+    tbdev->trace(mem->id(), true);
+    cpu->trace(true);
+
+    mem->write(0, {walking_program.data(), walking_program.size()}, app);
+    // Nothing at its default, so an undo that does nothing cannot pass.
+    cpu->write_register_uncached(R::A, 0xAAAA);
+    cpu->write_register_uncached(R::SP, 0xCCCC);
+    cpu->write_packed_csr(0b1111);
+    begin = tbdev->buffer().cursor();
+    for (int i = 0; i < ticks; ++i) cpu->clock_tick(PulseSchedule::PulseIndex{0}, static_cast<u64>(i));
+    end = tbdev->buffer().cursor();
+  }
+
+  // Registers from the bank rather than the CPU's PC shadow, plus every word the loop could have stored to.
+  std::vector<u16> capture(int ticks) const {
+    std::vector<u16> ret{cpu->read_register_uncached(R::A), cpu->read_register_uncached(R::X),
+                         cpu->read_register_uncached(R::SP), cpu->read_register_uncached(R::PC),
+                         cpu->read_packed_csr()};
+    for (int i = 0; i < ticks; ++i)
+      ret.emplace_back(((Target *)mem)->read<u16, bits::host_is_le>(STORE + 2 * i, app).second);
+    return ret;
+  }
+
+  std::unique_ptr<tvm::Interpreter> blaster() const {
+    auto ret = sys->make_trace_interpreter();
+    // Else replaying would record into the trace being replayed.
+    ret->backend().set_access_mode(tvm::AccessMode::ReplaceWithInternal);
+    return ret;
+  }
+};
+} // namespace
+
+TEST_CASE("Bulk replay through precompiled stencils", "[scope:core][scope:core.dbg][kind:unit][arch:pep10]") {
+  constexpr int TICKS = 1 + 4 * 100;
+  Harness h(TICKS, 4);
+  auto &tb = h.tbdev->buffer();
+  REQUIRE(tb.stencil_count() > 0);
+  const auto after = h.capture(TICKS);
+
+  SECTION("Backward then forward") {
+    auto blaster = h.blaster();
+    CHECK(blaster->replay(tb, h.begin, h.end, tvm::Direction::Backward) == TICKS);
+    CHECK(blaster->csrs().F == 0);
+    const auto initial = h.capture(TICKS);
+    CHECK(initial != after);
+    CHECK(initial[0] == 0xAAAA);
+    // Every promoted stencil was compiled once, and every later CALL into it reused that.
+    CHECK(blaster->stencils().size() > 0);
+    CHECK(blaster->stencils().size() <= tb.stencil_count() + 1);
+    CHECK(blaster->stencils().hits() > TICKS / 2);
+    // Only code in the stencil chain is compiled. The ring's own code is overwritten as slots are reused.
+    CHECK_FALSE(tb.is_stencil_code((*tb.range(h.begin, h.end).begin()).code.id));
+    // replay() only borrows the trace buffer.
+    CHECK(blaster->stencil_source() == nullptr);
+
+    CHECK(blaster->replay(tb, h.begin, h.end, tvm::Direction::Forward) == TICKS);
+    CHECK(h.capture(TICKS) == after);
+  }
+
+  SECTION("Matches stepping every packet") {
+    // Undo the second half with plain stepping and the first half with the stencil table, then do the same with the
+    // roles swapped. Either way each program must land on the state the other path would have produced.
+    std::vector<tvm::ProgramLocation> locs;
+    for (const auto loc : tb.range(h.begin, h.end)) locs.emplace_back(loc);
+    REQUIRE(locs.size() == TICKS);
+    auto mid = h.begin;
+    mid.entry += TICKS / 2;
+
+    auto stepper = h.blaster();
+    stepper->backend().set_direction(tvm::Direction::Backward);
+    auto blaster = h.blaster();
+    for (auto it = locs.rbegin(); it != locs.rbegin() + (TICKS - TICKS / 2); ++it) {
+      stepper->run(*it, tvm::RegisterRetention::None);
+      REQUIRE(stepper->csrs().F == 0);
+    }
+    const auto halfway = h.capture(TICKS);
+    CHECK(blaster->replay(tb, h.begin, mid, tvm::Direction::Backward) == TICKS / 2);
+    const auto initial = h.capture(TICKS);
+
+    CHECK(blaster->replay(tb, h.begin, mid, tvm::Direction::Forward) == TICKS / 2);
+    CHECK(h.capture(TICKS) == halfway);
+    stepper->backend().set_direction(tvm::Direction::Forward);
+    for (auto it = locs.begin() + TICKS / 2; it != locs.end(); ++it) stepper->run(*it, tvm::RegisterRetention::None);
+    CHECK(h.capture(TICKS) == after);
+
+    CHECK(blaster->replay(tb, h.begin, h.end, tvm::Direction::Backward) == TICKS);
+    CHECK(h.capture(TICKS) == initial);
+  }
+
+  SECTION("Clearing the trace buffer invalidates compiled stencils") {
+    auto blaster = h.blaster();
+    CHECK(blaster->replay(tb, h.begin, h.end, tvm::Direction::Backward) == TICKS);
+    CHECK(blaster->replay(tb, h.begin, h.end, tvm::Direction::Forward) == TICKS);
+    const auto generation = tb.stencil_generation();
+    tb.clear();
+    CHECK(tb.stencil_generation() != generation);
+
+    // The new stencils may well reuse the buffers the old ones lived in.
+    const auto before = h.capture(TICKS);
+    const auto begin = tb.cursor();
+    for (int i = 0; i < 40; ++i) h.cpu->clock_tick(PulseSchedule::PulseIndex{0}, static_cast<u64>(TICKS + i));
+    REQUIRE(tb.stencil_count() > 0);
+    CHECK(blaster->replay(tb, begin, tb.cursor(), tvm::Direction::Backward) == 40);
+    CHECK(blaster->csrs().F == 0);
+    CHECK(blaster->stencils().size() <= tb.stencil_count() + 1);
+    CHECK(h.capture(TICKS) == before);
+  }
+}
+
+TEST_CASE("Bulk replay throughput", "[.][benchmark][scope:core][scope:core.dbg][arch:pep10]") {
+  constexpr int TICKS = 20000;
+  Harness h(TICKS, 16);
+  auto &tb = h.tbdev->buffer();
+  auto blaster = h.blaster();
+  blaster->backend().set_direction(tvm::Direction::Backward);
+
+  using clock = std::chrono::steady_clock;
+  const auto t0 = clock::now();
+  const auto range = tb.range(h.begin, h.end);
+  for (auto it = range.end(); it != range.begin();) blaster->run(*--it, tvm::RegisterRetention::None);
+  const auto t1 = clock::now();
+  blaster->replay(tb, h.begin, h.end, tvm::Direction::Forward);
+  const auto t2 = clock::now();
+  blaster->replay(tb, h.begin, h.end, tvm::Direction::Backward);
+  const auto t3 = clock::now();
+
+  auto per_program = [](auto d) { return std::chrono::duration<double, std::nano>(d).count() / TICKS; };
+  printf("tvm replay: %d programs, stepping %.1f ns/program, stencils %.1f ns/program forward, %.1f backward\n",
+         TICKS, per_program(t1 - t0), per_program(t2 - t1), per_program(t3 - t2));
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include "core/sim/debugger/watchpoints.hpp"
+#include "core/sim/memory/bus/simplebus.hpp"
+#include "core/sim/memory/ram/dense.hpp"
+#include "core/sim/memory/ram/sparse.hpp"
+#include "core/sim/system.hpp"
+
+namespace {
+const auto rw = Operation{Operation::Type::Standard, Operation::Kind::data};
+const auto app = Operation{Operation::Type::Application, Operation::Kind::data};
+auto base_desc = Device::Configuration{.basename = "dev", .fullname = "/dev"};
+
+template <typename Storage> std::unique_ptr<Storage> make_storage() {
+  typename Storage::Configuration cfg{Device::Configuration{base_desc}};
+  cfg.span = AddressSpan(0, 0xFFFF);
+  return std::make_unique<Storage>(cfg);
+}
+} // namespace
+
+TEMPLATE_TEST_CASE("Memory watchpoints", "[scope:core][scope:core.dbg][kind:unit][arch:*]", Dense, Sparse) {
+  auto mem = make_storage<TestType>();
+  WatchpointSet wps;
+  mem->set_watchpoints(&wps);
+  u8 buf[2] = {0, 0};
+
+  SECTION("No watchpoints") {
+    CHECK(!mem->write(0x1000, bits::span<const u8>{buf}, rw).pause);
+    CHECK(!mem->read(0x1000, bits::span<u8>{buf}, rw).pause);
+    CHECK(!wps.hit());
+  }
+  SECTION("Read") {
+    wps.add(AddressSpan(0x1001, 0x1002), WatchpointSet::Read);
+    // Same page, but not overlapping.
+    CHECK(!mem->read(0x1003, bits::span<u8>{buf}, rw).pause);
+    CHECK(!mem->write(0x1001, bits::span<const u8>{buf}, rw).pause);
+    CHECK(!wps.hit());
+    // Overlapping only by the last byte.
+    CHECK(mem->read(0x1000, bits::span<u8>{buf}, rw).pause);
+    REQUIRE(wps.hit());
+    CHECK(wps.hit()->index == 0);
+    CHECK(wps.hit()->address == 0x1000);
+    CHECK(wps.hit()->kind == WatchpointSet::Read);
+    wps.clear_hit();
+    // The debugger looking at memory must not trigger the watchpoint.
+    CHECK(!mem->read(0x1001, bits::span<u8>{buf}, app).pause);
+    CHECK(!wps.hit());
+  }
+  SECTION("Write") {
+    wps.add(AddressSpan(0x20, 0x20), WatchpointSet::Read);
+    wps.add(AddressSpan(0x10, 0x11), WatchpointSet::Write);
+    CHECK(mem->write(0x11, bits::span<const u8>{buf}, rw).pause);
+    REQUIRE(wps.hit());
+    CHECK(wps.hit()->index == 1);
+    CHECK(wps.hit()->kind == WatchpointSet::Write);
+    // The first hit is kept until it is cleared.
+    CHECK(mem->read(0x20, bits::span<u8>{buf}.first(1), rw).pause);
+    CHECK(wps.hit()->index == 1);
+  }
+  SECTION("Change") {
+    wps.add(AddressSpan(0x8001, 0x8001), WatchpointSet::Change);
+    const u8 same[2] = {0xAA, 0}, different[2] = {0xAA, 1};
+    // Bytes outside the watched range may change without a hit.
+    CHECK(!mem->write(0x8000, bits::span<const u8>{same}, rw).pause);
+    CHECK(!wps.hit());
+    CHECK(mem->write(0x8000, bits::span<const u8>{different}, rw).pause);
+    REQUIRE(wps.hit());
+    CHECK(wps.hit()->kind == WatchpointSet::Change);
+    wps.clear_hit();
+    CHECK(!mem->write(0x8000, bits::span<const u8>{different}, rw).pause);
+    // The write still happened, even though it was watched.
+    mem->read(0x8000, bits::span<u8>{buf}, app);
+    CHECK(buf[1] == 1);
+  }
+  SECTION("Remove and detach") {
+    auto index = wps.add(AddressSpan(0x10, 0x11), WatchpointSet::Read | WatchpointSet::Write);
+    CHECK(mem->read(0x10, bits::span<u8>{buf}, rw).pause);
+    wps.remove(index);
+    CHECK(!wps.hit());
+    CHECK(!mem->read(0x10, bits::span<u8>{buf}, rw).pause);
+    wps.add(AddressSpan(0x10, 0x11), WatchpointSet::Read);
+    mem->set_watchpoints(nullptr);
+    CHECK(!mem->read(0x10, bits::span<u8>{buf}, rw).pause);
+    CHECK(!wps.hit());
+  }
+}
+
+TEST_CASE("Bus watchpoints", "[scope:core][scope:core.dbg][kind:int][arch:*]") {
+  using Mapping = SimpleBus::Configuration::Mapping;
+  auto system = std::make_shared<System>();
+  auto d1 = Dense::Configuration{{.basename = "d1", .fullname = "/bus0/d1"}, 0, AddressSpan(0, 0xFF)};
+  auto d2 = Dense::Configuration{{.basename = "d2", .fullname = "/bus0/d2"}, 0, AddressSpan(0, 0xFF)};
+  auto m1 = system->make_device<Dense>(d1);
+  auto m2 = system->make_device<Dense>(d2);
+  SimpleBus::Configuration b1{{Device::Configuration{.basename = "bus0", .fullname = "/bus0"}}, 0, AddressSpan(0, 0x1FF)};
+  b1.mappings.push_back(Mapping{.target = m1->config().fullname, .source_span = AddressSpan(0, 0xFF)});
+  b1.mappings.push_back(Mapping{.target = m2->config().fullname, .source_span = AddressSpan(0x100, 0x1FF)});
+  auto bus = system->make_device<SimpleBus>(b1);
+  system->initialize();
+
+  // Watchpoints on the bus use bus addresses; watchpoints on a device use device addresses.
+  WatchpointSet on_bus, on_device;
+  bus->set_watchpoints(&on_bus);
+  m2->set_watchpoints(&on_device);
+  on_bus.add(AddressSpan(0x100, 0x100), WatchpointSet::Change);
+  on_device.add(AddressSpan(0x10, 0x10), WatchpointSet::Write);
+
+  // Only the first byte of the write is watched by the bus.
+  const u8 src[2] = {0, 0}, unchanged[2] = {0, 7}, changed[2] = {7, 7};
+  CHECK(!bus->write(0x100, bits::span<const u8>{src}, rw).pause);
+  CHECK(!bus->write(0x100, bits::span<const u8>{unchanged}, rw).pause);
+  CHECK(!on_bus.hit());
+  CHECK(bus->write(0x100, bits::span<const u8>{changed}, rw).pause);
+  REQUIRE(on_bus.hit());
+  CHECK(on_bus.hit()->address == 0x100);
+  CHECK(!on_device.hit());
+  // A device's hit is reported through the bus. Device-relative 0x10 is bus address 0x110.
+  on_bus.clear_hit();
+  CHECK(bus->write(0x110, bits::span<const u8>{src}.first(1), rw).pause);
+  CHECK(on_device.hit());
+  CHECK(!on_bus.hit());
+}
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include <chrono>
+
+#include "sim/debug/debugger.hpp"
+#include "sim/debug/expr_compile.hpp"
+#include "sim/debug/expr_parser.hpp"
+
+namespace {
+// Registers are exposed as debugger variables $a and $x; everything else reads as 0.
+struct RegisterEnvironment : public pepp::debug::ZeroEnvironment {
+  mutable std::map<quint32, uint8_t> mem;
+  u16 a = 0, x = 0;
+  mutable int lookups = 0;
+  inline uint8_t read_mem_u8(uint32_t addr) const override {
+    if (mem.contains(addr)) return mem[addr];
+    return 0;
+  }
+  inline uint16_t read_mem_u16(uint32_t addr) const override {
+    return (uint16_t)(read_mem_u8(addr) << 8 | read_mem_u8(addr + 1));
+  }
+  inline uint32_t cache_debug_variable_name(QStringView name) const override {
+    lookups++;
+    if (name.compare(u"a", Qt::CaseInsensitive) == 0) return 1;
+    else if (name.compare(u"x", Qt::CaseInsensitive) == 0) return 2;
+    return -1;
+  }
+  inline pepp::debug::Value evaluate_debug_variable(uint32_t cache_index) const override {
+    switch (cache_index) {
+    case 1: return pepp::debug::VPrimitive::from_int(a);
+    case 2: return pepp::debug::VPrimitive::from_int(x);
+    default: return pepp::debug::VPrimitive::from_int(u16(0));
+    }
+  }
+};
+} // namespace
+
+TEST_CASE("Compiled expressions", "[scope:debug][kind:unit][arch:*]") {
+  using namespace pepp::debug;
+  RegisterEnvironment env;
+  env.type_info()->box(types::Primitives::u16);
+  env.type_info()->box(types::Primitives::i16);
+  env.type_info()->box(types::Primitives::u8);
+  ExpressionCache c;
+  Parser p(c, *env.type_info());
+
+  SECTION("Agrees with the AST") {
+    env.mem[0x10] = 0x12;
+    env.mem[0x11] = 0x34;
+    for (QString body : {"3 * 3 + 4", "(i8)(258 + 255)", "$a + $x * 2", "-$a", "~($x & 0xf)", "($a == 5) & ($x != 0)",
+                         "*0x10", "*(u8*)0x10 + 1", "*($x + 0x10)", "(u8)$a << 1"}) {
+      auto ast = p.compile(body);
+      REQUIRE(ast != nullptr);
+      CompiledExpression compiled(ast, env);
+      auto eval = ast->evaluator();
+      for (auto [a, x] : {std::pair<u16, u16>{0, 0}, {5, 1}, {0xffff, 0x8000}}) {
+        env.a = a, env.x = x;
+        INFO(body.toStdString() << " with a=" << a << " x=" << x);
+        CHECK(compiled.evaluate(env) == eval.evaluate(CachePolicy::UseNever, env));
+      }
+    }
+  }
+  SECTION("Constants are folded") {
+    auto ast = p.compile("(1 + 2) * 3");
+    REQUIRE(ast != nullptr);
+    CompiledExpression compiled(ast, env);
+    CHECK(compiled.size() == 1);
+    CHECK(value_bits(compiled.evaluate(env)) == 9);
+  }
+  SECTION("Debugger variables are resolved once") {
+    auto ast = p.compile("$a + 1");
+    REQUIRE(ast != nullptr);
+    CompiledExpression compiled(ast, env);
+    CHECK(env.lookups == 1);
+    env.a = 6;
+    CHECK(value_bits(compiled.evaluate(env)) == 7);
+    env.a = 9;
+    CHECK(value_bits(compiled.evaluate(env)) == 10);
+    CHECK(env.lookups == 1);
+  }
+  SECTION("Does not clean dirty terms") {
+    auto ast = p.compile("$a + 1");
+    REQUIRE(ast != nullptr);
+    auto eval = ast->evaluator();
+    eval.evaluate(CachePolicy::UseNever, env);
+    ast->mark_dirty();
+    CompiledExpression compiled(ast, env);
+    compiled.evaluate(env);
+    CHECK(ast->dirty());
+  }
+  SECTION("Fallbacks do not evaluate shared terms") {
+    // Member access has no compiled form. A watch expression may share the term, and is evaluated on another thread.
+    auto ast = p.compile("x.y");
+    REQUIRE(ast != nullptr);
+    auto watch = ast->evaluator();
+    CompiledExpression compiled(ast, env);
+    compiled.evaluate(env);
+    CHECK(!watch.dirty());
+  }
+  SECTION("Memory is re-read on every evaluation") {
+    auto ast = p.compile("*0");
+    REQUIRE(ast != nullptr);
+    CompiledExpression compiled(ast, env);
+    env.mem[0] = 7, env.mem[1] = 7;
+    CHECK(value_bits(compiled.evaluate(env)) == 0x0707);
+    env.mem[0] = 8;
+    CHECK(value_bits(compiled.evaluate(env)) == 0x0807);
+  }
+  SECTION("Breakpoint conditions") {
+    BreakpointSet bps(&c, &env);
+    bps.addBP(0x20, p.compile("$a == 5").get());
+    bps.notifyPCChanged(0x20);
+    CHECK(!bps.hit());
+    env.a = 5;
+    bps.notifyPCChanged(0x22);
+    CHECK(!bps.hit());
+    bps.notifyPCChanged(0x20);
+    CHECK(bps.hit());
+    bps.clearHit();
+    bps.modify_condition(0x20, p.compile("$x == 5").get());
+    bps.notifyPCChanged(0x20);
+    CHECK(!bps.hit());
+    bps.modify_condition(0x20, nullptr);
+    bps.notifyPCChanged(0x20);
+    CHECK(bps.hit());
+  }
+}
+
+TEST_CASE("Breakpoint condition throughput", "[.][benchmark][scope:debug][arch:*]") {
+  using namespace pepp::debug;
+  RegisterEnvironment env;
+  env.type_info()->box(types::Primitives::u16);
+  ExpressionCache c;
+  Parser p(c, *env.type_info());
+  // A condition which is never true, so that every hit evaluates the condition and execution continues.
+  auto condition = p.compile("($a == 5) & (*($x + 0x10) == 0x1234)");
+  REQUIRE(condition != nullptr);
+
+  // Stand-in for a simulator's fetch loop: 512 three-byte instructions, run repeatedly.
+  static const int instructions = 10'000'000, program = 512;
+  for (int count : {0, 1, 128}) {
+    BreakpointSet bps(&c, &env);
+    for (int it = 0; it < count; it++) bps.addBP(it * 3, condition.get());
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < instructions; it++) {
+      env.a = it;
+      bps.notifyPCChanged((it % program) * 3);
+    }
+    auto end = std::chrono::steady_clock::now();
+    REQUIRE(!bps.hit());
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("%3d conditional breakpoints: %.1fM instructions/s\n", count, instructions / seconds / 1e6);
+  }
+
+  // Cost of one condition, evaluated as the AST would and as compiled.
+  static const int evaluations = 1'000'000;
+  auto eval = condition->evaluator();
+  CompiledExpression compiled(condition, env);
+  auto start = std::chrono::steady_clock::now();
+  for (int it = 0; it < evaluations; it++) env.a = it, eval.evaluate(CachePolicy::UseNonVolatiles, env);
+  auto mid = std::chrono::steady_clock::now();
+  for (int it = 0; it < evaluations; it++) env.a = it, compiled.evaluate(env);
+  auto end = std::chrono::steady_clock::now();
+  printf("AST: %.1fM evaluations/s, compiled: %.1fM evaluations/s\n",
+         evaluations / std::chrono::duration<double>(mid - start).count() / 1e6,
+         evaluations / std::chrono::duration<double>(end - mid).count() / 1e6);
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include "sim3/cores/riscv/decode/decoder_cache.hpp"
+#include "sim3/cores/riscv/decode/decoder_cache_file.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x10000;
+
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (rd << 7) | 0b0010011;
+}
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// Blocks of additions, each closed by a loop which runs a few times. Ends with an infinite loop.
+std::vector<uint32_t> program(size_t blocks) {
+  std::vector<uint32_t> code;
+  for (size_t block = 0; block < blocks; block++) {
+    code.push_back(addi(11, 0, 3));
+    for (int it = 0; it < 30; it++) code.push_back(addi(10, 10, it));
+    code.push_back(addi(11, 11, -1));
+    code.push_back(bne(11, 0, -4 * 31));
+  }
+  code.push_back(0x0000006f); // j .
+  return code;
+}
+
+std::filesystem::path fresh_directory(const char *name) {
+  const auto dir = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  return dir;
+}
+
+std::vector<std::filesystem::path> cache_files(const std::filesystem::path &dir) {
+  std::vector<std::filesystem::path> ret;
+  for (const auto &entry : std::filesystem::directory_iterator(dir))
+    if (entry.path().extension() == ".rvdc") ret.push_back(entry.path());
+  return ret;
+}
+
+std::vector<uint8_t> read_file(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+
+struct Runner {
+  riscv::Machine<uint64_t> machine{empty};
+
+  Runner(const std::vector<uint32_t> &code, const std::filesystem::path &dir, bool persistent = true) {
+    auto options = std::make_shared<riscv::MachineOptions<uint64_t>>();
+    options->use_shared_execute_segments = false;
+    options->persistent_decoder_cache = persistent;
+    options->decoder_cache_dir = dir.string();
+    machine.set_options(options);
+    machine.cpu.init_execute_area(code.data(), CODE, code.size() * sizeof(uint32_t));
+    machine.cpu.jump(CODE);
+  }
+  std::vector<uint8_t> decoder_cache() {
+    auto &exec = machine.cpu.current_execute_segment();
+    const auto *base = reinterpret_cast<const uint8_t *>(exec.decoder_cache_base());
+    return {base, base + exec.decoder_cache_size() * sizeof(riscv::DecoderCache<uint64_t>)};
+  }
+};
+} // namespace
+
+TEST_CASE("RISC-V persistent decoder cache", "[scope:sim][kind:int][arch:RV]") {
+  const auto code = program(64);
+  const auto dir = fresh_directory("pepp-rvdc-test");
+
+  SECTION("Warm start maps the cache written by the cold start") {
+    Runner cold(code, dir);
+    const auto files = cache_files(dir);
+    REQUIRE(files.size() == 1);
+    const auto written = read_file(files[0]);
+
+    Runner warm(code, dir);
+    CHECK(warm.decoder_cache() == cold.decoder_cache());
+    // Mapping must not write back to the file, even once the machine patches its decoder cache
+    warm.machine.simulate<false>(100000);
+    cold.machine.simulate<false>(100000);
+    CHECK(read_file(files[0]) == written);
+    CHECK(warm.machine.instruction_counter() == cold.machine.instruction_counter());
+    CHECK(warm.machine.cpu.pc() == cold.machine.cpu.pc());
+    CHECK(warm.machine.cpu.reg(10) == cold.machine.cpu.reg(10));
+  }
+
+  SECTION("Changed code is keyed separately") {
+    Runner first(code, dir);
+    auto changed = code;
+    changed[1] = addi(10, 10, 99);
+    Runner second(changed, dir);
+    CHECK(cache_files(dir).size() == 2);
+    Runner reference(changed, dir, false);
+    CHECK(second.decoder_cache() == reference.decoder_cache());
+  }
+
+  SECTION("Corrupt files are regenerated") {
+    { Runner cold(code, dir); }
+    const auto file = cache_files(dir).at(0);
+    const auto written = read_file(file);
+    {
+      std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+      stream.seekp(riscv::DECODER_CACHE_FILE_ALIGN + 4096);
+      stream.put(0x5A);
+    }
+    Runner warm(code, dir);
+    Runner reference(code, dir, false);
+    CHECK(warm.decoder_cache() == reference.decoder_cache());
+    CHECK(read_file(file) == written);
+  }
+
+  SECTION("Files from other builds are ignored") {
+    { Runner cold(code, dir); }
+    const auto file = cache_files(dir).at(0);
+    {
+      riscv::DecoderCacheFileHeader hdr;
+      std::fstream stream(file, std::ios::binary | std::ios::in | std::ios::out);
+      stream.read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+      hdr.build_id[0] ^= 1;
+      stream.seekp(0);
+      stream.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+    }
+    Runner warm(code, dir);
+    riscv::DecoderCacheFileHeader hdr;
+    std::ifstream(file, std::ios::binary).read(reinterpret_cast<char *>(&hdr), sizeof(hdr));
+    const auto &build_id = riscv::decoder_cache_build_id<uint64_t>();
+    CHECK(std::memcmp(hdr.build_id, build_id.data(), build_id.size()) == 0);
+  }
+
+  SECTION("Build IDs differ between XLENs") {
+    const auto &id64 = riscv::decoder_cache_build_id<uint64_t>();
+    CHECK(id64 != riscv::DecoderCacheBuildId{});
+    CHECK(id64 != riscv::decoder_cache_build_id<uint32_t>());
+  }
+
+  SECTION("Files are private to the current user") {
+    { Runner cold(code, dir); }
+    const auto file = cache_files(dir).at(0);
+    using std::filesystem::perms;
+    CHECK((std::filesystem::status(dir).permissions() & perms::all) == perms::owner_all);
+    CHECK((std::filesystem::status(file).permissions() & perms::all) == (perms::owner_read | perms::owner_write));
+
+    // A file others could have written is not trusted, and is replaced
+    const auto written = read_file(file);
+    std::filesystem::permissions(file, perms::others_write, std::filesystem::perm_options::add);
+    Runner warm(code, dir);
+    CHECK((std::filesystem::status(file).permissions() & perms::all) == (perms::owner_read | perms::owner_write));
+    CHECK(read_file(file) == written);
+  }
+}
+
+TEST_CASE("RISC-V persistent decoder cache startup", "[.][benchmark][scope:sim][arch:RV]") {
+  // About 4 MiB of instructions, a large statically linked program
+  const auto code = program(32768);
+  const auto dir = fresh_directory("pepp-rvdc-bench");
+  { Runner prime(code, dir); }
+
+  BENCHMARK("Cold start (decode)") { return Runner(code, dir, false).machine.cpu.pc(); };
+  BENCHMARK("Warm start (mapped)") { return Runner(code, dir, true).machine.cpu.pc(); };
+}
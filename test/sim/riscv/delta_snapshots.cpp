@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <chrono>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, HEAP = 0x1000000;
+static constexpr uint32_t A0 = 10, A1 = 11, A2 = 12;
+static const uint64_t page = riscv::Page::size();
+using Snapshot = std::vector<uint8_t>;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t sd(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b011 << 12) |
+         (uint32_t(imm & 0x1F) << 7) | 0b0100011;
+}
+uint32_t add(uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (rs2 << 20) | (rs1 << 15) | (rd << 7) | 0b0110011;
+}
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// Stores a1 to a1 addresses, starting at a0 and a2 bytes apart.
+const std::vector<uint32_t> touch = {
+    sd(A0, A1, 0),                   // 1: sd a1, 0(a0)
+    add(A0, A0, A2),                 //    add a0, a0, a2
+    itype(0b0010011, 0, A1, A1, -1), //    addi a1, a1, -1
+    bne(A1, 0, -12),                 //    bnez a1, 1b
+    0x00100073,                      //    ebreak
+};
+
+struct Main {
+  riscv::Machine<uint64_t> machine;
+  explicit Main(uint64_t heap)
+      : machine{empty, {.memory_max = heap + (16ull << 20), .use_memory_arena = false}} {
+    machine.memory.memset(HEAP, 0, heap);
+    load();
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+  // Restoring a snapshot evicts execute segments, and this one only exists as an execute segment.
+  void load() { machine.cpu.init_execute_area(touch.data(), CODE, touch.size() * sizeof(uint32_t)); }
+  // Writes one doubleword to each of count pages, stride pages apart.
+  void run(uint64_t first, uint64_t count, uint64_t stride) {
+    machine.cpu.reg(A0) = first;
+    machine.cpu.reg(A1) = count;
+    machine.cpu.reg(A2) = stride * page;
+    machine.cpu.jump(CODE);
+    machine.simulate(UINT64_MAX);
+  }
+  uint64_t at(uint64_t addr) { return machine.memory.template read<uint64_t>(addr); }
+};
+} // namespace
+
+TEST_CASE("RISC-V delta snapshots", "[scope:sim][kind:int][arch:RV]") {
+  Main main(64 * page);
+  Snapshot base, d1, d2;
+  main.machine.serialize_delta_to(base);
+  SECTION("First snapshot is full, later ones only carry dirty pages") {
+    main.run(HEAP, 2, 10);
+    main.machine.serialize_delta_to(d1);
+    CHECK(base.size() > 64 * page);
+    CHECK(d1.size() < 4 * page);
+    // Nothing written since d1
+    main.machine.serialize_delta_to(d2);
+    CHECK(d2.size() < d1.size());
+  }
+  SECTION("Chain restore reproduces each snapshot") {
+    main.run(HEAP, 3, 10);
+    main.machine.serialize_delta_to(d1);
+    main.run(HEAP + 8, 2, 1);
+    main.machine.memory.free_pages(HEAP + 30 * page, page);
+    main.machine.serialize_delta_to(d2);
+
+    Main restored(page);
+    REQUIRE(restored.machine.deserialize_from(std::vector<Snapshot>{base, d1}) == 0);
+    CHECK(restored.at(HEAP) == 3);
+    CHECK(restored.at(HEAP + 8) == 0);
+    CHECK(restored.at(HEAP + 20 * page) == 1);
+    CHECK(restored.machine.memory.pages().count((HEAP >> 12) + 30) == 1);
+
+    REQUIRE(restored.machine.deserialize_from(std::vector<Snapshot>{base, d1, d2}) == 0);
+    CHECK(restored.at(HEAP) == 3);
+    CHECK(restored.at(HEAP + 8) == 2);
+    CHECK(restored.at(HEAP + page + 8) == 1);
+    CHECK(restored.at(HEAP + 20 * page) == 1);
+    CHECK(restored.machine.memory.pages().count((HEAP >> 12) + 30) == 0);
+    CHECK(restored.machine.memory.pages().size() == main.machine.memory.pages().size());
+    CHECK(restored.machine.cpu.reg(A0) == main.machine.cpu.reg(A0));
+    CHECK(restored.machine.instruction_counter() == main.machine.instruction_counter());
+
+    // A restored machine can continue the chain
+    restored.load();
+    restored.run(HEAP + 40 * page, 1, 1);
+    Snapshot d3;
+    restored.machine.serialize_delta_to(d3);
+    Main again(page);
+    REQUIRE(again.machine.deserialize_from(std::vector<Snapshot>{base, d1, d2, d3}) == 0);
+    CHECK(again.at(HEAP + 40 * page) == 1);
+  }
+  SECTION("Deltas only apply to the state they were taken against") {
+    main.run(HEAP, 1, 1);
+    main.machine.serialize_delta_to(d1);
+    // Must start with a full snapshot
+    CHECK(main.machine.deserialize_from(std::vector<Snapshot>{d1}) != 0);
+    main.run(HEAP + 2 * page, 1, 1);
+    main.machine.serialize_delta_to(d2);
+
+    // At the snapshot d2 was taken against, but written to since.
+    Main moved(page);
+    REQUIRE(moved.machine.deserialize_from(std::vector<Snapshot>{base, d1}) == 0);
+    moved.load();
+    moved.run(HEAP + 3 * page, 1, 1);
+    CHECK_THROWS(moved.machine.deserialize_from(d2));
+  }
+  SECTION("Deltas record the snapshot they were taken against") {
+    main.run(HEAP, 1, 1);
+    main.machine.serialize_delta_to(d1);
+    main.run(HEAP + page, 1, 1);
+    main.machine.serialize_delta_to(d2);
+
+    // d2 was taken on top of d1, not on top of base
+    Main restored(page);
+    REQUIRE(restored.machine.deserialize_from(std::vector<Snapshot>{base}) == 0);
+    CHECK(restored.machine.deserialize_from(d2) == -7);
+    CHECK(restored.machine.deserialize_from(std::vector<Snapshot>{base, d2}) == -7);
+    CHECK(restored.at(HEAP) == 0);
+    CHECK(restored.at(HEAP + page) == 0);
+    // The failed restores left the machine at base, where d1 still applies
+    REQUIRE(restored.machine.deserialize_from(d1) == 0);
+    REQUIRE(restored.machine.deserialize_from(d2) == 0);
+    CHECK(restored.at(HEAP) == 1);
+    CHECK(restored.at(HEAP + page) == 1);
+
+    // A delta of another machine never applies, even to an identical state
+    Main other(64 * page);
+    Snapshot other_base, other_d1;
+    other.machine.serialize_delta_to(other_base);
+    other.run(HEAP, 1, 1);
+    other.machine.serialize_delta_to(other_d1);
+    REQUIRE(restored.machine.deserialize_from(std::vector<Snapshot>{base}) == 0);
+    CHECK(restored.machine.deserialize_from(other_d1) == -7);
+  }
+}
+
+TEST_CASE("RISC-V delta snapshot size and time", "[.][benchmark][scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t heap = 512ull << 20;
+  static constexpr int rounds = 10;
+  const uint64_t pages = heap / page, stride = 100, touched = pages / stride;
+  Main main(heap);
+  using clock = std::chrono::steady_clock;
+  auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+  std::vector<Snapshot> chain(1);
+  main.machine.serialize_delta_to(chain[0]);
+  double full_ms = 0, delta_ms = 0;
+  size_t full_bytes = 0, delta_bytes = 0;
+  for (int round = 0; round < rounds; round++) {
+    main.run(HEAP + (round % stride) * page, touched, stride);
+    Snapshot full;
+    auto start = clock::now();
+    full_bytes += main.machine.serialize_to(full);
+    full_ms += ms(clock::now() - start);
+    start = clock::now();
+    delta_bytes += main.machine.serialize_delta_to(chain.emplace_back());
+    delta_ms += ms(clock::now() - start);
+  }
+  Main restored(page);
+  const auto start = clock::now();
+  REQUIRE(restored.machine.deserialize_from(chain) == 0);
+  const double restore_ms = ms(clock::now() - start);
+  REQUIRE(restored.at(HEAP + (rounds - 1) * page) == touched);
+
+  printf("Touching %llu of %llu pages per snapshot, averaged over %d snapshots:\n", (unsigned long long)touched,
+         (unsigned long long)pages, rounds);
+  printf("  full:  %8.2f MiB %8.2f ms\n", full_bytes / double(rounds << 20), full_ms / rounds);
+  printf("  delta: %8.2f MiB %8.2f ms\n", delta_bytes / double(rounds << 20), delta_ms / rounds);
+  printf("  restoring base + %d deltas: %.2f ms\n", rounds, restore_ms);
+}
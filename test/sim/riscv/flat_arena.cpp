@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <catch.hpp>
+#include <chrono>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, SRC = 0x1000000;
+static constexpr uint32_t T0 = 5, T1 = 6, T2 = 7, A0 = 10, A1 = 11, A2 = 12, A3 = 13, A4 = 14, T3 = 28, T4 = 29,
+                          T5 = 30;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t rtype(uint32_t f7, uint32_t f3, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | 0b0110011;
+}
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0b000, rd, rs1, imm); }
+uint32_t andi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0b111, rd, rs1, imm); }
+uint32_t slli(uint32_t rd, uint32_t rs1, int32_t shamt) { return itype(0b0010011, 0b001, rd, rs1, shamt); }
+uint32_t srli(uint32_t rd, uint32_t rs1, int32_t shamt) { return itype(0b0010011, 0b101, rd, rs1, shamt); }
+uint32_t ld(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0000011, 0b011, rd, rs1, imm); }
+uint32_t sd(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b011 << 12) |
+         (uint32_t(imm & 0x1F) << 7) | 0b0100011;
+}
+uint32_t add(uint32_t rd, uint32_t rs1, uint32_t rs2) { return rtype(0, 0b000, rd, rs1, rs2); }
+uint32_t srl(uint32_t rd, uint32_t rs1, uint32_t rs2) { return rtype(0, 0b101, rd, rs1, rs2); }
+uint32_t and_(uint32_t rd, uint32_t rs1, uint32_t rs2) { return rtype(0, 0b111, rd, rs1, rs2); }
+uint32_t mul(uint32_t rd, uint32_t rs1, uint32_t rs2) { return rtype(1, 0b000, rd, rs1, rs2); }
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// Copies a2 doublewords from a0 to a1.
+static constexpr uint64_t MEMCPY = CODE;
+// Increments a2 random doublewords of the table at a0. a1 masks the byte offset, and a3 is the LCG state, which is
+// stepped with the multiplier in a4.
+static constexpr uint64_t HASH = MEMCPY + 7 * 4;
+// One pass of an LSD radix sort: scatters a3 doublewords from a0 to a1 by the byte at bit a4 of each key. a2 holds
+// 256 zeroed counters.
+static constexpr uint64_t RADIX = HASH + 11 * 4;
+const std::vector<uint32_t> program = {
+    ld(T0, A0, 0),    // 1: ld t0, 0(a0)
+    sd(A1, T0, 0),    //    sd t0, 0(a1)
+    addi(A0, A0, 8),  //    addi a0, a0, 8
+    addi(A1, A1, 8),  //    addi a1, a1, 8
+    addi(A2, A2, -1), //    addi a2, a2, -1
+    bne(A2, 0, -20),  //    bnez a2, 1b
+    0x00100073,       //    ebreak
+
+    mul(A3, A3, A4),  // 1: mul a3, a3, a4
+    addi(A3, A3, 1),  //    addi a3, a3, 1
+    srli(T0, A3, 29), //    srli t0, a3, 29
+    and_(T0, T0, A1), //    and t0, t0, a1
+    add(T0, T0, A0),  //    add t0, t0, a0
+    ld(T1, T0, 0),    //    ld t1, 0(t0)
+    addi(T1, T1, 1),  //    addi t1, t1, 1
+    sd(T0, T1, 0),    //    sd t1, 0(t0)
+    addi(A2, A2, -1), //    addi a2, a2, -1
+    bne(A2, 0, -36),  //    bnez a2, 1b
+    0x00100073,       //    ebreak
+
+    addi(T2, A0, 0),   //    mv t2, a0
+    addi(T3, A3, 0),   //    mv t3, a3
+    ld(T0, T2, 0),     // 1: ld t0, 0(t2)
+    srl(T0, T0, A4),   //    srl t0, t0, a4
+    andi(T0, T0, 255), //    andi t0, t0, 255
+    slli(T0, T0, 3),   //    slli t0, t0, 3
+    add(T0, T0, A2),   //    add t0, t0, a2
+    ld(T1, T0, 0),     //    ld t1, 0(t0)
+    addi(T1, T1, 1),   //    addi t1, t1, 1
+    sd(T0, T1, 0),     //    sd t1, 0(t0)
+    addi(T2, T2, 8),   //    addi t2, t2, 8
+    addi(T3, T3, -1),  //    addi t3, t3, -1
+    bne(T3, 0, -40),   //    bnez t3, 1b
+    addi(T2, A2, 0),   //    mv t2, a2
+    addi(T3, 0, 256),  //    li t3, 256
+    addi(T4, A1, 0),   //    mv t4, a1
+    ld(T0, T2, 0),     // 2: ld t0, 0(t2)
+    sd(T2, T4, 0),     //    sd t4, 0(t2)
+    slli(T0, T0, 3),   //    slli t0, t0, 3
+    add(T4, T4, T0),   //    add t4, t4, t0
+    addi(T2, T2, 8),   //    addi t2, t2, 8
+    addi(T3, T3, -1),  //    addi t3, t3, -1
+    bne(T3, 0, -24),   //    bnez t3, 2b
+    addi(T2, A0, 0),   //    mv t2, a0
+    addi(T3, A3, 0),   //    mv t3, a3
+    ld(T5, T2, 0),     // 3: ld t5, 0(t2)
+    srl(T0, T5, A4),   //    srl t0, t5, a4
+    andi(T0, T0, 255), //    andi t0, t0, 255
+    slli(T0, T0, 3),   //    slli t0, t0, 3
+    add(T0, T0, A2),   //    add t0, t0, a2
+    ld(T1, T0, 0),     //    ld t1, 0(t0)
+    sd(T1, T5, 0),     //    sd t5, 0(t1)
+    addi(T1, T1, 8),   //    addi t1, t1, 8
+    sd(T0, T1, 0),     //    sd t1, 0(t0)
+    addi(T2, T2, 8),   //    addi t2, t2, 8
+    addi(T3, T3, -1),  //    addi t3, t3, -1
+    bne(T3, 0, -44),   //    bnez t3, 3b
+    0x00100073,        //    ebreak
+};
+
+enum class Mode { Paged, Flat, HugePages };
+riscv::MachineOptions<uint64_t> options_for(Mode mode, uint64_t memory) {
+  switch (mode) {
+  case Mode::Paged: return {.memory_max = memory, .use_memory_arena = false};
+  case Mode::Flat: return {.memory_max = memory, .flat_memory_arena = true};
+  case Mode::HugePages: return {.memory_max = memory, .flat_memory_arena = true, .memory_arena_huge_pages = true};
+  }
+  return {};
+}
+const char *name_of(Mode mode) {
+  switch (mode) {
+  case Mode::Paged: return "paged";
+  case Mode::Flat: return "flat";
+  case Mode::HugePages: return "flat, huge pages";
+  }
+  return "";
+}
+
+struct Guest {
+  riscv::Machine<uint64_t> machine;
+  Guest(Mode mode, uint64_t memory) : machine{empty, options_for(mode, memory)} {
+    machine.cpu.init_execute_area(program.data(), CODE, program.size() * sizeof(uint32_t));
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+  void run(uint64_t entry, std::initializer_list<uint64_t> args) {
+    uint32_t reg = A0;
+    for (const auto arg : args) machine.cpu.reg(reg++) = arg;
+    machine.cpu.jump(entry);
+    machine.simulate(UINT64_MAX);
+  }
+  void memcpy(uint64_t dst, uint64_t src, uint64_t bytes) { run(MEMCPY, {src, dst, bytes / 8}); }
+  void hash(uint64_t table, uint64_t bytes, uint64_t count) {
+    run(HASH, {table, (bytes - 1) & ~uint64_t(7), count, 1, 6364136223846793005ull});
+  }
+  // Sorts count 16-bit keys at src, using dst as scratch space.
+  void sort(uint64_t src, uint64_t dst, uint64_t counters, uint64_t count) {
+    for (const uint64_t shift : {0, 8}) {
+      machine.memory.memset(counters, 0, 256 * 8);
+      run(RADIX, {src, dst, counters, count, shift});
+      std::swap(src, dst);
+    }
+  }
+  std::vector<uint64_t> read(uint64_t addr, uint64_t count) {
+    std::vector<uint64_t> ret(count);
+    machine.copy_from_guest(ret.data(), addr, count * 8);
+    return ret;
+  }
+  void write(uint64_t addr, const std::vector<uint64_t> &values) {
+    machine.copy_to_guest(addr, values.data(), values.size() * 8);
+  }
+};
+
+std::vector<uint64_t> random_keys(uint64_t count) {
+  std::vector<uint64_t> ret(count);
+  uint64_t state = 0x1234;
+  for (auto &key : ret) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    key = state >> 48;
+  }
+  return ret;
+}
+} // namespace
+
+TEST_CASE("RISC-V flat memory arena", "[scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t memory = 64ull << 20, count = 1 << 16, bytes = count * 8;
+  const uint64_t DST = SRC + bytes, COUNTERS = DST + bytes;
+  const auto keys = random_keys(count);
+  auto sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+
+  for (const auto mode : {Mode::Paged, Mode::Flat, Mode::HugePages}) {
+    DYNAMIC_SECTION(name_of(mode)) {
+      Guest guest(mode, memory);
+      const size_t pages_before = guest.machine.memory.pages().size();
+      guest.write(SRC, keys);
+      guest.memcpy(DST, SRC, bytes);
+      CHECK(guest.read(DST, count) == keys);
+
+      guest.machine.memory.memset(DST, 0, bytes);
+      guest.hash(DST, bytes, 4 * count);
+      const auto table = guest.read(DST, count);
+      uint64_t total = 0;
+      for (const auto value : table) total += value;
+      CHECK(total == 4 * count);
+      CHECK(std::count(table.begin(), table.end(), 0) < count / 8);
+
+      guest.sort(SRC, DST, COUNTERS, count);
+      CHECK(guest.read(SRC, count) == sorted);
+
+      if (mode == Mode::Paged) continue;
+      // Loads and stores never went through the page table
+      CHECK(guest.machine.memory.pages().size() == pages_before);
+      CHECK(guest.machine.memory.memory_arena_size() == memory);
+#if defined(__linux__)
+      if (mode == Mode::HugePages) CHECK(uintptr_t(guest.machine.memory.memory_arena_ptr()) % (2 << 20) == 0);
+#endif
+    }
+  }
+  SECTION("Spans the whole address space of 32-bit guests") {
+    riscv::Machine<uint32_t> machine{empty, {.memory_max = 65536, .flat_memory_arena = true}};
+    REQUIRE(machine.memory.memory_arena_size() == size_t(1) << 32);
+    const size_t pages_before = machine.memory.pages().size();
+    machine.memory.write<uint32_t>(0x80000000, 0x1234);
+    machine.memory.write<uint64_t>(0xFFFFFFF8, 0x5678);
+    CHECK(machine.memory.read<uint32_t>(0x80000000) == 0x1234);
+    CHECK(machine.memory.read<uint64_t>(0xFFFFFFF8) == 0x5678);
+    CHECK(machine.memory.pages().size() == pages_before);
+    // Page zero is still reached through the page table
+    CHECK(machine.memory.memory_arena_read_boundary() == 0xFFFFF000);
+  }
+}
+
+TEST_CASE("RISC-V flat memory arena throughput", "[.][benchmark][scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t memory = 512ull << 20, bytes = 128ull << 20, count = bytes / 8;
+  const uint64_t DST = SRC + bytes, COUNTERS = DST + bytes;
+  const auto keys = random_keys(count);
+  using clock = std::chrono::steady_clock;
+  auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+  printf("%-18s %10s %10s %10s\n", "mode", "memcpy", "hash", "sort");
+  for (const auto mode : {Mode::Paged, Mode::Flat, Mode::HugePages}) {
+    Guest guest(mode, memory);
+    guest.write(SRC, keys);
+    guest.machine.memory.memset(DST, 0, bytes);
+    // Copy 4x the buffer, make 16M random increments, and sort 16M 16-bit keys
+    auto start = clock::now();
+    for (int it = 0; it < 4; it++) guest.memcpy(DST, SRC, bytes);
+    const double memcpy_ms = ms(clock::now() - start);
+    start = clock::now();
+    guest.hash(DST, bytes, count);
+    const double hash_ms = ms(clock::now() - start);
+    start = clock::now();
+    guest.sort(SRC, DST, COUNTERS, count);
+    const double sort_ms = ms(clock::now() - start);
+    const auto result = guest.read(SRC, count);
+    REQUIRE(std::is_sorted(result.begin(), result.end()));
+    printf("%-18s %8.1f ms %8.1f ms %8.1f ms\n", name_of(mode), memcpy_ms, hash_ms, sort_ms);
+  }
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <chrono>
+#include <fstream>
+#include <unistd.h>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, DATA = 0x2000;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t sd(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b011 << 12) |
+         (uint32_t(imm & 0x1F) << 7) | 0b0100011;
+}
+uint32_t add(uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (rs2 << 20) | (rs1 << 15) | (rd << 7) | 0b0110011;
+}
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// Sums 1..n, where n is read from DATA, and stores the sum to DATA + 8.
+const std::vector<uint32_t> program = {
+    (0x2 << 12) | (12 << 7) | 0b0110111, // lui a2, 0x2
+    itype(0b0000011, 0b011, 10, 12, 0),  // ld a0, 0(a2)
+    itype(0b0010011, 0, 11, 0, 0),       // li a1, 0
+    add(11, 11, 10),                     // 1: add a1, a1, a0
+    itype(0b0010011, 0, 10, 10, -1),     //    addi a0, a0, -1
+    bne(10, 0, -8),                      //    bnez a0, 1b
+    sd(12, 11, 8),                       // sd a1, 8(a2)
+    0x00100073,                          // ebreak
+};
+
+struct Main {
+  riscv::Machine<uint64_t> machine;
+  explicit Main(bool forkable = true) : machine{empty, {.forkable_memory_arena = forkable}} {
+    auto options = std::make_shared<riscv::MachineOptions<uint64_t>>();
+    options->use_shared_execute_segments = false;
+    machine.set_options(options);
+    machine.memory.memset(DATA, 0, 0x1000);
+    machine.memory.template write<uint64_t>(DATA, 10);
+    machine.cpu.init_execute_area(program.data(), CODE, program.size() * sizeof(uint32_t));
+    machine.cpu.jump(CODE);
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+};
+
+uint64_t run(riscv::Machine<uint64_t> &machine, uint64_t n) {
+  machine.memory.template write<uint64_t>(DATA, n);
+  machine.simulate(100'000);
+  return machine.memory.template read<uint64_t>(DATA + 8);
+}
+
+// Mappings of arena memory files in this process
+size_t arena_files() {
+  std::ifstream maps("/proc/self/maps");
+  size_t count = 0;
+  for (std::string line; std::getline(maps, line);) count += line.find("pepp-arena") != std::string::npos;
+  return count;
+}
+
+size_t resident_bytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t size = 0, resident = 0;
+  statm >> size >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+} // namespace
+
+TEST_CASE("RISC-V copy-on-write forks", "[scope:sim][kind:int][arch:RV]") {
+  const bool forkable = GENERATE(true, false);
+  INFO("Forkable arena " << forkable);
+  const size_t files_before = arena_files();
+  Main main(forkable);
+  SECTION("Only forkable machines back their arena by a memory file") {
+#ifdef __linux__
+    CHECK(arena_files() - files_before == (forkable ? 1 : 0));
+    auto fork = main.machine.fork();
+    CHECK(arena_files() - files_before == (forkable ? 2 : 0));
+    CHECK((fork->memory.memory_arena_ptr() != nullptr) == forkable);
+#endif
+  }
+  SECTION("Forks read the main machine's memory") {
+    auto fork = main.machine.fork();
+    CHECK(fork->is_forked());
+    CHECK(fork->memory.template read<uint64_t>(DATA) == 10);
+    fork->simulate(100'000);
+    CHECK(fork->memory.template read<uint64_t>(DATA + 8) == 55);
+  }
+  SECTION("Fork writes are private") {
+    auto a = main.machine.fork(), b = main.machine.fork();
+    CHECK(run(*a, 100) == 5050);
+    CHECK(run(*b, 4) == 10);
+    CHECK(a->memory.template read<uint64_t>(DATA) == 100);
+    CHECK(b->memory.template read<uint64_t>(DATA) == 4);
+    CHECK(main.machine.memory.template read<uint64_t>(DATA) == 10);
+    CHECK(main.machine.memory.template read<uint64_t>(DATA + 8) == 0);
+    // Releasing one fork leaves its sibling intact
+    a.reset();
+    CHECK(b->memory.template read<uint64_t>(DATA + 8) == 10);
+  }
+  SECTION("Forks share the decoder cache") {
+    auto fork = main.machine.fork();
+    CHECK(&fork->cpu.current_execute_segment() == &main.machine.cpu.current_execute_segment());
+    CHECK(fork->cpu.current_execute_segment().decoder_cache_base() ==
+          main.machine.cpu.current_execute_segment().decoder_cache_base());
+  }
+}
+
+TEST_CASE("RISC-V forks of a flat memory arena", "[scope:sim][kind:int][arch:RV]") {
+  const auto [huge_pages, forkable] = GENERATE(table<bool, bool>({{false, false}, {false, true}, {true, false}}));
+  INFO("Huge pages " << huge_pages << ", forkable arena " << forkable);
+  static constexpr uint64_t ADDR = 0x200000;
+  riscv::Machine<uint64_t> main{
+      empty, {.flat_memory_arena = true, .memory_arena_huge_pages = huge_pages, .forkable_memory_arena = forkable}};
+  REQUIRE(main.memory.memory_arena_write_boundary() > ADDR);
+  // Written through the arena fast path, so the main machine has no page for it
+  main.memory.template write<uint64_t>(ADDR, 0x1234);
+
+  auto a = main.fork(), b = main.fork();
+  CHECK(a->memory.template read<uint64_t>(ADDR) == 0x1234);
+  a->memory.template write<uint64_t>(ADDR, 0x5678);
+  CHECK(a->memory.template read<uint64_t>(ADDR) == 0x5678);
+  CHECK(b->memory.template read<uint64_t>(ADDR) == 0x1234);
+  CHECK(main.memory.template read<uint64_t>(ADDR) == 0x1234);
+}
+
+TEST_CASE("RISC-V fork throughput", "[.][benchmark][scope:sim][arch:RV]") {
+  Main main;
+  static constexpr size_t FORKS = 10'000;
+  std::vector<std::unique_ptr<riscv::Machine<uint64_t>>> forks;
+  forks.reserve(FORKS);
+  const size_t resident_before = resident_bytes();
+  const auto start = std::chrono::steady_clock::now();
+  uint64_t checksum = 0;
+  for (size_t it = 0; it < FORKS; it++) {
+    forks.push_back(main.machine.fork());
+    checksum += run(*forks.back(), 1 + it % 64);
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  const size_t resident_after = resident_bytes();
+  printf("libriscv: %zu forks in %.3fs (%.0f instances/s), %zu KiB resident per fork, checksum %lu\n", FORKS,
+         elapsed.count(), FORKS / elapsed.count(), (resident_after - resident_before) / FORKS / 1024,
+         (unsigned long)checksum);
+  CHECK(main.machine.memory.template read<uint64_t>(DATA + 8) == 0);
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <chrono>
+#include <cstring>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, BUFFER = 0x10000;
+static constexpr uint32_t A0 = 10, A1 = 11, A2 = 12, A7 = 17;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0, rd, rs1, imm); }
+uint32_t lui(uint32_t rd, uint32_t imm20) { return (imm20 << 12) | (rd << 7) | 0b0110111; }
+uint32_t bge(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b101 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+uint32_t jal(uint32_t rd, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) | (((u >> 12) & 0xFF) << 12) |
+         (rd << 7) | 0b1101111;
+}
+
+// cat: copies stdin to stdout in 64 KiB chunks until read() returns 0.
+const std::vector<uint32_t> cat = {
+    lui(A1, BUFFER >> 12), //     li a1, BUFFER
+    addi(A0, 0, 0),        // 1:  li a0, 0
+    lui(A2, 0x10),         //     li a2, 65536
+    addi(A7, 0, 63),       //     li a7, SYS_read
+    0x00000073,            //     ecall
+    bge(0, A0, 24),        //     blez a0, 2f
+    addi(A2, A0, 0),       //     mv a2, a0
+    addi(A0, 0, 1),        //     li a0, 1
+    addi(A7, 0, 64),       //     li a7, SYS_write
+    0x00000073,            //     ecall
+    jal(0, -36),           //     j 1b
+    0x00100073,            // 2:  ebreak
+};
+
+// Stands in for the host's stdin and stdout. The input is a repeating pattern, so the output can be checked without
+// buffering the whole stream.
+struct Stream {
+  static inline std::vector<char> pattern;
+  static inline size_t length = 0, read = 0, written = 0;
+  static inline bool verify = true, matches = true;
+
+  static void reset(size_t len, bool check) {
+    if (pattern.empty()) {
+      pattern.resize(1 << 20);
+      for (size_t it = 0; it < pattern.size(); it++) pattern[it] = char(it * 31 + it / 251);
+    }
+    length = len, read = written = 0, verify = check, matches = true;
+  }
+  static long stdin_read(const riscv::Machine<uint64_t> &, char *buffer, size_t len) {
+    len = std::min(len, length - read);
+    for (size_t done = 0; done < len;) {
+      const size_t offset = (read + done) % pattern.size();
+      const size_t chunk = std::min(len - done, pattern.size() - offset);
+      std::memcpy(buffer + done, pattern.data() + offset, chunk);
+      done += chunk;
+    }
+    read += len;
+    return len;
+  }
+  static void stdout_write(const riscv::Machine<uint64_t> &, const char *buffer, size_t len) {
+    for (size_t done = 0; verify && done < len;) {
+      const size_t offset = (written + done) % pattern.size();
+      const size_t chunk = std::min(len - done, pattern.size() - offset);
+      matches &= std::memcmp(buffer + done, pattern.data() + offset, chunk) == 0;
+      done += chunk;
+    }
+    written += len;
+  }
+};
+
+struct Cat {
+  riscv::Machine<uint64_t> machine{empty};
+  Cat() {
+    machine.setup_linux_syscalls();
+    machine.set_stdin(Stream::stdin_read);
+    machine.set_printer(Stream::stdout_write);
+    machine.cpu.init_execute_area(cat.data(), CODE, cat.size() * sizeof(uint32_t));
+    machine.cpu.jump(CODE);
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+  void run() { machine.simulate(UINT64_MAX); }
+};
+} // namespace
+
+TEST_CASE("RISC-V guest stdin and stdout", "[scope:sim][kind:int][arch:RV]") {
+  Cat cat;
+  SECTION("Whole stream is echoed") {
+    // Not a multiple of the guest's chunk size, so the last read is short.
+    Stream::reset((3 << 20) + 12345, true);
+    cat.run();
+    CHECK(Stream::read == Stream::length);
+    CHECK(Stream::written == Stream::length);
+    CHECK(Stream::matches);
+  }
+  SECTION("Reads land in guest memory") {
+    Stream::reset(100, false);
+    cat.run();
+    std::vector<char> buffer(100);
+    cat.machine.copy_from_guest(buffer.data(), BUFFER, buffer.size());
+    CHECK(std::memcmp(buffer.data(), Stream::pattern.data(), buffer.size()) == 0);
+  }
+  SECTION("Gathers are clamped to what the buffers can cover") {
+    using Memory = riscv::Memory<uint64_t>;
+    const size_t page = riscv::Page::size();
+    CHECK(Memory::gather_limit(4, 0x1FF0, 1 << 20) == 0x10 + 3 * page);
+    CHECK(Memory::gather_limit(4, 0x2000, 1 << 20) == 4 * page);
+    CHECK(Memory::gather_limit(4, 0x2000, 100) == 100);
+    CHECK(Memory::gather_limit(0, 0x2000, 100) == 0);
+  }
+}
+
+TEST_CASE("RISC-V guest stdin to stdout throughput", "[.][benchmark][scope:sim][kind:int][arch:RV]") {
+  static constexpr size_t length = size_t(1) << 30;
+  Cat cat;
+  Stream::reset(length, false);
+  const auto start = std::chrono::steady_clock::now();
+  cat.run();
+  const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  REQUIRE(Stream::written == length);
+  printf("Streamed %zu MiB through the guest in %.3f s (%.1f MiB/s, %zu instructions)\n", length >> 20, seconds,
+         (length >> 20) / seconds, size_t(cat.machine.instruction_counter()));
+}
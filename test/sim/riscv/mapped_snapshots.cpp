@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <cstring>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, HEAP = 0x1000000;
+static constexpr uint32_t A0 = 10, A1 = 11, A2 = 12;
+static const uint64_t page = riscv::Page::size();
+using Snapshot = std::vector<uint8_t>;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t sd(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b011 << 12) |
+         (uint32_t(imm & 0x1F) << 7) | 0b0100011;
+}
+uint32_t add(uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (rs2 << 20) | (rs1 << 15) | (rd << 7) | 0b0110011;
+}
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// Stores a1 to a1 addresses, starting at a0 and a2 bytes apart.
+const std::vector<uint32_t> touch = {
+    sd(A0, A1, 0),                   // 1: sd a1, 0(a0)
+    add(A0, A0, A2),                 //    add a0, a0, a2
+    itype(0b0010011, 0, A1, A1, -1), //    addi a1, a1, -1
+    bne(A1, 0, -12),                 //    bnez a1, 1b
+    0x00100073,                      //    ebreak
+};
+
+struct Main {
+  riscv::Machine<uint64_t> machine;
+  explicit Main(uint64_t heap)
+      : machine{empty, {.memory_max = heap + (16ull << 20), .use_memory_arena = false}} {
+    machine.memory.memset(HEAP, 0, heap);
+    load();
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+  // Restoring a snapshot evicts execute segments, and this one only exists as an execute segment.
+  void load() { machine.cpu.init_execute_area(touch.data(), CODE, touch.size() * sizeof(uint32_t)); }
+  // Writes one doubleword to each of count pages, stride pages apart.
+  void run(uint64_t first, uint64_t count, uint64_t stride) {
+    machine.cpu.reg(A0) = first;
+    machine.cpu.reg(A1) = count;
+    machine.cpu.reg(A2) = stride * page;
+    machine.cpu.jump(CODE);
+    machine.simulate(UINT64_MAX);
+  }
+  uint64_t at(uint64_t addr) { return machine.memory.template read<uint64_t>(addr); }
+};
+
+std::filesystem::path snapshot_file(const char *name) {
+  return std::filesystem::temp_directory_path() / name;
+}
+
+std::vector<uint8_t> read_file(const std::filesystem::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), {});
+}
+} // namespace
+
+TEST_CASE("RISC-V mapped snapshots", "[scope:sim][kind:int][arch:RV]") {
+  const auto path = snapshot_file("pepp-rv-mapped-snapshot.bin");
+  Main main(64 * page);
+  main.run(HEAP, 4, 10);
+  const size_t written = main.machine.serialize_to_file(path.string());
+  REQUIRE(written == std::filesystem::file_size(path));
+  const auto original = read_file(path);
+  // Page data starts on a page boundary of the file
+  CHECK(written % page == 0);
+
+  Main restored(page);
+  REQUIRE(restored.machine.deserialize_from_file(path.string()) == 0);
+  SECTION("Restores memory, registers and counters") {
+    CHECK(restored.at(HEAP) == 4);
+    CHECK(restored.at(HEAP + 30 * page) == 1);
+    CHECK(restored.at(HEAP + 31 * page) == 0);
+    CHECK(restored.machine.memory.pages().size() == main.machine.memory.pages().size());
+    CHECK(restored.machine.cpu.reg(A0) == main.machine.cpu.reg(A0));
+    CHECK(restored.machine.instruction_counter() == main.machine.instruction_counter());
+  }
+  SECTION("Guest writes do not reach the file") {
+    restored.load();
+    restored.run(HEAP, 64, 1);
+    CHECK(restored.at(HEAP) == 64);
+    CHECK(restored.at(HEAP + 63 * page) == 1);
+    CHECK(read_file(path) == original);
+    // A second machine mapping the same file still sees the snapshot
+    Main other(page);
+    REQUIRE(other.machine.deserialize_from_file(path.string()) == 0);
+    CHECK(other.at(HEAP) == 4);
+    CHECK(other.at(HEAP + 63 * page) == 0);
+  }
+  SECTION("Matches restoring from a vector") {
+    Main copied(page);
+    REQUIRE(copied.machine.deserialize_from(original) == 0);
+    // Every snapshot has its own ID, so compare the restored state rather than snapshots of it
+    const auto &pages = restored.machine.memory.pages();
+    REQUIRE(pages.size() == copied.machine.memory.pages().size());
+    for (const auto &[addr, page] : pages) {
+      INFO("Page " << addr);
+      const auto &other = copied.machine.memory.pages().at(addr);
+      CHECK(page.is_cow_page() == other.is_cow_page());
+      CHECK(std::memcmp(page.data(), other.data(), riscv::Page::size()) == 0);
+    }
+    CHECK(restored.machine.cpu.registers().pc == copied.machine.cpu.registers().pc);
+    CHECK(restored.machine.instruction_counter() == copied.machine.instruction_counter());
+  }
+  SECTION("Deltas apply on top of a mapped snapshot") {
+    // Deltas taken by another machine which restored the same file
+    Main other(page);
+    REQUIRE(other.machine.deserialize_from_file(path.string()) == 0);
+    other.load();
+    other.run(HEAP + 2 * page, 1, 1);
+    Snapshot d1;
+    other.machine.serialize_delta_to(d1);
+    REQUIRE(restored.machine.deserialize_from(d1) == 0);
+    CHECK(restored.at(HEAP + 2 * page) == 1);
+    CHECK(restored.at(HEAP + 10 * page) == 3);
+
+    // The original machine wrote the file, but its own deltas are not based on it
+    Snapshot base, d2;
+    main.machine.serialize_delta_to(base);
+    main.machine.serialize_delta_to(d2);
+    Main fresh(page);
+    REQUIRE(fresh.machine.deserialize_from_file(path.string()) == 0);
+    CHECK(fresh.machine.deserialize_from(d2) != 0);
+  }
+  SECTION("Rejects missing and foreign files") {
+    CHECK(restored.machine.deserialize_from_file((path.string() + ".missing")) != 0);
+    const auto foreign = snapshot_file("pepp-rv-mapped-foreign.bin");
+    std::ofstream(foreign, std::ios::binary) << std::string(4096, 'x');
+    CHECK(restored.machine.deserialize_from_file(foreign.string()) != 0);
+    std::filesystem::remove(foreign);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("RISC-V mapped snapshot restore time", "[.][benchmark][scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t heap = 512ull << 20;
+  const auto path = snapshot_file("pepp-rv-mapped-snapshot-bench.bin");
+  Main main(heap);
+  REQUIRE(main.machine.serialize_to_file(path.string()) > heap);
+  const auto bytes = read_file(path);
+  using clock = std::chrono::steady_clock;
+  auto ms = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+  Main copied(page), mapped(page);
+  auto start = clock::now();
+  REQUIRE(copied.machine.deserialize_from(bytes) == 0);
+  const double copy_ms = ms(clock::now() - start);
+  start = clock::now();
+  REQUIRE(mapped.machine.deserialize_from_file(path.string()) == 0);
+  const double map_ms = ms(clock::now() - start);
+  // Touch one page in a hundred after restoring, as a short-lived guest would
+  start = clock::now();
+  mapped.load();
+  mapped.run(HEAP, heap / page / 100, 100);
+  const double touch_ms = ms(clock::now() - start);
+
+  printf("Restoring a %.2f MiB snapshot:\n", bytes.size() / double(1 << 20));
+  printf("  from a vector: %8.2f ms\n", copy_ms);
+  printf("  mapped:        %8.2f ms (then %.2f ms writing 1%% of pages)\n", map_ms, touch_ms);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <random>
+#include "sim3/cores/riscv/decode/decoder_cache.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+// Not page aligned, so the first chunk starts in the middle of a page
+static constexpr uint64_t CODE = 0x10002;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b001 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+
+// A mix of 16- and 32-bit instructions, so that many chunk boundaries fall inside a 32-bit instruction.
+std::vector<uint16_t> program(size_t bytes) {
+  std::mt19937 rng(1234);
+  std::vector<uint16_t> code;
+  auto push32 = [&code](uint32_t instr) { code.push_back(instr & 0xFFFF), code.push_back(instr >> 16); };
+  while (code.size() * 2 < bytes) {
+    for (int it = 0; it < 16; it++) {
+      const uint32_t rd = 1 + rng() % 31, rs = rng() % 32, imm = rng() % 2048;
+      switch (rng() % 6) {
+      case 0: push32(itype(0b0010011, 0, rd, rs, imm)); break;      // addi
+      case 1: push32(itype(0b0000011, 0b010, rd, rs, imm)); break;  // lw
+      case 2: push32((imm << 12) | (rd << 7) | 0b0110111); break;   // lui
+      case 3: code.push_back(uint16_t((rd << 7) | ((imm & 0x1F) << 2) | 0b01)); break;          // c.addi
+      case 4: code.push_back(uint16_t((0b010 << 13) | (rd << 7) | ((imm & 0x1F) << 2) | 0b01)); // c.li
+        break;
+      default: code.push_back(uint16_t(rng())); break; // Anything, including the lower half of a 32-bit instruction
+      }
+    }
+    push32(bne(10, 11, -64));
+  }
+  push32(0x0000006f); // j .
+  return code;
+}
+
+template <riscv::AddressType address_t> std::vector<uint8_t> decode(const std::vector<uint16_t> &code, unsigned threads) {
+  auto options = std::make_shared<riscv::MachineOptions<address_t>>();
+  options->use_shared_execute_segments = false;
+  options->decoder_threads = threads;
+  riscv::Machine<address_t> machine{empty};
+  machine.set_options(options);
+  auto &exec = machine.cpu.init_execute_area(code.data(), CODE, code.size() * sizeof(uint16_t));
+  const auto *base = reinterpret_cast<const uint8_t *>(exec.decoder_cache_base());
+  return {base, base + exec.decoder_cache_size() * sizeof(riscv::DecoderCache<address_t>)};
+}
+} // namespace
+
+TEST_CASE("RISC-V parallel decoding", "[scope:sim][kind:int][arch:RV]") {
+  const auto code = program(1 << 20);
+  SECTION("RV64") {
+    const auto serial = decode<uint64_t>(code, 1);
+    for (const unsigned threads : {2u, 3u, 7u, 16u}) {
+      INFO("Threads " << threads);
+      CHECK(decode<uint64_t>(code, threads) == serial);
+    }
+  }
+  SECTION("RV32") {
+    const auto serial = decode<uint32_t>(code, 1);
+    for (const unsigned threads : {2u, 5u}) {
+      INFO("Threads " << threads);
+      CHECK(decode<uint32_t>(code, threads) == serial);
+    }
+  }
+}
+
+TEST_CASE("RISC-V parallel decoding latency", "[.][benchmark][scope:sim][arch:RV]") {
+  // A multi-megabyte statically linked program
+  const auto code = program(8 << 20);
+  BENCHMARK("Serial") { return decode<uint64_t>(code, 1).size(); };
+  BENCHMARK("Parallel") { return decode<uint64_t>(code, 0).size(); };
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include "sim3/cores/riscv/decode/superinstructions.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t stype(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (uint32_t(imm & 0x1F) << 7) |
+         0b0100011;
+}
+uint32_t btype(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+uint32_t utype(uint32_t opcode, uint32_t rd, uint32_t imm20) { return (imm20 << 12) | (rd << 7) | opcode; }
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0, rd, rs1, imm); }
+uint32_t lui(uint32_t rd, uint32_t imm20) { return utype(0b0110111, rd, imm20); }
+uint32_t auipc(uint32_t rd, uint32_t imm20) { return utype(0b0010111, rd, imm20); }
+uint32_t jalr(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b1100111, 0, rd, rs1, imm); }
+uint32_t beq(uint32_t rs1, uint32_t rs2, int32_t imm) { return btype(0b000, rs1, rs2, imm); }
+uint32_t bne(uint32_t rs1, uint32_t rs2, int32_t imm) { return btype(0b001, rs1, rs2, imm); }
+uint16_t c_addi(uint32_t rd, int32_t imm) {
+  return uint16_t((((imm >> 5) & 1) << 12) | (rd << 7) | ((imm & 0x1F) << 2) | 0b01);
+}
+uint16_t c_bnez(uint32_t rs1, int32_t imm) { // rs1 is x8-x15
+  const uint32_t u = imm;
+  return uint16_t((0b111 << 13) | (((u >> 8) & 1) << 12) | (((u >> 3) & 3) << 10) | ((rs1 - 8) << 7) |
+                  (((u >> 6) & 3) << 5) | (((u >> 1) & 3) << 3) | (((u >> 5) & 1) << 2) | 0b01);
+}
+
+// Assembles a mix of 16- and 32-bit instructions.
+struct Assembler {
+  std::vector<uint16_t> halves;
+  uint64_t pc() const { return CODE + 2 * halves.size(); }
+  Assembler &operator<<(uint32_t instr) {
+    halves.push_back(instr & 0xFFFF), halves.push_back(instr >> 16);
+    return *this;
+  }
+  Assembler &c(uint16_t instr) {
+    halves.push_back(instr);
+    return *this;
+  }
+};
+
+// One loop containing every fused idiom, with taken and not-taken, forward and backward branches.
+std::vector<uint16_t> program() {
+  Assembler a;
+  a << lui(12, 0x2) << addi(12, 12, 0x10); //        0x1000: a2 = 0x2010          (lui+addi)
+  a << addi(9, 0, 200);                    //        0x1008: s1 = 200
+  const auto loop = a.pc();                //        0x100c:
+  a << stype(0b010, 12, 9, 0);             //                sw s1, 0(a2)
+  a << itype(0b0000011, 0b010, 13, 12, 0); //                lw a3, 0(a2)
+  a << beq(13, 9, 8);                      //                beq a3, s1, +8        (load+beq, taken)
+  a << addi(8, 8, 1000);                   //                skipped
+  a << itype(0b0000011, 0b011, 14, 12, 0); //                ld a4, 0(a2)
+  a << bne(14, 0, 8);                      //                bnez a4, +8           (load+bne, taken)
+  a << addi(8, 8, 1000);                   //                skipped
+  a << itype(0b0000011, 0b011, 15, 12, 0); //                ld a5, 0(a2)
+  a << beq(15, 0, 0x100);                  //                beqz a5, fail         (load+beq, not taken)
+  const auto call = a.pc();
+  a << auipc(6, 0) << jalr(1, 6, 0x80);    //                call func             (auipc+jalr)
+  a << addi(10, 0, 5);                     //                li a0, 5
+  a << addi(10, 10, -1) << bne(10, 0, -4); //                1: addi+bne, backward
+  a.c(c_addi(9, -1));                      //        0x1044: c.addi s1, -1
+  a.c(c_bnez(9, int32_t(loop - a.pc())));  //        0x1046: c.bnez s1, loop      (c.addi+c.bnez)
+  a << lui(16, 0x12345);                   //                lui a6, 0x12345
+  a << itype(0b0011011, 0, 16, 16, 0x678); //                addiw a6, a6, 0x678  (lui+addiw)
+  a << 0x0000006f;                         //                j .
+  while (a.pc() < call + 0x80) a << addi(0, 0, 0);
+  a << addi(17, 17, 3) << jalr(0, 1, 0);   // func:          addi a7, a7, 3; ret
+  while (a.pc() < call + 0x104 + 0x100) a << addi(0, 0, 0);
+  return a.halves;
+}
+
+struct Runner {
+  riscv::Machine<uint64_t> machine{empty};
+  const std::vector<uint16_t> code = program();
+
+  explicit Runner(bool fuse) {
+    auto options = std::make_shared<riscv::MachineOptions<uint64_t>>();
+    options->use_shared_execute_segments = false;
+    options->fuse_superinstructions = fuse;
+    machine.set_options(options);
+    machine.memory.memset(0x2000, 0, 0x100);
+    machine.cpu.init_execute_area(code.data(), CODE, code.size() * sizeof(uint16_t));
+    machine.cpu.jump(CODE);
+  }
+};
+
+void check_same(riscv::Machine<uint64_t> &fused, riscv::Machine<uint64_t> &plain) {
+  CHECK(fused.instruction_counter() == plain.instruction_counter());
+  CHECK(fused.cpu.pc() == plain.cpu.pc());
+  for (int reg = 0; reg < 32; reg++) {
+    INFO("Register x" << reg);
+    CHECK(fused.cpu.reg(reg) == plain.cpu.reg(reg));
+  }
+}
+} // namespace
+
+TEST_CASE("RISC-V superinstructions", "[scope:sim][kind:int][arch:RV]") {
+  SECTION("Every idiom is fused") {
+    auto &counters = riscv::fusion_counters();
+    counters.reset();
+    Runner fused(true);
+    using enum riscv::FusedIdiom;
+    CHECK(counters.sites[size_t(LuiAddi)] == 2);
+    CHECK(counters.sites[size_t(AuipcJalr)] == 1);
+    CHECK(counters.sites[size_t(LoadBranch)] == 3);
+    CHECK(counters.sites[size_t(AddiBranch)] == 2);
+    counters.reset();
+    Runner plain(false);
+    for (const auto &sites : counters.sites) CHECK(sites == 0);
+  }
+
+  // Odd budgets stop between the halves of a superinstruction, and must stop on the same instruction
+  for (const uint64_t budget : {1ull, 2ull, 7ull, 33ull, 100ull, 1001ull, 123457ull}) {
+    DYNAMIC_SECTION("Budget " << budget) {
+      Runner fused(true), plain(false);
+      fused.machine.simulate<false>(budget);
+      plain.machine.simulate<false>(budget);
+      check_same(fused.machine, plain.machine);
+    }
+  }
+
+  SECTION("Results") {
+    Runner fused(true);
+    fused.machine.simulate<false>(100000);
+    CHECK(fused.machine.cpu.reg(8) == 0);
+    CHECK(fused.machine.cpu.reg(9) == 0);
+    CHECK(fused.machine.cpu.reg(10) == 0);
+    CHECK(fused.machine.cpu.reg(16) == 0x12345678);
+    CHECK(fused.machine.cpu.reg(17) == 3 * 200);
+  }
+
+  SECTION("Breakpoints split superinstructions") {
+    // Breakpoint on the second half of auipc+jalr, and on the second half of c.addi+c.bnez
+    for (const auto [offset, counter] : {std::pair{0x34ull, 200}, std::pair{0x46ull, 199}}) {
+      Runner fused(true);
+      fused.machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+      fused.machine.cpu.install_ebreak_at(CODE + offset);
+      fused.machine.simulate(100000);
+      CHECK(fused.machine.cpu.pc() == CODE + offset);
+      CHECK(fused.machine.cpu.reg(9) == counter);
+    }
+  }
+}
+
+TEST_CASE("RISC-V superinstruction micro-benchmarks", "[.][benchmark][scope:sim][arch:RV]") {
+  // Each kernel is a loop of 64 copies of one idiom, closed by a counted branch
+  struct Kernel {
+    const char *name;
+    std::vector<uint32_t> body;
+  };
+  const Kernel kernels[] = {
+      {"lui+addi", {lui(10, 0x12345), addi(10, 10, 0x678)}},
+      {"auipc+jalr", {auipc(6, 0), jalr(0, 6, 8)}},
+      {"load+branch", {itype(0b0000011, 0b011, 13, 12, 0), beq(13, 0, 4)}},
+      {"addi+bne", {addi(14, 14, 1), bne(14, 0, 4)}},
+  };
+  for (const auto &kernel : kernels) {
+    Assembler a;
+    a << lui(12, 0x80) << addi(11, 0, 2000);
+    for (int it = 0; it < 64; it++)
+      for (const auto instr : kernel.body) a << instr;
+    a << addi(11, 11, -1) << bne(11, 0, -8 * 64 - 4) << 0x0000006f;
+    for (const bool fuse : {false, true}) {
+      auto options = std::make_shared<riscv::MachineOptions<uint64_t>>();
+      options->use_shared_execute_segments = false;
+      options->fuse_superinstructions = fuse;
+      riscv::Machine<uint64_t> machine{empty};
+      machine.set_options(options);
+      machine.memory.memset(0x80000, 0xFF, 8);
+      machine.cpu.init_execute_area(a.halves.data(), CODE, a.halves.size() * sizeof(uint16_t));
+      BENCHMARK(std::string(kernel.name) + (fuse ? " (fused)" : " (separate)")) {
+        machine.cpu.jump(CODE);
+        machine.set_instruction_counter(0);
+        return machine.simulate<false>(2000 * (64 * 2 + 2) + 2);
+      };
+    }
+  }
+}
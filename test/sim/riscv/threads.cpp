@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <chrono>
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000, DATA = 0x10000;
+static constexpr uint32_t T0 = 5, S0 = 8, S1 = 9, A0 = 10, A1 = 11, A2 = 12, A7 = 17, S2 = 18, S3 = 19;
+static constexpr uint32_t ECALL = 0x00000073, EBREAK = 0x00100073;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0b000, rd, rs1, imm); }
+uint32_t sltiu(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0b011, rd, rs1, imm); }
+uint32_t xori(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0b100, rd, rs1, imm); }
+uint32_t lw(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0000011, 0b010, rd, rs1, imm); }
+uint32_t ld(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0000011, 0b011, rd, rs1, imm); }
+uint32_t lui(uint32_t rd, uint32_t imm20) { return (imm20 << 12) | (rd << 7) | 0b0110111; }
+uint32_t store(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (uint32_t(imm & 0x1F) << 7) |
+         0b0100011;
+}
+uint32_t sw(uint32_t rs1, uint32_t rs2, int32_t imm) { return store(0b010, rs1, rs2, imm); }
+uint32_t sd(uint32_t rs1, uint32_t rs2, int32_t imm) { return store(0b011, rs1, rs2, imm); }
+uint32_t beq(uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (0b000 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+uint32_t jal(uint32_t rd, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) | (((u >> 12) & 0xFF) << 12) |
+         (rd << 7) | 0b1101111;
+}
+
+// Two threads, each incrementing its own doubleword forever without ever yielding.
+// The child counts at DATA, the parent at DATA + 8.
+const std::vector<uint32_t> spin = {
+    lui(S0, DATA >> 12), //     li s0, DATA
+    addi(A7, 0, 220),    //     li a7, SYS_clone
+    addi(A0, 0, 0),      //     li a0, 0
+    addi(A1, 0, 0),      //     li a1, 0
+    ECALL,               //     ecall
+    beq(A0, 0, 8),       //     beqz a0, 1f
+    addi(S0, S0, 8),     //     addi s0, s0, 8
+    ld(T0, S0, 0),       // 1:  ld t0, 0(s0)
+    addi(T0, T0, 1),     //     addi t0, t0, 1
+    sd(S0, T0, 0),       //     sd t0, 0(s0)
+    jal(0, -12),         //     j 1b
+};
+
+// Parks DATA[16] threads on a futex at DATA + 8 that is never woken, then two workers hand a turn word at DATA back
+// and forth with futex wait and wake, DATA[24] times each. Every handoff blocks one worker and wakes the other.
+const std::vector<uint32_t> pingpong = {
+    lui(S0, DATA >> 12), //     li s0, DATA
+    ld(S1, S0, 16),      //     ld s1, 16(s0)
+    beq(S1, 0, 32),      // 1:  beqz s1, 2f
+    addi(A7, 0, 220),    //     li a7, SYS_clone
+    addi(A0, 0, 0),      //     li a0, 0
+    addi(A1, 0, 0),      //     li a1, 0
+    ECALL,               //     ecall
+    beq(A0, 0, 112),     //     beqz a0, 6f
+    addi(S1, S1, -1),    //     addi s1, s1, -1
+    jal(0, -28),         //     j 1b
+    addi(A7, 0, 220),    // 2:  li a7, SYS_clone
+    addi(A0, 0, 0),      //     li a0, 0
+    addi(A1, 0, 0),      //     li a1, 0
+    ECALL,               //     ecall
+    sltiu(S2, A0, 1),    //     seqz s2, a0
+    ld(S3, S0, 24),      //     ld s3, 24(s0)
+    lw(T0, S0, 0),       // 3:  lw t0, 0(s0)
+    beq(T0, S2, 28),     //     beq t0, s2, 4f
+    addi(A0, S0, 0),     //     mv a0, s0
+    addi(A1, 0, 0),      //     li a1, FUTEX_WAIT
+    addi(A2, T0, 0),     //     mv a2, t0
+    addi(A7, 0, 98),     //     li a7, SYS_futex
+    ECALL,               //     ecall
+    jal(0, -28),         //     j 3b
+    beq(S3, 0, 40),      // 4:  beqz s3, 5f
+    addi(S3, S3, -1),    //     addi s3, s3, -1
+    xori(T0, S2, 1),     //     xori t0, s2, 1
+    sw(S0, T0, 0),       //     sw t0, 0(s0)
+    addi(A0, S0, 0),     //     mv a0, s0
+    addi(A1, 0, 1),      //     li a1, FUTEX_WAKE
+    addi(A2, 0, 1),      //     li a2, 1
+    addi(A7, 0, 98),     //     li a7, SYS_futex
+    ECALL,               //     ecall
+    jal(0, -68),         //     j 3b
+    EBREAK,              // 5:  ebreak
+    addi(A0, S0, 8),     // 6:  addi a0, s0, 8
+    addi(A1, 0, 0),      //     li a1, FUTEX_WAIT
+    addi(A2, 0, 0),      //     li a2, 0
+    addi(A7, 0, 98),     //     li a7, SYS_futex
+    ECALL,               //     ecall
+    jal(0, -20),         //     j 6b
+};
+
+struct Guest {
+  riscv::Machine<uint64_t> machine{empty};
+  explicit Guest(const std::vector<uint32_t> &code) {
+    machine.setup_posix_threads();
+    machine.memory.memset(DATA, 0, riscv::Page::size());
+    machine.cpu.init_execute_area(code.data(), CODE, code.size() * sizeof(uint32_t));
+    machine.cpu.jump(CODE);
+    machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  }
+  uint64_t at(uint64_t addr) { return machine.memory.template read<uint64_t>(addr); }
+};
+
+// Makes a new thread current and blocks it on a futex, handing the CPU back to the main thread.
+void park(riscv::MultiThreading<uint64_t> &mt, uint32_t word, uint32_t bitset) {
+  auto *main = mt.get_thread();
+  auto *thread = mt.create(0, 0, 0, 0, 0, 0, 0);
+  main->suspend();
+  thread->activate();
+  REQUIRE(mt.block(0, word, bitset));
+  REQUIRE(mt.get_thread() == main);
+}
+std::vector<int> tids(const riscv::ThreadQueue<uint64_t> &queue) {
+  std::vector<int> ret;
+  for (auto *t = queue.front(); t != nullptr; t = t->queue_next) ret.push_back(t->tid);
+  return ret;
+}
+} // namespace
+
+TEST_CASE("RISC-V guest thread wait queues", "[scope:sim][kind:int][arch:RV]") {
+  Guest guest({EBREAK});
+  auto &mt = guest.machine.threads();
+  static constexpr uint32_t WORD = DATA, OTHER = DATA + 4;
+  park(mt, WORD, 0);     // tid 1
+  park(mt, OTHER, 0);    // tid 2
+  park(mt, WORD, 0b01);  // tid 3
+  park(mt, WORD, 0b10);  // tid 4
+  REQUIRE(mt.blocked_threads().size() == 2);
+  CHECK(tids(mt.blocked_threads().at(WORD)) == std::vector<int>{1, 3, 4});
+  CHECK(mt.suspended_threads().empty());
+
+  SECTION("Waiters wake in the order they blocked") {
+    CHECK(mt.wakeup_blocked(2, WORD) == 2);
+    CHECK(tids(mt.suspended_threads()) == std::vector<int>{1, 3});
+    CHECK(tids(mt.blocked_threads().at(WORD)) == std::vector<int>{4});
+  }
+  SECTION("Bitsets select waiters") {
+    CHECK(mt.wakeup_blocked(10, WORD, 0b10) == 2);
+    CHECK(tids(mt.suspended_threads()) == std::vector<int>{1, 4});
+    CHECK(mt.wakeup_blocked(10, WORD, 0b01) == 1);
+    CHECK(mt.blocked_threads().at(WORD).empty());
+    CHECK(mt.wakeup_blocked(10, WORD) == 0);
+    CHECK(mt.wakeup_blocked(10, OTHER) == 1);
+    CHECK(mt.suspended_threads().size() == 4);
+  }
+  SECTION("Empty wait queues are pruned") {
+    const size_t limit = 2 * mt.m_max_threads;
+    for (uint32_t word = 0; word < 4 * limit; word++) mt.wait_queue(DATA + 0x100 + 4 * word);
+    CHECK(mt.blocked_threads().size() <= limit);
+    CHECK(tids(mt.blocked_threads().at(WORD)) == std::vector<int>{1, 3, 4});
+    CHECK(tids(mt.blocked_threads().at(OTHER)) == std::vector<int>{2});
+    // Pruning must not leave a stale cached queue behind
+    CHECK(&mt.wait_queue(WORD) == &mt.blocked_threads().at(WORD));
+    CHECK(mt.wakeup_blocked(10, DATA + 0x100) == 0);
+    CHECK(mt.wakeup_blocked(10, OTHER) == 1);
+  }
+  SECTION("Exiting and unblocked threads leave their queue") {
+    mt.get_thread(3)->exit();
+    CHECK(tids(mt.blocked_threads().at(WORD)) == std::vector<int>{1, 4});
+    mt.unblock(2);
+    CHECK(mt.get_tid() == 2);
+    CHECK(mt.blocked_threads().at(OTHER).empty());
+    CHECK(tids(mt.suspended_threads()) == std::vector<int>{0});
+    // Not blocked
+    mt.unblock(0);
+    CHECK(guest.machine.cpu.reg(A0) == uint64_t(-1));
+  }
+  SECTION("Forks copy the queues") {
+    mt.wakeup_blocked(1, WORD);
+    riscv::Machine<uint64_t> fork{guest.machine, {}};
+    auto &copy = fork.threads();
+    CHECK(tids(copy.suspended_threads()) == std::vector<int>{1});
+    CHECK(tids(copy.blocked_threads().at(WORD)) == std::vector<int>{3, 4});
+    CHECK(copy.suspended_threads().front() == copy.get_thread(1));
+  }
+}
+
+TEST_CASE("RISC-V guest thread time slices", "[scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t budget = 100'000;
+  Guest guest(spin);
+  auto &mt = guest.machine.threads();
+  SECTION("Without a time slice, a spinning thread is never switched out") {
+    CHECK(!mt.simulate<false>(budget));
+    CHECK(guest.at(DATA) > 0);
+    CHECK(guest.at(DATA + 8) == 0);
+  }
+  SECTION("With a time slice, both threads share the budget") {
+    mt.set_time_slice(1000);
+    CHECK(!mt.simulate<false>(budget));
+    CHECK(guest.machine.instruction_counter() >= budget);
+    const uint64_t child = guest.at(DATA), parent = guest.at(DATA + 8);
+    CHECK(child > budget / 16);
+    CHECK(parent > budget / 16);
+    // Eight instructions up to the loops, four per increment, and each thread may be part way through an increment.
+    // More would mean a switch skipped or repeated instructions.
+    const uint64_t rest = guest.machine.instruction_counter() - (child + parent) * 4;
+    CHECK(rest >= 8);
+    CHECK(rest <= 8 + 2 * 3);
+    // Resuming continues the round-robin
+    CHECK(!mt.simulate<false>(2 * budget, guest.machine.instruction_counter()));
+    CHECK(guest.at(DATA) > child);
+    CHECK(guest.at(DATA + 8) > parent);
+    CHECK_THROWS_AS(mt.simulate(3 * budget, guest.machine.instruction_counter()), riscv::MachineTimeoutException);
+  }
+}
+
+TEST_CASE("RISC-V guest futex handoff cost", "[.][benchmark][scope:sim][kind:int][arch:RV]") {
+  static constexpr uint64_t handoffs = 1'000'000;
+  for (const uint64_t threads : {2, 10, 50}) {
+    Guest guest(pingpong);
+    guest.machine.memory.write<uint64_t>(DATA + 16, threads - 2);
+    guest.machine.memory.write<uint64_t>(DATA + 24, handoffs / 2);
+    const auto start = std::chrono::steady_clock::now();
+    guest.machine.simulate(UINT64_MAX);
+    const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(guest.machine.threads().get_tid() == 0);
+    printf("%2llu threads: %7.1f ns per futex handoff\n", (unsigned long long)threads, ns / handoffs);
+  }
+}
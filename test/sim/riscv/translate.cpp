@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <catch.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+#include "sim3/cores/riscv/translate/block_translator.hpp"
+#include "sim3/systems/notraced_riscv_isa3_system.hpp"
+#include "sim3/utils/private_cache.hpp"
+#if defined(__linux__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+namespace {
+static const std::vector<uint8_t> empty;
+static constexpr uint64_t CODE = 0x1000;
+static constexpr uint64_t DATA = 0x2000;
+
+uint32_t itype(uint32_t opcode, uint32_t f3, uint32_t rd, uint32_t rs1, int32_t imm) {
+  return (uint32_t(imm & 0xFFF) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | opcode;
+}
+uint32_t rtype(uint32_t f7, uint32_t f3, uint32_t rd, uint32_t rs1, uint32_t rs2) {
+  return (f7 << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | 0b0110011;
+}
+uint32_t stype(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  return (uint32_t((imm >> 5) & 0x7F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | (uint32_t(imm & 0x1F) << 7) |
+         0b0100011;
+}
+uint32_t btype(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 12) & 1) << 31) | (((u >> 5) & 0x3F) << 25) | (rs2 << 20) | (rs1 << 15) | (f3 << 12) |
+         (((u >> 1) & 0xF) << 8) | (((u >> 11) & 1) << 7) | 0b1100011;
+}
+uint32_t jal(uint32_t rd, int32_t imm) {
+  const uint32_t u = imm;
+  return (((u >> 20) & 1) << 31) | (((u >> 1) & 0x3FF) << 21) | (((u >> 11) & 1) << 20) | (((u >> 12) & 0xFF) << 12) |
+         (rd << 7) | 0b1101111;
+}
+uint32_t addi(uint32_t rd, uint32_t rs1, int32_t imm) { return itype(0b0010011, 0, rd, rs1, imm); }
+
+// An outer loop around a counted inner loop with memory traffic, a call, a division and a forward branch.
+std::vector<uint32_t> program() {
+  return {
+      addi(10, 0, 0),                           // 0x1000: li a0, 0
+      addi(11, 0, 100),                         // 0x1004: li a1, 100
+      (0x2 << 12) | (12 << 7) | 0b0110111,      // 0x1008: lui a2, 0x2
+      rtype(0, 0, 10, 10, 11),                  // 0x100c: add a0, a0, a1
+      stype(0b010, 12, 10, 8),                  // 0x1010: sw a0, 8(a2)
+      itype(0b0000011, 0b010, 13, 12, 8),       // 0x1014: lw a3, 8(a2)
+      rtype(0, 0b100, 14, 13, 11),              // 0x1018: xor a4, a3, a1
+      addi(11, 11, -1),                         // 0x101c: addi a1, a1, -1
+      btype(0b001, 11, 0, -0x14),               // 0x1020: bne a1, zero, 0x100c
+      rtype(1, 0, 15, 10, 10),                  // 0x1024: mul a5, a0, a0
+      jal(1, 0x10),                             // 0x1028: call 0x1038
+      btype(0b000, 15, 0, 0x8),                 // 0x102c: beqz a5, 0x1034
+      rtype(1, 0b100, 16, 15, 14),              // 0x1030: div a6, a5, a4
+      jal(0, -0x30),                            // 0x1034: j 0x1004
+      addi(17, 17, 3),                          // 0x1038: addi a7, a7, 3
+      itype(0b1100111, 0, 0, 1, 0),             // 0x103c: ret
+  };
+}
+
+// Unsigned remainders by a non-zero and a zero divisor, whose C contains a '%' operator.
+std::vector<uint32_t> remainders() {
+  return {
+      addi(10, 0, 1000),                        // 0x1000: li a0, 1000
+      addi(11, 0, 7),                           // 0x1004: li a1, 7
+      rtype(1, 0b111, 12, 10, 11),              // 0x1008: remu a2, a0, a1
+      rtype(1, 0b111, 13, 10, 0),               // 0x100c: remu a3, a0, zero
+      rtype(0, 0, 14, 14, 12),                  // 0x1010: add a4, a4, a2
+      rtype(0, 0, 15, 15, 13),                  // 0x1014: add a5, a5, a3
+      addi(10, 10, -1),                         // 0x1018: addi a0, a0, -1
+      btype(0b001, 10, 0, -0x14),               // 0x101c: bne a0, zero, 0x1008
+      jal(0, -0x20),                            // 0x1020: j 0x1000
+  };
+}
+
+template <bool Translate> struct Runner {
+  riscv::Machine<uint64_t> machine{empty};
+  const std::vector<uint32_t> code;
+
+  explicit Runner(bool wait = true, std::string dir = (std::filesystem::temp_directory_path() / "pepp-rvbt-test"),
+                  std::vector<uint32_t> program = ::program())
+      : code(std::move(program)) {
+    auto options = std::make_shared<riscv::MachineOptions<uint64_t>>();
+    options->use_shared_execute_segments = false;
+    options->translate_enabled = Translate;
+    options->translation_cache_dir = dir;
+    options->translation_wait = wait;
+    machine.set_options(options);
+    machine.cpu.init_execute_area(code.data(), CODE, code.size() * sizeof(uint32_t));
+    machine.cpu.jump(CODE);
+  }
+};
+} // namespace
+
+TEST_CASE("RISC-V block translation", "[scope:sim][kind:int][arch:RV]") {
+  const bool have_compiler = std::system("cc --version > /dev/null 2>&1") == 0;
+  // Odd budgets stop inside translated loops, and must stop on the same instruction as the interpreter.
+  for (const uint64_t budget : {1ull, 7ull, 100ull, 1001ull, 123457ull}) {
+    DYNAMIC_SECTION("Budget " << budget) {
+      Runner<false> interpreted;
+      Runner<true> translated;
+      if (have_compiler) CHECK(translated.machine.is_binary_translation_enabled());
+      CHECK(!interpreted.machine.is_binary_translation_enabled());
+
+      interpreted.machine.simulate<false>(budget);
+      translated.machine.simulate<false>(budget);
+      CHECK(translated.machine.instruction_counter() == interpreted.machine.instruction_counter());
+      CHECK(translated.machine.cpu.pc() == interpreted.machine.cpu.pc());
+      for (int reg = 0; reg < 32; reg++) {
+        INFO("Register x" << reg);
+        CHECK(translated.machine.cpu.reg(reg) == interpreted.machine.cpu.reg(reg));
+      }
+      CHECK(translated.machine.memory.template read<uint32_t>(DATA + 8) ==
+            interpreted.machine.memory.template read<uint32_t>(DATA + 8));
+    }
+  }
+}
+
+TEST_CASE("RISC-V block translation of remainders", "[scope:sim][kind:int][arch:RV]") {
+  const bool have_compiler = std::system("cc --version > /dev/null 2>&1") == 0;
+  const auto dir = (std::filesystem::temp_directory_path() / "pepp-rvbt-test").string();
+  Runner<false> interpreted(true, dir, remainders());
+  Runner<true> translated(true, dir, remainders());
+  const auto source = riscv::emit_translation(interpreted.machine.cpu.current_execute_segment(),
+                                              interpreted.machine.options());
+  INFO(source);
+  CHECK(source.find("s1 % s2") != std::string::npos);
+  if (have_compiler) CHECK(translated.machine.is_binary_translation_enabled());
+
+  interpreted.machine.simulate<false>(12345);
+  translated.machine.simulate<false>(12345);
+  CHECK(translated.machine.cpu.pc() == interpreted.machine.cpu.pc());
+  for (int reg = 10; reg < 16; reg++) {
+    INFO("Register x" << reg);
+    CHECK(translated.machine.cpu.reg(reg) == interpreted.machine.cpu.reg(reg));
+  }
+  CHECK(translated.machine.cpu.reg(13) != 0);
+}
+
+TEST_CASE("RISC-V block translation is reverted by breakpoints", "[scope:sim][kind:int][arch:RV]") {
+  Runner<true> translated;
+  translated.machine.install_syscall_handler(riscv::SYSCALL_EBREAK, [](auto &machine) { machine.stop(); });
+  translated.machine.cpu.install_ebreak_at(CODE + 0x24);
+  CHECK(!translated.machine.is_binary_translation_enabled());
+  // The breakpoint must be hit when the inner loop finishes for the first time
+  translated.machine.simulate(100000);
+  CHECK(translated.machine.cpu.pc() == CODE + 0x24);
+  CHECK(translated.machine.cpu.reg(10) == 5050);
+}
+
+TEST_CASE("RISC-V block translation compiles in the background", "[scope:sim][kind:int][arch:RV]") {
+  if (std::system("cc --version > /dev/null 2>&1") != 0) return;
+  const auto dir = std::filesystem::temp_directory_path() / "pepp-rvbt-background-test";
+  std::filesystem::remove_all(dir);
+  {
+    Runner<true> first(false, dir.string());
+    // Not waiting for the compiler: the first machine stays on the dispatcher
+    CHECK(!first.machine.is_binary_translation_enabled());
+  }
+  bool compiled = false;
+  for (int attempt = 0; attempt < 600 && !compiled; attempt++) {
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) compiled |= entry.path().extension() == ".so";
+    if (!compiled) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  REQUIRE(compiled);
+  Runner<true> second(false, dir.string());
+  CHECK(second.machine.is_binary_translation_enabled());
+}
+
+TEST_CASE("RISC-V cache directories are private", "[scope:sim][kind:int][arch:RV]") {
+  namespace fs = std::filesystem;
+  const auto root = fs::temp_directory_path() / "pepp-private-cache-test";
+  fs::remove_all(root);
+  fs::create_directories(root);
+  SECTION("Existing directories lose group and other access") {
+    fs::create_directory(root / "open");
+    fs::permissions(root / "open", fs::perms::all);
+    CHECK(riscv::private_cache_directory((root / "open").string(), "unused") == (root / "open").string());
+    CHECK((fs::status(root / "open").permissions() & fs::perms::mask) == fs::perms::owner_all);
+  }
+  SECTION("Symlinked directories are refused") {
+    fs::create_directory(root / "target");
+    fs::create_directory_symlink(root / "target", root / "link");
+    CHECK(riscv::private_cache_directory((root / "link").string(), "unused").empty());
+  }
+  SECTION("Only private regular files are opened") {
+    const auto dir = riscv::private_cache_directory((root / "files").string(), "unused");
+    REQUIRE(!dir.empty());
+    const auto file = fs::path(dir) / "cached";
+    REQUIRE(riscv::write_private_file(file.string(), {{"data", 4}}));
+    const int fd = riscv::open_private_file(file.string());
+    CHECK(fd >= 0);
+    if (fd >= 0) close(fd);
+    fs::permissions(file, fs::perms::group_write, fs::perm_options::add);
+    CHECK(riscv::open_private_file(file.string()) < 0);
+    fs::create_symlink(file, fs::path(dir) / "planted");
+    CHECK(riscv::open_private_file((fs::path(dir) / "planted").string()) < 0);
+  }
+  fs::remove_all(root);
+}
@@ -1,5 +1,6 @@
 #include "sim3/trace/modified.hpp"
 #include <catch.hpp>
+#include <chrono>
 #include "sim3/subsystems/bus/simple.hpp"
 #include "sim3/subsystems/ram/dense.hpp"
 #include "sim3/trace/buffers/infinite.hpp"
@@ -646,3 +647,38 @@ TEST_CASE("TranslatingModifiedAddressSink", "[scope:sim][kind:unit][arch:*]") {
     CHECK(sink.contains(5));
   }
 }
+
+TEST_CASE("Modified address GUI update cost", "[.][benchmark][scope:sim][arch:*]") {
+  using namespace sim::api2::packet;
+  // Stand-in for 1M instructions of memory-heavy code: each pushes a word to a 256-byte stack and stores a word into a
+  // 16 KiB array, so the modified addresses form many short intervals scattered over two regions.
+  static const int instructions = 1'000'000, bytesPerRow = 8;
+  InfiniteBuffer buf;
+  buf.trace(0, true);
+  quint8 src[2] = {0, 0}, dest[2] = {0, 0};
+  for (int it = 0; it < instructions; it++) {
+    buf.emitFrameStart();
+    buf.emitWrite<quint16>(0, 0xFB00 + (it * 2) % 0x100, src, dest);
+    buf.emitWrite<quint16>(0, 0x1000 + (it * 6) % 0x4000, src, dest);
+  }
+  buf.emitFrameStart();
+
+  ModifiedAddressSink<uint16_t> sink;
+  const auto start = std::chrono::steady_clock::now();
+  for (auto frame = buf.cbegin(); frame != buf.cend(); ++frame)
+    for (auto pkt = frame.cbegin(); pkt != frame.cend(); ++pkt)
+      sink.analyze(pkt, sim::api2::trace::Direction::Forward);
+  const auto analyzed = std::chrono::steady_clock::now();
+  // What SimulatorRawMemory and MemoryByteModel do with the result: one signal per interval, coalesced into rows.
+  std::size_t intervals = 0, rowRuns = 0;
+  pepp::DirtyBitmap rows;
+  sink.for_each_interval([&](I interval) {
+    intervals++;
+    rows.mark(interval.lower() / bytesPerRow, interval.upper() / bytesPerRow);
+  });
+  rows.for_each_run([&](u64, u64) { rowRuns++; });
+  const auto end = std::chrono::steady_clock::now();
+  using ms = std::chrono::duration<double, std::milli>;
+  printf("Analyze %d instructions: %.1f ms\n", instructions, ms(analyzed - start).count());
+  printf("Coalesce %zu intervals into %zu row ranges: %.3f ms\n", intervals, rowRuns, ms(end - analyzed).count());
+}